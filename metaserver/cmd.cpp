@@ -526,37 +526,29 @@ static void ParseBuffer(Session *session)
 }
 
 /**
-**  Parse all session buffers
+**  Parse the complete messages in a session's buffer
+**
+**  @param session  Session which has received data.
 */
-int UpdateParser(void)
+void ParseSession(Session *session)
 {
-	Session *session;
 	int len;
 	char *next;
 
-	if (!Pool || !Pool->First) {
-		// No connections
-		return 0;
-	}
-
-	for (session = Pool->First; session; session = session->Next) {
-		// Confirm full message.
-		while ((next = strpbrk(session->Buffer, "\r\n"))) {
-			*next++ = '\0';
-			if (*next == '\r' || *next == '\n') {
-				++next;
-			}
-
-			ParseBuffer(session);
-
-			// Remove parsed message
-			len = next - session->Buffer;
-			memmove(session->Buffer, next, sizeof(session->Buffer) - len);
-			session->Buffer[sizeof(session->Buffer) - len] = '\0';
+	// Confirm full message.
+	while (!session->Closed && (next = strpbrk(session->Buffer, "\r\n"))) {
+		*next++ = '\0';
+		if (*next == '\r' || *next == '\n') {
+			++next;
 		}
 
+		ParseBuffer(session);
+
+		// Remove parsed message
+		len = next - session->Buffer;
+		memmove(session->Buffer, next, sizeof(session->Buffer) - len);
+		session->Buffer[sizeof(session->Buffer) - len] = '\0';
 	}
-	return 0;
 }
 
 //@}
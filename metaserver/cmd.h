@@ -36,7 +36,9 @@
 --  Declarations
 ----------------------------------------------------------------------------*/
 
-extern int UpdateParser(void);
+class Session;
+
+extern void ParseSession(Session *session);
 
 //@}
 
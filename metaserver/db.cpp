@@ -38,16 +38,48 @@
 #include <string.h>
 #include <time.h>
 
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "stratagus.h"
 #include "sqlite3.h"
 #include "games.h"
+#include "netdriver.h"
+#include "db.h"
 
 /*----------------------------------------------------------------------------
 --  Variables
 ----------------------------------------------------------------------------*/
 
 static const char *dbfile = "metaserver.db";
-static sqlite3 *DB;
+static sqlite3 *DB;       /// Connection used for the reads, in the event loop
+static sqlite3 *WriteDB;  /// Connection used for the writes, in the writer thread
+
+/// Runs the writes in order, so that the event loop doesn't wait for the disk
+static boost::asio::thread_pool *DBWriter;
+
+static sqlite3_stmt *FindUserStatement;
+static sqlite3_stmt *AddUserStatement;
+static sqlite3_stmt *UpdateLoginDateStatement;
+static sqlite3_stmt *BeginStatement;
+static sqlite3_stmt *CommitStatement;
+
+/// A write queued for the writer thread
+struct DBWrite {
+	std::function<void()> Execute;  /// Binds and executes the write's statement
+	std::string RegisteredUser;     /// The user registered by the write, if any
+};
+
+/// Writes queued for the writer thread, which commits all of the writes queued by the time it runs in one transaction
+static std::vector<DBWrite> PendingWrites;
+static std::mutex PendingWritesMutex;
+
+/// Users whose registration has been queued but not yet committed, so that they can already log in
+static std::unordered_map<std::string, std::string> PendingUsers;
+static std::mutex PendingUsersMutex;
 
 #define SQLCreatePlayersTable \
 	"CREATE TABLE players (" \
@@ -102,18 +134,123 @@ static sqlite3 *DB;
 	SQLCreatePlayersTable SQLCreateGamesTable SQLCreateGameDataTable \
 	SQLCreateRankingsTable SQLCreateMapsTable
 
+#define SQLSetupConnection \
+	"PRAGMA journal_mode = WAL;" \
+	"PRAGMA synchronous = NORMAL;"
+
 /*----------------------------------------------------------------------------
 --  Functions
 ----------------------------------------------------------------------------*/
 
 /**
-**  Max id callback
+**  Compile a statement, which is kept for the lifetime of the connection
+**
+**  @return  0 for success, non-zero for failure
+*/
+static int DBPrepare(sqlite3 *db, const char *sql, sqlite3_stmt **statement)
+{
+	if (sqlite3_prepare_v2(db, sql, -1, statement, NULL) != SQLITE_OK) {
+		fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+		return -1;
+	}
+	return 0;
+}
+
+/**
+**  Execute a write statement, and reset it for reuse
+**
+**  Called in the writer thread.
+**
+**  @return  0 for success, non-zero for failure
+*/
+static int DBStep(sqlite3_stmt *statement)
+{
+	const int result = sqlite3_step(statement);
+	sqlite3_reset(statement);
+	sqlite3_clear_bindings(statement);
+
+	if (result != SQLITE_DONE) {
+		fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(WriteDB));
+		return -1;
+	}
+	return 0;
+}
+
+/**
+**  Commit the queued writes in one transaction
+**
+**  Runs in the writer thread. The writes which are queued while a batch is
+**  being committed form the next batch, so a batch is only as large as the
+**  writes which arrived during the previous commit, and nothing waits on a
+**  timer to be committed.
+*/
+static void DBWritePending(void)
+{
+	std::vector<DBWrite> writes;
+
+	{
+		std::lock_guard<std::mutex> lock(PendingWritesMutex);
+		writes.swap(PendingWrites);
+	}
+
+	DBStep(BeginStatement);
+
+	for (const DBWrite &write : writes) {
+		write.Execute();
+	}
+
+	if (DBStep(CommitStatement)) {
+		sqlite3_exec(WriteDB, "ROLLBACK;", NULL, NULL, NULL);
+	}
+
+	// the registered users can now be found by the reads
+	std::lock_guard<std::mutex> lock(PendingUsersMutex);
+	for (const DBWrite &write : writes) {
+		if (!write.RegisteredUser.empty()) {
+			PendingUsers.erase(write.RegisteredUser);
+		}
+	}
+}
+
+/**
+**  Queue a write for the writer thread
+*/
+static void DBQueueWrite(DBWrite &&write)
+{
+	bool commit_queued;
+
+	{
+		std::lock_guard<std::mutex> lock(PendingWritesMutex);
+		commit_queued = !PendingWrites.empty();
+		PendingWrites.push_back(std::move(write));
+	}
+
+	if (!commit_queued) {
+		boost::asio::post(*DBWriter, DBWritePending);
+	}
+}
+
+/**
+**  Open a connection to the database file
+**
+**  @return  0 for success, non-zero for failure
 */
-static int DBMaxIDCallback(void *password, int argc, char **argv, char **colname)
+static int DBOpen(sqlite3 **db)
 {
-	Assert(argc == 1);
-	if (argv[0])
-		GameID = atoi(argv[0]);
+	char *errmsg;
+
+	if (sqlite3_open(dbfile, db) != SQLITE_OK) {
+		fprintf(stderr, "ERROR: sqlite3_open failed: %s\n", sqlite3_errmsg(*db));
+		return -1;
+	}
+
+	errmsg = NULL;
+	if (sqlite3_exec(*db, SQLSetupConnection, NULL, NULL, &errmsg) != SQLITE_OK) {
+		fprintf(stderr, "SQL error: %s\n", errmsg);
+		sqlite3_free(errmsg);
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -127,6 +264,7 @@ int DBInit(void)
 	FILE *fd;
 	int doinit;
 	char *errmsg;
+	sqlite3_stmt *max_id_statement;
 
 	// Check if this is the first time running
 	doinit = 0;
@@ -136,29 +274,43 @@ int DBInit(void)
 		doinit = 1;
 	}
 
-	if (sqlite3_open(dbfile, &DB) != SQLITE_OK) {
-		fprintf(stderr, "ERROR: sqlite3_open failed: %s\n", sqlite3_errmsg(DB));
+	if (DBOpen(&DB)) {
 		return -1;
 	}
 
-	if (!doinit) {
-		return 0;
+	if (doinit) {
+		errmsg = NULL;
+		if (sqlite3_exec(DB, SQLCreateTables, NULL, NULL, &errmsg) != SQLITE_OK) {
+			fprintf(stderr, "SQL error: %s\n", errmsg);
+			sqlite3_free(errmsg);
+			return -1;
+		}
 	}
 
-	errmsg = NULL;
-	if (sqlite3_exec(DB, SQLCreateTables, NULL, NULL, &errmsg) != SQLITE_OK) {
-		fprintf(stderr, "SQL error: %s\n", errmsg);
-		sqlite3_free(errmsg);
+	if (DBPrepare(DB, "SELECT MAX(id) FROM games;", &max_id_statement)) {
 		return -1;
 	}
+	if (sqlite3_step(max_id_statement) == SQLITE_ROW && sqlite3_column_type(max_id_statement, 0) != SQLITE_NULL) {
+		GameID = sqlite3_column_int(max_id_statement, 0) + 1;
+	}
+	sqlite3_finalize(max_id_statement);
 
-	errmsg = NULL;
-	if (sqlite3_exec(DB, "SELECT MAX(id) FROM games;", DBMaxIDCallback, NULL, &errmsg) != SQLITE_OK) {
-		fprintf(stderr, "SQL error: %s\n", errmsg);
-		sqlite3_free(errmsg);
+	if (DBOpen(&WriteDB)) {
+		return -1;
+	}
+	// the writer may briefly wait for a checkpoint, but never the event loop
+	sqlite3_busy_timeout(WriteDB, 5000);
+
+	if (DBPrepare(DB, "SELECT password FROM players WHERE username = ?1;", &FindUserStatement)
+			|| DBPrepare(WriteDB, "INSERT INTO players VALUES(?1, ?2, ?3, ?3);", &AddUserStatement)
+			|| DBPrepare(WriteDB, "UPDATE players SET last_login_date = ?1 WHERE username = ?2;", &UpdateLoginDateStatement)
+			|| DBPrepare(WriteDB, "BEGIN;", &BeginStatement)
+			|| DBPrepare(WriteDB, "COMMIT;", &CommitStatement)) {
 		return -1;
 	}
 
+	DBWriter = new boost::asio::thread_pool(1);
+
 	return 0;
 }
 
@@ -167,17 +319,28 @@ int DBInit(void)
 */
 void DBQuit(void)
 {
-	sqlite3_close(DB);
-}
+	// finish the queued writes
+	if (DBWriter) {
+		DBWriter->join();
+		delete DBWriter;
+		DBWriter = NULL;
+	}
 
-/**
-**  Find user callback
-*/
-static int DBFindUserCallback(void *password, int argc, char **argv, char **colname)
-{
-	Assert(argc == 1);
-	strcpy((char *)password, argv[0]);
-	return 0;
+	sqlite3_finalize(FindUserStatement);
+	sqlite3_finalize(AddUserStatement);
+	sqlite3_finalize(UpdateLoginDateStatement);
+	sqlite3_finalize(BeginStatement);
+	sqlite3_finalize(CommitStatement);
+	FindUserStatement = NULL;
+	AddUserStatement = NULL;
+	UpdateLoginDateStatement = NULL;
+	BeginStatement = NULL;
+	CommitStatement = NULL;
+
+	sqlite3_close(WriteDB);
+	WriteDB = NULL;
+	sqlite3_close(DB);
+	DB = NULL;
 }
 
 /**
@@ -190,20 +353,31 @@ static int DBFindUserCallback(void *password, int argc, char **argv, char **coln
 */
 int DBFindUser(char *username, char *password)
 {
-	char buf[1024];
-	char *errmsg;
+	int result;
 
 	password[0] = '\0';
-	if (strchr(username, '\'')) {
-		return 0;
+
+	{
+		std::lock_guard<std::mutex> lock(PendingUsersMutex);
+		const auto find_iterator = PendingUsers.find(username);
+		if (find_iterator != PendingUsers.end()) {
+			snprintf(password, MAX_PASSWORD_LENGTH + 1, "%s", find_iterator->second.c_str());
+			return 1;
+		}
 	}
 
-	sprintf(buf, "SELECT password FROM players WHERE username = '%s';", username);
-	if (sqlite3_exec(DB, buf, DBFindUserCallback, password, &errmsg) != SQLITE_OK) {
-		fprintf(stderr, "SQL error: %s\n", errmsg);
-		sqlite3_free(errmsg);
-		return 0;
+	sqlite3_bind_text(FindUserStatement, 1, username, -1, SQLITE_TRANSIENT);
+	result = sqlite3_step(FindUserStatement);
+	if (result == SQLITE_ROW) {
+		const unsigned char *text = sqlite3_column_text(FindUserStatement, 0);
+		if (text) {
+			snprintf(password, MAX_PASSWORD_LENGTH + 1, "%s", (const char *)text);
+		}
+	} else if (result != SQLITE_DONE) {
+		fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(DB));
 	}
+	sqlite3_reset(FindUserStatement);
+	sqlite3_clear_bindings(FindUserStatement);
 
 	if (password[0]) {
 		return 1;
@@ -214,6 +388,8 @@ int DBFindUser(char *username, char *password)
 /**
 **  Add a user
 **
+**  The write is queued for the writer thread.
+**
 **  @param username  User name
 **  @param password  Password
 **
@@ -221,41 +397,46 @@ int DBFindUser(char *username, char *password)
 */
 int DBAddUser(char *username, char *password)
 {
-	char buf[1024];
-	int t;
-	char *errmsg;
+	const sqlite3_int64 date = (sqlite3_int64)time(0);
 
-	t = (int)time(0);
-	sprintf(buf, "INSERT INTO players VALUES('%s', '%s', %d, %d);",
-		username, password, t, t);
-	if (sqlite3_exec(DB, buf, NULL, NULL, &errmsg) != SQLITE_OK) {
-		fprintf(stderr, "SQL error: %s\n", errmsg);
-		sqlite3_free(errmsg);
-		return -1;
+	{
+		std::lock_guard<std::mutex> lock(PendingUsersMutex);
+		PendingUsers[username] = password;
 	}
+
+	DBWrite write;
+	write.Execute = [username = std::string(username), password = std::string(password), date]() {
+		sqlite3_bind_text(AddUserStatement, 1, username.c_str(), -1, SQLITE_TRANSIENT);
+		sqlite3_bind_text(AddUserStatement, 2, password.c_str(), -1, SQLITE_TRANSIENT);
+		sqlite3_bind_int64(AddUserStatement, 3, date);
+		DBStep(AddUserStatement);
+	};
+	write.RegisteredUser = username;
+	DBQueueWrite(std::move(write));
+
 	return 0;
 }
 
 /**
 **  Log in a user
 **
+**  The write is queued for the writer thread.
+**
 **  @param username  User name
 **
 **  @return          0 for success, non-zero otherwise
 */
 int DBUpdateLoginDate(char *username)
 {
-	char buf[1024];
-	int t;
-	char *errmsg;
+	const sqlite3_int64 date = (sqlite3_int64)time(0);
+
+	DBWrite write;
+	write.Execute = [username = std::string(username), date]() {
+		sqlite3_bind_int64(UpdateLoginDateStatement, 1, date);
+		sqlite3_bind_text(UpdateLoginDateStatement, 2, username.c_str(), -1, SQLITE_TRANSIENT);
+		DBStep(UpdateLoginDateStatement);
+	};
+	DBQueueWrite(std::move(write));
 
-	t = (int)time(0);
-	sprintf(buf, "UPDATE players SET last_login_date = %d WHERE username = '%s'",
-		t, username);
-	if (sqlite3_exec(DB, buf, NULL, NULL, &errmsg) != SQLITE_OK) {
-		fprintf(stderr, "SQL error: %s\n", errmsg);
-		sqlite3_free(errmsg);
-		return -1;
-	}
 	return 0;
 }
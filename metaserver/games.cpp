@@ -37,6 +37,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <map>
+#include <memory>
+#include <string>
+
 #include "stratagus.h"
 #include "games.h"
 #include "netdriver.h"
@@ -45,7 +49,12 @@
 --  Variables
 ----------------------------------------------------------------------------*/
 
-static GameData *Games;
+/// All games, keyed by their ID
+static std::map<int, std::unique_ptr<GameData>> Games;
+
+/// Games which have not been started yet, i.e. those shown by LISTGAMES, keyed by their ID
+static std::map<int, GameData *> OpenGames;
+
 int GameID;
 
 /*----------------------------------------------------------------------------
@@ -58,9 +67,7 @@ int GameID;
 void CreateGame(Session *session, char *description, char *map,
 	char *players, char *ip, char *port, char *password)
 {
-	GameData *game;
-
-	game = new GameData;
+	auto game = std::make_unique<GameData>();
 
 	strcpy(game->IP, ip);
 	strcpy(game->Port, port);
@@ -82,14 +89,10 @@ void CreateGame(Session *session, char *description, char *map,
 	game->GameName = session->UserData.GameName;
 	game->Version = session->UserData.Version;
 
-	if (Games) {
-		Games->Prev = game;
-	}
-	game->Next = Games;
-	game->Prev = NULL;
-	Games = game;
+	session->Game = game.get();
 
-	session->Game = game;
+	OpenGames[game->ID] = game.get();
+	Games[game->ID] = std::move(game);
 }
 
 /**
@@ -102,25 +105,16 @@ int CancelGame(Session *session)
 
 	game = session->Game;
 
-	if (game->Sessions[0] != session) {
+	if (!game || game->Sessions[0] != session) {
 		return -1; // Not the host
 	}
 
-	if (game->Next) {
-		game->Next->Prev = game->Prev;
-	}
-	if (game->Prev) {
-		game->Prev->Next = game->Next;
-	}
-	if (Games == game) {
-		Games = game->Next;
-	}
-
 	for (i = 0; i < game->NumSessions; ++i) {
 		game->Sessions[i]->Game = NULL;
 	}
 
-	delete game;
+	OpenGames.erase(game->ID);
+	Games.erase(game->ID);
 	return 0;
 }
 
@@ -129,11 +123,12 @@ int CancelGame(Session *session)
 */
 int StartGame(Session *session)
 {
-	if (session->Game->Sessions[0] != session) {
+	if (!session->Game || session->Game->Sessions[0] != session) {
 		return -1; // Not the host
 	}
 
 	session->Game->Started = 1;
+	OpenGames.erase(session->Game->ID);
 	return 0;
 }
 
@@ -148,23 +143,18 @@ int JoinGame(Session *session, int id, char *password)
 		return -1; // Already in a game
 	}
 
-	game = Games;
-	while (game) {
-		if (game->ID == id) {
-			break;
-		}
-		game = game->Next;
-	}
-	if (!game) {
+	const auto find_iterator = Games.find(id);
+	if (find_iterator == Games.end()) {
 		return -2; // ID not found
 	}
+	game = find_iterator->second.get();
 
 	if (game->Password[0]) {
 		if (!password || strcmp(game->Password, password)) {
 			return -3; // Wrong password
 		}
 	}
-	if (!game->OpenSlots) {
+	if (!game->OpenSlots || game->NumSessions >= (int)(sizeof(game->Sessions) / sizeof(*game->Sessions))) {
 		return -4; // Game full
 	}
 	game->Sessions[game->NumSessions++] = session;
@@ -174,26 +164,20 @@ int JoinGame(Session *session, int id, char *password)
 }
 
 /**
-**  Leave a game
+**  Remove a session from its game, cancelling the game if the session is
+**  its host
 */
-int PartGame(Session *session)
+void LeaveGame(Session *session)
 {
 	GameData *game;
 	int i;
 
 	game = session->Game;
 
-	if (!game) {
-		return -1; // Not in a game
-	}
-	if (game->Started) {
-		return -2;
-	}
-
 	if (game->Sessions[0] == session) {
 		// The host left, cancel the game
 		CancelGame(session);
-		return 0;
+		return;
 	}
 
 	for (i = 1; i < game->NumSessions; ++i) {
@@ -207,6 +191,25 @@ int PartGame(Session *session)
 	}
 
 	session->Game = NULL;
+}
+
+/**
+**  Leave a game
+*/
+int PartGame(Session *session)
+{
+	GameData *game;
+
+	game = session->Game;
+
+	if (!game) {
+		return -1; // Not in a game
+	}
+	if (game->Started) {
+		return -2;
+	}
+
+	LeaveGame(session);
 
 	return 0;
 }
@@ -219,20 +222,24 @@ static int MatchGameType(Session *session, GameData *game)
 
 /**
 **  List games
+**
+**  All matching games are sent in a single message.
 */
 void ListGames(Session *session)
 {
-	GameData *game;
 	char buf[1024];
+	std::string msg;
 
-	game = Games;
-	while (game) {
-		if (!game->Started && MatchGameType(session, game)) {
-			sprintf(buf, "LISTGAMES %d \"%s\" \"%s\" %d %d %s %s\n",
+	for (const auto &[id, game] : OpenGames) {
+		if (MatchGameType(session, game)) {
+			snprintf(buf, sizeof(buf), "LISTGAMES %d \"%s\" \"%s\" %d %d %s %s\n",
 				game->ID, game->Description, game->Map,
 				game->OpenSlots, game->MaxSlots, game->IP, game->Port);
-			Send(session, buf);
+			msg += buf;
 		}
-		game = game->Next;
+	}
+
+	if (!msg.empty()) {
+		Send(session, msg.c_str());
 	}
 }
@@ -64,9 +64,6 @@ public:
 	int NumSessions;
 	int ID;
 	int Started;
-
-	GameData *Next;
-	GameData *Prev;
 };
 
 extern int GameID;
@@ -81,6 +78,7 @@ extern int CancelGame(Session *session);
 extern int StartGame(Session *session);
 extern int JoinGame(Session *session, int id, char *password);
 extern int PartGame(Session *session);
+extern void LeaveGame(Session *session);
 extern void ListGames(Session *session);
 
 //@}
@@ -0,0 +1,257 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+/**@name loadtest.cpp - Metaserver load test client. */
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+//
+
+
+//@{
+
+/*----------------------------------------------------------------------------
+--  Includes
+----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+/*----------------------------------------------------------------------------
+--  Declarations
+----------------------------------------------------------------------------*/
+
+/**
+**  Load test parameters
+*/
+struct LoadTestOptions {
+	std::string Host = "127.0.0.1";
+	unsigned short Port = 7775;
+	int Sessions = 100;        /// Number of concurrent sessions
+	int Requests = 10;         /// LISTGAMES requests per session
+	int HoldSeconds = 0;       /// Time to keep each session connected and idle afterwards
+	bool CreateGames = false;  /// Whether each session hosts a game
+};
+
+/**
+**  Load test results, shared by all sessions
+*/
+struct LoadTestResults {
+	int Connected = 0;
+	int LoggedIn = 0;
+	int Failed = 0;
+	std::vector<double> Latencies; /// Request round trip times in milliseconds
+};
+
+/*----------------------------------------------------------------------------
+--  Variables
+----------------------------------------------------------------------------*/
+
+static LoadTestOptions Options;
+static LoadTestResults Results;
+
+/*----------------------------------------------------------------------------
+--  Functions
+----------------------------------------------------------------------------*/
+
+/**
+**  Send a command and read its reply, skipping the game entries which
+**  precede the final reply of LISTGAMES.
+**
+**  @return  The final reply line
+*/
+static boost::asio::awaitable<std::string> Request(boost::asio::ip::tcp::socket &socket, boost::asio::streambuf &buffer, const std::string &command)
+{
+	co_await boost::asio::async_write(socket, boost::asio::buffer(command), boost::asio::use_awaitable);
+
+	for (;;) {
+		const size_t len = co_await boost::asio::async_read_until(socket, buffer, '\n', boost::asio::use_awaitable);
+		std::string line(boost::asio::buffers_begin(buffer.data()), boost::asio::buffers_begin(buffer.data()) + len);
+		buffer.consume(len);
+
+		while (!line.empty() && (line.back() == '\n' || line.back() == '\r')) {
+			line.pop_back();
+		}
+
+		// Game entries precede the final LISTGAMES_OK reply
+		if (line.rfind("LISTGAMES ", 0) == 0) {
+			continue;
+		}
+
+		co_return line;
+	}
+}
+
+/**
+**  Simulate a single client session
+*/
+static boost::asio::awaitable<void> RunSession(const int index, const boost::asio::ip::tcp::endpoint endpoint)
+{
+	boost::asio::ip::tcp::socket socket(co_await boost::asio::this_coro::executor);
+	boost::asio::streambuf buffer;
+
+	try {
+		co_await socket.async_connect(endpoint, boost::asio::use_awaitable);
+		socket.set_option(boost::asio::ip::tcp::no_delay(true));
+		++Results.Connected;
+
+		const std::string credentials = "loadtest" + std::to_string(index) + " password loadtest 1\n";
+		std::string reply = co_await Request(socket, buffer, "REGISTER " + credentials);
+		if (reply == "ERR_USEREXISTS") {
+			reply = co_await Request(socket, buffer, "USER " + credentials);
+		}
+		if (reply != "REGISTER_OK" && reply != "USER_OK") {
+			fprintf(stderr, "Session %d: login failed: %s\n", index, reply.c_str());
+			++Results.Failed;
+			co_return;
+		}
+		++Results.LoggedIn;
+
+		if (Options.CreateGames) {
+			reply = co_await Request(socket, buffer, "CREATEGAME \"Load Test " + std::to_string(index) + "\" \"test.smp\" 8 127.0.0.1 6660\n");
+			if (reply != "CREATEGAME_OK") {
+				fprintf(stderr, "Session %d: game creation failed: %s\n", index, reply.c_str());
+			}
+		}
+
+		for (int i = 0; i < Options.Requests; ++i) {
+			const auto start = std::chrono::steady_clock::now();
+			reply = co_await Request(socket, buffer, "LISTGAMES\n");
+			const auto end = std::chrono::steady_clock::now();
+
+			if (reply != "LISTGAMES_OK") {
+				fprintf(stderr, "Session %d: unexpected reply: %s\n", index, reply.c_str());
+				++Results.Failed;
+				co_return;
+			}
+
+			Results.Latencies.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		if (Options.HoldSeconds > 0) {
+			boost::asio::steady_timer timer(socket.get_executor(), std::chrono::seconds(Options.HoldSeconds));
+			co_await timer.async_wait(boost::asio::use_awaitable);
+		}
+	} catch (const std::exception &exception) {
+		fprintf(stderr, "Session %d: %s\n", index, exception.what());
+		++Results.Failed;
+	}
+}
+
+/**
+**  Print the collected results
+*/
+static void PrintResults(const double seconds)
+{
+	std::vector<double> &latencies = Results.Latencies;
+	std::sort(latencies.begin(), latencies.end());
+
+	printf("Sessions: %d, connected: %d, logged in: %d, failed: %d\n",
+		Options.Sessions, Results.Connected, Results.LoggedIn, Results.Failed);
+	printf("Requests: %zu in %.2f s (%.1f requests/s)\n",
+		latencies.size(), seconds, seconds > 0 ? latencies.size() / seconds : 0.);
+
+	if (latencies.empty()) {
+		return;
+	}
+
+	const auto percentile = [&latencies](const double p) {
+		return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))];
+	};
+
+	printf("Latency (ms): min %.3f, median %.3f, p99 %.3f, max %.3f\n",
+		latencies.front(), percentile(0.5), percentile(0.99), latencies.back());
+}
+
+static void Usage(const char *argv0)
+{
+	printf("Usage: %s [-h host] [-P port] [-n sessions] [-r requests] [-w hold_seconds] [-g]\n", argv0);
+	printf("\t-h host\tMetaserver host (default 127.0.0.1)\n");
+	printf("\t-P port\tMetaserver port (default 7775)\n");
+	printf("\t-n sessions\tNumber of concurrent sessions (default 100)\n");
+	printf("\t-r requests\tLISTGAMES requests per session (default 10)\n");
+	printf("\t-w hold_seconds\tKeep the sessions connected and idle for this long afterwards\n");
+	printf("\t-g\tEach session hosts a game\n");
+}
+
+/**
+**  The main program: parse the arguments and run the sessions.
+*/
+int main(int argc, char **argv)
+{
+	for (int i = 1; i < argc; ++i) {
+		const bool has_value = i + 1 < argc;
+
+		if (!strcmp(argv[i], "-h") && has_value) {
+			Options.Host = argv[++i];
+		} else if (!strcmp(argv[i], "-P") && has_value) {
+			Options.Port = static_cast<unsigned short>(atoi(argv[++i]));
+		} else if (!strcmp(argv[i], "-n") && has_value) {
+			Options.Sessions = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-r") && has_value) {
+			Options.Requests = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-w") && has_value) {
+			Options.HoldSeconds = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-g")) {
+			Options.CreateGames = true;
+		} else {
+			Usage(argv[0]);
+			return 1;
+		}
+	}
+
+	boost::asio::io_context io_context(1);
+
+	boost::system::error_code ec;
+	const boost::asio::ip::address address = boost::asio::ip::make_address(Options.Host, ec);
+	if (ec) {
+		fprintf(stderr, "Invalid host address: %s\n", Options.Host.c_str());
+		return 1;
+	}
+	const boost::asio::ip::tcp::endpoint endpoint(address, Options.Port);
+
+	Results.Latencies.reserve(static_cast<size_t>(std::max(0, Options.Sessions)) * std::max(0, Options.Requests));
+
+	for (int i = 0; i < Options.Sessions; ++i) {
+		boost::asio::co_spawn(io_context, RunSession(i, endpoint), boost::asio::detached);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	io_context.run();
+	const auto end = std::chrono::steady_clock::now();
+
+	PrintResults(std::chrono::duration<double>(end - start).count());
+
+	return Results.Failed == 0 ? 0 : 1;
+}
+
+//@}
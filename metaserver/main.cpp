@@ -37,10 +37,7 @@
 #include <stdio.h>
 #include <string.h>
 
-#include "SDL.h"
-
 #include "stratagus.h"
-#include "util.h"
 #include "netdriver.h"
 #include "cmd.h"
 #include "db.h"
@@ -72,9 +69,9 @@ bool EnableDebugPrint;           /// if enabled, print the debug messages
 bool EnableAssert;               /// if enabled, halt on assertion failures
 bool EnableUnitDebug;            /// if enabled, a unit info dump will be created
 
-void PrintLocation(const char *file, int line, const char *funcName)
+void PrintLocation(const char *file, int line, const char *funcName, std::ostream &output_stream)
 {
-	fprintf(stdout, "%s:%d: %s: ", file, line, funcName);
+	output_stream << file << ":" << line << ": " << funcName << ": ";
 }
 
 void AbortAt(const char *file, int line, const char *funcName, const char *conditionStr)
@@ -157,47 +154,6 @@ int getopt(int argc, char *const *argv, const char *opts)
 
 
 
-/**
-**  Main loop
-*/
-static void MainLoop(void)
-{
-	Uint32 ticks[2];
-	int delay;
-	int done;
-
-	//
-	// Start the transactions.
-	//
-	done = 0;
-	while (!done) {
-		ticks[0] = SDL_GetTicks();
-
-		//
-		// Update sessions and buffers.
-		//
-		UpdateSessions();
-		UpdateParser();
-
-		ticks[1] = SDL_GetTicks();
-
-		//
-		// Idle out the remainder of this loop.
-		//
-		if ((int)(ticks[1] - ticks[0]) > Server.PollingDelay) {
-			delay = 0;
-		} else {
-			delay = Server.PollingDelay - (ticks[1] - ticks[0]);
-		}
-
-		if (delay > 2000) {
-			delay = 2000;
-		}
-
-		SDL_Delay(delay);
-	}
-
-}
 /**
 **  The main program: initialize, parse options and arguments.
 */
@@ -209,21 +165,11 @@ int main(int argc, char **argv)
 	Server.Port = DEFAULT_PORT;
 	Server.MaxConnections = DEFAULT_MAX_CONN;
 	Server.IdleTimeout = DEFAULT_SESSION_TIMEOUT;
-	Server.PollingDelay = DEFAULT_POLLING_DELAY;
-
-	//
-	// Standard SDL Init.
-	//
-	if (SDL_Init(0) == -1) {
-		printf("SDL_Init: %s\n", SDL_GetError());
-		exit(1);
-	}
-	atexit(SDL_Quit);
 
 	//
 	// Parse the command line.
 	//
-	while ((i = getopt(argc, argv, "aP:pm:i:d:")) != -1) {
+	while ((i = getopt(argc, argv, "aP:pm:i:")) != -1) {
 		switch (i) {
 			case 'a':
 				EnableAssert = true;
@@ -243,9 +189,6 @@ int main(int argc, char **argv)
 			case 'i':
 				Server.IdleTimeout = atoi(optarg);
 				break;
-			case 'd':
-				Server.PollingDelay = atoi(optarg);
-				break;
 			case ':':
 				printf("Missing argument for %c\n", optopt);
 				exit(0);
@@ -269,11 +212,7 @@ int main(int argc, char **argv)
 	// Open the server to connections.
 	//
 	if ((status = ServerInit(Server.Port)) != 0) {
-		if (status > 0) {
-			fprintf(stderr, "ERROR %d: %s\n", errno, strerror(errno));		// > 0
-		} else {
-			fprintf(stderr, "ERROR: %s\n", SDL_GetError());				// < 0
-		}
+		fprintf(stderr, "ERROR: ServerInit failed\n");
 		exit(status);
 	}
 	atexit(ServerQuit);
@@ -286,7 +225,10 @@ int main(int argc, char **argv)
 	//
 	// signal(SIGSEGV, SIG_DFL);
 
-	MainLoop();
+	//
+	// Handle the sessions as their events arrive, until stopped by a signal.
+	//
+	ServerRun();
 
 	//
 	// Server tasks done.
@@ -8,7 +8,7 @@
 //                        T H E   W A R   B E G I N S
 //         Stratagus - A free fantasy real time strategy game engine
 //
-/**@name netdriver.cpp - Session mangement (SDL_net Socket Implementation). */
+/**@name netdriver.cpp - Session mangement (Boost.Asio Implementation). */
 //
 //      (c) Copyright 2005 by Edward Haase and Jimmy Salmon
 //
@@ -37,61 +37,20 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
-#ifndef _MSC_VER
-#include <errno.h>
-#endif
 
 #include "stratagus.h"
 #include "netdriver.h"
-#include "net_lowlevel.h"
-
-/*----------------------------------------------------------------------------
---  Defines
-----------------------------------------------------------------------------*/
-
-/**
-**  LINK
-**
-**  Adds an item to a linked list.
-*/
-#define LINK(first, item, last, count) { \
-	if (!first)                     \
-		first = item;               \
-	if (!last) {                    \
-		last = item;                \
-	} else {                        \
-		item->Next = last->Next;    \
-		last->Next = item;          \
-		item->Prev = last;          \
-		last = item;                \
-		if (!item->Prev->Next)      \
-			item->Prev->Next = item;\
-	}                               \
-	++count;                        \
-}
-
-/**
-**  UNLINK
-**
-**  Removes an item from the linked list.
-*/
-#define UNLINK(first, item, last, count) { \
-	if (item->Prev)                   \
-		item->Prev->Next = item->Next;\
-	if (item->Next)                   \
-		item->Next->Prev = item->Prev;\
-	if (item == last)                 \
-		last = item->Prev;            \
-	if (item == first)                \
-		first = item->Next;           \
-	--count;                          \
-}
+#include "cmd.h"
+#include "db.h"
+#include "games.h"
 
 /*----------------------------------------------------------------------------
 --  Variables
 ----------------------------------------------------------------------------*/
 
-static Socket MasterSocket;
+static boost::asio::io_context *IOContext;
+static boost::asio::ip::tcp::acceptor *Acceptor;
+static boost::asio::signal_set *Signals;
 
 SessionPool *Pool;
 ServerStruct Server;
@@ -100,226 +59,298 @@ ServerStruct Server;
 --  Functions
 ----------------------------------------------------------------------------*/
 
+Session::Session(boost::asio::ip::tcp::socket &&socket)
+	: Idle(time(0)), Sock(std::move(socket)), IdleTimer(Sock.get_executor()), Game(NULL)
+{
+	Buffer[0] = '\0';
+	AddrData.Host = 0;
+	AddrData.IPStr[0] = '\0';
+	AddrData.Port = 0;
+	UserData.Name[0] = '\0';
+	UserData.GameName[0] = '\0';
+	UserData.Version[0] = '\0';
+	UserData.LoggedIn = 0;
+}
+
 /**
-**  Send a message to a session
+**  Returns time (in seconds) that a session has been idle.
 **
-**  @param session  Session to send the message to
-**  @param msg      Message to send
+**  @param session  This is the session we are checking.
 */
-void Send(Session *session, const char *msg)
+static int IdleSeconds(const Session *session)
 {
-	NetSendTCP(session->Sock, msg, strlen(msg));
+	return (int)(time(0) - session->Idle);
 }
 
 /**
-**  Initialize the server
+**  Destroys and cleans up session data.
 **
-**  @param port  Defines the port to which the server will bind.
+**  The session object itself is released once its last pending
+**  asynchronous operation has completed.
 **
-**  @return      0 for success, non-zero for failure
+**  @param session  Reference to the session to be killed.
 */
-int ServerInit(int port)
+static void KillSession(Session *session)
 {
-	Pool = NULL;
-
-	if (NetInit() == -1) {
-		return -1;
-	}
-
-	if ((MasterSocket = NetOpenTCP(NULL, port)) == (Socket)-1) {
-   		fprintf(stderr, "NetOpenTCP failed\n");
-   		return -2;
-	}
-
-	if (NetSetNonBlocking(MasterSocket) == -1) {
-		fprintf(stderr, "NetSetNonBlocking failed\n");
-		NetCloseTCP(MasterSocket);
-		NetExit();
-		return -3;
-	}
-
-	if (NetListenTCP(MasterSocket) == -1) {
-   		fprintf(stderr, "NetListenTCP failed\n");
-		NetCloseTCP(MasterSocket);
-		NetExit();
-   		return -4;
+	if (session->Closed) {
+		return;
 	}
 
-	if (!(Pool = new SessionPool)) {
-		fprintf(stderr, "Out of memory\n");
-		NetCloseTCP(MasterSocket);
-		NetExit();
-		return -5;
-	}
+	DebugPrint("Closing connection from '%s'\n" _C_ session->AddrData.IPStr);
+	session->Closed = true;
 
-	if (!(Pool->Sockets = new SocketSet)) {
-		NetCloseTCP(MasterSocket);
-		NetExit();
-		return -6;
+	if (session->Game) {
+		LeaveGame(session);
 	}
 
-	Pool->First = NULL;
-	Pool->Last = NULL;
-	Pool->Count = 0;
+	boost::system::error_code ec;
+	session->IdleTimer.cancel();
+	session->Sock.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+	session->Sock.close(ec);
+	session->OutgoingMessages.clear();
 
-	return 0;
+	Pool->Sessions.erase(session->shared_from_this());
+	--Pool->Count;
 }
 
 /**
-**  ServerQuit: Releases the server socket.
+**  (Re)start the idle timeout of a session
 */
-void ServerQuit(void)
+static void ResetIdleTimer(const std::shared_ptr<Session> &session)
 {
-	NetCloseTCP(MasterSocket);
-	// begin clean up of any remaining sockets
-	if (Pool) {
-		Session *ptr;
-
-		while (Pool->First) {
-			ptr = Pool->First;
-			UNLINK(Pool->First, Pool->First, Pool->Last, Pool->Count);
-			NetCloseTCP(ptr->Sock);
-			delete ptr;
+	session->Idle = time(0);
+	session->IdleTimer.expires_after(std::chrono::seconds(Server.IdleTimeout));
+	session->IdleTimer.async_wait([session](const boost::system::error_code &ec) {
+		if (ec == boost::asio::error::operation_aborted || session->Closed) {
+			return;
 		}
 
-		delete Pool->Sockets;
-		delete Pool;
-	}
+		//the timer may have expired just before new data arrived
+		if (IdleSeconds(session.get()) < Server.IdleTimeout) {
+			return;
+		}
 
-	NetExit();
+		DebugPrint("Kicking idler '%s'\n" _C_ session->AddrData.IPStr);
+		KillSession(session.get());
+	});
 }
 
 /**
-**  Returns time (in seconds) that a session has been idle.
-**
-**  @param session  This is the session we are checking.
+**  Write the first queued message of a session, continuing with the
+**  next one when done.
 */
-static int IdleSeconds(Session *session)
+static void WriteNextMessage(const std::shared_ptr<Session> &session)
 {
-	return (int)(time(0) - session->Idle);
+	boost::asio::async_write(session->Sock, boost::asio::buffer(session->OutgoingMessages.front()),
+		[session](const boost::system::error_code &ec, const size_t) {
+			if (session->Closed) {
+				return;
+			}
+
+			if (ec) {
+				KillSession(session.get());
+				return;
+			}
+
+			session->OutgoingMessages.pop_front();
+			if (!session->OutgoingMessages.empty()) {
+				WriteNextMessage(session);
+			}
+		});
 }
 
 /**
-**  Destroys and cleans up session data.
+**  Send a message to a session
 **
-**  @param session  Reference to the session to be killed.
+**  @param session  Session to send the message to
+**  @param msg      Message to send
 */
-static int KillSession(Session *session)
+void Send(Session *session, const char *msg)
 {
-	DebugPrint("Closing connection from '%s'\n" _C_ session->AddrData.IPStr);
-	NetCloseTCP(session->Sock);
-	Pool->Sockets->DelSocket(session->Sock);
-	UNLINK(Pool->First, session, Pool->Last, Pool->Count);
-	delete session;
-	return 0;
+	if (session->Closed) {
+		return;
+	}
+
+	const bool write_in_progress = !session->OutgoingMessages.empty();
+	session->OutgoingMessages.emplace_back(msg);
+
+	if (!write_in_progress) {
+		WriteNextMessage(session->shared_from_this());
+	}
 }
 
 /**
-**  Accept new connections
+**  Read data from a session until it is closed
 */
-static void AcceptConnections()
+static boost::asio::awaitable<void> ReadSession(const std::shared_ptr<Session> session)
 {
-	Session *new_session;
-	Socket new_socket;
-	unsigned long host;
-	int port;
-	while ((new_socket = NetAcceptTCP(MasterSocket, &host, &port)) != (Socket)-1) {
-		// Check if we're at MaxConnections
-		if (Pool->Count == Server.MaxConnections) {
-			NetSendTCP(new_socket, "Server Full\n", 12);
-			NetCloseTCP(new_socket);
-			break;
+	while (!session->Closed) {
+		const size_t clen = strlen(session->Buffer);
+		if (clen >= sizeof(session->Buffer) - 1) {
+			// The buffer is full without containing a complete message
+			DebugPrint("Message too long from '%s'\n" _C_ session->AddrData.IPStr);
+			KillSession(session.get());
+			co_return;
 		}
 
-		new_session = new Session;
-		if (!new_session) {
-			fprintf(stderr, "ERROR: %s\n", strerror(errno));
-			break;
+		boost::system::error_code ec;
+		const size_t result = co_await session->Sock.async_read_some(boost::asio::buffer(session->Buffer + clen, sizeof(session->Buffer) - 1 - clen), boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+
+		if (session->Closed) {
+			co_return;
 		}
 
-		new_session->Sock = new_socket;
-		new_session->Idle = time(0);
+		if (ec) {
+			KillSession(session.get());
+			co_return;
+		}
 
-		new_session->AddrData.Host = host;
-		sprintf(new_session->AddrData.IPStr, "%d.%d.%d.%d", NIPQUAD(ntohl(host)));
-		new_session->AddrData.Port = port;
-		DebugPrint("New connection from '%s'\n" _C_ new_session->AddrData.IPStr);
+		session->Buffer[clen + result] = '\0';
+		ResetIdleTimer(session);
 
-		LINK(Pool->First, new_session, Pool->Last, Pool->Count);
-		Pool->Sockets->AddSocket(new_socket);
+		ParseSession(session.get());
 	}
 }
 
 /**
-**  Kick idlers
+**  Accept new connections
 */
-static void KickIdlers(void)
+static boost::asio::awaitable<void> AcceptConnections()
 {
-	Session *session;
-	Session *next;
-
-	for (session = Pool->First; session; ) {
-		next = session->Next;
-		if (IdleSeconds(session) > Server.IdleTimeout) {
-			DebugPrint("Kicking idler '%s'\n" _C_ session->AddrData.IPStr);
-			KillSession(session);
+	for (;;) {
+		boost::system::error_code ec;
+		boost::asio::ip::tcp::socket new_socket = co_await Acceptor->async_accept(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+
+		if (ec == boost::asio::error::operation_aborted) {
+			co_return;
+		} else if (ec) {
+			fprintf(stderr, "ERROR: accept failed: %s\n", ec.message().c_str());
+			continue;
+		}
+
+		// Check if we're at MaxConnections
+		if (Pool->Count >= Server.MaxConnections) {
+			boost::asio::write(new_socket, boost::asio::buffer("Server Full\n", 12), ec);
+			new_socket.close(ec);
+			continue;
 		}
-		session = next;
+
+		const boost::asio::ip::tcp::endpoint endpoint = new_socket.remote_endpoint(ec);
+		if (ec) {
+			continue;
+		}
+
+		// replies are short and sent as soon as a command is parsed
+		new_socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+
+		const std::shared_ptr<Session> new_session = std::make_shared<Session>(std::move(new_socket));
+
+		const boost::asio::ip::address address = endpoint.address();
+		new_session->AddrData.Host = address.is_v4() ? address.to_v4().to_ulong() : 0;
+		snprintf(new_session->AddrData.IPStr, sizeof(new_session->AddrData.IPStr), "%s", address.to_string().c_str());
+		new_session->AddrData.Port = endpoint.port();
+		DebugPrint("New connection from '%s'\n" _C_ new_session->AddrData.IPStr);
+
+		Pool->Sessions.insert(new_session);
+		++Pool->Count;
+
+		ResetIdleTimer(new_session);
+		boost::asio::co_spawn(*IOContext, ReadSession(new_session), boost::asio::detached);
 	}
 }
 
 /**
-**  Read data
+**  Initialize the server
+**
+**  @param port  Defines the port to which the server will bind.
+**
+**  @return      0 for success, non-zero for failure
 */
-static int ReadData()
+int ServerInit(int port)
 {
-	int result = Pool->Sockets->Select(0);
+	Pool = NULL;
 
-	if (result == 0) {
-		// No sockets ready
-		return 0;
-	}
-	if (result == -1) {
-		// FIXME: print error message
-		return -1;
+	IOContext = new boost::asio::io_context(1);
+
+	try {
+		Acceptor = new boost::asio::ip::tcp::acceptor(*IOContext);
+		const boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), static_cast<unsigned short>(port));
+		Acceptor->open(endpoint.protocol());
+		Acceptor->set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+		Acceptor->bind(endpoint);
+		Acceptor->listen(boost::asio::socket_base::max_listen_connections);
+	} catch (const boost::system::system_error &exception) {
+		fprintf(stderr, "Opening the server socket failed: %s\n", exception.what());
+		delete Acceptor;
+		Acceptor = NULL;
+		delete IOContext;
+		IOContext = NULL;
+		return -2;
 	}
 
-	// ready sockets
-	for (Session *session = Pool->First; session; ) {
-		Session *next = session->Next;
-		if (Pool->Sockets->HasDataToRead(session->Sock)) {
-			// socket ready
-			session->Idle = time(0);
-			int clen = strlen(session->Buffer);
-			result = NetRecvTCP(session->Sock, session->Buffer + clen,
-				sizeof(session->Buffer) - clen);
-			if (result < 0) {
-				KillSession(session);
-			} else {
-				session->Buffer[clen + result] = '\0';
-			}
+	Pool = new SessionPool;
+
+	Signals = new boost::asio::signal_set(*IOContext, SIGINT, SIGTERM);
+	Signals->async_wait([](const boost::system::error_code &ec, const int) {
+		if (!ec) {
+			ServerStop();
 		}
-		session = next;
-	}
+	});
+
+	boost::asio::co_spawn(*IOContext, AcceptConnections(), boost::asio::detached);
 
 	return 0;
 }
 
 /**
-**  Accepts new connections, receives data, manages buffers,
+**  ServerQuit: Releases the server socket.
 */
-int UpdateSessions(void)
+void ServerQuit(void)
 {
-	AcceptConnections();
+	if (!IOContext) {
+		return;
+	}
+
+	ServerStop();
 
-	if (!Pool->First) {
-		// No connections
-		return 0;
+	// begin clean up of any remaining sockets
+	if (Pool) {
+		while (!Pool->Sessions.empty()) {
+			KillSession(Pool->Sessions.begin()->get());
+		}
 	}
 
-	KickIdlers();
+	// run the handlers of the aborted operations, so that the sessions are released
+	IOContext->restart();
+	IOContext->poll();
+
+	delete Signals;
+	Signals = NULL;
+	delete Acceptor;
+	Acceptor = NULL;
+	delete Pool;
+	Pool = NULL;
+	delete IOContext;
+	IOContext = NULL;
+}
+
+/**
+**  Run the event loop until the server is stopped.
+*/
+void ServerRun(void)
+{
+	IOContext->run();
+}
 
-	return ReadData();
+/**
+**  Stop accepting connections and make ServerRun return.
+*/
+void ServerStop(void)
+{
+	boost::system::error_code ec;
+	Acceptor->close(ec);
+	Signals->cancel();
+	IOContext->stop();
 }
 
 //@}
@@ -37,16 +37,21 @@
 ----------------------------------------------------------------------------*/
 
 #include <time.h>
-#include "net_lowlevel.h"
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include <boost/asio.hpp>
 
 /*----------------------------------------------------------------------------
 --  Defines
 ----------------------------------------------------------------------------*/
 
 #define DEFAULT_PORT			7775			// Server port
-#define DEFAULT_MAX_CONN		500			// Max Connections
+#define DEFAULT_MAX_CONN		5000			// Max Connections
 #define DEFAULT_SESSION_TIMEOUT		900			// 15 miniutes
-#define DEFAULT_POLLING_DELAY		250			// MS (1000 = 1s)
 
 #define MAX_USERNAME_LENGTH 32
 #define MAX_PASSWORD_LENGTH 32
@@ -65,13 +70,11 @@ class GameData;
 */
 class ServerStruct {
 public:
-	ServerStruct() : Port(0), MaxConnections(0), IdleTimeout(0),
-		PollingDelay(0) {}
+	ServerStruct() : Port(0), MaxConnections(0), IdleTimeout(0) {}
 
 	int Port;
  	int MaxConnections;
 	int IdleTimeout;
-	int PollingDelay;
 };
 
 extern ServerStruct Server;
@@ -79,29 +82,21 @@ extern ServerStruct Server;
 /**
 **  Session data
 **
-**  One per connection.
+**  One per connection. Sessions are owned by the session pool and kept
+**  alive by their pending asynchronous operations, so that no work is
+**  done for idle connections until they receive data or time out.
 */
-class Session {
+class Session final : public std::enable_shared_from_this<Session> {
 public:
-	Session() : Next(NULL), Prev(NULL), Idle(0), Sock(0), Game(NULL)
-	{
-		Buffer[0] = '\0';
-		AddrData.Host = 0;
-		AddrData.IPStr[0] = '\0';
-		AddrData.Port = 0;
-		UserData.Name[0] = '\0';
-		UserData.GameName[0] = '\0';
-		UserData.Version[0] = '\0';
-		UserData.LoggedIn = 0;
-	}
-
-	Session *Next;
-	Session *Prev;
+	explicit Session(boost::asio::ip::tcp::socket &&socket);
 
 	char Buffer[1024];
 	time_t Idle;
 
-	Socket Sock;
+	boost::asio::ip::tcp::socket Sock;
+	boost::asio::steady_timer IdleTimer;   /// Fires when the session has been idle for too long
+	std::deque<std::string> OutgoingMessages; /// Messages queued for sending, the front one is being written
+	bool Closed = false;
 
 	struct {
 		unsigned long Host;
@@ -124,13 +119,8 @@ public:
 */
 class SessionPool {
 public:
-	SessionPool() : First(NULL), Last(NULL), Count(0), Sockets(NULL) {}
-
-	Session *First;
-	Session *Last;
-	int Count;
-
-	SocketSet *Sockets;
+	std::unordered_set<std::shared_ptr<Session>> Sessions;
+	int Count = 0;
 };
 
 	/// external reference to session tracking.
@@ -144,7 +134,8 @@ extern void Send(Session *session, const char *msg);
 
 extern int ServerInit(int port);
 extern void ServerQuit(void);
-extern int UpdateSessions(void);
+extern void ServerRun(void);
+extern void ServerStop(void);
 
 //@}
 
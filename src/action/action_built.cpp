@@ -36,6 +36,7 @@
 #include "character.h"
 #include "commands.h"
 #include "database/defines.h"
+#include "economy/resource_unit_index.h"
 #include "iolib.h"
 #include "map/map.h"
 #include "map/map_layer.h"
@@ -282,7 +283,9 @@ static void Finish(COrder_Built &order, CUnit &unit)
 			unit.SetResourcesHeld(vector::get_random(type.get_starting_resources()));
 		}
 
+		const int old_resource = unit.GivesResource;
 		unit.GivesResource = type.get_given_resource()->get_index();
+		resource_unit_index::get()->on_unit_given_resource_changed(&unit, old_resource);
 		//Wyrmgus end
 	}
 
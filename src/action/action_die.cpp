@@ -132,6 +132,7 @@ void COrder_Die::Execute(CUnit &unit)
 	unit.Stats = &corpse_type->Stats[unit.Player->get_index()];
 	//Wyrmgus start
 	unit.Variable = corpse_type->Stats[unit.Player->get_index()].Variables;
+	unit.register_variable_increases();
 	//Wyrmgus end
 	UpdateUnitSightRange(unit);
 	//Wyrmgus start
@@ -199,7 +199,7 @@ void COrder_PickUp::Execute(CUnit &unit)
 		}
 
 		if (unit.HasInventory() && goal && goal->Type->BoolFlag[ITEM_INDEX].value) {
-			goal->TTL = 0; //remove item destruction timer when picked up
+			goal->set_ttl(0); //remove item destruction timer when picked up
 			
 			goal->Remove(&unit);
 			if (game::get()->is_persistency_enabled() && unit.get_character() != nullptr && unit.Player == CPlayer::GetThisPlayer()) { //if the unit has a persistent character, store the item for it
@@ -1040,9 +1040,9 @@ int COrder_Resource::GatherResource(CUnit &unit)
 
 				// Improved version of DropOutAll that makes workers go to the depot.
 				LoseResource(unit, *source);
-				for (const std::shared_ptr<wyrmgus::unit_ref> &uins_ref : source->Resource.Workers) {
-					CUnit *uins = uins_ref->get();
-					if (uins != &unit && uins->CurrentOrder()->Action == UnitAction::Resource) {
+				for (const wyrmgus::unit_handle &uins_handle : source->Resource.Workers) {
+					CUnit *uins = uins_handle.get();
+					if (uins != nullptr && uins != &unit && uins->CurrentOrder()->Action == UnitAction::Resource) {
 						COrder_Resource &order = *static_cast<COrder_Resource *>(uins->CurrentOrder());
 						if (!uins->Anim.Unbreakable && order.State == SUB_GATHER_RESOURCE) {
 							order.LoseResource(*uins, *source);
@@ -1096,8 +1096,9 @@ int GetNumWaitingWorkers(const CUnit &mine)
 {
 	int ret = 0;
 
-	for (const std::shared_ptr<wyrmgus::unit_ref> &worker_ref : mine.Resource.Workers) {
-		const CUnit *worker = worker_ref->get();
+	for (const wyrmgus::unit_handle &worker_handle : mine.Resource.Workers) {
+		const CUnit *worker = worker_handle.get();
+		assert_throw(worker != nullptr);
 		assert_throw(worker->CurrentAction() == UnitAction::Resource);
 		COrder_Resource &order = *static_cast<COrder_Resource *>(worker->CurrentOrder());
 
@@ -1159,8 +1160,9 @@ bool COrder_Resource::StopGathering(CUnit &unit)
 			if (!source->Type->BoolFlag[HARVESTFROMOUTSIDE_INDEX].value && source->Type->MaxOnBoard) {
 				int count = 0;
 				CUnit *next = nullptr;
-				for (const std::shared_ptr<wyrmgus::unit_ref> &worker_ref : source->Resource.Workers) {
-					CUnit *worker = worker_ref->get();
+				for (const wyrmgus::unit_handle &worker_handle : source->Resource.Workers) {
+					CUnit *worker = worker_handle.get();
+					assert_throw(worker != nullptr);
 					assert_throw(worker->CurrentAction() == UnitAction::Resource);
 					COrder_Resource &order = *static_cast<COrder_Resource *>(worker->CurrentOrder());
 					if (worker != &unit && order.IsGatheringWaiting()) {
@@ -277,7 +277,7 @@ void COrder_Train::Execute(CUnit &unit)
 
 	// Set life span
 	if (unit.Type->DecayRate) {
-		newUnit->TTL = GameCycle + unit.Type->DecayRate * 6 * CYCLES_PER_SECOND;
+		newUnit->set_ttl(GameCycle + unit.Type->DecayRate * 6 * CYCLES_PER_SECOND);
 	}
 	*/
 	
@@ -347,7 +347,7 @@ void COrder_Train::Execute(CUnit &unit)
 
 		// Set life span
 		if (unit.Type->DecayRate) {
-			newUnit->TTL = GameCycle + unit.Type->DecayRate * 6 * CYCLES_PER_SECOND;
+			newUnit->set_ttl(GameCycle + unit.Type->DecayRate * 6 * CYCLES_PER_SECOND);
 		}
 		
 		/* Auto Group Add */
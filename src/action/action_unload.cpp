@@ -333,7 +333,7 @@ static int UnloadUnit(CUnit &transporter, CUnit &unit, const landmass *landmass)
 		if (unit.Prefix != nullptr || unit.Suffix != nullptr || unit.Spell != nullptr || unit.Work != nullptr || unit.Elixir != nullptr) {
 			ttl_cycles *= 4;
 		}
-		unit.TTL = GameCycle + ttl_cycles;
+		unit.set_ttl(GameCycle + ttl_cycles);
 	}
 	//Wyrmgus end
 	
@@ -227,6 +227,7 @@ int TransformUnitIntoType(CUnit &unit, const wyrmgus::unit_type &newtype)
 		} else {
 			unit.Variable[i].Max += newstats.Variables[i].Max - oldstats.Variables[i].Max;
 			unit.Variable[i].Increase += newstats.Variables[i].Increase - oldstats.Variables[i].Increase;
+			unit.register_variable_increases();
 			unit.Variable[i].Enable = newstats.Variables[i].Enable;
 		}
 		//Wyrmgus end
@@ -374,6 +375,11 @@ int TransformUnitIntoType(CUnit &unit, const wyrmgus::unit_type &newtype)
 		}
 	}
 	//Wyrmgus end
+	//whether the units inside can attack depends on the type of their container
+	for (CUnit *uins : unit.get_units_inside()) {
+		uins->update_military_score_contribution();
+	}
+
 	//Wyrmgus start
 	//update the unit's XP required, as its level or points may have changed
 	unit.UpdateXPRequired();
@@ -351,32 +351,70 @@ static inline void IncreaseVariable(CUnit &unit, int index)
 	//Wyrmgus end
 }
 
+/**
+**  Handle the time to live of a unit each cycle
+**
+**  @param unit    The unit whose time to live has expired
+**
+**  @return        True if the unit has died, false otherwise
+*/
+static bool HandleTimeToLiveEachCycle(CUnit &unit)
+{
+	const int slot = UnitNumber(unit);
+	const unsigned long ttl = unit.get_ttl();
+
+	if (ttl >= GameCycle) {
+		//the slot was marked with an earlier current game cycle, e.g. before a saved game was loaded, so queue it again
+		unit_manager::get()->set_unit_ttl(slot, ttl);
+		return false;
+	}
+
+	if (!unit.IsAlive()) {
+		return false;
+	}
+
+	DebugPrint("Unit must die %lu %lu!\n" _C_ ttl _C_ GameCycle);
+
+	// Hit unit does some funky stuff...
+	--unit.Variable[HP_INDEX].Value;
+	if (unit.Variable[HP_INDEX].Value <= 0) {
+		LetUnitDie(unit);
+		return true;
+	}
+
+	return false;
+}
+
 /**
 **  Handle things about the unit that decay over time each cycle
 **
+**  Only called for the units which the unit manager has marked as having
+**  an expired time to live, timers or unit stocks.
+**
 **  @param unit    The unit that the decay is handled for
 */
 static void HandleBuffsEachCycle(CUnit &unit)
 {
-	// Look if the time to live is over.
-	if (unit.TTL && unit.IsAlive() && unit.TTL < GameCycle) {
-		DebugPrint("Unit must die %lu %lu!\n" _C_ unit.TTL _C_ GameCycle);
+	const int slot = UnitNumber(unit);
 
-		// Hit unit does some funky stuff...
-		--unit.Variable[HP_INDEX].Value;
-		if (unit.Variable[HP_INDEX].Value <= 0) {
-			LetUnitDie(unit);
-			return;
-		}
+	// Look if the time to live is over.
+	if (unit_manager::get()->has_expired_ttl(slot) && HandleTimeToLiveEachCycle(unit)) {
+		return;
 	}
 
-	if (--unit.Threshold < 0) {
-		unit.Threshold = 0;
+	const bool has_timers = unit_manager::get()->has_timers(slot);
+
+	if (has_timers) {
+		unit.decrement_spell_cooldown_timers();
 	}
 
-	unit.decrement_spell_cooldown_timers();
+	const unit_stats &stats = unit.Type->Stats[unit.Player->get_index()];
 
-	for (const auto &[unit_type, unit_stock] : unit.Type->Stats[unit.Player->get_index()].get_unit_stocks()) {
+	if (unit_manager::get()->has_unit_stocks(slot) && stats.get_unit_stocks().empty() && stats.get_unit_class_stocks().empty()) {
+		unit_manager::get()->set_has_unit_stocks(slot, false);
+	}
+
+	for (const auto &[unit_type, unit_stock] : stats.get_unit_stocks()) {
 		if (unit_stock <= 0) {
 			continue;
 		}
@@ -395,7 +433,7 @@ static void HandleBuffsEachCycle(CUnit &unit)
 		}
 	}
 	
-	for (const auto &[unit_class, unit_stock] : unit.Type->Stats[unit.Player->get_index()].get_unit_class_stocks()) {
+	for (const auto &[unit_class, unit_stock] : stats.get_unit_class_stocks()) {
 		if (unit_stock <= 0) {
 			continue;
 		}
@@ -416,8 +454,14 @@ static void HandleBuffsEachCycle(CUnit &unit)
 			}
 		}
 	}
-	
-	unit.decrement_status_effect_timers();
+
+	if (has_timers) {
+		unit.decrement_status_effect_timers();
+
+		if (unit.get_spell_cooldown_timers().empty() && unit.get_status_effect_timers().empty()) {
+			unit_manager::get()->set_has_timers(slot, false);
+		}
+	}
 }
 
 /**
@@ -468,21 +512,37 @@ static void HandleBuffsEachSecond(CUnit &unit)
 	}
 	//Wyrmgus end
 	
-	// User defined variables
-	for (unsigned int i = 0; i < UnitTypeVar.GetNumberVariable(); i++) {
-		if (i == HP_INDEX) {
-			HandleBurnAndPoison(unit);
-
-			//Wyrmgus start
-			if (unit.has_status_effect(status_effect::regeneration)) {
-				unit.Variable[i].Value += 1;
-				unit.Variable[i].Value = std::clamp(unit.Variable[i].Value, 0, unit.GetModifiedVariable(i, VariableAttribute::Max));
+	//HP is the first variable, so burn, poison and regeneration are applied before any variable increase
+	static_assert(HP_INDEX == 0);
+
+	HandleBurnAndPoison(unit);
+
+	//Wyrmgus start
+	if (unit.has_status_effect(status_effect::regeneration)) {
+		unit.Variable[HP_INDEX].Value += 1;
+		unit.Variable[HP_INDEX].Value = std::clamp(unit.Variable[HP_INDEX].Value, 0, unit.GetModifiedVariable(HP_INDEX, VariableAttribute::Max));
+	}
+	//Wyrmgus end
+
+	// User defined variables, only for the units which may have a variable with an increase
+	const int slot = UnitNumber(unit);
+	if (unit_manager::get()->has_variable_increases(slot)) {
+		bool has_variable_increases = false;
+
+		for (unsigned int i = 0; i < UnitTypeVar.GetNumberVariable(); i++) {
+			if (unit.Variable[i].Increase == 0) {
+				continue;
+			}
+
+			has_variable_increases = true;
+
+			if (unit.Variable[i].Enable) {
+				IncreaseVariable(unit, i);
 			}
-			//Wyrmgus end
 		}
 
-		if (unit.Variable[i].Enable && unit.Variable[i].Increase) {
-			IncreaseVariable(unit, i);
+		if (!has_variable_increases) {
+			unit_manager::get()->set_has_variable_increases(slot, false);
 		}
 	}
 	
@@ -651,6 +711,26 @@ static void UnitActionsEachFiveSeconds(UNITP_ITERATOR begin, UNITP_ITERATOR end)
 	}
 }
 
+/**
+**  Handle the timed effects of the units which have them, in slot order
+*/
+static void UnitTimedEffectsEachCycle()
+{
+	//copy the slots, as handling the effects may change them
+	const std::set<int> &timed_effect_slots = unit_manager::get()->get_timed_effect_slots();
+	const std::vector<int> slots(timed_effect_slots.begin(), timed_effect_slots.end());
+
+	for (const int slot : slots) {
+		CUnit &unit = unit_manager::get()->GetSlotUnit(slot);
+
+		if (unit.Destroyed) {
+			continue;
+		}
+
+		HandleBuffsEachCycle(unit);
+	}
+}
+
 template <typename UNITP_ITERATOR>
 static void UnitActionsEachCycle(UNITP_ITERATOR begin, UNITP_ITERATOR end)
 {
@@ -673,13 +753,6 @@ static void UnitActionsEachCycle(UNITP_ITERATOR begin, UNITP_ITERATOR end)
 			unit.Type->OnEachCycle->run();
 		}
 
-		// Handle each cycle buffs
-		HandleBuffsEachCycle(unit);
-		// Unit could be dead after TTL kill
-		if (unit.Destroyed) {
-			continue;
-		}
-
 		try {
 			HandleUnitAction(unit);
 		} catch (AnimationDie_Exception &) {
@@ -748,6 +821,14 @@ void UnitActions()
 		if ((GameCycle % (CYCLES_PER_SECOND * 5)) == 0) {
 			UnitActionsEachFiveSeconds(table.begin(), table.end());
 		}
+
+		//the thresholds are stored contiguously, so they are decremented for all units at once
+		unit_manager::get()->decrement_unit_thresholds();
+
+		//mark the units whose time to live has expired, and handle the timed effects of the units which have them
+		unit_manager::get()->update_expired_ttls();
+		UnitTimedEffectsEachCycle();
+
 		// Do all actions
 		UnitActionsEachCycle(table.begin(), table.end());
 
@@ -1387,7 +1387,7 @@ void CommandSharedVision(const int player_index, const bool state, const int oth
 			for (size_t z = 0; z < CMap::get()->MapLayers.size(); ++z) {
 				for (int i = 0; i != CMap::get()->Info->MapWidths[z] * CMap::get()->Info->MapHeights[z]; ++i) {
 					wyrmgus::tile &mf = *CMap::get()->Field(i, z);
-					const std::unique_ptr<wyrmgus::tile_player_info> &mfp = mf.player_info;
+					wyrmgus::tile_player_info *mfp = mf.player_info;
 
 					if (mfp->get_visibility_state(player_index) != 0 && mfp->get_visibility_state(other_player_index) == 0 && !player->is_revealed()) {
 						mfp->get_visibility_state_ref(other_player_index) = 1;
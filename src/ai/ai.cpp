@@ -127,6 +127,7 @@
 
 #include "ai.h"
 #include "ai_local.h"
+#include "ai_scheduler.h"
 
 #include "actions.h"
 #include "action/action_attack.h"
@@ -176,7 +177,6 @@
 #include "util/enum_util.h"
 #include "util/log_util.h"
 #include "util/util.h"
-#include "util/vector_random_util.h"
 #include "util/vector_util.h"
 
 int AiSleepCycles;              /// Ai sleeps # cycles
@@ -213,7 +213,7 @@ void PlayerAi::check_factions()
 	}
 
 	if (!potential_factions.empty()) {
-		this->Player->set_faction(vector::get_random(potential_factions));
+		this->Player->set_faction(potential_factions[this->generate_random(static_cast<int>(potential_factions.size()))]);
 	}
 
 	if (this->Player->get_dynasty() == nullptr && !this->Player->has_neutral_faction_type()) {
@@ -228,7 +228,7 @@ void PlayerAi::check_factions()
 		}
 
 		if (!potential_dynasties.empty()) {
-			this->Player->set_dynasty(vector::get_random(potential_dynasties));
+			this->Player->set_dynasty(potential_dynasties[this->generate_random(static_cast<int>(potential_dynasties.size()))]);
 		}
 	}
 }
@@ -270,7 +270,7 @@ void PlayerAi::evaluate_diplomacy()
 		if (!player->at_war() && GameCycle > PlayerAi::enforced_peace_cycle_count) {
 			if (player->is_independent()) {
 				std::vector<CPlayer *> border_players = container::to_vector(player->get_border_players());
-				vector::shuffle(border_players);
+				this->shuffle(border_players);
 
 				for (CPlayer *border_player : border_players) {
 					if (!player->is_player_capital_explored(border_player)) {
@@ -699,6 +699,7 @@ static void SaveAiPlayer(CFile &file, int plynr, const PlayerAi &ai)
 	}
 	file.printf("  \"last-exploration-cycle\", %lu,\n", ai.LastExplorationGameCycle);
 	file.printf("  \"last-can-not-move-cycle\", %lu,\n", ai.LastCanNotMoveGameCycle);
+	file.printf("  \"random-seed\", %u,\n", ai.get_random_seed());
 	file.printf("  \"unit-type\", {");
 	const size_t unitTypeRequestsCount = ai.UnitTypeRequests.size();
 	for (size_t i = 0; i != unitTypeRequestsCount; ++i) {
@@ -755,6 +756,8 @@ static void SaveAiPlayer(CFile &file, int plynr, const PlayerAi &ai)
 	}
 	file.printf("},\n");
 
+	AiSaveBuildingPlaceSearches(file, ai);
+
 	//Wyrmgus start
 	if (!ai.Scouts.empty()) {
 		file.printf("  \"scouts\", {");
@@ -811,6 +814,8 @@ void SaveAi(CFile &file)
 		}
 	}
 
+	ai_scheduler::get()->save(file);
+
 	DebugPrint("FIXME: Saving lua function definition isn't supported\n");
 }
 
@@ -862,6 +867,9 @@ void AiInit(CPlayer &player)
 	pai->AiType = ait;
 	pai->Script = ait->Script;
 
+	//derive the player's AI random stream from the synchronized seed, so that it is the same for all clients in a network game
+	pai->set_random_seed(random::get()->get_seed() ^ (static_cast<uint32_t>(player.get_index() + 1) * 0x9E3779B9));
+
 	//Wyrmgus start
 //	pai->Collect[GoldCost] = 50;
 //	pai->Collect[WoodCost] = 50;
@@ -882,6 +890,23 @@ void AiInit(CPlayer &player)
 void InitAiModule()
 {
 	AiResetUnitTypeEquiv();
+
+	//the tasks are registered by name, so that the queued tasks can be saved and loaded
+	ai_scheduler *scheduler = ai_scheduler::get();
+	scheduler->register_task("check_workers", ai_task_priority::high, AiCheckWorkers);
+	scheduler->register_task("check_buildings", ai_task_priority::high, AiCheckBuildings);
+	scheduler->register_task("continue_building_place_searches", ai_task_priority::high, AiContinueBuildingPlaceSearches);
+	scheduler->register_task("check_upgrades", ai_task_priority::normal, AiCheckUpgrades);
+	scheduler->register_task("force_manager_each_half_minute", ai_task_priority::normal, AiForceManagerEachHalfMinute);
+	scheduler->register_task("check_settlement_construction", ai_task_priority::normal, []() {
+		AiPlayer->check_settlement_construction();
+	});
+	scheduler->register_task("check_transporters", ai_task_priority::normal, []() {
+		AiPlayer->check_transporters();
+	});
+	scheduler->register_task("force_manager_each_minute", ai_task_priority::normal, AiForceManagerEachMinute);
+	scheduler->register_task("check_dock_construction", ai_task_priority::low, AiCheckDockConstruction);
+	scheduler->register_task("check_pathway_construction", ai_task_priority::low, AiCheckPathwayConstruction);
 }
 
 /**
@@ -892,6 +917,8 @@ void CleanAi()
 	for (int p = 0; p < PlayerMax; ++p) {
 		CPlayer::Players[p]->Ai.reset();
 	}
+
+	ai_scheduler::get()->clear();
 }
 
 /**
@@ -1118,7 +1145,7 @@ void AiHelpMe(CUnit *attacker, CUnit &defender)
 			// FIXME ad support for help from Coward type units
 			if (aiunit.IsAgressive() && aiunit.Type->can_target(attacker)
 				&& aiunit.CurrentOrder()->GetGoal() != attacker) {
-				bool shouldAttack = aiunit.IsIdle() && aiunit.Threshold == 0;
+				bool shouldAttack = aiunit.IsIdle() && aiunit.get_threshold() == 0;
 
 				if (aiunit.CurrentAction() == UnitAction::Attack) {
 					const COrder_Attack &orderAttack = *static_cast<COrder_Attack *>(aiunit.CurrentOrder());
@@ -1208,7 +1235,7 @@ void AiHelpMe(CUnit *attacker, CUnit &defender)
 				// FIXME ad support for help from Coward type units
 				if (aiunit.IsAgressive() && aiunit.Type->can_target(attacker)
 					&& aiunit.CurrentOrder()->GetGoal() != attacker) {
-					bool shouldAttack = aiunit.IsIdle() && aiunit.Threshold == 0;
+					bool shouldAttack = aiunit.IsIdle() && aiunit.get_threshold() == 0;
 
 					if (aiunit.CurrentAction() == UnitAction::Attack) {
 						const COrder_Attack &orderAttack = *static_cast<COrder_Attack *>(aiunit.CurrentOrder());
@@ -1280,7 +1307,7 @@ void AiHelpMe(CUnit *attacker, CUnit &defender)
 			// FIXME ad support for help from Coward type units
 			if (aiunit.Active && aiunit.IsAgressive() && aiunit.Type->can_target(attacker)
 				&& aiunit.CurrentOrder()->get_goal() != attacker) {
-				bool shouldAttack = aiunit.IsIdle() && aiunit.Threshold == 0;
+				bool shouldAttack = aiunit.IsIdle() && aiunit.get_threshold() == 0;
 
 				if (aiunit.CurrentAction() == UnitAction::Attack) {
 					const COrder_Attack &orderAttack = *static_cast<COrder_Attack *>(aiunit.CurrentOrder());
@@ -1472,7 +1499,7 @@ static void AiMoveUnitInTheWay(CUnit &unit)
 		}
 
 		// Move blocker in a rand dir
-		int r = SyncRand(8);
+		int r = AiPlayer->generate_random(8);
 		int trycount = 8;
 		while (trycount > 0) {
 			r = (r + 1) & 7;
@@ -1505,7 +1532,7 @@ static void AiMoveUnitInTheWay(CUnit &unit)
 
 	// Don't move more than 1 unit.
 	if (movablenb) {
-		const int index = SyncRand(movablenb);
+		const int index = AiPlayer->generate_random(movablenb);
 		std::unique_ptr<COrder> saved_order;
 		if (movableunits[index]->IsIdle() == false) {
 			if (unit.CanStoreOrder(unit.CurrentOrder())) {
@@ -1711,12 +1738,13 @@ void AiEachHalfMinute(CPlayer &player)
 	if (AiPlayer->Scouting) { //check periodically if has found new enemies
 		AiPlayer->Scouting = false;
 	}
-	
-	AiCheckWorkers();
-	AiCheckUpgrades();
-	AiCheckBuildings();
-	
-	AiForceManagerEachHalfMinute();
+
+	//the heavier checks are queued in the AI scheduler, to spread them across cycles
+	ai_scheduler *scheduler = ai_scheduler::get();
+	scheduler->queue_task(player, "check_workers");
+	scheduler->queue_task(player, "check_upgrades");
+	scheduler->queue_task(player, "check_buildings");
+	scheduler->queue_task(player, "force_manager_each_half_minute");
 }
 
 /**
@@ -1734,11 +1762,11 @@ void AiEachMinute(CPlayer &player)
 		return;
 	}
 
-	AiPlayer->check_settlement_construction();
-	AiPlayer->check_transporters();
-	AiCheckDockConstruction();
-	
-	AiForceManagerEachMinute();
+	ai_scheduler *scheduler = ai_scheduler::get();
+	scheduler->queue_task(player, "check_settlement_construction");
+	scheduler->queue_task(player, "check_transporters");
+	scheduler->queue_task(player, "check_dock_construction");
+	scheduler->queue_task(player, "force_manager_each_minute");
 }
 
 int AiGetUnitTypeCount(const PlayerAi &pai, const wyrmgus::unit_type *type, const landmass *landmass, const bool include_requests, const bool include_upgrades)
@@ -30,17 +30,24 @@
 
 #include "ai_local.h"
 
+#include "ai/ai_building_place_cache.h"
+#include "ai/ai_scheduler.h"
 #include "database/defines.h"
 #include "economy/resource.h"
+#include "iolib.h"
+#include "map/landmass.h"
 #include "map/map.h"
 #include "map/map_info.h"
 #include "map/map_layer.h"
+#include "map/site.h"
 #include "map/tile.h"
 #include "map/tile_flag.h"
 #include "pathfinder/pathfinder.h"
 #include "player/player.h"
+#include "script.h"
 #include "unit/unit.h"
 #include "unit/unit_find.h"
+#include "unit/unit_manager.h"
 #include "unit/unit_type.h"
 #include "util/assert_util.h"
 
@@ -149,7 +156,7 @@ static bool AiCheckSurrounding(const CUnit &worker, const wyrmgus::unit_type &ty
 class BuildingPlaceFinder final
 {
 public:
-	explicit BuildingPlaceFinder(const CUnit &worker, const wyrmgus::unit_type &type, bool checkSurround, Vec2i *resultPos, bool ignore_exploration, int z, const landmass *landmass, const wyrmgus::site *settlement) :
+	explicit BuildingPlaceFinder(const CUnit &worker, const wyrmgus::unit_type &type, bool checkSurround, Vec2i *resultPos, bool ignore_exploration, int z, const landmass *landmass, const wyrmgus::site *settlement, int *remaining_visit_count = nullptr) :
 		worker(worker), type(type),
 			movemask(worker.Type->MovementMask 
 			& ~((type.BoolFlag[SHOREBUILDING_INDEX].value ? (tile_flag::coast_allowed | tile_flag::land_unit | tile_flag::air_unit | tile_flag::sea_unit)
@@ -161,13 +168,18 @@ public:
 		z(z),
 		landmass(landmass),
 		settlement(settlement),
-		IgnoreExploration(ignore_exploration)
+		IgnoreExploration(ignore_exploration),
+		remaining_visit_count(remaining_visit_count)
 		//Wyrmgus start
 	{
-		resultPos->x = -1;
-		resultPos->y = -1;
 	}
 	VisitResult Visit(TerrainTraversal &terrainTraversal, const Vec2i &pos, const Vec2i &from);
+
+	bool was_cancelled() const
+	{
+		return this->cancelled;
+	}
+
 private:
 	const CUnit &worker;
 	const wyrmgus::unit_type &type;
@@ -180,6 +192,8 @@ private:
 	const wyrmgus::site *settlement;
 	bool IgnoreExploration;
 	//Wyrmgus end
+	int *remaining_visit_count = nullptr; //if set, the traversal is cancelled once this reaches zero, and can then be resumed
+	bool cancelled = false;
 };
 
 VisitResult BuildingPlaceFinder::Visit(TerrainTraversal &terrainTraversal, const Vec2i &pos, const Vec2i &from)
@@ -187,6 +201,16 @@ VisitResult BuildingPlaceFinder::Visit(TerrainTraversal &terrainTraversal, const
 	Q_UNUSED(terrainTraversal)
 	Q_UNUSED(from)
 
+	if (this->remaining_visit_count != nullptr) {
+		if (*this->remaining_visit_count == 0) {
+			//the position stays at the front of the traversal's queue, so that it is visited when the traversal is resumed
+			this->cancelled = true;
+			return VisitResult::Cancel;
+		}
+
+		--(*this->remaining_visit_count);
+	}
+
 	//Wyrmgus start
 	/*
 #if 0
@@ -209,6 +233,7 @@ VisitResult BuildingPlaceFinder::Visit(TerrainTraversal &terrainTraversal, const
 //	if (CanBuildUnitType(&worker, type, pos, 1)
 	if (
 		(!landmass || CMap::get()->get_tile_landmass(pos, z) == landmass)
+		&& ai_building_place_cache::get()->is_terrain_candidate(type, pos, z)
 		&& CanBuildUnitType(&worker, type, pos, 1, IgnoreExploration, z)
 		&& !AiEnemyUnitsInDistance(*worker.Player, nullptr, pos, 8, z)
 		&& (!this->settlement || this->settlement == tile->get_settlement())
@@ -263,6 +288,9 @@ static bool AiFindBuildingPlace2(const CUnit &worker, const wyrmgus::unit_type &
 		terrainTraversal.PushPos(startPos);
 	}
 
+	resultPos->x = -1;
+	resultPos->y = -1;
+
 	//Wyrmgus start
 //	BuildingPlaceFinder buildingPlaceFinder(worker, type, checkSurround, resultPos);
 	BuildingPlaceFinder buildingPlaceFinder(worker, type, checkSurround, resultPos, ignore_exploration, z, landmass, settlement);
@@ -272,6 +300,272 @@ static bool AiFindBuildingPlace2(const CUnit &worker, const wyrmgus::unit_type &
 	return CMap::get()->Info->IsPointOnMap(*resultPos, z);
 }
 
+/**
+**  A flood fill search for a building place, which is run in chunks over several cycles by the AI scheduler, so that searches over a large area don't make a single cycle take much longer.
+**
+**  The worker is kept as a handle, since it can be released between chunks. The game state can also change between chunks, so the place found is checked again before it is used.
+**
+**  The searches are saved with the state of their flood fill, so that a loaded game continues them as the game it was saved from does.
+*/
+class AiBuildingPlaceSearch final
+{
+public:
+	static constexpr int chunk_visit_count = 2000;
+
+	AiBuildingPlaceSearch()
+	{
+	}
+
+	explicit AiBuildingPlaceSearch(const CUnit &worker, const wyrmgus::unit_type &type, const Vec2i &startPos, const bool ignore_exploration, const int z, const landmass *landmass, const wyrmgus::site *settlement)
+		: worker(worker.get_handle()), worker_movemask(worker.Type->MovementMask), type(&type), startPos(startPos), ignore_exploration(ignore_exploration), z(z), landmass(landmass), settlement(settlement)
+	{
+		this->terrainTraversal.SetSize(CMap::get()->Info->MapWidths[z], CMap::get()->Info->MapHeights[z]);
+		this->terrainTraversal.Init();
+
+		assert_throw(CMap::get()->Info->IsPointOnMap(startPos, z));
+		this->terrainTraversal.PushPos(startPos);
+	}
+
+	//whether the search is for the same building place as one for the given parameters would be, with the worker only needing to have the same movement
+	bool Matches(const CUnit &worker, const wyrmgus::unit_type &type, const Vec2i &startPos, const bool ignore_exploration, const int z, const landmass *landmass, const wyrmgus::site *settlement) const
+	{
+		return worker.Type->MovementMask == this->worker_movemask && &type == this->type && startPos == this->startPos && ignore_exploration == this->ignore_exploration && z == this->z && landmass == this->landmass && settlement == this->settlement;
+	}
+
+	bool IsFinished() const
+	{
+		return this->finished;
+	}
+
+	const Vec2i &GetResultPos() const
+	{
+		return this->resultPos;
+	}
+
+	//run the next chunk of the search, returning whether it is finished
+	bool RunChunk()
+	{
+		const CUnit *worker = this->worker.get();
+
+		if (worker == nullptr || !worker->IsAliveOnMap()) {
+			this->resultPos = Vec2i(-1, -1);
+			this->finished = true;
+			return true;
+		}
+
+		int remaining_visit_count = AiBuildingPlaceSearch::chunk_visit_count;
+		BuildingPlaceFinder buildingPlaceFinder(*worker, *this->type, true, &this->resultPos, this->ignore_exploration, this->z, this->landmass, this->settlement, &remaining_visit_count);
+
+		this->terrainTraversal.Run(buildingPlaceFinder);
+
+		this->finished = !buildingPlaceFinder.was_cancelled();
+		return this->finished;
+	}
+
+	void Save(CFile &file) const
+	{
+		const CUnit *worker = this->worker.get();
+
+		file.printf("{\"worker\", %d, ", worker != nullptr ? UnitNumber(*worker) : -1);
+		file.printf("\"worker-movemask\", %" PRIu32 ", ", enumeration::to_underlying(this->worker_movemask));
+		file.printf("\"type\", \"%s\", ", this->type->get_identifier().c_str());
+		file.printf("\"start-pos\", {%d, %d}, ", this->startPos.x, this->startPos.y);
+		file.printf("\"map-layer\", %d, ", this->z);
+		if (this->ignore_exploration) {
+			file.printf("\"ignore-exploration\", ");
+		}
+		if (this->landmass != nullptr) {
+			file.printf("\"landmass\", %zu, ", this->landmass->get_index());
+		}
+		if (this->settlement != nullptr) {
+			file.printf("\"settlement\", \"%s\", ", this->settlement->get_identifier().c_str());
+		}
+		file.printf("\"result-pos\", {%d, %d}, ", this->resultPos.x, this->resultPos.y);
+		if (this->finished) {
+			file.printf("\"finished\", ");
+		}
+		file.printf("\"terrain-traversal\", ");
+		this->terrainTraversal.Save(file);
+		file.printf("}");
+	}
+
+	void Load(lua_State *l)
+	{
+		if (!lua_istable(l, -1)) {
+			LuaError(l, "incorrect argument in AiBuildingPlaceSearch::Load");
+		}
+		const int args = 1 + lua_rawlen(l, -1);
+		for (int i = 1; i < args; ++i) {
+			const char *tag = LuaToString(l, -1, i);
+			++i;
+			if (!strcmp(tag, "worker")) {
+				const int worker_number = LuaToNumber(l, -1, i);
+				if (worker_number != -1) {
+					this->worker = wyrmgus::unit_manager::get()->GetSlotUnit(worker_number).get_handle();
+				}
+			} else if (!strcmp(tag, "worker-movemask")) {
+				this->worker_movemask = static_cast<tile_flag>(LuaToUnsignedNumber(l, -1, i));
+			} else if (!strcmp(tag, "type")) {
+				this->type = wyrmgus::unit_type::get(LuaToString(l, -1, i));
+			} else if (!strcmp(tag, "start-pos")) {
+				lua_rawgeti(l, -1, i);
+				CclGetPos(l, &this->startPos.x, &this->startPos.y);
+				lua_pop(l, 1);
+			} else if (!strcmp(tag, "map-layer")) {
+				this->z = LuaToNumber(l, -1, i);
+			} else if (!strcmp(tag, "ignore-exploration")) {
+				this->ignore_exploration = true;
+				--i;
+			} else if (!strcmp(tag, "landmass")) {
+				this->landmass = CMap::get()->get_landmasses()[LuaToNumber(l, -1, i)].get();
+			} else if (!strcmp(tag, "settlement")) {
+				this->settlement = wyrmgus::site::get(LuaToString(l, -1, i));
+			} else if (!strcmp(tag, "result-pos")) {
+				lua_rawgeti(l, -1, i);
+				CclGetPos(l, &this->resultPos.x, &this->resultPos.y);
+				lua_pop(l, 1);
+			} else if (!strcmp(tag, "finished")) {
+				this->finished = true;
+				--i;
+			} else if (!strcmp(tag, "terrain-traversal")) {
+				lua_rawgeti(l, -1, i);
+				this->terrainTraversal.Load(l);
+				lua_pop(l, 1);
+			} else {
+				LuaError(l, "AiBuildingPlaceSearch::Load: Unsupported tag: %s" _C_ tag);
+			}
+		}
+	}
+
+private:
+	unit_handle worker;
+	tile_flag worker_movemask;
+	const wyrmgus::unit_type *type = nullptr;
+	Vec2i startPos;
+	bool ignore_exploration = false;
+	int z = 0;
+	const wyrmgus::landmass *landmass = nullptr;
+	const wyrmgus::site *settlement = nullptr;
+	TerrainTraversal terrainTraversal;
+	Vec2i resultPos = Vec2i(-1, -1);
+	bool finished = false;
+};
+
+/**
+**  Run a chunk of each of the current AI player's unfinished building place searches, queuing this again if any of them is still unfinished.
+*/
+void AiContinueBuildingPlaceSearches()
+{
+	bool unfinished = false;
+
+	for (const std::shared_ptr<AiBuildingPlaceSearch> &search : AiPlayer->BuildingPlaceSearches) {
+		if (search->IsFinished()) {
+			continue;
+		}
+
+		if (!search->RunChunk()) {
+			unfinished = true;
+		}
+	}
+
+	if (unfinished) {
+		ai_scheduler::get()->queue_task(*AiPlayer->Player, "continue_building_place_searches");
+	}
+}
+
+void AiSaveBuildingPlaceSearches(CFile &file, const PlayerAi &pai)
+{
+	file.printf("  \"building-place-searches\", {");
+	for (const std::shared_ptr<AiBuildingPlaceSearch> &search : pai.BuildingPlaceSearches) {
+		search->Save(file);
+		file.printf(", ");
+	}
+	file.printf("},\n");
+}
+
+void AiLoadBuildingPlaceSearches(lua_State *l, PlayerAi &pai)
+{
+	if (!lua_istable(l, -1)) {
+		LuaError(l, "incorrect argument");
+	}
+
+	pai.BuildingPlaceSearches.clear();
+
+	const int args = lua_rawlen(l, -1);
+	for (int i = 0; i < args; ++i) {
+		auto search = std::make_shared<AiBuildingPlaceSearch>();
+		lua_rawgeti(l, -1, i + 1);
+		search->Load(l);
+		lua_pop(l, 1);
+		pai.BuildingPlaceSearches.push_back(std::move(search));
+	}
+}
+
+/**
+**  Find a free building place with a flood fill which can be spread over several cycles.
+**
+**  The first chunk of the search is run immediately, so that searches over a small area find their result at once, as before; if more is needed, the search is continued by the AI scheduler, and its result is used when a building place is searched for with the same parameters again.
+**
+**  @return  True if a place was found, false if none was found or if the search is still in progress.
+*/
+static bool AiFindBuildingPlaceResumable(const CUnit &worker, const wyrmgus::unit_type &type, const Vec2i &startPos, Vec2i *resultPos, bool ignore_exploration, int z, const landmass *landmass, const wyrmgus::site *settlement)
+{
+	static constexpr size_t max_search_count = 4;
+
+	resultPos->x = -1;
+	resultPos->y = -1;
+
+	std::vector<std::shared_ptr<AiBuildingPlaceSearch>> &searches = worker.Player->Ai->BuildingPlaceSearches;
+
+	const auto find_iterator = std::find_if(searches.begin(), searches.end(), [&](const std::shared_ptr<AiBuildingPlaceSearch> &search) {
+		return search->Matches(worker, type, startPos, ignore_exploration, z, landmass, settlement);
+	});
+
+	if (find_iterator != searches.end()) {
+		if (!(*find_iterator)->IsFinished()) {
+			return false;
+		}
+
+		//the search's result is only used once, as the game state keeps changing
+		const Vec2i found_pos = (*find_iterator)->GetResultPos();
+		searches.erase(find_iterator);
+
+		if (CMap::get()->Info->IsPointOnMap(found_pos, z) && CanBuildUnitType(&worker, type, found_pos, 1, ignore_exploration, z)) {
+			*resultPos = found_pos;
+			return true;
+		}
+	}
+
+	std::shared_ptr<AiBuildingPlaceSearch> search = std::make_shared<AiBuildingPlaceSearch>(worker, type, startPos, ignore_exploration, z, landmass, settlement);
+
+	if (search->RunChunk()) {
+		*resultPos = search->GetResultPos();
+		return CMap::get()->Info->IsPointOnMap(*resultPos, z);
+	}
+
+	if (searches.size() >= max_search_count) {
+		searches.erase(searches.begin());
+	}
+
+	searches.push_back(std::move(search));
+
+	ai_scheduler::get()->queue_task(*worker.Player, "continue_building_place_searches");
+
+	return false;
+}
+
+/**
+**  Find a free building place with a flood fill, spreading the search over several cycles if it is resumable and the worker belongs to an AI player.
+*/
+static bool AiFindGenericBuildingPlace(const CUnit &worker, const wyrmgus::unit_type &type, const Vec2i &startPos, Vec2i *resultPos, bool ignore_exploration, int z, const landmass *landmass, const wyrmgus::site *settlement, const bool resumable)
+{
+	if (resumable && worker.Player->Ai != nullptr) {
+		return AiFindBuildingPlaceResumable(worker, type, startPos, resultPos, ignore_exploration, z, landmass, settlement);
+	}
+
+	return AiFindBuildingPlace2(worker, type, startPos, nullptr, true, resultPos, ignore_exploration, z, landmass, settlement);
+}
+
 class HallPlaceFinder final
 {
 public:
@@ -608,13 +902,14 @@ static bool AiFindMiningPlace(const CUnit &worker,
 **  @param type       Type of building.
 **  @param nearPos    Start search near nearPos position (or worker->X if nearPos is invalid).
 **  @param resultPos  Pointer for position returned.
+**  @param resumable  Whether the flood fill for buildings without special placement may be spread over several cycles, for AI players.
 **
-**  @return        True if place found, false if no found.
+**  @return        True if place found, false if no found (or if a resumable search is still in progress).
 **
 **  @todo          Better and faster way to find building place of oil
 **                 platforms Special routines for special buildings.
 */
-bool AiFindBuildingPlace(const CUnit &worker, const wyrmgus::unit_type &type, const Vec2i &nearPos, Vec2i *resultPos, bool ignore_exploration, int z, const landmass *landmass, const wyrmgus::site *settlement)
+bool AiFindBuildingPlace(const CUnit &worker, const wyrmgus::unit_type &type, const Vec2i &nearPos, Vec2i *resultPos, bool ignore_exploration, int z, const landmass *landmass, const wyrmgus::site *settlement, const bool resumable)
 {
 	// Find a good place for a new hall
 	//Wyrmgus start
@@ -650,7 +945,7 @@ bool AiFindBuildingPlace(const CUnit &worker, const wyrmgus::unit_type &type, co
 				if (AiFindLumberMillPlace(worker, type, startPos, i, resultPos, ignore_exploration, z, settlement)) {
 					return true;
 				} else {
-					return AiFindBuildingPlace2(worker, type, startPos, nullptr, true, resultPos, ignore_exploration, z, landmass, settlement);
+					return AiFindGenericBuildingPlace(worker, type, startPos, resultPos, ignore_exploration, z, landmass, settlement, resumable);
 				}
 				//Wyrmgus end
 			//Wyrmgus start
@@ -678,7 +973,7 @@ bool AiFindBuildingPlace(const CUnit &worker, const wyrmgus::unit_type &type, co
 					//Mine can be build without resource restrictions: solar panels, etc
 					//Wyrmgus start
 //					return AiFindBuildingPlace2(worker, type, startPos, nullptr, true, resultPos);
-					return AiFindBuildingPlace2(worker, type, startPos, nullptr, true, resultPos, ignore_exploration, z, landmass, settlement);
+					return AiFindGenericBuildingPlace(worker, type, startPos, resultPos, ignore_exploration, z, landmass, settlement, resumable);
 					//Wyrmgus end
 				}
 			}
@@ -686,6 +981,6 @@ bool AiFindBuildingPlace(const CUnit &worker, const wyrmgus::unit_type &type, co
 	}
 	//Wyrmgus start
 //	return AiFindBuildingPlace2(worker, type, startPos, nullptr, true, resultPos);
-	return AiFindBuildingPlace2(worker, type, startPos, nullptr, true, resultPos, ignore_exploration, z, landmass, settlement);
+	return AiFindGenericBuildingPlace(worker, type, startPos, resultPos, ignore_exploration, z, landmass, settlement, resumable);
 	//Wyrmgus end
 }
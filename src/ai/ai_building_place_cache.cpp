@@ -0,0 +1,206 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "ai/ai_building_place_cache.h"
+
+#include "map/map.h"
+#include "map/map_info.h"
+#include "map/tile.h"
+#include "map/tile_flag.h"
+#include "unit/build_restriction/and_build_restriction.h"
+#include "unit/build_restriction/on_top_build_restriction.h"
+#include "unit/build_restriction/or_build_restriction.h"
+#include "unit/unit_type.h"
+
+namespace wyrmgus {
+
+static bool has_on_top_build_restriction(const std::vector<std::unique_ptr<build_restriction>> &restrictions)
+{
+	for (const std::unique_ptr<build_restriction> &restriction : restrictions) {
+		if (dynamic_cast<const on_top_build_restriction *>(restriction.get()) != nullptr) {
+			return true;
+		}
+
+		const and_build_restriction *and_restriction = dynamic_cast<const and_build_restriction *>(restriction.get());
+		if (and_restriction != nullptr && has_on_top_build_restriction(and_restriction->get_restrictions())) {
+			return true;
+		}
+
+		const or_build_restriction *or_restriction = dynamic_cast<const or_build_restriction *>(restriction.get());
+		if (or_restriction != nullptr && has_on_top_build_restriction(or_restriction->get_restrictions())) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ai_building_place_cache::is_unit_type_cacheable(const unit_type &type)
+{
+	if (type.get_build_restrictions() == nullptr) {
+		return true;
+	}
+
+	return !has_on_top_build_restriction(type.get_build_restrictions()->get_restrictions());
+}
+
+bool ai_building_place_cache::is_terrain_candidate(const unit_type &type, const QPoint &pos, const int z)
+{
+	//the terrain flags may still change in ways not tracked by the cache while the map is being set up
+	if (GameCycle == 0) {
+		return true;
+	}
+
+	if (!ai_building_place_cache::is_unit_type_cacheable(type)) {
+		return true;
+	}
+
+	const tile_flag terrain_mask = type.MovementMask & ~ai_building_place_cache::unit_flags;
+	const candidate_map &candidate_map = this->get_candidate_map(type.get_tile_size(), terrain_mask, z);
+
+	if (!CMap::get()->Info->IsPointOnMap(pos, z)) {
+		return false;
+	}
+
+	return candidate_map.candidates[pos.x() + pos.y() * CMap::get()->Info->MapWidths[z]];
+}
+
+void ai_building_place_cache::on_tile_terrain_changed(const QRect &tile_rect, const int z)
+{
+	for (const std::unique_ptr<candidate_map> &candidate_map : this->candidate_maps) {
+		if (candidate_map->z != z) {
+			continue;
+		}
+
+		this->update_candidate_map(*candidate_map, tile_rect);
+	}
+}
+
+void ai_building_place_cache::on_unit_field_flags_changed(const QRect &tile_rect, const tile_flag field_flags, const int z)
+{
+	//units can also set flags such as no_building, impassable, air_impassable or gravel, which are part of the cached terrain masks
+	const tile_flag terrain_flags = field_flags & ~ai_building_place_cache::unit_flags;
+
+	if (terrain_flags == tile_flag::none) {
+		return;
+	}
+
+	for (const std::unique_ptr<candidate_map> &candidate_map : this->candidate_maps) {
+		if (candidate_map->z != z || (candidate_map->terrain_mask & terrain_flags) == tile_flag::none) {
+			continue;
+		}
+
+		this->update_candidate_map(*candidate_map, tile_rect);
+	}
+}
+
+ai_building_place_cache::candidate_map &ai_building_place_cache::get_candidate_map(const QSize &footprint_size, const tile_flag terrain_mask, const int z)
+{
+	for (const std::unique_ptr<candidate_map> &candidate_map : this->candidate_maps) {
+		if (candidate_map->z == z && candidate_map->footprint_size == footprint_size && candidate_map->terrain_mask == terrain_mask) {
+			return *candidate_map;
+		}
+	}
+
+	auto candidate_map = std::make_unique<ai_building_place_cache::candidate_map>();
+	candidate_map->z = z;
+	candidate_map->footprint_size = footprint_size;
+	candidate_map->terrain_mask = terrain_mask;
+	this->build_candidate_map(*candidate_map);
+
+	this->candidate_maps.push_back(std::move(candidate_map));
+	return *this->candidate_maps.back();
+}
+
+void ai_building_place_cache::build_candidate_map(candidate_map &candidate_map) const
+{
+	const int z = candidate_map.z;
+	const int map_width = CMap::get()->Info->MapWidths[z];
+	const int map_height = CMap::get()->Info->MapHeights[z];
+	const int footprint_width = candidate_map.footprint_size.width();
+	const int footprint_height = candidate_map.footprint_size.height();
+
+	//use a summed-area table of the tiles whose terrain blocks the building, so that each footprint is checked in constant time
+	const int table_width = map_width + 1;
+	std::vector<int> blocked_sums(table_width * (map_height + 1), 0);
+
+	for (int y = 0; y < map_height; ++y) {
+		for (int x = 0; x < map_width; ++x) {
+			const bool blocked = CMap::get()->Field(x, y, z)->CheckMask(candidate_map.terrain_mask);
+			blocked_sums[(x + 1) + (y + 1) * table_width] = (blocked ? 1 : 0) + blocked_sums[x + (y + 1) * table_width] + blocked_sums[(x + 1) + y * table_width] - blocked_sums[x + y * table_width];
+		}
+	}
+
+	candidate_map.candidates.assign(map_width * map_height, false);
+
+	for (int y = 0; y + footprint_height <= map_height; ++y) {
+		for (int x = 0; x + footprint_width <= map_width; ++x) {
+			const int blocked_count = blocked_sums[(x + footprint_width) + (y + footprint_height) * table_width] - blocked_sums[x + (y + footprint_height) * table_width] - blocked_sums[(x + footprint_width) + y * table_width] + blocked_sums[x + y * table_width];
+			candidate_map.candidates[x + y * map_width] = blocked_count == 0;
+		}
+	}
+}
+
+void ai_building_place_cache::update_candidate_map(candidate_map &candidate_map, const QRect &tile_rect) const
+{
+	//update the positions whose footprint overlaps the rect
+	const int z = candidate_map.z;
+	const int map_width = CMap::get()->Info->MapWidths[z];
+	const int map_height = CMap::get()->Info->MapHeights[z];
+	const QSize &footprint_size = candidate_map.footprint_size;
+
+	const int max_x = std::min(tile_rect.right(), map_width - 1);
+	const int max_y = std::min(tile_rect.bottom(), map_height - 1);
+
+	for (int y = std::max(0, tile_rect.top() - footprint_size.height() + 1); y <= max_y; ++y) {
+		for (int x = std::max(0, tile_rect.left() - footprint_size.width() + 1); x <= max_x; ++x) {
+			candidate_map.candidates[x + y * map_width] = this->calculate_candidate(candidate_map, QPoint(x, y));
+		}
+	}
+}
+
+bool ai_building_place_cache::calculate_candidate(const candidate_map &candidate_map, const QPoint &pos) const
+{
+	const int z = candidate_map.z;
+
+	if ((pos.x() + candidate_map.footprint_size.width()) > CMap::get()->Info->MapWidths[z] || (pos.y() + candidate_map.footprint_size.height()) > CMap::get()->Info->MapHeights[z]) {
+		return false;
+	}
+
+	for (int y = pos.y(); y < pos.y() + candidate_map.footprint_size.height(); ++y) {
+		for (int x = pos.x(); x < pos.x() + candidate_map.footprint_size.width(); ++x) {
+			if (CMap::get()->Field(x, y, z)->CheckMask(candidate_map.terrain_mask)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,80 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "map/tile_flag.h"
+#include "util/singleton.h"
+
+namespace wyrmgus {
+
+class unit_type;
+
+//caches, for each map layer and building footprint, the positions at which the terrain allows placing a building, so that the AI's building place searches can skip the costly build checks for tiles where a building could never be placed
+//only the terrain flags are cached, as they change rarely; units, buildings, territory and build restrictions are still checked for the remaining candidate positions
+//units whose field flags include terrain flags (e.g. no_building for buildings without hit points, or impassable for doors) update the cache when marking or unmarking their tiles
+class ai_building_place_cache final : public singleton<ai_building_place_cache>
+{
+private:
+	struct candidate_map final
+	{
+		int z = 0;
+		QSize footprint_size;
+		tile_flag terrain_mask{};
+		std::vector<bool> candidates; //whether the footprint's terrain allows a building at each position of the map layer
+	};
+
+public:
+	//the flags which only units set, and which are thus never cached
+	static inline const tile_flag unit_flags = tile_flag::land_unit | tile_flag::sea_unit | tile_flag::air_unit | tile_flag::building | tile_flag::air_building | tile_flag::item;
+
+	//whether the cache can be used for a building type; this is not the case for buildings which can be built on top of other units, as then the terrain isn't checked
+	static bool is_unit_type_cacheable(const unit_type &type);
+
+	//get whether the terrain at the position might allow the building type to be placed there; if false, the building can't be placed there
+	bool is_terrain_candidate(const unit_type &type, const QPoint &pos, const int z);
+
+	//update the cache for a change in the terrain flags of the tiles in the rect
+	void on_tile_terrain_changed(const QRect &tile_rect, const int z);
+
+	//update the cache for a unit marking or unmarking its field flags on the tiles in the rect
+	void on_unit_field_flags_changed(const QRect &tile_rect, const tile_flag field_flags, const int z);
+
+	void clear()
+	{
+		this->candidate_maps.clear();
+	}
+
+private:
+	candidate_map &get_candidate_map(const QSize &footprint_size, const tile_flag terrain_mask, const int z);
+	void build_candidate_map(candidate_map &candidate_map) const;
+	void update_candidate_map(candidate_map &candidate_map, const QRect &tile_rect) const;
+	bool calculate_candidate(const candidate_map &candidate_map, const QPoint &pos) const;
+
+	std::vector<std::unique_ptr<candidate_map>> candidate_maps;
+};
+
+}
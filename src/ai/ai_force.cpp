@@ -60,7 +60,6 @@
 #include "unit/unit_type.h"
 #include "util/assert_util.h"
 #include "util/point_util.h"
-#include "util/vector_random_util.h"
 #include "util/vector_util.h"
 
 static constexpr int AIATTACK_RANGE = 0;
@@ -1879,7 +1878,7 @@ void AiForceManager::CheckForceRecruitment()
 			
 			wyrmgus::ai_force_template *force_template = nullptr;
 			if (!potential_force_templates.empty()) {
-				force_template = wyrmgus::vector::get_random(potential_force_templates);
+				force_template = potential_force_templates[AiPlayer->generate_random(static_cast<int>(potential_force_templates.size()))];
 			}
 		
 			if (force_template) {
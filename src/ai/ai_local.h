@@ -40,10 +40,13 @@
 #undef Wait
 #endif
 
+class AiBuildingPlaceSearch;
 class AiHelper;
+class CFile;
 class CPlayer;
 class CUnit;
 class CUpgrade;
+struct lua_State;
 
 namespace wyrmgus {
 	class landmass;
@@ -418,6 +421,31 @@ public:
 
 	bool recruit_mercenary(CUnit *mercenary_building, const unit_type *mercenary_type);
 
+	uint32_t get_random_seed() const
+	{
+		return this->random_seed;
+	}
+
+	void set_random_seed(const uint32_t seed)
+	{
+		this->random_seed = seed;
+	}
+
+	//generate a random number in the range [0, max) from the player's own random stream, so that the AI players' random choices don't depend on the order in which they are processed
+	int generate_random(const int max)
+	{
+		this->random_seed = this->random_seed * (0x12345678 * 4 + 1) + 1;
+		return static_cast<int>(((this->random_seed >> 16) * static_cast<uint64_t>(max)) >> 16);
+	}
+
+	template <typename T>
+	void shuffle(std::vector<T> &values)
+	{
+		for (int i = static_cast<int>(values.size()) - 1; i > 0; --i) {
+			std::swap(values[i], values[this->generate_random(i + 1)]);
+		}
+	}
+
 	CPlayer *Player = nullptr;		/// Engine player structure
 	CAiType *AiType = nullptr;		/// AI type of this player AI
 	// controller
@@ -457,7 +485,9 @@ public:
 	int LastPathwayConstructionBuilding = 0;		/// Last building checked for pathway construction in this turn
 	std::vector<CUnit *> Scouts;				/// AI scouting units
 	//Wyrmgus end
+	std::vector<std::shared_ptr<AiBuildingPlaceSearch>> BuildingPlaceSearches;	/// Building place searches spread over several cycles
 private:
+	uint32_t random_seed = 0; //the seed of the player's AI random stream
 	landmass_map<std::vector<CUnit *>> transporters; //AI transporters, mapped to the sea (water "landmass") they belong to
 	site_map<std::vector<std::shared_ptr<unit_ref>>> site_transport_units; //units to be transported to certain sites
 };
@@ -803,12 +833,19 @@ extern void AiCheckDockConstruction();
 extern void AiCheckUpgrades();
 extern void AiCheckBuildings();
 //Wyrmgus end
+extern void AiCheckPathwayConstruction();
 
 //
 // Buildings
 //
 /// Find nice building place
-extern bool AiFindBuildingPlace(const CUnit &worker, const wyrmgus::unit_type &type, const Vec2i &nearPos, Vec2i *resultPos, bool ignore_exploration, int z, const landmass *landmass = nullptr, const wyrmgus::site *settlement = nullptr);
+extern bool AiFindBuildingPlace(const CUnit &worker, const wyrmgus::unit_type &type, const Vec2i &nearPos, Vec2i *resultPos, bool ignore_exploration, int z, const landmass *landmass = nullptr, const wyrmgus::site *settlement = nullptr, const bool resumable = false);
+/// Run a chunk of each of the current AI player's unfinished building place searches
+extern void AiContinueBuildingPlaceSearches();
+/// Save the building place searches of a player's AI
+extern void AiSaveBuildingPlaceSearches(CFile &file, const PlayerAi &pai);
+/// Load the building place searches of a player's AI from the table at the top of the Lua stack
+extern void AiLoadBuildingPlaceSearches(lua_State *l, PlayerAi &pai);
 
 //
 // Forces
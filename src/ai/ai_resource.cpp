@@ -30,6 +30,7 @@
 #include "stratagus.h"
 
 #include "ai_local.h"
+#include "ai_scheduler.h"
 
 #include "action/action_build.h"
 #include "action/action_repair.h"
@@ -61,7 +62,6 @@
 #include "upgrade/upgrade_modifier.h"
 #include "util/assert_util.h"
 #include "util/util.h"
-#include "util/vector_random_util.h"
 #include "util/vector_util.h"
 
 static constexpr int COLLECT_RESOURCES_INTERVAL = 4;
@@ -393,7 +393,7 @@ static int AiBuildBuilding(const unit_type &type, const unit_type &building, con
 
 	//Wyrmgus start
 //	CUnit &unit = (num == 1) ? *table[0] : *table[SyncRand(num)];
-	CUnit &unit = near_unit ? *near_unit : ((num == 1) ? *table[0] : *table[SyncRand(num)]);
+	CUnit &unit = near_unit ? *near_unit : ((num == 1) ? *table[0] : *table[AiPlayer->generate_random(num)]);
 	//Wyrmgus end
 	
 	if (!CMap::get()->Info->IsPointOnMap(nearPos, z)) {
@@ -404,7 +404,7 @@ static int AiBuildBuilding(const unit_type &type, const unit_type &building, con
 	// Find a place to build.
 	//Wyrmgus start
 //	if (AiFindBuildingPlace(unit, building, nearPos, &pos)) {
-	if (AiFindBuildingPlace(unit, building, nearPos, &pos, true, z, landmass, settlement)) {
+	if (AiFindBuildingPlace(unit, building, nearPos, &pos, true, z, landmass, settlement, true)) {
 	//Wyrmgus end
 		//Wyrmgus start
 //		CommandBuildBuilding(unit, pos, building, FlushCommands);
@@ -1345,10 +1345,12 @@ static void AiCheckingWork()
 **
 **  @param unit      pointer to the unit.
 **  @param resource  resource identification.
+**  @param planned_resource_unit_workers  the workers already sent to harvest from each resource unit in this pass, updated with the assignment.
+**  @param planned_resource_tiles         the resource tiles already assigned to workers in this pass, updated with the assignment.
 **
 **  @return          true if the worker was assigned, false otherwise.
 */
-static bool AiAssignHarvester(CUnit &unit, const resource *resource)
+static bool AiAssignHarvester(CUnit &unit, const resource *resource, std::map<const CUnit *, int> &planned_resource_unit_workers, point_set &planned_resource_tiles)
 {
 	if (unit.Removed || unit.CurrentAction() == UnitAction::Build) {
 		//prevent units building from outside to being assigned to gather a resource, and then leaving the construction unbuilt forever and ever
@@ -1368,12 +1370,14 @@ static bool AiAssignHarvester(CUnit &unit, const resource *resource)
 	finder.set_check_usage(true);
 	finder.set_only_harvestable(false);
 	finder.set_include_luxury_resources(resource->get_index() == CopperCost && AiPlayer->Player->HasMarketUnit());
+	finder.set_planned_harvests(&planned_resource_unit_workers, &planned_resource_tiles);
 
 	const find_resource_result result = finder.find();
 
 	if (result.resource_unit != nullptr) {
 		if (result.resource_unit->Type->BoolFlag[CANHARVEST_INDEX].value) {
 			CommandResource(unit, *result.resource_unit, FlushCommands);
+			++planned_resource_unit_workers[result.resource_unit];
 			return true;
 		} else { // if the resource isn't readily harvestable (but is a deposit), build a mine there
 			const int n = AiHelpers.Mines[result.resource_unit->GivesResource].size();
@@ -1386,12 +1390,14 @@ static bool AiAssignHarvester(CUnit &unit, const resource *resource)
 					&& CanBuildUnitType(&unit, type, result.resource_unit->tilePos, 1, true, result.resource_unit->MapLayer->ID)
 				) {
 					CommandBuildBuilding(unit, result.resource_unit->tilePos, type, FlushCommands, result.resource_unit->MapLayer->ID);
+					++planned_resource_unit_workers[result.resource_unit];
 					return true;
 				}
 			}
 		}
 	} else if (result.resource_pos != QPoint(-1, -1)) {
 		CommandResourceLoc(unit, result.resource_pos, FlushCommands, unit.MapLayer->ID);
+		planned_resource_tiles.insert(result.resource_pos);
 		return true;
 	}
 
@@ -1404,11 +1410,6 @@ static bool AiAssignHarvester(CUnit &unit, const resource *resource)
 	return false;
 }
 
-static bool CmpWorkers(const CUnit *lhs, const CUnit *rhs)
-{
-	return lhs->ResourcesHeld < rhs->ResourcesHeld;
-}
-
 //Wyrmgus start
 static bool AiCanSellResource(const resource *resource)
 {
@@ -1488,7 +1489,6 @@ static void AiCollectResources()
 		return;
 	}
 	
-	std::array<std::vector<CUnit *>, MaxCosts> units_assigned; // Worker assigned to resource
 	std::array<std::vector<CUnit *>, MaxCosts> units_unassigned; // Unassigned workers
 	std::array<int, MaxCosts> num_units_with_resource{};
 	std::array<int, MaxCosts> num_units_assigned{};
@@ -1522,7 +1522,6 @@ static void AiCollectResources()
 				cost_resource = defines::get()->get_wealth_resource();
 			}
 			//Wyrmgus end
-			units_assigned[cost_resource->get_index()].push_back(&unit);
 			num_units_assigned[cost_resource->get_index()]++;
 			total_harvester++;
 			continue;
@@ -1604,13 +1603,8 @@ static void AiCollectResources()
 	for (size_t c = 0; c < resource::get_all().size(); ++c) {
 		priority_resource[c] = c;
 		priority_needed[c] = wanted[c] - num_units_assigned[c] - num_units_with_resource[c];
-
-		if (c && num_units_assigned[c] > 1) {
-			//first should go workers with lower ResourcesHeld value
-			std::sort(units_assigned[c].begin(), units_assigned[c].end(), CmpWorkers);
-		}
 	}
-	CUnit *unit;
+
 	// sort resources by priority
 	for (size_t i = 0; i < resource::get_all().size(); ++i) {
 		for (size_t j = i + 1; j < resource::get_all().size(); ++j) {
@@ -1620,11 +1614,14 @@ static void AiCollectResources()
 			}
 		}
 	}
-	unit = nullptr;
+
+	//the assignments made in this pass, since the usage of the resources doesn't change until the workers reach them
+	std::map<const CUnit *, int> planned_resource_unit_workers;
+	point_set planned_resource_tiles;
 
 	// Try to complete each resource in the priority order
 	for (size_t i = 0; i < resource::get_all().size(); ++i) {
-		int c = priority_resource[i];
+		const int c = priority_resource[i];
 			
 		//Wyrmgus start
 		if (!wanted[c]) {
@@ -1632,124 +1629,44 @@ static void AiCollectResources()
 		}
 		//Wyrmgus end
 
-		// If there is a free worker for c, take it.
-		if (num_units_unassigned[c]) {
-			CUnit *unassigned_unit = units_unassigned[c][SyncRand(units_unassigned[c].size())]; //only try to assign one unit (randomly, so it isn't always the first unit) per time, to lessen the strain on performance
-			// Take the unit.
-			if (AiAssignHarvester(*unassigned_unit, resource::get_all()[c])) {
-				// unit is assigned
-				unit = unassigned_unit;
-					
-				// remove it from other ressources
-				for (const auto &kv_pair : unit->Type->get_resource_infos()) {
-					const resource *resource = kv_pair.first;
+		//assign as many free workers to c as it needs (at least one, as before), in one pass
+		const int needed = std::max(1, priority_needed[i]);
 
-					const int res_index = resource->get_index();
+		for (int j = 0; j < needed && num_units_unassigned[c] > 0; ++j) {
+			//pick the units randomly, so it isn't always the first unit
+			const int unit_index = AiPlayer->generate_random(num_units_unassigned[c]);
+			CUnit *unit = units_unassigned[c][unit_index];
+			units_unassigned[c][unit_index] = units_unassigned[c][--num_units_unassigned[c]];
+			units_unassigned[c].pop_back();
 
-					if (res_index == c) {
-						continue;
-					}
-
-					for (int k = 0; k < num_units_unassigned[res_index]; ++k) {
-						if (units_unassigned[res_index][k] == unit) {
-							units_unassigned[res_index][k] = units_unassigned[res_index][--num_units_unassigned[res_index]];
-							units_unassigned[res_index].pop_back();
-							break;
-						}
-					}
-				}
+			if (!AiAssignHarvester(*unit, resource::get_all()[c], planned_resource_unit_workers, planned_resource_tiles)) {
+				//the other free workers would most likely not find anything to harvest either
+				break;
 			}
-		}
 
-		// Else : Take from already assigned worker with lower priority.
-		if (!unit) {
-			// Take from lower priority only (i+1).
-			for (size_t j = i + 1; j < resource::get_all().size() && !unit; ++j) {
-				// Try to move worker from src_c to c
-				const int src_c = priority_resource[j];
+			// remove it from other ressources
+			for (const auto &kv_pair : unit->Type->get_resource_infos()) {
+				const resource *resource = kv_pair.first;
 
-				//Wyrmgus start
-				//don't reassign workers from one resource to another, that is too expensive performance-wise (this could be re-implemented if the AI is altered to keep track of found resource spots
-				break;
-				//Wyrmgus end
-					
-				//Wyrmgus start
-				// don't reassign if the src_c resource has no workers, or if the new resource has 0 "wanted"
-				if (num_units_assigned[src_c] == 0 || !wanted[c]) {
-					continue;
-				}
-				//Wyrmgus end
+				const int res_index = resource->get_index();
 
-				// Don't complete with lower priority ones...
-				//Wyrmgus start
-				/*
-				if (wanted[src_c] > wanted[c]
-					|| (wanted[src_c] == wanted[c]
-						&& num_units_assigned[src_c] <= num_units_assigned[c] + 1)) {
-				*/
-				if (wanted[src_c] && ((num_units_assigned[src_c] + 1) * 100 / wanted[src_c]) <= (num_units_assigned[c] * 100 / wanted[c])) { // what matters is the percent of "wanted" fulfilled, not the absolute quantity of needed workers for that resource; add one worker to num_units_assigned[src_c] so that you won't get one worker being shuffled back and forth
-					//Wyrmgus end
-					//Wyrmgus start
-//					continue;
-					if (num_units_assigned[c] != 0) { // if there are no workers for that resource, allow reshuffling regardless of proportion calculation, so that if the game starts with few workers (like two), the AI isn't stuck gathering only the first resource it finds
-						continue;
-					}
-					//Wyrmgus end
-				}
-					
-				//Wyrmgus start
-				if (num_units_assigned[src_c] <= wanted[src_c]) { // don't reassign if the src_c resource already has less workers than desired
-					if (num_units_assigned[c] != 0) {
-						continue;
-					}
+				if (res_index == c) {
+					continue;
 				}
-				//Wyrmgus end
-					
-				//Wyrmgus start
-//				for (int k = num_units_assigned[src_c] - 1; k >= 0 && !unit; --k) {
-				for (int k = num_units_assigned[src_c] - 1; k >= 0; --k) { // unit may be null now, continue instead of breaking loop if so
-				//Wyrmgus end
-					unit = units_assigned[src_c][k];
-					//Wyrmgus start
-					if (!unit) {
-						continue;
-					}
-					//Wyrmgus end
-
-					assert_throw(unit->CurrentAction() == UnitAction::Resource);
-					COrder_Resource &order = *static_cast<COrder_Resource *>(unit->CurrentOrder());
-
-					if (order.IsGatheringFinished()) {
-						//worker returning with resource
-						continue;
-					}
 
-					//Wyrmgus start
-					if (unit->Removed || unit->CurrentAction() == UnitAction::Build) { //if unit is removed or is currently building something, it can't be told to harvest (do this here so that AiAssignHarvester returning false later on is only because of unit type not being able to harvest something)
-						unit = nullptr;
-						continue;
-					}
-					//Wyrmgus end
-					
-					// unit can't harvest : next one
-					if (unit->Type->get_resource_info(resource::get_all()[c]) == nullptr || !AiAssignHarvester(*unit, resource::get_all()[c])) {
-						unit = nullptr;
-						continue;
+				for (int k = 0; k < num_units_unassigned[res_index]; ++k) {
+					if (units_unassigned[res_index][k] == unit) {
+						units_unassigned[res_index][k] = units_unassigned[res_index][--num_units_unassigned[res_index]];
+						units_unassigned[res_index].pop_back();
+						break;
 					}
-
-					// Remove from src_c
-					units_assigned[src_c][k] = units_assigned[src_c][--num_units_assigned[src_c]];
-					units_assigned[src_c].pop_back();
-
-					// j need one more
-					priority_needed[j]++;
-					
-					//Wyrmgus start
-					break; //only reassign one worker per time
-					//Wyrmgus end
 				}
 			}
 		}
+
+		//Wyrmgus start
+		//don't reassign workers from one resource to another, that is too expensive performance-wise (this could be re-implemented if the AI is altered to keep track of found resource spots
+		//Wyrmgus end
 	}
 	
 	//Wyrmgus start
@@ -1786,7 +1703,7 @@ static void AiCollectResources()
 					FindPlayerUnitsByType(*AiPlayer->Player, market_type, market_table, true);
 					
 					if (market_table.size() > 0) {
-						CUnit &market_unit = *market_table[SyncRand(market_table.size())];
+						CUnit &market_unit = *market_table[AiPlayer->generate_random(static_cast<int>(market_table.size()))];
 						CommandBuyResource(market_unit, c, AiPlayer->Player->get_index());
 						break;
 					}
@@ -1824,7 +1741,7 @@ static void AiCollectResources()
 					FindPlayerUnitsByType(*AiPlayer->Player, market_type, market_table, true);
 
 					if (market_table.size() > 0) {
-						CUnit &market_unit = *market_table[SyncRand(market_table.size())];
+						CUnit &market_unit = *market_table[AiPlayer->generate_random(static_cast<int>(market_table.size()))];
 						CommandSellResource(market_unit, c, AiPlayer->Player->get_index());
 						break;
 					}
@@ -1834,6 +1751,7 @@ static void AiCollectResources()
 	}
 	
 	//explore with the workers that are still idle (as that means they haven't gotten something to harvest)
+	const int n = AiPlayer->Player->GetUnitCount();
 	for (int i = 0; i < n; ++i) {
 		CUnit &scout_unit = AiPlayer->Player->GetUnit(i);
 
@@ -2163,7 +2081,7 @@ static bool build_pathway_for_pos(const QPoint &pathway_pos, const CMapLayer *ma
 /**
 **  Check if there's a building that should have pathways around it, but doesn't.
 */
-static void AiCheckPathwayConstruction()
+void AiCheckPathwayConstruction()
 {
 	if (AiPlayer->Player->NumTownHalls < 1) { //don't build pathways if has no town hall yet
 		return;
@@ -2539,7 +2457,7 @@ void AiCheckUpgrades()
 	}
 
 	std::vector<const CUpgrade *> potential_upgrades = AiPlayer->Player->GetResearchableUpgrades();
-	vector::shuffle(potential_upgrades); //shuffle the vector, so that upgrades are chosen at random
+	AiPlayer->shuffle(potential_upgrades); //shuffle the vector, so that upgrades are chosen at random
 	
 	for (size_t i = 0; i < potential_upgrades.size(); ++i) {
 		const CUpgrade *upgrade = potential_upgrades[i];
@@ -2631,7 +2549,7 @@ void AiCheckBuildings()
 		return;
 	}
 	
-	const CAiBuildingTemplate *building_template = potential_building_templates[SyncRand(potential_building_templates.size())];
+	const CAiBuildingTemplate *building_template = potential_building_templates[AiPlayer->generate_random(static_cast<int>(potential_building_templates.size()))];
 	
 	const unit_type *unit_type = AiPlayer->Player->get_faction()->get_class_unit_type(building_template->get_unit_class());
 	
@@ -2713,7 +2631,7 @@ static void AiCheckMinecartConstruction()
 	}
 	
 	if (potential_settlements.size() > 0) {
-		AiAddUnitTypeRequest(*minecart_type, 1, 0, potential_settlements[SyncRand(potential_settlements.size())]);
+		AiAddUnitTypeRequest(*minecart_type, 1, 0, potential_settlements[AiPlayer->generate_random(static_cast<int>(potential_settlements.size()))]);
 	}
 }
 
@@ -2847,6 +2765,6 @@ void AiResourceManager()
 	AiCheckRepair();
 	
 	//Wyrmgus start
-	AiCheckPathwayConstruction();
+	ai_scheduler::get()->queue_task(*AiPlayer->Player, "check_pathway_construction");
 	//Wyrmgus end
 }
@@ -0,0 +1,191 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "ai/ai_scheduler.h"
+
+#include "ai/ai_local.h"
+#include "iolib.h"
+#include "pathfinder/pathfinder.h"
+#include "player/player.h"
+#include "profiler.h"
+#include "script.h"
+
+namespace wyrmgus {
+
+void ai_scheduler::register_task(const std::string_view &name, const ai_task_priority priority, std::function<void()> &&function)
+{
+	task_type &type = this->task_types[name];
+	type.priority = priority;
+	type.function = std::move(function);
+}
+
+void ai_scheduler::queue_task(const CPlayer &player, const std::string_view &name)
+{
+	const auto find_iterator = this->task_types.find(name);
+	if (find_iterator == this->task_types.end()) {
+		throw std::runtime_error("Tried to queue the unregistered AI task \"" + std::string(name) + "\".");
+	}
+
+	std::deque<task> &queue = this->queues[static_cast<size_t>(find_iterator->second.priority)];
+
+	for (const task &queued_task : queue) {
+		if (queued_task.player_index == player.get_index() && queued_task.name == name) {
+			return;
+		}
+	}
+
+	task new_task;
+	new_task.player_index = player.get_index();
+	new_task.name = find_iterator->first;
+	new_task.queued_game_cycle = GameCycle;
+	queue.push_back(std::move(new_task));
+}
+
+void ai_scheduler::run_tasks()
+{
+	//first run the tasks which have waited for too long, regardless of the budget; as the queues are in queuing order, these are at their front
+	for (std::deque<task> &queue : this->queues) {
+		while (!queue.empty() && GameCycle >= queue.front().queued_game_cycle + ai_scheduler::max_wait_cycles) {
+			const task overdue_task = std::move(queue.front());
+			queue.pop_front();
+			this->run_task(overdue_task);
+		}
+	}
+
+	int spent_budget = 0;
+
+	for (std::deque<task> &queue : this->queues) {
+		while (!queue.empty()) {
+			const int cost = this->get_task_cost(queue.front().name);
+
+			//always allow at least one task per cycle, even if its cost exceeds the budget by itself
+			if (spent_budget > 0 && (spent_budget + cost) > ai_scheduler::cycle_budget) {
+				return;
+			}
+
+			const task current_task = std::move(queue.front());
+			queue.pop_front();
+			spent_budget += cost;
+			this->run_task(current_task);
+		}
+	}
+}
+
+void ai_scheduler::run_task(const task &task_to_run)
+{
+	CPlayer *player = CPlayer::Players[task_to_run.player_index].get();
+
+	//the player's AI may have been removed while the task was queued
+	if (!player->AiEnabled || player->Ai == nullptr) {
+		return;
+	}
+
+	PROFILE_SCOPE(profiler_stage::ai, task_to_run.player_index);
+
+	AiPlayer = player->Ai.get();
+
+	const uint64_t start_work_count = PathFinderWorkCount;
+
+	this->task_types.find(task_to_run.name)->second.function();
+
+	const uint64_t work_count = PathFinderWorkCount - start_work_count;
+	const int measured_cost = static_cast<int>(std::min<uint64_t>(work_count + ai_scheduler::base_task_cost, std::numeric_limits<int>::max() / 4));
+
+	//keep a moving average, so that a single unusually heavy or light run doesn't change the cost too much
+	const auto find_iterator = this->task_costs.find(task_to_run.name);
+	if (find_iterator != this->task_costs.end()) {
+		find_iterator->second = (find_iterator->second * 3 + measured_cost) / 4;
+	} else {
+		this->task_costs[task_to_run.name] = measured_cost;
+	}
+}
+
+void ai_scheduler::save(CFile &file) const
+{
+	file.printf("DefineAiScheduler(\n");
+
+	//the tasks are saved in queuing order, with each queue after the one of the previous priority, so that loading them into the queues of their priorities restores the same order
+	file.printf("  \"tasks\", {");
+	for (const std::deque<task> &queue : this->queues) {
+		for (const task &queued_task : queue) {
+			file.printf("%d, \"%s\", %lu, ", queued_task.player_index, std::string(queued_task.name).c_str(), queued_task.queued_game_cycle);
+		}
+	}
+	file.printf("},\n");
+
+	file.printf("  \"task-costs\", {");
+	for (const auto &[name, cost] : this->task_costs) {
+		file.printf("\"%s\", %d, ", std::string(name).c_str(), cost);
+	}
+	file.printf("}\n");
+
+	file.printf(")\n");
+}
+
+void ai_scheduler::load(lua_State *l)
+{
+	this->clear();
+
+	const int args = lua_gettop(l);
+	for (int j = 0; j < args; ++j) {
+		const char *value = LuaToString(l, j + 1);
+		++j;
+
+		if (!strcmp(value, "tasks")) {
+			if (!lua_istable(l, j + 1)) {
+				LuaError(l, "incorrect argument");
+			}
+			const int subargs = lua_rawlen(l, j + 1);
+			for (int k = 0; k < subargs; ++k) {
+				task loaded_task;
+				loaded_task.player_index = LuaToNumber(l, j + 1, k + 1);
+				++k;
+				loaded_task.name = this->get_task_name(LuaToString(l, j + 1, k + 1));
+				++k;
+				loaded_task.queued_game_cycle = LuaToUnsignedNumber(l, j + 1, k + 1);
+
+				const ai_task_priority priority = this->task_types.find(loaded_task.name)->second.priority;
+				this->queues[static_cast<size_t>(priority)].push_back(std::move(loaded_task));
+			}
+		} else if (!strcmp(value, "task-costs")) {
+			if (!lua_istable(l, j + 1)) {
+				LuaError(l, "incorrect argument");
+			}
+			const int subargs = lua_rawlen(l, j + 1);
+			for (int k = 0; k < subargs; ++k) {
+				const std::string_view &name = this->get_task_name(LuaToString(l, j + 1, k + 1));
+				++k;
+				this->task_costs[name] = LuaToNumber(l, j + 1, k + 1);
+			}
+		} else {
+			LuaError(l, "Unsupported tag: %s" _C_ value);
+		}
+	}
+}
+
+}
@@ -0,0 +1,125 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "util/singleton.h"
+
+class CFile;
+class CPlayer;
+struct lua_State;
+
+namespace wyrmgus {
+
+enum class ai_task_priority {
+	high, //tasks affecting the AI's economy, such as the worker and building checks
+	normal,
+	low, //tasks whose delay has little effect, such as the pathway and dock construction checks
+
+	count
+};
+
+//runs the heavy periodic AI tasks of players spread across game cycles, within a per-cycle work budget, so that cycles in which a player's periodic checks coincide don't take much longer than others
+//the budget is measured in deterministic work units rather than in time, since the AI runs on every client in network games and must make the same decisions in the same cycles; the cost of a task is the average of the work it was measured to do when it last ran, counting the path finding work done (see PathFinderWorkCount) plus a base cost for the rest of its work
+//tasks are registered by name, so that the queued tasks and the measured costs can be saved, and a loaded game makes the same decisions as the game it was saved from
+class ai_scheduler final : public singleton<ai_scheduler>
+{
+private:
+	struct task_type final
+	{
+		ai_task_priority priority = ai_task_priority::normal;
+		std::function<void()> function;
+	};
+
+	struct task final
+	{
+		int player_index = -1;
+		std::string_view name;
+		unsigned long queued_game_cycle = 0;
+	};
+
+public:
+	static constexpr int cycle_budget = 10000;
+
+	//the cost counted for a task's work other than path finding
+	static constexpr int base_task_cost = 100;
+
+	//the cost assumed for a task which has not been measured yet
+	static constexpr int default_task_cost = 2000;
+
+	//tasks which have waited for this long are run even if the cycle's budget has been spent, so that low priority tasks are not starved
+	static constexpr unsigned long max_wait_cycles = CYCLES_PER_SECOND * 5;
+
+	//register the function run by the tasks with the given name; the name must have static storage duration, as it is used to refer to the task type
+	void register_task(const std::string_view &name, const ai_task_priority priority, std::function<void()> &&function);
+
+	//queue a task for a player's AI, unless a task with the same name is already queued for the player; the task is called with the player's AI set as the current one
+	void queue_task(const CPlayer &player, const std::string_view &name);
+
+	void run_tasks();
+
+	void save(CFile &file) const;
+	void load(lua_State *l);
+
+	void clear()
+	{
+		for (std::deque<task> &queue : this->queues) {
+			queue.clear();
+		}
+
+		this->task_costs.clear();
+	}
+
+	int get_task_cost(const std::string_view &name) const
+	{
+		const auto find_iterator = this->task_costs.find(name);
+		if (find_iterator != this->task_costs.end()) {
+			return find_iterator->second;
+		}
+
+		return ai_scheduler::default_task_cost;
+	}
+
+private:
+	//get the registered name equal to the given one, which has static storage duration
+	const std::string_view &get_task_name(const std::string_view &name) const
+	{
+		const auto find_iterator = this->task_types.find(name);
+		if (find_iterator == this->task_types.end()) {
+			throw std::runtime_error("No AI task is registered with the name \"" + std::string(name) + "\".");
+		}
+
+		return find_iterator->first;
+	}
+
+	void run_task(const task &task_to_run);
+
+	std::map<std::string_view, task_type> task_types;
+	std::array<std::deque<task>, static_cast<size_t>(ai_task_priority::count)> queues;
+	std::map<std::string_view, int> task_costs; //the average measured cost of each task
+};
+
+}
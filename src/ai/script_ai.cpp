@@ -31,6 +31,7 @@
 
 #include "ai.h"
 #include "ai_local.h"
+#include "ai_scheduler.h"
 
 #include "database/defines.h"
 #include "economy/resource.h"
@@ -1502,6 +1503,17 @@ static void CclParseBuildQueue(lua_State *l, PlayerAi *ai, int offset)
 	}
 }
 
+/**
+**  Define the state of the AI scheduler.
+**
+**  @param l  Lua state.
+*/
+static int CclDefineAiScheduler(lua_State *l)
+{
+	ai_scheduler::get()->load(l);
+	return 0;
+}
+
 /**
 ** Define an AI player.
 **
@@ -1705,6 +1717,8 @@ static int CclDefineAiPlayer(lua_State *l)
 			ai->LastExplorationGameCycle = LuaToNumber(l, j + 1);
 		} else if (!strcmp(value, "last-can-not-move-cycle")) {
 			ai->LastCanNotMoveGameCycle = LuaToNumber(l, j + 1);
+		} else if (!strcmp(value, "random-seed")) {
+			ai->set_random_seed(LuaToUnsignedNumber(l, j + 1));
 		} else if (!strcmp(value, "unit-type")) {
 			if (!lua_istable(l, j + 1)) {
 				LuaError(l, "incorrect argument");
@@ -1750,6 +1764,10 @@ static int CclDefineAiPlayer(lua_State *l)
 			}
 		} else if (!strcmp(value, "building")) {
 			CclParseBuildQueue(l, ai, j + 1);
+		} else if (!strcmp(value, "building-place-searches")) {
+			lua_pushvalue(l, j + 1);
+			AiLoadBuildingPlaceSearches(l, *ai);
+			lua_pop(l, 1);
 		} else if (!strcmp(value, "repair-building")) {
 			ai->LastRepairBuilding = LuaToNumber(l, j + 1);
 		//Wyrmgus start
@@ -1841,6 +1859,7 @@ void AiCclRegister()
 	lua_register(Lua, "AiDump", CclAiDump);
 
 	lua_register(Lua, "DefineAiPlayer", CclDefineAiPlayer);
+	lua_register(Lua, "DefineAiScheduler", CclDefineAiScheduler);
 	lua_register(Lua, "AiAttackWithForces", CclAiAttackWithForces);
 	lua_register(Lua, "AiWaitForces", CclAiWaitForces);
 }
@@ -109,6 +109,7 @@ void preferences::save() const
 	data.add_property("difficulty", enum_converter<wyrmgus::difficulty>::to_string(this->get_difficulty()));
 	data.add_property("sound_effects_enabled", string::from_bool(this->are_sound_effects_enabled()));
 	data.add_property("sound_effects_volume", std::to_string(this->get_sound_effects_volume()));
+	data.add_property("sound_cache_size", std::to_string(this->get_sound_cache_size()));
 	data.add_property("music_enabled", string::from_bool(this->is_music_enabled()));
 	data.add_property("music_volume", std::to_string(this->get_music_volume()));
 	data.add_property("hotkey_setup", enum_converter<wyrmgus::hotkey_setup>::to_string(this->get_hotkey_setup()));
@@ -124,6 +125,7 @@ void preferences::save() const
 	data.add_property("key_scroll_speed", std::to_string(this->get_key_scroll_speed()));
 	data.add_property("mouse_scroll_speed", std::to_string(this->get_mouse_scroll_speed()));
 	data.add_property("reverse_mousewheel_scrolling", string::from_bool(this->is_reverse_mousewheel_scrolling_enabled()));
+	data.add_property("adaptive_network_lag", string::from_bool(this->is_adaptive_network_lag_enabled()));
 
 	if (!this->get_local_player_name().empty()) {
 		data.add_property("local_player_name", "\"" + string::escaped(this->get_local_player_name()) + "\"");
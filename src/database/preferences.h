@@ -56,6 +56,7 @@ class preferences final : public QObject, public singleton<preferences>
 	Q_PROPERTY(wyrmgus::difficulty difficulty READ get_difficulty WRITE set_difficulty)
 	Q_PROPERTY(bool sound_effects_enabled READ are_sound_effects_enabled WRITE set_sound_effects_enabled NOTIFY sound_effects_enabled_changed)
 	Q_PROPERTY(int sound_effects_volume READ get_sound_effects_volume WRITE set_sound_effects_volume NOTIFY sound_effects_volume_changed)
+	Q_PROPERTY(int sound_cache_size MEMBER sound_cache_size READ get_sound_cache_size NOTIFY changed)
 	Q_PROPERTY(bool music_enabled READ is_music_enabled WRITE set_music_enabled NOTIFY music_enabled_changed)
 	Q_PROPERTY(int music_volume READ get_music_volume WRITE set_music_volume NOTIFY music_volume_changed)
 	Q_PROPERTY(wyrmgus::hotkey_setup hotkey_setup READ get_hotkey_setup WRITE set_hotkey_setup)
@@ -73,6 +74,7 @@ class preferences final : public QObject, public singleton<preferences>
 	Q_PROPERTY(bool reverse_mousewheel_scrolling MEMBER reverse_mousewheel_scrolling READ is_reverse_mousewheel_scrolling_enabled NOTIFY changed)
 	Q_PROPERTY(bool show_water_borders MEMBER show_water_borders READ is_show_water_borders_enabled NOTIFY changed)
 	Q_PROPERTY(bool time_of_day_shading MEMBER time_of_day_shading READ is_time_of_day_shading_enabled NOTIFY changed)
+	Q_PROPERTY(bool adaptive_network_lag MEMBER adaptive_network_lag READ is_adaptive_network_lag_enabled NOTIFY changed)
 	Q_PROPERTY(QString local_player_name READ get_local_player_name_qstring WRITE set_local_player_name_qstring NOTIFY changed)
 
 public:
@@ -284,6 +286,17 @@ public:
 
 	void set_sound_effects_volume(int volume);
 
+	//the memory budget for decoded sound effects, in megabytes
+	int get_sound_cache_size() const
+	{
+		return this->sound_cache_size;
+	}
+
+	void set_sound_cache_size(const int size)
+	{
+		this->sound_cache_size = size;
+	}
+
 	bool is_music_enabled() const
 	{
 		return this->music_enabled;
@@ -392,6 +405,11 @@ public:
 		return this->time_of_day_shading;
 	}
 
+	bool is_adaptive_network_lag_enabled() const
+	{
+		return this->adaptive_network_lag;
+	}
+
 	const std::string &get_local_player_name() const
 	{
 		return this->local_player_name;
@@ -437,6 +455,7 @@ private:
 	wyrmgus::difficulty difficulty;
 	bool sound_effects_enabled = true;
 	int sound_effects_volume = 128;
+	int sound_cache_size = 64;
 	bool music_enabled = true;
 	int music_volume = 128;
 	wyrmgus::hotkey_setup hotkey_setup;
@@ -454,6 +473,7 @@ private:
 	bool reverse_mousewheel_scrolling = false;
 	bool show_water_borders = false;
 	bool time_of_day_shading = true;
+	bool adaptive_network_lag = true; //whether the network lag is adapted to the connection when hosting a game
 	std::string local_player_name;
 };
 
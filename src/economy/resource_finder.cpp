@@ -74,7 +74,7 @@ public:
 		this->waiting = 0;
 	}
 
-	void set_from(const CUnit *mine, const CUnit *depot, const CUnit *worker, const bool check_usage)
+	void set_from(const CUnit *mine, const CUnit *depot, const CUnit *worker, const bool check_usage, const int planned_workers)
 	{
 		const resource *resource = mine->get_given_resource();
 
@@ -88,8 +88,11 @@ public:
 		}
 
 		if (check_usage) {
-			this->assigned = static_cast<int>(mine->Resource.Workers.size()) - mine->Type->MaxOnBoard;
-			this->waiting = GetNumWaitingWorkers(*mine);
+			const int workers = static_cast<int>(mine->Resource.Workers.size()) + planned_workers;
+			this->assigned = workers - mine->Type->MaxOnBoard;
+
+			//the planned workers which will not fit in the resource unit will have to wait
+			this->waiting = GetNumWaitingWorkers(*mine) + std::clamp(workers - mine->Type->MaxOnBoard, 0, planned_workers);
 		} else {
 			this->assigned = 0;
 			this->waiting = 0;
@@ -126,7 +129,7 @@ private:
 struct find_resource_context final
 {
 	explicit find_resource_context(const resource_finder *finder, find_resource_result &result)
-		: result(result), worker(finder->get_worker()), movemask(finder->get_worker()->Type->MovementMask), max_range(finder->get_range()), resource(finder->get_resource()), depot(finder->get_depot()), ignore_exploration(finder->ignores_exploration()), check_usage(finder->checks_usage()), only_harvestable(finder->includes_only_harvestable()), include_luxury_resources(finder->includes_luxury_resources()), only_same_resource(finder->allows_only_same_resource())
+		: result(result), worker(finder->get_worker()), movemask(finder->get_worker()->Type->MovementMask), max_range(finder->get_range()), resource(finder->get_resource()), depot(finder->get_depot()), ignore_exploration(finder->ignores_exploration()), check_usage(finder->checks_usage()), only_harvestable(finder->includes_only_harvestable()), include_luxury_resources(finder->includes_luxury_resources()), only_same_resource(finder->allows_only_same_resource()), planned_resource_unit_workers(finder->get_planned_resource_unit_workers()), planned_resource_tiles(finder->get_planned_resource_tiles())
 	{
 		result = find_resource_result();
 		this->best_cost.set_to_max();
@@ -154,7 +157,7 @@ struct find_resource_context final
 
 		const int z = worker->MapLayer->ID;
 
-		if (this->is_valid_resource_tile(tile)) {
+		if (this->is_valid_resource_tile(tile) && (this->planned_resource_tiles == nullptr || !this->planned_resource_tiles->contains(pos))) {
 			find_resource_cost cost;
 
 			cost.set_from(tile, pos, z, this->depot, worker);
@@ -181,7 +184,7 @@ struct find_resource_context final
 		) {
 			find_resource_cost cost;
 
-			cost.set_from(mine, this->depot, worker, this->check_usage);
+			cost.set_from(mine, this->depot, worker, this->check_usage, this->get_planned_workers(mine));
 
 			if (cost < this->best_cost) {
 				this->result.resource_unit = mine;
@@ -207,6 +210,20 @@ struct find_resource_context final
 		}
 	}
 
+	int get_planned_workers(const CUnit *mine) const
+	{
+		if (this->planned_resource_unit_workers == nullptr) {
+			return 0;
+		}
+
+		const auto find_iterator = this->planned_resource_unit_workers->find(mine);
+		if (find_iterator == this->planned_resource_unit_workers->end()) {
+			return 0;
+		}
+
+		return find_iterator->second;
+	}
+
 	bool is_valid_resource(const wyrmgus::resource *resource) const
 	{
 		if (resource == nullptr) {
@@ -244,6 +261,8 @@ struct find_resource_context final
 	const bool only_harvestable = false;
 	const bool include_luxury_resources = false;
 	const bool only_same_resource = false;
+	const std::map<const CUnit *, int> *planned_resource_unit_workers = nullptr;
+	const point_set *planned_resource_tiles = nullptr;
 	find_resource_cost best_cost;
 };
 
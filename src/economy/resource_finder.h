@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include "util/point_container.h"
+
 class CUnit;
 
 namespace wyrmgus {
@@ -123,6 +125,23 @@ public:
 		this->only_same_resource = value;
 	}
 
+	const std::map<const CUnit *, int> *get_planned_resource_unit_workers() const
+	{
+		return this->planned_resource_unit_workers;
+	}
+
+	const point_set *get_planned_resource_tiles() const
+	{
+		return this->planned_resource_tiles;
+	}
+
+	//set the harvests already planned for other workers, which have not been given their orders yet, so that the search counts them as usage
+	void set_planned_harvests(const std::map<const CUnit *, int> *resource_unit_workers, const point_set *resource_tiles)
+	{
+		this->planned_resource_unit_workers = resource_unit_workers;
+		this->planned_resource_tiles = resource_tiles;
+	}
+
 private:
 	const CUnit *worker = nullptr;
 	const CUnit *start_unit = nullptr; //the unit to use as the starting point for the search
@@ -134,6 +153,8 @@ private:
 	bool only_harvestable = true;
 	bool include_luxury_resources = false;
 	bool only_same_resource = false;
+	const std::map<const CUnit *, int> *planned_resource_unit_workers = nullptr; //the amount of workers planned to harvest from each resource unit
+	const point_set *planned_resource_tiles = nullptr; //the resource tiles planned to be harvested by other workers
 };
 
 }
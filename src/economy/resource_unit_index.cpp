@@ -0,0 +1,104 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "economy/resource_unit_index.h"
+
+#include "map/map_layer.h"
+#include "unit/unit.h"
+
+namespace wyrmgus {
+
+void resource_unit_index::add_unit(CUnit *unit)
+{
+	if (unit->GivesResource == 0) {
+		return;
+	}
+
+	const int z = unit->MapLayer->ID;
+
+	if (z >= static_cast<int>(this->layer_resource_units.size())) {
+		this->layer_resource_units.resize(z + 1);
+	}
+
+	this->layer_resource_units[z][unit->GivesResource].push_back(unit);
+}
+
+void resource_unit_index::remove_unit(CUnit *unit)
+{
+	if (unit->GivesResource == 0) {
+		return;
+	}
+
+	this->remove_unit(unit, unit->MapLayer->ID, unit->GivesResource);
+}
+
+void resource_unit_index::on_unit_given_resource_changed(CUnit *unit, const int old_resource)
+{
+	if (unit->MapLayer == nullptr || old_resource == unit->GivesResource) {
+		return;
+	}
+
+	const int z = unit->MapLayer->ID;
+
+	//only units which are on the map are indexed
+	if (old_resource != 0) {
+		if (!this->remove_unit(unit, z, old_resource)) {
+			return;
+		}
+	} else if (unit->Removed) {
+		return;
+	}
+
+	this->add_unit(unit);
+}
+
+bool resource_unit_index::remove_unit(CUnit *unit, const int z, const int resource)
+{
+	if (z >= static_cast<int>(this->layer_resource_units.size())) {
+		return false;
+	}
+
+	const auto find_iterator = this->layer_resource_units[z].find(resource);
+	if (find_iterator == this->layer_resource_units[z].end()) {
+		return false;
+	}
+
+	std::vector<CUnit *> &units = find_iterator->second;
+	const auto unit_iterator = std::find(units.begin(), units.end(), unit);
+	if (unit_iterator == units.end()) {
+		return false;
+	}
+
+	//the order of the units doesn't matter, so swap the unit with the last one to remove it in constant time
+	*unit_iterator = units.back();
+	units.pop_back();
+
+	return true;
+}
+
+}
@@ -0,0 +1,98 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "util/singleton.h"
+
+class CUnit;
+
+namespace wyrmgus {
+
+//an index of the units on the map which give resources, by map layer and given resource, kept in sync with the map's unit cache
+//it allows resource searches to know in advance how many resource units they can possibly find, so that they can skip or stop their flood fills
+class resource_unit_index final : public singleton<resource_unit_index>
+{
+public:
+	void add_unit(CUnit *unit);
+	void remove_unit(CUnit *unit);
+
+	//re-index a unit on the map whose given resource changed
+	void on_unit_given_resource_changed(CUnit *unit, const int old_resource);
+
+	void clear()
+	{
+		this->layer_resource_units.clear();
+	}
+
+	const std::vector<CUnit *> &get_resource_units(const int z, const int resource) const
+	{
+		static const std::vector<CUnit *> empty_vector;
+
+		if (z >= static_cast<int>(this->layer_resource_units.size())) {
+			return empty_vector;
+		}
+
+		const auto find_iterator = this->layer_resource_units[z].find(resource);
+		if (find_iterator == this->layer_resource_units[z].end()) {
+			return empty_vector;
+		}
+
+		return find_iterator->second;
+	}
+
+	//count the indexed units on a map layer which fulfill a predicate, visiting only the buckets of the given resources for which the resource predicate is true
+	template <typename resource_function_type, typename function_type>
+	int count_units(const int z, const resource_function_type &resource_function, const function_type &function) const
+	{
+		if (z >= static_cast<int>(this->layer_resource_units.size())) {
+			return 0;
+		}
+
+		int count = 0;
+
+		for (const auto &[resource, units] : this->layer_resource_units[z]) {
+			if (!resource_function(resource)) {
+				continue;
+			}
+
+			for (const CUnit *unit : units) {
+				if (function(unit)) {
+					++count;
+				}
+			}
+		}
+
+		return count;
+	}
+
+private:
+	bool remove_unit(CUnit *unit, const int z, const int resource);
+
+	std::vector<std::map<int, std::vector<CUnit *>>> layer_resource_units;
+};
+
+}
@@ -96,6 +96,8 @@
 #include "settings.h"
 #include "sound/music_player.h"
 #include "sound/music_type.h"
+#include "sound/sample_cache.h"
+#include "sound/sound_event_manager.h"
 #include "sound/sound.h"
 #include "sound/sound_server.h"
 #include "spell/spell.h"
@@ -1586,6 +1588,7 @@ void CreateGame(const std::filesystem::path &filepath, CMap *map)
 	//
 	if (SoundEnabled()) {
 		InitSoundClient();
+		sample_cache::get()->prefetch_map_unit_sounds();
 	}
 
 	//
@@ -1674,6 +1677,7 @@ void CleanGame()
 	CleanAi();
 	CleanGroups();
 	CleanMissiles();
+	sound_event_manager::get()->clear();
 	CleanUnits();
 	CleanSelections();
 	CMap::get()->Clean();
@@ -59,6 +59,7 @@
 #include "util/assert_util.h"
 #include "util/path_util.h"
 #include "util/random.h"
+#include "util/string_util.h"
 #include "version.h"
 
 class LogEntry
@@ -903,6 +904,16 @@ static void DoNextReplay()
 		PlayGameSound(wyrmgus::game_sound_set::get()->get_chat_message_sound(), MaxSampleVolume);
 	} else if (!strcmp(action, "quit")) {
 		CommandQuit(arg1);
+	} else if (!strcmp(action, "group")) {
+		//the value contains the destination unit, followed by the units receiving the command
+		const std::vector<std::string> unit_numbers = string::split(val, ' ');
+		assert_throw(!unit_numbers.empty());
+
+		std::vector<UnitRef> units;
+		for (size_t i = 1; i < unit_numbers.size(); ++i) {
+			units.push_back(static_cast<UnitRef>(std::stoi(unit_numbers[i])));
+		}
+		ExecGroupCommand(static_cast<unsigned char>(num), units, static_cast<unsigned short>(arg1), static_cast<unsigned short>(arg2), static_cast<UnitRef>(std::stoi(unit_numbers[0])));
 	} else {
 		DebugPrint("Invalid action: %s" _C_ action);
 	}
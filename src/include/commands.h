@@ -278,10 +278,15 @@ extern void SendCommandSharedVision(int player, bool state, int opponent);
 extern void SendCommandSetFaction(CPlayer *player, const faction *faction);
 extern void SendCommandSetDynasty(CPlayer *player, const wyrmgus::dynasty *dynasty);
 extern void SendCommandAutosellResource(int player, int resource);
+/// Send network lag change command
+extern void SendCommandNetworkLag(const unsigned int lag);
 
 /// Execute a command (from network).
 extern void ExecCommand(unsigned char type, UnitRef unum, unsigned short x,
 						unsigned short y, UnitRef dest);
+/// Execute a command given to a group of units (from network).
+extern void ExecGroupCommand(unsigned char type, const std::vector<UnitRef> &units,
+							 unsigned short x, unsigned short y, UnitRef dest);
 /// Execute an extended command (from network).
 extern void ExecExtendedCommand(unsigned char type, int status, unsigned char arg1,
 								unsigned short arg2, unsigned short arg3,
@@ -29,10 +29,12 @@
 
 #include "map/map.h"
 
+#include "ai/ai_building_place_cache.h"
 #include "ai/ai_local.h"
 #include "database/defines.h"
 #include "database/gsml_parser.h"
 #include "database/preferences.h"
+#include "economy/resource_unit_index.h"
 //Wyrmgus start
 #include "editor.h"
 //Wyrmgus end
@@ -53,6 +55,7 @@
 #include "map/site_container.h"
 #include "map/site_game_data.h"
 #include "map/site_history.h"
+#include "map/terrain_compatibility_table.h"
 #include "map/terrain_feature.h"
 #include "map/terrain_type.h"
 #include "map/tile.h"
@@ -91,6 +94,7 @@
 //Wyrmgus end
 #include "util/assert_util.h"
 #include "util/container_util.h"
+#include "util/parallel_util.h"
 #include "util/path_util.h"
 #include "util/point_util.h"
 #include "util/rect_util.h"
@@ -194,7 +198,7 @@ void CMap::Reveal(const bool only_person_players)
 	for (size_t z = 0; z < this->MapLayers.size(); ++z) {
 		for (int i = 0; i != this->Info->MapWidths[z] * this->Info->MapHeights[z]; ++i) {
 			wyrmgus::tile &mf = *this->Field(i, z);
-			const std::unique_ptr<wyrmgus::tile_player_info> &player_info = mf.player_info;
+			wyrmgus::tile_player_info *player_info = mf.player_info;
 			for (int p = 0; p < PlayerMax; ++p) {
 				if (CPlayer::Players[p]->get_type() == player_type::person || !only_person_players) {
 					if (player_info->get_visibility_state(p) >= 1) {
@@ -953,39 +957,12 @@ bool CMap::TileHasUnitsIncompatibleWithTerrain(const Vec2i &pos, const wyrmgus::
 
 bool CMap::is_point_in_a_subtemplate_area(const QPoint &pos, const int z) const
 {
-	for (const auto &kv_pair : this->MapLayers[z]->subtemplate_areas) {
-		const map_template *subtemplate = kv_pair.first;
-		const QRect &subtemplate_rect = kv_pair.second;
-		if (subtemplate_rect.contains(pos) && subtemplate->is_map_pos_usable(pos)) {
-			return true;
-		}
-	}
-
-	return false;
+	return this->MapLayers[z]->is_pos_in_subtemplate_area(pos);
 }
 
 bool CMap::is_rect_in_a_subtemplate_area(const QRect &rect, const int z) const
 {
-	for (const auto &kv_pair : this->MapLayers[z]->subtemplate_areas) {
-		const map_template *subtemplate = kv_pair.first;
-		const QRect &subtemplate_rect = kv_pair.second;
-
-		if (!rect.intersects(subtemplate_rect)) {
-			continue;
-		}
-
-		for (int x = rect.x(); x <= rect.right(); ++x) {
-			for (int y = rect.y(); y <= rect.bottom(); ++y) {
-				const QPoint tile_pos(x, y);
-
-				if (subtemplate->is_map_pos_usable(tile_pos)) {
-					return true;
-				}
-			}
-		}
-	}
-
-	return false;
+	return this->MapLayers[z]->get_subtemplate_area_tile_count(rect) > 0;
 }
 
 bool CMap::is_point_in_subtemplate_area(const QPoint &pos, const int z, const wyrmgus::map_template *subtemplate) const
@@ -1153,17 +1130,7 @@ bool CMap::is_point_adjacent_to_non_subtemplate_area(const Vec2i &pos, const int
 
 std::vector<const map_template *> CMap::get_pos_subtemplates(const QPoint &pos, const int z) const
 {
-	std::vector<const map_template *> subtemplates;
-
-	for (const auto &kv_pair : this->MapLayers[z]->subtemplate_areas) {
-		const map_template *subtemplate = kv_pair.first;
-		const QRect &subtemplate_rect = kv_pair.second;
-		if (subtemplate_rect.contains(pos)) {
-			subtemplates.push_back(subtemplate);
-		}
-	}
-
-	return subtemplates;
+	return this->MapLayers[z]->get_pos_subtemplates(pos);
 }
 
 std::vector<const map_template *> CMap::get_rect_subtemplates(const QRect &rect, const int z) const
@@ -1735,6 +1702,8 @@ bool CanMoveToMask(const Vec2i &pos, const tile_flag mask, const int z)
 
 CMap::CMap()
 {
+	tile::set_landmasses(&this->landmasses);
+
 	this->Tileset = make_qunique<tileset>("map");
 	this->Info = make_qunique<map_info>();
 
@@ -1746,6 +1715,7 @@ CMap::CMap()
 
 CMap::~CMap()
 {
+	tile::set_landmasses(nullptr);
 }
 
 int CMap::get_pos_index(const int x, const int y, const int z) const
@@ -1860,6 +1830,12 @@ void CMap::Clean()
 	//Wyrmgus end
 	this->animated_tiles.clear();
 
+	//the terrain types may have changed since the last game
+	this->terrain_compatibility.reset();
+
+	ai_building_place_cache::get()->clear();
+	resource_unit_index::get()->clear();
+
 	// Tileset freed by Tileset?
 
 	this->Info->reset();
@@ -2229,6 +2205,9 @@ void CMap::SetTileTerrain(const QPoint &pos, const terrain_type *terrain, const
 				}
 			}
 		}
+
+		//the transitions may have changed the flags of the adjacent tiles as well
+		ai_building_place_cache::get()->on_tile_terrain_changed(QRect(pos - QPoint(1, 1), QSize(3, 3)), z);
 	} catch (...) {
 		std::throw_with_nested(std::runtime_error("Error setting terrain \"" + terrain->get_identifier() + "\" for tile " + point::to_string(pos) + ", map layer " + std::to_string(z) + "."));
 	}
@@ -2291,6 +2270,8 @@ void CMap::RemoveTileOverlayTerrain(const QPoint &pos, const int z)
 			}
 		}
 	}
+
+	ai_building_place_cache::get()->on_tile_terrain_changed(QRect(pos - QPoint(1, 1), QSize(3, 3)), z);
 }
 
 void CMap::SetOverlayTerrainDestroyed(const QPoint &pos, const bool destroyed, const int z)
@@ -2406,6 +2387,8 @@ void CMap::SetOverlayTerrainDestroyed(const QPoint &pos, const bool destroyed, c
 				}
 			}
 		}
+
+		ai_building_place_cache::get()->on_tile_terrain_changed(QRect(pos - QPoint(1, 1), QSize(3, 3)), z);
 	} catch (...) {
 		std::throw_with_nested(std::runtime_error("Error setting the overlay terrain of tile " + point::to_string(pos) + ", map layer " + std::to_string(z) + " to " + (destroyed ? "" : "not") + " destroyed."));
 	}
@@ -2918,227 +2901,346 @@ void CMap::AdjustMap()
 	}
 }
 
-void CMap::AdjustTileMapIrregularities(const bool overlay, const Vec2i &min_pos, const Vec2i &max_pos, const int z)
+//process the tiles of a rectangle in rounds of sweeps, with each sweep adjusting the tiles in column-major order, until a round adjusts no tile or the maximum amount of rounds is reached
+//this gives the same result as checking every tile in every sweep, since a tile which was left as it is can only need adjusting after it or an adjacent tile has been adjusted; only such tiles are checked again
+//at the start of a sweep, the tiles to be checked are checked concurrently without modifying the map; the adjustment is then called sequentially for the tiles which failed the check, or which have had an adjacent tile adjusted earlier in the sweep, and must itself check the tile again, returning whether it adjusted it
+template <typename check_function_type, typename adjust_function_type>
+static void process_tile_sweeps(const QRect &rect, const int max_round_count, const size_t sweep_count, const check_function_type &check_tile, const adjust_function_type &adjust_tile)
 {
-	bool no_irregularities_found = false;
-	int try_count = 0;
-	static constexpr int max_try_count = 100;
+	static constexpr size_t min_chunk_tile_count = 4096;
 
-	while (!no_irregularities_found && try_count < max_try_count) {
-		no_irregularities_found = true;
-		++try_count;
+	if (rect.isEmpty()) {
+		return;
+	}
 
-		for (int x = min_pos.x; x < max_pos.x; ++x) {
-			for (int y = min_pos.y; y < max_pos.y; ++y) {
-				tile &mf = *this->Field(x, y, z);
-				const terrain_type *terrain = overlay ? mf.get_overlay_terrain() : mf.get_terrain();
-				if (!terrain || terrain->allows_single()) {
-					continue;
-				}
+	const size_t tile_count = static_cast<size_t>(rect.width()) * static_cast<size_t>(rect.height());
+	const size_t rect_height = static_cast<size_t>(rect.height());
 
-				std::set<const terrain_type *> acceptable_adjacent_tile_types;
-				acceptable_adjacent_tile_types.insert(terrain);
-				set::merge(acceptable_adjacent_tile_types, terrain->get_outer_border_terrain_types());
-				
-				int horizontal_adjacent_tiles = 0;
-				int vertical_adjacent_tiles = 0;
-				int nw_quadrant_adjacent_tiles = 0; //should be 4 if the wrong tile types are present in X-1,Y; X-1,Y-1; X,Y-1; and X+1,Y+1
-				int ne_quadrant_adjacent_tiles = 0;
-				int sw_quadrant_adjacent_tiles = 0;
-				int se_quadrant_adjacent_tiles = 0;
-				
-				if ((x - 1) >= 0 && !acceptable_adjacent_tile_types.contains(this->GetTileTerrain(Vec2i(x - 1, y), overlay, z))) {
-					horizontal_adjacent_tiles += 1;
-					nw_quadrant_adjacent_tiles += 1;
-					sw_quadrant_adjacent_tiles += 1;
-				}
-				if ((x + 1) < this->Info->MapWidths[z] && !acceptable_adjacent_tile_types.contains(this->GetTileTerrain(Vec2i(x + 1, y), overlay, z))) {
-					horizontal_adjacent_tiles += 1;
-					ne_quadrant_adjacent_tiles += 1;
-					se_quadrant_adjacent_tiles += 1;
-				}
-				
-				if ((y - 1) >= 0 && !acceptable_adjacent_tile_types.contains(this->GetTileTerrain(Vec2i(x, y - 1), overlay, z))) {
-					vertical_adjacent_tiles += 1;
-					nw_quadrant_adjacent_tiles += 1;
-					ne_quadrant_adjacent_tiles += 1;
-				}
-				if ((y + 1) < this->Info->MapHeights[z] && !acceptable_adjacent_tile_types.contains(this->GetTileTerrain(Vec2i(x, y + 1), overlay, z))) {
-					vertical_adjacent_tiles += 1;
-					sw_quadrant_adjacent_tiles += 1;
-					se_quadrant_adjacent_tiles += 1;
+	const auto index_to_pos = [&rect, rect_height](const size_t index) {
+		return QPoint(rect.left() + static_cast<int>(index / rect_height), rect.top() + static_cast<int>(index % rect_height));
+	};
+
+	//the tiles to be checked in each sweep, as they or an adjacent tile have been adjusted since they were last checked in it
+	std::vector<std::vector<bool>> sweep_pending_tiles(sweep_count, std::vector<bool>(tile_count, true));
+
+	//the tiles which are or are adjacent to a tile adjusted in the current sweep, for which the concurrent check is outdated
+	std::vector<bool> changed_surroundings_tiles(tile_count, false);
+
+	std::vector<size_t> checked_tile_indexes;
+	std::vector<uint8_t> failed_checks(tile_count, 0);
+
+	bool tile_adjusted = true;
+	int round_count = 0;
+
+	while (tile_adjusted && round_count < max_round_count) {
+		tile_adjusted = false;
+		++round_count;
+
+		for (size_t sweep_index = 0; sweep_index < sweep_count; ++sweep_index) {
+			std::vector<bool> &pending_tiles = sweep_pending_tiles[sweep_index];
+
+			checked_tile_indexes.clear();
+			for (size_t i = 0; i < tile_count; ++i) {
+				if (pending_tiles[i]) {
+					checked_tile_indexes.push_back(i);
 				}
+			}
 
-				if ((x - 1) >= 0 && (y - 1) >= 0 && !acceptable_adjacent_tile_types.contains(this->GetTileTerrain(Vec2i(x - 1, y - 1), overlay, z))) {
-					nw_quadrant_adjacent_tiles += 1;
-					se_quadrant_adjacent_tiles += 1;
+			if (checked_tile_indexes.empty()) {
+				continue;
+			}
+
+			parallel::for_each_chunk(checked_tile_indexes.size(), min_chunk_tile_count, [&](const size_t begin, const size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					const size_t tile_index = checked_tile_indexes[i];
+					failed_checks[tile_index] = check_tile(sweep_index, index_to_pos(tile_index)) ? 0 : 1;
 				}
+			});
+
+			std::fill(changed_surroundings_tiles.begin(), changed_surroundings_tiles.end(), false);
 
-				if ((x - 1) >= 0 && (y + 1) < this->Info->MapHeights[z] && !acceptable_adjacent_tile_types.contains(GetTileTerrain(Vec2i(x - 1, y + 1), overlay, z))) {
-					sw_quadrant_adjacent_tiles += 1;
-					ne_quadrant_adjacent_tiles += 1;
+			for (size_t i = checked_tile_indexes.front(); i < tile_count; ++i) {
+				if (!pending_tiles[i]) {
+					continue;
 				}
-				if ((x + 1) < this->Info->MapWidths[z] && (y - 1) >= 0 && !acceptable_adjacent_tile_types.contains(GetTileTerrain(Vec2i(x + 1, y - 1), overlay, z))) {
-					ne_quadrant_adjacent_tiles += 1;
-					sw_quadrant_adjacent_tiles += 1;
+
+				pending_tiles[i] = false;
+
+				//tiles which became pending during the sweep always have changed surroundings, so their outdated check results are never used
+				if (!changed_surroundings_tiles[i] && failed_checks[i] == 0) {
+					continue;
 				}
-				if ((x + 1) < this->Info->MapWidths[z] && (y + 1) < this->Info->MapHeights[z] && !acceptable_adjacent_tile_types.contains(GetTileTerrain(Vec2i(x + 1, y + 1), overlay, z))) {
-					se_quadrant_adjacent_tiles += 1;
-					nw_quadrant_adjacent_tiles += 1;
+
+				const QPoint tile_pos = index_to_pos(i);
+
+				if (!adjust_tile(sweep_index, tile_pos)) {
+					continue;
 				}
-				
-				if (horizontal_adjacent_tiles >= 2 || vertical_adjacent_tiles >= 2 || nw_quadrant_adjacent_tiles >= 4 || ne_quadrant_adjacent_tiles >= 4 || sw_quadrant_adjacent_tiles >= 4 || se_quadrant_adjacent_tiles >= 4) {
-					if (overlay) {
-						mf.RemoveOverlayTerrain();
-					} else {
-						std::map<const wyrmgus::terrain_type *, int> best_terrain_scores;
 
-						for (int sub_x = -1; sub_x <= 1; ++sub_x) {
-							for (int sub_y = -1; sub_y <= 1; ++sub_y) {
-								if ((x + sub_x) < min_pos.x || (x + sub_x) >= max_pos.x || (y + sub_y) < min_pos.y || (y + sub_y) >= max_pos.y || (sub_x == 0 && sub_y == 0)) {
-									continue;
-								}
-								const wyrmgus::terrain_type *tile_terrain = GetTileTerrain(Vec2i(x + sub_x, y + sub_y), false, z);
-								if (mf.get_terrain() != tile_terrain) {
-									best_terrain_scores[tile_terrain]++;
-								}
-							}
-						}
+				tile_adjusted = true;
 
-						const wyrmgus::terrain_type *best_terrain = nullptr;
-						int best_score = 0;
-						for (const auto &score_pair : best_terrain_scores) {
-							const int score = score_pair.second;
-							if (score > best_score) {
-								best_score = score;
-								best_terrain = score_pair.first;
-							}
+				for (int offset_x = -1; offset_x <= 1; ++offset_x) {
+					for (int offset_y = -1; offset_y <= 1; ++offset_y) {
+						const QPoint adjacent_pos(tile_pos.x() + offset_x, tile_pos.y() + offset_y);
+
+						if (!rect.contains(adjacent_pos)) {
+							continue;
 						}
 
-						mf.SetTerrain(best_terrain);
+						const size_t adjacent_index = static_cast<size_t>(adjacent_pos.x() - rect.left()) * rect_height + static_cast<size_t>(adjacent_pos.y() - rect.top());
+
+						changed_surroundings_tiles[adjacent_index] = true;
+
+						for (std::vector<bool> &other_pending_tiles : sweep_pending_tiles) {
+							other_pending_tiles[adjacent_index] = true;
+						}
 					}
-					no_irregularities_found = false;
 				}
 			}
 		}
 	}
 }
 
-void CMap::AdjustTileMapTransitions(const Vec2i &min_pos, const Vec2i &max_pos, int z)
+//call the function for each tile adjacent to the given position which is in the rect, in the order in which the terrain adjustment passes check them
+template <typename function_type>
+static void for_each_adjacent_tile_in_rect(const QPoint &pos, const QRect &rect, const function_type &function)
+{
+	for (int sub_x = -1; sub_x <= 1; ++sub_x) {
+		for (int sub_y = -1; sub_y <= 1; ++sub_y) {
+			const QPoint adjacent_pos(pos.x() + sub_x, pos.y() + sub_y);
+			if (!rect.contains(adjacent_pos) || (sub_x == 0 && sub_y == 0)) {
+				continue;
+			}
+
+			function(adjacent_pos);
+		}
+	}
+}
+
+//whether the tile's base terrain needs to be changed to that of the adjacent tile, so that the latter's overlay terrain can border it
+static bool needs_adjacent_base_terrain(const terrain_compatibility_table &compatibility_table, const tile *tile, const wyrmgus::tile *adjacent_tile)
+{
+	const terrain_type *terrain = tile->get_terrain();
+	const terrain_type *adjacent_terrain = adjacent_tile->get_terrain();
+
+	if (terrain == nullptr || adjacent_terrain == nullptr || adjacent_terrain == terrain) {
+		return false;
+	}
+
+	const terrain_type *adjacent_top_terrain = adjacent_tile->get_top_terrain(false);
+
+	return adjacent_top_terrain->is_overlay()
+		&& adjacent_top_terrain != tile->get_overlay_terrain()
+		&& !compatibility_table.is_outer_border(adjacent_terrain, terrain)
+		&& !compatibility_table.is_base_terrain(adjacent_top_terrain, terrain);
+}
+
+//get the intermediate terrain type which the tile needs to have to border the adjacent tile, or null if none is needed
+static const terrain_type *get_needed_intermediate_terrain(const terrain_compatibility_table &compatibility_table, const tile *tile, const wyrmgus::tile *adjacent_tile)
+{
+	const terrain_type *terrain = tile->get_terrain();
+	const terrain_type *adjacent_terrain = adjacent_tile->get_terrain();
+
+	if (terrain == nullptr || adjacent_terrain == nullptr || adjacent_terrain == terrain || compatibility_table.is_border(terrain, adjacent_terrain)) {
+		return nullptr;
+	}
+
+	return compatibility_table.get_intermediate_terrain(terrain, adjacent_terrain);
+}
+
+const terrain_compatibility_table &CMap::get_terrain_compatibility_table()
+{
+	if (this->terrain_compatibility == nullptr) {
+		this->terrain_compatibility = std::make_unique<terrain_compatibility_table>();
+	}
+
+	return *this->terrain_compatibility;
+}
+
+bool CMap::is_tile_irregular(const QPoint &pos, const bool overlay, const int z) const
+{
+	const tile *tile = this->Field(pos, z);
+	const terrain_type *terrain = overlay ? tile->get_overlay_terrain() : tile->get_terrain();
+	if (terrain == nullptr || terrain->allows_single()) {
+		return false;
+	}
+
+	const terrain_compatibility_table &compatibility_table = *this->terrain_compatibility;
+	const int map_width = this->Info->MapWidths[z];
+	const int map_height = this->Info->MapHeights[z];
+
+	const auto is_unacceptable = [&](const int x_offset, const int y_offset) {
+		const QPoint adjacent_pos(pos.x() + x_offset, pos.y() + y_offset);
+		if (adjacent_pos.x() < 0 || adjacent_pos.x() >= map_width || adjacent_pos.y() < 0 || adjacent_pos.y() >= map_height) {
+			return false;
+		}
+
+		const wyrmgus::tile *adjacent_tile = this->Field(adjacent_pos, z);
+		const terrain_type *adjacent_terrain = overlay ? adjacent_tile->get_overlay_terrain() : adjacent_tile->get_terrain();
+		return !compatibility_table.is_same_or_outer_border(terrain, adjacent_terrain);
+	};
+
+	const bool west = is_unacceptable(-1, 0);
+	const bool east = is_unacceptable(1, 0);
+	const bool north = is_unacceptable(0, -1);
+	const bool south = is_unacceptable(0, 1);
+
+	if ((west && east) || (north && south)) {
+		return true;
+	}
+
+	const bool northwest = is_unacceptable(-1, -1);
+	const bool southwest = is_unacceptable(-1, 1);
+	const bool northeast = is_unacceptable(1, -1);
+	const bool southeast = is_unacceptable(1, 1);
+
+	//a quadrant is irregular if the wrong tile types are present in e.g. X-1,Y; X-1,Y-1; X,Y-1; and X+1,Y+1
+	const int nw_quadrant_adjacent_tiles = west + north + northwest + southeast;
+	const int ne_quadrant_adjacent_tiles = east + north + southwest + northeast;
+	const int sw_quadrant_adjacent_tiles = west + south + southwest + northeast;
+	const int se_quadrant_adjacent_tiles = east + south + northwest + southeast;
+
+	return nw_quadrant_adjacent_tiles >= 4 || ne_quadrant_adjacent_tiles >= 4 || sw_quadrant_adjacent_tiles >= 4 || se_quadrant_adjacent_tiles >= 4;
+}
+
+void CMap::AdjustTileMapIrregularities(const bool overlay, const Vec2i &min_pos, const Vec2i &max_pos, const int z)
 {
-	bool tile_changed = true;
-	int try_count = 0;
 	static constexpr int max_try_count = 100;
 
-	while (tile_changed && try_count < max_try_count) {
-		tile_changed = false;
-		++try_count;
+	const QRect rect(QPoint(min_pos.x, min_pos.y), QPoint(max_pos.x - 1, max_pos.y - 1));
 
-		for (int x = min_pos.x; x < max_pos.x; ++x) {
-			for (int y = min_pos.y; y < max_pos.y; ++y) {
-				wyrmgus::tile &mf = *this->Field(x, y, z);
+	this->get_terrain_compatibility_table();
 
-				if (mf.get_terrain() == nullptr) {
-					continue;
-				}
+	process_tile_sweeps(rect, max_try_count, 1, [&](const size_t sweep_index, const QPoint &tile_pos) {
+		Q_UNUSED(sweep_index)
 
-				for (int sub_x = -1; sub_x <= 1; ++sub_x) {
-					for (int sub_y = -1; sub_y <= 1; ++sub_y) {
-						if ((x + sub_x) < min_pos.x || (x + sub_x) >= max_pos.x || (y + sub_y) < min_pos.y || (y + sub_y) >= max_pos.y || (sub_x == 0 && sub_y == 0)) {
-							continue;
-						}
+		return !this->is_tile_irregular(tile_pos, overlay, z);
+	}, [&](const size_t sweep_index, const QPoint &tile_pos) {
+		Q_UNUSED(sweep_index)
 
-						const wyrmgus::terrain_type *tile_terrain = GetTileTerrain(Vec2i(x + sub_x, y + sub_y), false, z);
-						const wyrmgus::terrain_type *tile_top_terrain = GetTileTopTerrain(Vec2i(x + sub_x, y + sub_y), false, z);
+		if (!this->is_tile_irregular(tile_pos, overlay, z)) {
+			return false;
+		}
 
-						if (tile_terrain == nullptr) {
-							continue;
-						}
+		tile &mf = *this->Field(tile_pos, z);
 
-						if (
-							mf.get_terrain() != tile_terrain
-							&& tile_top_terrain->is_overlay()
-							&& tile_top_terrain != mf.get_overlay_terrain()
-							&& !vector::contains(tile_terrain->get_outer_border_terrain_types(), mf.get_terrain())
-							&& !vector::contains(tile_top_terrain->get_base_terrain_types(), mf.get_terrain())
-						) {
-							mf.SetTerrain(tile_terrain);
-							tile_changed = true;
-						}
-					}
-				}
+		if (overlay) {
+			mf.RemoveOverlayTerrain();
+			return true;
+		}
+
+		std::map<const terrain_type *, int> best_terrain_scores;
+
+		for_each_adjacent_tile_in_rect(tile_pos, rect, [&](const QPoint &adjacent_pos) {
+			const terrain_type *tile_terrain = this->Field(adjacent_pos, z)->get_terrain();
+			if (mf.get_terrain() != tile_terrain) {
+				best_terrain_scores[tile_terrain]++;
+			}
+		});
+
+		const terrain_type *best_terrain = nullptr;
+		int best_score = 0;
+		for (const auto &[terrain, score] : best_terrain_scores) {
+			if (score > best_score) {
+				best_score = score;
+				best_terrain = terrain;
 			}
 		}
 
-		for (int x = min_pos.x; x < max_pos.x; ++x) {
-			for (int y = min_pos.y; y < max_pos.y; ++y) {
-				wyrmgus::tile &mf = *this->Field(x, y, z);
+		mf.SetTerrain(best_terrain);
+		return true;
+	});
+}
 
-				if (mf.get_terrain() == nullptr) {
-					continue;
-				}
+void CMap::AdjustTileMapTransitions(const Vec2i &min_pos, const Vec2i &max_pos, int z)
+{
+	static constexpr int max_try_count = 100;
 
-				for (int sub_x = -1; sub_x <= 1; ++sub_x) {
-					for (int sub_y = -1; sub_y <= 1; ++sub_y) {
-						if ((x + sub_x) < min_pos.x || (x + sub_x) >= max_pos.x || (y + sub_y) < min_pos.y || (y + sub_y) >= max_pos.y || (sub_x == 0 && sub_y == 0)) {
-							continue;
-						}
+	//the first sweep changes tiles to the base terrain of adjacent overlay terrain which cannot border them, and the second one changes tiles to an intermediate terrain type if they cannot border an adjacent tile directly
+	static constexpr size_t overlay_base_sweep_index = 0;
+	static constexpr size_t sweep_count = 2;
 
-						const terrain_type *tile_terrain = GetTileTerrain(Vec2i(x + sub_x, y + sub_y), false, z);
+	const QRect rect(QPoint(min_pos.x, min_pos.y), QPoint(max_pos.x - 1, max_pos.y - 1));
 
-						if (tile_terrain == nullptr) {
-							continue;
-						}
+	const terrain_compatibility_table &compatibility_table = this->get_terrain_compatibility_table();
 
-						if (mf.get_terrain() != tile_terrain && !mf.get_terrain()->is_border_terrain_type(tile_terrain)) {
-							const terrain_type *intermediate_terrain = mf.get_terrain()->get_intermediate_terrain_type(tile_terrain);
-							if (intermediate_terrain != nullptr) {
-								mf.SetTerrain(intermediate_terrain);
-								tile_changed = true;
-							}
-						}
-					}
+	process_tile_sweeps(rect, max_try_count, sweep_count, [&](const size_t sweep_index, const QPoint &tile_pos) {
+		const tile *tile = this->Field(tile_pos, z);
+		bool needs_change = false;
+
+		for_each_adjacent_tile_in_rect(tile_pos, rect, [&](const QPoint &adjacent_pos) {
+			if (needs_change) {
+				return;
+			}
+
+			const wyrmgus::tile *adjacent_tile = this->Field(adjacent_pos, z);
+
+			if (sweep_index == overlay_base_sweep_index) {
+				needs_change = needs_adjacent_base_terrain(compatibility_table, tile, adjacent_tile);
+			} else {
+				needs_change = get_needed_intermediate_terrain(compatibility_table, tile, adjacent_tile) != nullptr;
+			}
+		});
+
+		return !needs_change;
+	}, [&](const size_t sweep_index, const QPoint &tile_pos) {
+		tile &mf = *this->Field(tile_pos, z);
+		bool tile_changed = false;
+
+		//the tile's terrain may be changed more than once, as each change is taken into account for the following adjacent tiles
+		for_each_adjacent_tile_in_rect(tile_pos, rect, [&](const QPoint &adjacent_pos) {
+			const tile *adjacent_tile = this->Field(adjacent_pos, z);
+
+			if (sweep_index == overlay_base_sweep_index) {
+				if (needs_adjacent_base_terrain(compatibility_table, &mf, adjacent_tile)) {
+					mf.SetTerrain(adjacent_tile->get_terrain());
+					tile_changed = true;
+				}
+			} else {
+				const terrain_type *intermediate_terrain = get_needed_intermediate_terrain(compatibility_table, &mf, adjacent_tile);
+				if (intermediate_terrain != nullptr) {
+					mf.SetTerrain(intermediate_terrain);
+					tile_changed = true;
 				}
 			}
-		}
-	}
+		});
+
+		return tile_changed;
+	});
 }
 
 void CMap::adjust_territory_irregularities(const QPoint &min_pos, const QPoint &max_pos, const int z)
 {
-	bool no_irregularities_found = false;
-	int try_count = 0;
 	static constexpr int max_try_count = 100;
 
-	while (!no_irregularities_found && try_count < max_try_count) {
-		no_irregularities_found = true;
-		++try_count;
+	const auto is_tile_territory_irregular = [this, z](const QPoint &tile_pos) {
+		const wyrmgus::site *settlement = this->Field(tile_pos, z)->get_settlement();
 
-		for (int x = min_pos.x(); x <= max_pos.x(); ++x) {
-			for (int y = min_pos.y(); y <= max_pos.y(); ++y) {
-				const QPoint tile_pos(x, y);
-				wyrmgus::tile *tile = this->Field(tile_pos, z);
-				const wyrmgus::site *settlement = tile->get_settlement();
+		if (settlement == nullptr) {
+			return false;
+		}
 
-				if (settlement == nullptr) {
-					continue;
-				}
+		if (settlement->get_game_data()->get_site_unit() == nullptr) {
+			return true;
+		}
 
-				const wyrmgus::site_game_data *settlement_game_data = settlement->get_game_data();
+		return !this->tile_borders_same_settlement_territory(tile_pos, z, false);
+	};
 
-				if (settlement_game_data->get_site_unit() == nullptr) {
-					tile->set_settlement(nullptr);
-					no_irregularities_found = false;
-					continue;
-				}
+	process_tile_sweeps(QRect(min_pos, max_pos), max_try_count, 1, [&](const size_t sweep_index, const QPoint &tile_pos) {
+		Q_UNUSED(sweep_index)
 
-				if (!this->tile_borders_same_settlement_territory(tile_pos, z, false)) {
-					tile->set_settlement(nullptr);
-					no_irregularities_found = false;
-				}
-			}
+		return !is_tile_territory_irregular(tile_pos);
+	}, [&](const size_t sweep_index, const QPoint &tile_pos) {
+		Q_UNUSED(sweep_index)
+
+		if (!is_tile_territory_irregular(tile_pos)) {
+			return false;
 		}
-	}
+
+		this->Field(tile_pos, z)->set_settlement(nullptr);
+		return true;
+	});
 }
 
 void CMap::generate_terrain(const generated_terrain *generated_terrain, const QPoint &min_pos, const QPoint &max_pos, const bool preserve_coastline, const int z)
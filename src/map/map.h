@@ -91,6 +91,7 @@ namespace wyrmgus {
 	class map_settings;
 	class map_template;
 	class site;
+	class terrain_compatibility_table;
 	class terrain_type;
 	class tile;
 	class tileset;
@@ -337,6 +338,11 @@ private:
 	/// Build tables for fog of war
 	void InitFogOfWar();
 
+	const terrain_compatibility_table &get_terrain_compatibility_table();
+
+	//whether the tile's terrain is irregular, i.e. its shape cannot be drawn with the terrain's transitions; this must only be called after the terrain compatibility table has been built, and can be called concurrently
+	bool is_tile_irregular(const QPoint &pos, const bool overlay, const int z) const;
+
 	//Wyrmgus start
 	/*
 	/// Correct the surrounding seen wood fields
@@ -375,6 +381,7 @@ public:
 
 private:
 	std::vector<tile *> animated_tiles;
+	std::unique_ptr<terrain_compatibility_table> terrain_compatibility; //built when first needed for map generation
 };
 
 extern std::filesystem::path CurrentMapPath; /// Path to the current map
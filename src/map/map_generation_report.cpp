@@ -0,0 +1,84 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "map/map_generation_report.h"
+
+namespace wyrmgus {
+
+std::string_view get_map_generation_stage_name(const map_generation_stage stage)
+{
+	switch (stage) {
+		case map_generation_stage::terrain_loading:
+			return "Terrain Loading";
+		case map_generation_stage::terrain:
+			return "Terrain";
+		case map_generation_stage::subtemplates:
+			return "Subtemplates";
+		case map_generation_stage::zones:
+			return "Zones";
+		case map_generation_stage::terrain_adjustment:
+			return "Terrain Adjustment";
+		case map_generation_stage::units:
+			return "Units";
+		case map_generation_stage::random_subtemplates:
+			return "Random Subtemplates";
+		case map_generation_stage::missing_terrain:
+			return "Missing Terrain";
+		case map_generation_stage::generated_terrain:
+			return "Generated Terrain";
+		case map_generation_stage::terrain_readjustment:
+			return "Terrain Readjustment";
+		case map_generation_stage::constructed_subtemplates:
+			return "Constructed Subtemplates";
+		case map_generation_stage::random_units:
+			return "Random Units";
+		case map_generation_stage::territories:
+			return "Territories";
+		default:
+			break;
+	}
+
+	throw std::runtime_error("Invalid map generation stage: \"" + std::to_string(static_cast<int>(stage)) + "\".");
+}
+
+void map_generation_report::print(const std::string &map_template_identifier) const
+{
+	fprintf(stdout, "Map generation times for map template \"%s\", excluding nested stages:\n", map_template_identifier.c_str());
+
+	for (size_t i = 0; i < this->stage_durations.size(); ++i) {
+		if (this->stage_counts[i] == 0) {
+			continue;
+		}
+
+		const map_generation_stage stage = static_cast<map_generation_stage>(i);
+		const double milliseconds = std::chrono::duration<double, std::milli>(this->stage_durations[i]).count();
+		fprintf(stdout, "\t%s: %.1f ms (%d)\n", std::string(get_map_generation_stage_name(stage)).c_str(), milliseconds, this->stage_counts[i]);
+	}
+}
+
+}
@@ -0,0 +1,123 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "util/singleton.h"
+
+namespace wyrmgus {
+
+//the stages in which a map template is applied, in order
+enum class map_generation_stage {
+	terrain_loading,
+	terrain,
+	subtemplates,
+	zones,
+	terrain_adjustment,
+	units,
+	random_subtemplates,
+	missing_terrain,
+	generated_terrain,
+	terrain_readjustment,
+	constructed_subtemplates,
+	random_units,
+	territories,
+
+	count
+};
+
+extern std::string_view get_map_generation_stage_name(const map_generation_stage stage);
+
+//accumulates the time spent in each stage of map generation, for the application of a main map template and its subtemplates
+class map_generation_report final : public singleton<map_generation_report>
+{
+public:
+	void clear()
+	{
+		this->stage_durations.fill(std::chrono::steady_clock::duration::zero());
+		this->stage_counts.fill(0);
+	}
+
+	void record(const map_generation_stage stage, const std::chrono::steady_clock::duration duration)
+	{
+		this->stage_durations[static_cast<size_t>(stage)] += duration;
+		++this->stage_counts[static_cast<size_t>(stage)];
+	}
+
+	void push_nested_stage()
+	{
+		this->nested_stage_durations.push_back(std::chrono::steady_clock::duration::zero());
+	}
+
+	//pops the nested stage, adding its total duration to that of the enclosing one, and returns the time spent in the stages nested in it
+	std::chrono::steady_clock::duration pop_nested_stage(const std::chrono::steady_clock::duration total_duration)
+	{
+		const std::chrono::steady_clock::duration children_duration = this->nested_stage_durations.back();
+		this->nested_stage_durations.pop_back();
+
+		if (!this->nested_stage_durations.empty()) {
+			this->nested_stage_durations.back() += total_duration;
+		}
+
+		return children_duration;
+	}
+
+	//print the time spent in each stage, excluding the time spent in the stages nested in it, e.g. those of the applied subtemplates
+	void print(const std::string &map_template_identifier) const;
+
+private:
+	std::array<std::chrono::steady_clock::duration, static_cast<size_t>(map_generation_stage::count)> stage_durations{};
+	std::array<int, static_cast<size_t>(map_generation_stage::count)> stage_counts{};
+	std::vector<std::chrono::steady_clock::duration> nested_stage_durations;
+};
+
+//times the scope it is created in, recording it as part of a map generation stage, with the time of the stages nested in it excluded
+class map_generation_stage_timer final
+{
+public:
+	explicit map_generation_stage_timer(const map_generation_stage stage)
+		: stage(stage), start(std::chrono::steady_clock::now())
+	{
+		map_generation_report::get()->push_nested_stage();
+	}
+
+	~map_generation_stage_timer()
+	{
+		const std::chrono::steady_clock::duration total_duration = std::chrono::steady_clock::now() - this->start;
+		const std::chrono::steady_clock::duration children_duration = map_generation_report::get()->pop_nested_stage(total_duration);
+
+		map_generation_report::get()->record(this->stage, total_duration - children_duration);
+	}
+
+	map_generation_stage_timer(const map_generation_stage_timer &other) = delete;
+	map_generation_stage_timer &operator =(const map_generation_stage_timer &other) = delete;
+
+private:
+	const map_generation_stage stage;
+	const std::chrono::steady_clock::time_point start;
+};
+
+}
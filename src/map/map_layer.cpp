@@ -32,6 +32,7 @@
 #include "engine_interface.h"
 #include "map/map.h"
 #include "map/map_info.h"
+#include "map/map_template.h"
 #include "map/minimap.h"
 #include "map/terrain_type.h"
 #include "map/tile.h"
@@ -62,9 +63,15 @@ CMapLayer::CMapLayer(const QSize &size) : size(size)
 	const int max_tile_index = size.width() * size.height();
 
 	try {
+		//the player information of all tiles is allocated as a single block, rather than separately for each tile
 		this->Fields = std::make_unique<wyrmgus::tile[]>(max_tile_index);
+		this->tile_player_infos = std::make_unique<wyrmgus::tile_player_info[]>(max_tile_index);
 	} catch (const std::bad_alloc &) {
-		std::throw_with_nested(std::runtime_error("Failed to allocate map layer with a tile area of " + std::to_string(max_tile_index) + ", for " + std::to_string(max_tile_index * sizeof(wyrmgus::tile)) + " bytes in total."));
+		std::throw_with_nested(std::runtime_error("Failed to allocate map layer with a tile area of " + std::to_string(max_tile_index) + ", for " + std::to_string(max_tile_index * (sizeof(wyrmgus::tile) + sizeof(wyrmgus::tile_player_info))) + " bytes in total."));
+	}
+
+	for (int i = 0; i < max_tile_index; ++i) {
+		this->Fields[i].player_info = &this->tile_player_infos[i];
 	}
 }
 
@@ -523,3 +530,105 @@ const wyrmgus::season *CMapLayer::get_tile_season(const QPoint &tile_pos) const
 {
 	return this->get_tile_season(point::to_index(tile_pos, this->get_width()));
 }
+
+void CMapLayer::add_subtemplate_area(const map_template *subtemplate, const QRect &map_rect)
+{
+	this->subtemplate_areas[subtemplate] = map_rect;
+
+	const int tile_count = this->get_width() * this->get_height();
+
+	if (this->subtemplate_area_mask.empty()) {
+		this->subtemplate_area_mask.resize(tile_count, 0);
+		this->subtemplate_set_indices.resize(tile_count, 0);
+		this->subtemplate_area_prefix_sums.resize((this->get_width() + 1) * (this->get_height() + 1), 0);
+	}
+
+	const QRect layer_rect = map_rect.intersected(QRect(QPoint(0, 0), this->get_size()));
+
+	if (layer_rect.isEmpty()) {
+		return;
+	}
+
+	//tiles which were contained in the same set of subtemplates before are now contained in the same new set
+	std::map<uint16_t, uint16_t> new_set_indices;
+
+	for (int y = layer_rect.top(); y <= layer_rect.bottom(); ++y) {
+		for (int x = layer_rect.left(); x <= layer_rect.right(); ++x) {
+			const QPoint tile_pos(x, y);
+			const int tile_index = point::to_index(tile_pos, this->get_width());
+
+			if (subtemplate->is_map_pos_usable(tile_pos)) {
+				this->subtemplate_area_mask[tile_index] = 1;
+			}
+
+			const uint16_t old_set_index = this->subtemplate_set_indices[tile_index];
+			const auto find_iterator = new_set_indices.find(old_set_index);
+			if (find_iterator != new_set_indices.end()) {
+				this->subtemplate_set_indices[tile_index] = find_iterator->second;
+				continue;
+			}
+
+			std::vector<const map_template *> new_set = this->subtemplate_sets[old_set_index];
+			new_set.push_back(subtemplate);
+			std::sort(new_set.begin(), new_set.end(), map_template_compare());
+
+			uint16_t new_set_index = 0;
+			const auto set_iterator = std::find(this->subtemplate_sets.begin(), this->subtemplate_sets.end(), new_set);
+			if (set_iterator != this->subtemplate_sets.end()) {
+				new_set_index = static_cast<uint16_t>(set_iterator - this->subtemplate_sets.begin());
+			} else {
+				if (this->subtemplate_sets.size() > std::numeric_limits<uint16_t>::max()) {
+					throw std::runtime_error("Too many distinct overlapping subtemplate combinations for map layer " + std::to_string(this->ID) + ".");
+				}
+
+				new_set_index = static_cast<uint16_t>(this->subtemplate_sets.size());
+				this->subtemplate_sets.push_back(std::move(new_set));
+			}
+
+			new_set_indices[old_set_index] = new_set_index;
+			this->subtemplate_set_indices[tile_index] = new_set_index;
+		}
+	}
+
+	this->update_subtemplate_area_prefix_sums(layer_rect.top());
+}
+
+int CMapLayer::get_subtemplate_area_tile_count(const QRect &rect) const
+{
+	if (this->subtemplate_area_prefix_sums.empty()) {
+		return 0;
+	}
+
+	const QRect layer_rect = rect.intersected(QRect(QPoint(0, 0), this->get_size()));
+
+	if (layer_rect.isEmpty()) {
+		return 0;
+	}
+
+	const int row_size = this->get_width() + 1;
+	const auto get_prefix_sum = [&](const int x, const int y) {
+		return this->subtemplate_area_prefix_sums[x + y * row_size];
+	};
+
+	const int left = layer_rect.left();
+	const int top = layer_rect.top();
+	const int right = layer_rect.right() + 1;
+	const int bottom = layer_rect.bottom() + 1;
+
+	return get_prefix_sum(right, bottom) - get_prefix_sum(left, bottom) - get_prefix_sum(right, top) + get_prefix_sum(left, top);
+}
+
+void CMapLayer::update_subtemplate_area_prefix_sums(const int min_y)
+{
+	//the prefix sums only change for the rows at or below the first changed row
+	const int row_size = this->get_width() + 1;
+
+	for (int y = min_y; y < this->get_height(); ++y) {
+		int row_sum = 0;
+
+		for (int x = 0; x < this->get_width(); ++x) {
+			row_sum += this->subtemplate_area_mask[point::to_index(x, y, this->get_width())];
+			this->subtemplate_area_prefix_sums[(x + 1) + (y + 1) * row_size] = this->subtemplate_area_prefix_sums[(x + 1) + y * row_size] + row_sum;
+		}
+	}
+}
@@ -48,6 +48,7 @@ namespace wyrmgus {
 	class season_schedule;
 	class terrain_type;
 	class tile;
+	class tile_player_info;
 	class time_of_day;
 	class time_of_day_schedule;
 	class unit_type;
@@ -193,6 +194,39 @@ public:
 		return empty_rect;
 	}
 
+	void add_subtemplate_area(const wyrmgus::map_template *subtemplate, const QRect &map_rect);
+
+	//whether the position is in the usable area of any subtemplate applied to the map layer
+	bool is_pos_in_subtemplate_area(const QPoint &pos) const
+	{
+		if (this->subtemplate_area_mask.empty() || !this->is_pos_on_layer(pos)) {
+			return false;
+		}
+
+		return this->subtemplate_area_mask[pos.x() + pos.y() * this->get_width()] != 0;
+	}
+
+	//get the quantity of tiles in the rect which are in the usable area of a subtemplate
+	int get_subtemplate_area_tile_count(const QRect &rect) const;
+
+	//get the subtemplates whose rect contains the position, in the same order as they are stored in the subtemplate areas
+	const std::vector<const wyrmgus::map_template *> &get_pos_subtemplates(const QPoint &pos) const
+	{
+		if (this->subtemplate_set_indices.empty() || !this->is_pos_on_layer(pos)) {
+			return this->subtemplate_sets.front();
+		}
+
+		return this->subtemplate_sets[this->subtemplate_set_indices[pos.x() + pos.y() * this->get_width()]];
+	}
+
+private:
+	bool is_pos_on_layer(const QPoint &pos) const
+	{
+		return pos.x() >= 0 && pos.y() >= 0 && pos.x() < this->get_width() && pos.y() < this->get_height();
+	}
+
+	void update_subtemplate_area_prefix_sums(const int min_y);
+
 signals:
 	void tile_image_changed(QPoint tile_pos, const terrain_type *terrain, short tile_frame, const player_color *player_color) const;
 	void tile_overlay_image_changed(QPoint tile_pos, const terrain_type *terrain, short tile_frame, const player_color *player_color) const;
@@ -211,6 +245,7 @@ public:
 	int ID = -1;
 private:
 	std::unique_ptr<wyrmgus::tile[]> Fields; //fields on the map layer
+	std::unique_ptr<wyrmgus::tile_player_info[]> tile_player_infos; //the player information of each field, in a single block
 	QSize size;									/// the size in tiles of the map layer
 	const scheduled_time_of_day *time_of_day = nullptr;	/// the time of day for the map layer
 	const wyrmgus::time_of_day_schedule *time_of_day_schedule = nullptr; //the time of day schedule for the map layer
@@ -223,7 +258,13 @@ public:
 	int RemainingSeasonHours = 0;				/// the quantity of hours remaining for the current season to end
 	const wyrmgus::world *world = nullptr;			/// the world pointer (if any) for the map layer
 	std::vector<CUnit *> LayerConnectors;		/// connectors in the map layer which lead to other map layers
-	wyrmgus::map_template_map<QRect> subtemplate_areas;
+	wyrmgus::map_template_map<QRect> subtemplate_areas; //should only be added to via add_subtemplate_area, so that the subtemplate area raster is kept up to date
+private:
+	std::vector<uint8_t> subtemplate_area_mask; //whether each tile is in the usable area of a subtemplate
+	std::vector<int> subtemplate_area_prefix_sums; //integral image of the subtemplate area mask, with an extra row and column of zeroes at the start
+	std::vector<uint16_t> subtemplate_set_indices; //for each tile, the index of the set of subtemplates whose rect contains it
+	std::vector<std::vector<const wyrmgus::map_template *>> subtemplate_sets = { {} }; //the distinct sets of subtemplates containing tiles; the first one is empty
+public:
 	std::vector<QPoint> destroyed_overlay_terrain_tiles; /// destroyed overlay terrain tiles (excluding trees)
 	std::vector<QPoint> destroyed_tree_tiles;	/// destroyed tree tiles; this list is used for forest regeneration
 
@@ -45,6 +45,7 @@
 #include "map/historical_location.h"
 #include "map/map.h"
 #include "map/map_info.h"
+#include "map/map_generation_report.h"
 #include "map/map_layer.h"
 #include "map/map_projection.h"
 #include "map/map_settings.h"
@@ -62,6 +63,7 @@
 #include "map/tileset.h"
 #include "map/world.h"
 #include "map/world_game_data.h"
+#include "parameters.h"
 #include "player/civilization.h"
 #include "player/faction.h"
 #include "player/faction_history.h"
@@ -87,6 +89,7 @@
 #include "util/geoshape_util.h"
 #include "util/image_util.h"
 #include "util/number_util.h"
+#include "util/parallel_util.h"
 #include "util/path_util.h"
 #include "util/point_util.h"
 #include "util/set_util.h"
@@ -850,8 +853,18 @@ void map_template::apply(const QPoint &template_start_pos, const QPoint &map_sta
 	}
 	
 	const bool has_base_map = !this->get_terrain_file().empty();
+
+	if (!this->IsSubtemplateArea()) {
+		map_generation_report::get()->clear();
+
+		const map_generation_stage_timer timer(map_generation_stage::terrain_loading);
+		this->preload_terrain_images();
+	}
 	
 	ShowLoadProgress(_("Applying \"%s\" Map Template Terrain..."), this->get_name().c_str());
+
+	std::optional<map_generation_stage_timer> stage_timer;
+	stage_timer.emplace(map_generation_stage::terrain);
 	
 	if (this->get_base_terrain_type() != nullptr || this->get_border_terrain_type() != nullptr || this->clear_terrain) {
 		for (int x = map_start_pos.x(); x < map_end.x(); ++x) {
@@ -989,18 +1002,23 @@ void map_template::apply(const QPoint &template_start_pos, const QPoint &map_sta
 		}
 	}
 	
+	stage_timer.reset();
+
 	if (!this->get_subtemplates().empty()) {
 		ShowLoadProgress(_("Applying \"%s\" Subtemplates..."), this->get_name().c_str());
+		const map_generation_stage_timer timer(map_generation_stage::subtemplates);
 		this->apply_subtemplates(template_start_pos, map_start_pos, map_end, z, false, false);
 	}
 
 	if (!this->IsSubtemplateArea() && !this->generated_factions.empty()) {
 		ShowLoadProgress(_("Generating \"%s\" Zones..."), this->get_name().c_str());
+		const map_generation_stage_timer timer(map_generation_stage::zones);
 		this->generate_zones(z);
 	}
 
 	if (!this->IsSubtemplateArea() && this->is_tile_adjustment_enabled()) {
 		ShowLoadProgress(_("Adjusting \"%s\" Map Template Terrain..."), this->get_name().c_str());
+		const map_generation_stage_timer timer(map_generation_stage::terrain_adjustment);
 		CMap::get()->AdjustTileMapIrregularities(false, map_start_pos, map_end, z);
 		CMap::get()->AdjustTileMapIrregularities(true, map_start_pos, map_end, z);
 		CMap::get()->AdjustTileMapTransitions(map_start_pos, map_end, z);
@@ -1009,6 +1027,8 @@ void map_template::apply(const QPoint &template_start_pos, const QPoint &map_sta
 	
 	ShowLoadProgress(_("Applying \"%s\" Map Template Units..."), this->get_name().c_str());
 
+	stage_timer.emplace(map_generation_stage::units);
+
 	for (std::map<std::pair<int, int>, std::tuple<unit_type *, int, unique_item *>>::const_iterator iterator = this->Resources.begin(); iterator != this->Resources.end(); ++iterator) {
 		Vec2i unit_raw_pos(iterator->first.first, iterator->first.second);
 		Vec2i unit_pos(map_start_pos.x() + unit_raw_pos.x - template_start_pos.x(), map_start_pos.y() + unit_raw_pos.y - template_start_pos.y());
@@ -1048,22 +1068,31 @@ void map_template::apply(const QPoint &template_start_pos, const QPoint &map_sta
 	this->apply_sites(template_start_pos, map_start_pos, map_end, z);
 	this->ApplyUnits(template_start_pos, map_start_pos, map_end, z);
 
+	stage_timer.reset();
+
 	if (!this->get_subtemplates().empty()) {
 		ShowLoadProgress(_("Applying \"%s\" Random Subtemplates..."), this->get_name().c_str());
+		const map_generation_stage_timer timer(map_generation_stage::random_subtemplates);
 		this->apply_subtemplates(template_start_pos, map_start_pos, map_end, z, true, false);
 	}
 
 	if (!this->IsSubtemplateArea()) {
+		const map_generation_stage_timer timer(map_generation_stage::missing_terrain);
 		CMap::get()->generate_missing_terrain(QRect(map_start_pos, map_end - QPoint(1, 1)), z);
 	}
 
 	ShowLoadProgress(_("Generating \"%s\" Map Template Random Terrain..."), this->get_name().c_str());
-	for (const auto &generated_terrain : this->generated_terrains) {
-		CMap::get()->generate_terrain(generated_terrain.get(), map_start_pos, map_end - Vec2i(1, 1), has_base_map, z);
+	if (!this->generated_terrains.empty()) {
+		const map_generation_stage_timer timer(map_generation_stage::generated_terrain);
+
+		for (const auto &generated_terrain : this->generated_terrains) {
+			CMap::get()->generate_terrain(generated_terrain.get(), map_start_pos, map_end - Vec2i(1, 1), has_base_map, z);
+		}
 	}
 
 	if (!this->IsSubtemplateArea() && this->is_tile_adjustment_enabled()) {
 		ShowLoadProgress(_("Readjusting \"%s\" Map Template Terrain..."), this->get_name().c_str());
+		const map_generation_stage_timer timer(map_generation_stage::terrain_readjustment);
 		CMap::get()->AdjustTileMapIrregularities(false, map_start_pos, map_end, z);
 		CMap::get()->AdjustTileMapIrregularities(true, map_start_pos, map_end, z);
 		CMap::get()->AdjustTileMapTransitions(map_start_pos, map_end, z);
@@ -1072,12 +1101,15 @@ void map_template::apply(const QPoint &template_start_pos, const QPoint &map_sta
 
 	if (!this->get_subtemplates().empty()) {
 		ShowLoadProgress(_("Applying \"%s\" Constructed Subtemplates..."), this->get_name().c_str());
+		const map_generation_stage_timer timer(map_generation_stage::constructed_subtemplates);
 		this->apply_subtemplates(template_start_pos, map_start_pos, map_end, z, false, true);
 		this->apply_subtemplates(template_start_pos, map_start_pos, map_end, z, true, true);
 	}
 
 	ShowLoadProgress(_("Generating \"%s\" Map Template Random Units..."), this->get_name().c_str());
 
+	stage_timer.emplace(map_generation_stage::random_units);
+
 	// now, generate the units and heroes that were set to be generated at a random position (by having their position set to {-1, -1})
 	if (current_campaign != nullptr) {
 		this->ApplyConnectors(template_start_pos, map_start_pos, map_end, z, true);
@@ -1156,7 +1188,10 @@ void map_template::apply(const QPoint &template_start_pos, const QPoint &map_sta
 		CMap::get()->generate_neutral_units(this->GeneratedNeutralUnits[i].first, this->GeneratedNeutralUnits[i].second, map_start_pos, map_end - Vec2i(1, 1), grouped, z);
 	}
 
+	stage_timer.reset();
+
 	if (!this->IsSubtemplateArea()) {
+		stage_timer.emplace(map_generation_stage::territories);
 		CMap::get()->adjust_territory_irregularities(map_start_pos, map_end - QPoint(1, 1), z);
 
 		if (this->create_starting_mine) {
@@ -1250,7 +1285,7 @@ void map_template::apply(const QPoint &template_start_pos, const QPoint &map_sta
 	const QRect map_rect(map_start_pos, map_end - Vec2i(1, 1));
 
 	if (this->IsSubtemplateArea()) {
-		CMap::get()->MapLayers[z]->subtemplate_areas[this] = map_rect;
+		CMap::get()->MapLayers[z]->add_subtemplate_area(this, map_rect);
 
 		//if this is the top subtemplate for a given world, set the world's map rect to this map template's map rect
 		if (this->get_world() != nullptr && this->get_world() != this->get_main_template()->get_world()) {
@@ -1266,7 +1301,13 @@ void map_template::apply(const QPoint &template_start_pos, const QPoint &map_sta
 		}
 	}
 
+	stage_timer.reset();
+
 	this->clear_application_data();
+
+	if (!this->IsSubtemplateArea() && parameters::get()->is_timing_report_enabled()) {
+		map_generation_report::get()->print(this->get_identifier());
+	}
 }
 
 /**
@@ -3062,7 +3103,7 @@ void map_template::apply_historical_unit(const historical_unit *historical_unit,
 		}
 
 		if (historical_unit->get_ttl() != 0) {
-			unit->TTL = historical_unit->get_ttl();
+			unit->set_ttl(historical_unit->get_ttl());
 		}
 	}
 }
@@ -4013,6 +4054,50 @@ QImage map_template::load_terrain_image_file(const std::filesystem::path &filepa
 	return terrain_image;
 }
 
+void map_template::preload_terrain_images()
+{
+	std::vector<map_template *> map_templates;
+	map_templates.push_back(this);
+
+	for (size_t i = 0; i < map_templates.size(); ++i) {
+		for (map_template *subtemplate : map_templates[i]->get_subtemplates()) {
+			if (game::get()->get_current_campaign() != nullptr && !subtemplate->history->is_active()) {
+				continue;
+			}
+
+			if (CMap::get()->is_subtemplate_on_map(subtemplate)) {
+				continue;
+			}
+
+			//optional subtemplates are picked at random during application, and may not be applied at all, so their images are only loaded if they are picked
+			if (subtemplate->is_optional_for_campaign(game::get()->get_current_campaign())) {
+				continue;
+			}
+
+			map_templates.push_back(subtemplate);
+		}
+	}
+
+	//only image files are loaded here, as their loading does not depend on anything but the map template itself; other terrain file formats can involve random character substitutions, and so are loaded in application order, to keep the result the same for a given seed
+	std::erase_if(map_templates, [](const map_template *map_template) {
+		return map_template->get_terrain_file().extension() != ".png" && map_template->get_overlay_terrain_file().extension() != ".png";
+	});
+
+	parallel::for_each_chunk(map_templates.size(), 1, [&map_templates](const size_t begin, const size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			map_template *map_template = map_templates[i];
+
+			if (map_template->get_terrain_file().extension() == ".png") {
+				map_template->load_terrain_image(false);
+			}
+
+			if (map_template->get_overlay_terrain_file().extension() == ".png") {
+				map_template->load_terrain_image(true);
+			}
+		}
+	});
+}
+
 void map_template::load_terrain_image(const bool overlay)
 {
 	QImage &terrain_image = overlay ? this->overlay_terrain_image : this->terrain_image;
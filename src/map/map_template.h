@@ -496,6 +496,10 @@ public:
 	void load_freeciv_terrain_file();
 	void load_stratagus_terrain_file();
 	QImage load_terrain_image_file(const std::filesystem::path &filepath);
+
+	//load the terrain images of the map template and of the subtemplates which will be applied with it concurrently, ahead of their application
+	void preload_terrain_images();
+
 	void load_terrain_image(const bool overlay);
 	void load_trade_route_image();
 
@@ -348,7 +348,7 @@ static int CclShowMapLocation(lua_State *l)
 		target->Variable[HP_INDEX].Value = 0;
 		target->tilePos.x = LuaToNumber(l, 1);
 		target->tilePos.y = LuaToNumber(l, 2);
-		target->TTL = GameCycle + LuaToNumber(l, 4);
+		target->set_ttl(GameCycle + LuaToNumber(l, 4));
 		target->CurrentSightRange = LuaToNumber(l, 3);
 		//Wyrmgus start
 		UpdateUnitSightRange(*target);
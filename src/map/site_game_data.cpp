@@ -39,6 +39,7 @@
 #include "map/tile.h"
 #include "player/player.h"
 #include "population/employment_type.h"
+#include "population/population_batch.h"
 #include "population/population_class.h"
 #include "population/population_type.h"
 #include "population/population_unit.h"
@@ -159,18 +160,6 @@ gsml_data site_game_data::to_gsml_data() const
 	return data;
 }
 
-void site_game_data::do_per_half_minute_loop()
-{
-	if (defines::get()->is_population_enabled() && this->site->is_settlement()) {
-		this->do_population_growth();
-		this->do_population_promotion();
-		this->do_population_demotion();
-		this->do_population_employment();
-
-		this->sort_population_units();
-	}
-}
-
 const std::string &site_game_data::get_current_cultural_name() const
 {
 	const CUnit *unit = this->get_site_unit();
@@ -217,6 +206,14 @@ void site_game_data::set_owner(CPlayer *player)
 	this->owner = player;
 
 	if (this->site->is_settlement()) {
+		if (old_owner != nullptr) {
+			old_owner->remove_settlement(this->site);
+		}
+
+		if (this->owner != nullptr) {
+			this->owner->add_settlement(this->site);
+		}
+
 		if (defines::get()->is_population_enabled()) {
 			if (old_owner != nullptr) {
 				old_owner->change_population(-this->get_population());
@@ -578,6 +575,51 @@ void site_game_data::clear_population_units()
 	emit population_units_changed(this->get_population_units_qvariant_list());
 }
 
+void site_game_data::set_population_units(const std::vector<std::pair<population_unit_key, int64_t>> &population_units, const int64_t population)
+{
+	//keep the objects of the population units whose key still exists, so that only the population units which have actually been added or removed cause the list to be updated
+	std::vector<const population_unit *> old_population_units;
+	for (const qunique_ptr<population_unit> &population_unit : this->population_units) {
+		old_population_units.push_back(population_unit.get());
+	}
+
+	std::vector<qunique_ptr<population_unit>> new_population_units;
+
+	for (const auto &[key, unit_population] : population_units) {
+		qunique_ptr<population_unit> population_unit;
+
+		for (qunique_ptr<wyrmgus::population_unit> &old_population_unit : this->population_units) {
+			if (old_population_unit != nullptr && old_population_unit->get_key() == key) {
+				population_unit = std::move(old_population_unit);
+				break;
+			}
+		}
+
+		if (population_unit != nullptr) {
+			if (population_unit->get_population() != unit_population) {
+				population_unit->set_population(unit_population);
+			}
+		} else {
+			population_unit = make_qunique<wyrmgus::population_unit>(key, unit_population);
+			population_unit->moveToThread(QApplication::instance()->thread());
+		}
+
+		new_population_units.push_back(std::move(population_unit));
+	}
+
+	bool changed = new_population_units.size() != old_population_units.size();
+	for (size_t i = 0; i < new_population_units.size() && !changed; ++i) {
+		changed = new_population_units[i].get() != old_population_units[i];
+	}
+
+	this->population_units = std::move(new_population_units);
+	this->set_population(population);
+
+	if (changed) {
+		emit population_units_changed(this->get_population_units_qvariant_list());
+	}
+}
+
 void site_game_data::set_population_unit_population(const population_unit_key &key, const int64_t population)
 {
 	if (population == 0) {
@@ -698,318 +740,16 @@ void site_game_data::change_default_population_type_population(const int64_t pop
 	this->change_population_unit_population(population_unit_key, population);
 }
 
-std::vector<std::pair<population_unit *, int64_t>> site_game_data::get_population_units_permyriad() const
-{
-	//get the settlement's population proportion for each population unit, in permyriad
-	std::vector<std::pair<population_unit *, int64_t>> population_units_permyriad;
-
-	const int64_t total_population = this->get_population();
-
-	for (const qunique_ptr<population_unit> &population_unit : this->population_units) {
-		const int64_t permyriad = population_unit->get_population() * 10000 / total_population;
-
-		population_units_permyriad.emplace_back(std::make_pair(population_unit.get(), permyriad));
-	}
-
-	return population_units_permyriad;
-}
-
-void site_game_data::move_to_employment(const population_unit_key &population_unit_key, const employment_type *employment_type, const int64_t quantity)
-{
-	wyrmgus::population_unit_key key = population_unit_key;
-	this->change_population_unit_population(key, -quantity);
-
-	key.employment_type = employment_type;
-	this->change_population_unit_population(key, quantity);
-}
-
-void site_game_data::move_to_unemployment(const population_unit_key &population_unit_key, const int64_t quantity)
-{
-	wyrmgus::population_unit_key key = population_unit_key;
-	this->change_population_unit_population(key, -quantity);
-
-	key.employment_type = nullptr;
-	this->change_population_unit_population(key, quantity);
-}
-
-void site_game_data::change_population_unit_to_type(const population_unit_key &population_unit_key, const population_type *population_type, const int64_t quantity)
-{
-	wyrmgus::population_unit_key key = population_unit_key;
-	this->change_population_unit_population(key, -quantity);
-
-	key.type = population_type;
-	this->change_population_unit_population(key, quantity);
-}
-
-void site_game_data::do_population_growth()
-{
-	const int64_t available_capacity = this->get_population_capacity() - this->get_population();
-
-	if (available_capacity != 0) {
-		this->apply_population_growth(available_capacity);
-	}
-}
-
-void site_game_data::apply_population_growth(const int64_t population_growth_capacity)
-{
-	const std::vector<std::pair<population_unit *, int64_t>> population_units_permyriad = this->get_population_units_permyriad();
-
-	int64_t remaining_population_growth_capacity = population_growth_capacity;
-
-	for (const auto &[population_unit, permyriad] : population_units_permyriad) {
-		const int64_t population_unit_growth_capacity = population_growth_capacity * permyriad / 10000;
-
-		if (population_unit_growth_capacity == 0) {
-			continue;
-		}
-
-		population_unit_key key = population_unit->get_key();
-
-		if (population_unit_growth_capacity > 0 && !population_unit->get_type()->is_growable()) {
-			key.type = this->get_default_population_type();
-			key.employment_type = nullptr;
-		}
-
-		const int64_t population_unit_growth = population_unit->calculate_population_growth_quantity(population_unit_growth_capacity);
-
-		this->change_population_unit_population(key, population_unit_growth);
-
-		remaining_population_growth_capacity -= population_unit_growth_capacity;
-	}
-
-	//if there is any remaining population growth capacity, apply it to the default population class if positive, or subtract from existing population units if negative
-	if (remaining_population_growth_capacity != 0) {
-		if (remaining_population_growth_capacity > 0) {
-			const int64_t population_unit_growth = population_unit::calculate_population_growth_quantity(remaining_population_growth_capacity, 0);
-			this->change_default_population_type_population(population_unit_growth);
-		} else {
-			if (!this->population_units.empty()) {
-				const qunique_ptr<population_unit> &population_unit = this->population_units.front();
-
-				const int64_t change = population_unit->calculate_population_growth_quantity(remaining_population_growth_capacity);
-
-				this->change_population_unit_population(population_unit->get_key(), change);
-			}
-		}
-	}
-}
-
-void site_game_data::do_population_promotion()
-{
-	std::vector<population_unit *> promotable_population_units;
-
-	for (const qunique_ptr<population_unit> &population_unit : this->population_units) {
-		if (population_unit->get_type()->get_population_class()->get_promotion_targets().empty()) {
-			continue;
-		}
-
-		if (population_unit->get_employment_type() == nullptr) {
-			//can only promote here within employment; promoting when becoming employed is handled in the available employment check code
-			continue;
-		}
-
-		promotable_population_units.push_back(population_unit.get());
-	}
-
-	for (population_unit *population_unit : promotable_population_units) {
-		for (const population_class *promotion_class : population_unit->get_type()->get_population_class()->get_promotion_targets()) {
-			if (!vector::contains(population_unit->get_employment_type()->get_employees(), promotion_class)) {
-				continue;
-			}
-
-			const population_type *promotion_type = this->get_class_population_type(promotion_class);
-			if (promotion_type == nullptr) {
-				continue;
-			}
-
-			const int64_t available_capacity = this->get_employment_capacity(population_unit->get_employment_type()) - this->get_employment_workforce(population_unit->get_employment_type()) + population_unit->get_population();
-
-			if (available_capacity <= 0) {
-				continue;
-			}
-
-			const int64_t promotion_quantity = population_unit->calculate_promotion_quantity(available_capacity);
-			const bool removed_pop = promotion_quantity >= population_unit->get_population();
-
-			this->change_population_unit_to_type(population_unit->get_key(), promotion_type, promotion_quantity);
-
-			if (removed_pop) {
-				break;
-			}
-		}
-	}
-}
-
-void site_game_data::do_population_demotion()
-{
-	std::vector<population_unit *> demotable_population_units;
-
-	for (const qunique_ptr<population_unit> &population_unit : this->population_units) {
-		if (population_unit->get_type()->get_population_class()->get_demotion_targets().empty()) {
-			continue;
-		}
-
-		bool should_demote = false;
-
-		if (population_unit->get_employment_type() == nullptr && !population_unit->get_type()->get_population_class()->can_have_unemployment()) {
-			should_demote = true;
-		}
-
-		if (!should_demote) {
-			continue;
-		}
-
-		demotable_population_units.push_back(population_unit.get());
-	}
-
-	for (population_unit *population_unit : demotable_population_units) {
-		for (const population_class *demotion_class : population_unit->get_type()->get_population_class()->get_demotion_targets()) {
-			if (population_unit->get_employment_type() != nullptr && !vector::contains(population_unit->get_employment_type()->get_employees(), demotion_class)) {
-				continue;
-			}
-
-			const population_type *demotion_type = this->get_class_population_type(demotion_class);
-			if (demotion_type == nullptr) {
-				continue;
-			}
-
-			const int64_t base_demotion_quantity = population_unit->get_population();
-
-			const int64_t demotion_quantity = population_unit->calculate_promotion_quantity(base_demotion_quantity);
-			const bool removed_pop = demotion_quantity >= population_unit->get_population();
-
-			this->change_population_unit_to_type(population_unit->get_key(), demotion_type, demotion_quantity);
-
-			if (removed_pop) {
-				break;
-			}
-		}
-	}
-}
-
-void site_game_data::do_population_employment()
-{
-	this->check_employment_validity();
-	this->check_employment_capacities();
-	this->check_available_employment();
-
-	this->calculate_employment_incomes();
-}
-
 void site_game_data::check_employment_validity()
 {
-	std::vector<population_unit *> invalid_employment_population_units;
-
-	for (const qunique_ptr<population_unit> &population_unit : this->population_units) {
-		if (population_unit->get_employment_type() == nullptr) {
-			continue;
-		}
-
-		if (this->get_employment_capacity(population_unit->get_employment_type()) == 0) {
-			invalid_employment_population_units.push_back(population_unit.get());
-		}
-	}
-
-	//move the population of population units with an invalid employment to that of their corresponding unemployed population unit
-	for (population_unit *population_unit : invalid_employment_population_units) {
-		const int64_t population = population_unit->get_population();
-		this->move_to_unemployment(population_unit->get_key(), population);
-	}
+	population_batch population_batch;
+	population_batch.process_employment_validity(this);
 }
 
 void site_game_data::check_employment_capacities()
 {
-	//check if any employment workforce is over capacity and if so, reduce it to capacity
-	for (const auto &[employment_type, capacity] : this->employment_capacities) {
-		int64_t surplus_workforce = this->get_employment_workforce(employment_type) - capacity;
-
-		if (surplus_workforce <= 0) {
-			continue;
-		}
-
-		std::vector<population_unit *> employment_population_units;
-		for (const qunique_ptr<population_unit> &population_unit : this->population_units) {
-			if (population_unit->get_employment_type() == employment_type) {
-				employment_population_units.push_back(population_unit.get());
-			}
-		}
-
-		for (population_unit *population_unit : employment_population_units) {
-			const int64_t unemployed_change = std::min(surplus_workforce, population_unit->get_population());
-			this->move_to_unemployment(population_unit->get_key(), unemployed_change);
-			surplus_workforce -= unemployed_change;
-
-			if (surplus_workforce <= 0) {
-				break;
-			}
-		}
-	}
-}
-
-void site_game_data::check_available_employment()
-{
-	for (const auto &[employment_type, capacity] : this->employment_capacities) {
-		int64_t available_capacity = capacity - this->get_employment_workforce(employment_type);
-
-		if (available_capacity <= 0) {
-			continue;
-		}
-
-		std::vector<population_unit *> employable_population_units;
-		for (const qunique_ptr<population_unit> &population_unit : this->population_units) {
-			if (population_unit->get_employment_type() != nullptr) {
-				continue;
-			}
-
-			if (!employment_type->can_employ(population_unit->get_type()->get_population_class())) {
-				continue;
-			}
-
-			employable_population_units.push_back(population_unit.get());
-		}
-
-		for (population_unit *population_unit : employable_population_units) {
-			//whether the population unit taking up this employment would entail a promotion
-			const bool is_promotion_employment = !vector::contains(employment_type->get_employees(), population_unit->get_type()->get_population_class());
-
-			population_unit_key key = population_unit->get_key();
-
-			int64_t employed_change = std::min(available_capacity, population_unit->get_population());
-
-			if (is_promotion_employment) {
-				key.type = nullptr;
-
-				for (const population_class *employee_class : employment_type->get_employees()) {
-					if (!vector::contains(population_unit->get_type()->get_population_class()->get_promotion_targets(), employee_class)) {
-						continue;
-					}
-
-					const population_type *employee_type = this->get_class_population_type(employee_class);
-					if (employee_type == nullptr) {
-						continue;
-					}
-
-					key.type = employee_type;
-					break;
-				}
-
-				if (key.type == nullptr) {
-					//this is a promotion-based employment, but no actual promotion type is available
-					continue;
-				}
-
-				employed_change = population_unit->calculate_promotion_quantity(available_capacity);
-				this->change_population_unit_to_type(population_unit->get_key(), key.type, employed_change);
-			}
-
-			this->move_to_employment(key, employment_type, employed_change);
-			available_capacity -= employed_change;
-
-			if (available_capacity <= 0) {
-				break;
-			}
-		}
-	}
+	population_batch population_batch;
+	population_batch.process_employment_capacities(this);
 }
 
 void site_game_data::calculate_employment_incomes()
@@ -67,8 +67,6 @@ public:
 
 	gsml_data to_gsml_data() const;
 
-	void do_per_half_minute_loop();
-
 	const std::string &get_current_cultural_name() const;
 
 	CUnit *get_site_unit() const
@@ -258,12 +256,18 @@ private:
 public:
 	void ensure_minimum_population();
 
+	const std::vector<qunique_ptr<population_unit>> &get_population_units() const
+	{
+		return this->population_units;
+	}
+
 	QVariantList get_population_units_qvariant_list() const;
 
 	population_unit *get_population_unit(const population_unit_key &key) const;
 	void create_population_unit(const population_unit_key &key, const int64_t population);
 	void remove_population_unit(const population_unit_key &key);
 	void clear_population_units();
+	void set_population_units(const std::vector<std::pair<population_unit_key, int64_t>> &population_units, const int64_t population);
 
 	void set_population_unit_population(const population_unit_key &key, const int64_t population);
 	void change_population_unit_population(const population_unit_key &key, const int64_t change);
@@ -278,27 +282,13 @@ public:
 	void set_default_population_type_population(const int64_t population);
 	void change_default_population_type_population(const int64_t population);
 
-	std::vector<std::pair<population_unit *, int64_t>> get_population_units_permyriad() const;
-
-	void move_to_employment(const population_unit_key &population_unit_key, const employment_type *employment_type, const int64_t quantity);
-	void move_to_unemployment(const population_unit_key &population_unit_key, const int64_t quantity);
-	void change_population_unit_to_type(const population_unit_key &population_unit_key, const population_type *population_type, const int64_t quantity);
-
 	int64_t get_population_capacity() const
 	{
 		return static_cast<int64_t>(this->get_housing()) * site_game_data::population_per_housing;
 	}
 
-	void do_population_growth();
-	void apply_population_growth(const int64_t population_growth_capacity);
-
-	void do_population_promotion();
-	void do_population_demotion();
-
-	void do_population_employment();
 	void check_employment_validity();
 	void check_employment_capacities();
-	void check_available_employment();
 
 	void calculate_employment_incomes();
 
@@ -330,6 +320,11 @@ public:
 		return this->get_population() / site_game_data::population_per_housing;
 	}
 
+	const employment_type_map<int> &get_employment_capacities() const
+	{
+		return this->employment_capacities;
+	}
+
 	int get_employment_capacity(const employment_type *employment_type) const
 	{
 		const auto find_iterator = this->employment_capacities.find(employment_type);
@@ -0,0 +1,67 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "map/terrain_compatibility_table.h"
+
+namespace wyrmgus {
+
+terrain_compatibility_table::terrain_compatibility_table()
+{
+	const std::vector<terrain_type *> &terrain_types = terrain_type::get_all();
+
+	this->terrain_type_count = terrain_types.size();
+	this->pair_flags.resize(this->terrain_type_count * this->terrain_type_count, 0);
+	this->intermediate_terrains.resize(this->terrain_type_count * this->terrain_type_count, nullptr);
+
+	for (const terrain_type *terrain : terrain_types) {
+		for (const terrain_type *outer_border_terrain : terrain->get_outer_border_terrain_types()) {
+			this->pair_flags[this->get_pair_index(terrain, outer_border_terrain)] |= terrain_compatibility_table::outer_border_flag;
+		}
+
+		for (const terrain_type *border_terrain : terrain->BorderTerrains) {
+			this->pair_flags[this->get_pair_index(terrain, border_terrain)] |= terrain_compatibility_table::border_flag;
+		}
+
+		for (const terrain_type *base_terrain : terrain->get_base_terrain_types()) {
+			this->pair_flags[this->get_pair_index(terrain, base_terrain)] |= terrain_compatibility_table::base_terrain_flag;
+		}
+	}
+
+	for (const terrain_type *terrain : terrain_types) {
+		for (const terrain_type *other_terrain : terrain_types) {
+			if (terrain == other_terrain || this->is_border(terrain, other_terrain)) {
+				//intermediate terrain types are only needed for terrain types which cannot border each other directly
+				continue;
+			}
+
+			this->intermediate_terrains[this->get_pair_index(terrain, other_terrain)] = terrain->get_intermediate_terrain_type(other_terrain);
+		}
+	}
+}
+
+}
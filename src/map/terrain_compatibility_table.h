@@ -0,0 +1,91 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "map/terrain_type.h"
+
+namespace wyrmgus {
+
+//precomputed relations between each pair of terrain types, so that the map generation passes can look them up in constant time instead of searching the terrain types' border lists for every tile
+class terrain_compatibility_table final
+{
+private:
+	static constexpr uint8_t outer_border_flag = 1 << 0;
+	static constexpr uint8_t border_flag = 1 << 1;
+	static constexpr uint8_t base_terrain_flag = 1 << 2;
+
+public:
+	terrain_compatibility_table();
+
+	//whether the other terrain type is the same as the terrain type, or one of its outer border terrain types
+	bool is_same_or_outer_border(const terrain_type *terrain, const terrain_type *other_terrain) const
+	{
+		if (other_terrain == nullptr) {
+			return false;
+		}
+
+		return terrain == other_terrain || this->has_flag(terrain, other_terrain, terrain_compatibility_table::outer_border_flag);
+	}
+
+	bool is_outer_border(const terrain_type *terrain, const terrain_type *other_terrain) const
+	{
+		return this->has_flag(terrain, other_terrain, terrain_compatibility_table::outer_border_flag);
+	}
+
+	bool is_border(const terrain_type *terrain, const terrain_type *other_terrain) const
+	{
+		return this->has_flag(terrain, other_terrain, terrain_compatibility_table::border_flag);
+	}
+
+	//whether the other terrain type is a possible base terrain type for the (overlay) terrain type
+	bool is_base_terrain(const terrain_type *terrain, const terrain_type *other_terrain) const
+	{
+		return this->has_flag(terrain, other_terrain, terrain_compatibility_table::base_terrain_flag);
+	}
+
+	const terrain_type *get_intermediate_terrain(const terrain_type *terrain, const terrain_type *other_terrain) const
+	{
+		return this->intermediate_terrains[this->get_pair_index(terrain, other_terrain)];
+	}
+
+private:
+	size_t get_pair_index(const terrain_type *terrain, const terrain_type *other_terrain) const
+	{
+		return static_cast<size_t>(terrain->ID) * this->terrain_type_count + static_cast<size_t>(other_terrain->ID);
+	}
+
+	bool has_flag(const terrain_type *terrain, const terrain_type *other_terrain, const uint8_t flag) const
+	{
+		return (this->pair_flags[this->get_pair_index(terrain, other_terrain)] & flag) != 0;
+	}
+
+	size_t terrain_type_count = 0;
+	std::vector<uint8_t> pair_flags;
+	std::vector<const terrain_type *> intermediate_terrains;
+};
+
+}
@@ -45,14 +45,37 @@
 #include "script.h"
 #include "unit/unit.h"
 #include "unit/unit_manager.h"
+#include "util/assert_util.h"
 #include "util/util.h"
 #include "util/vector_util.h"
 
 namespace wyrmgus {
 
+static uint16_t get_terrain_index(const terrain_type *terrain)
+{
+	if (terrain == nullptr) {
+		return 0;
+	}
+
+	//terrain types are stored in tiles as 16-bit indexes
+	assert_throw(terrain->ID + 1 <= std::numeric_limits<uint16_t>::max());
+
+	return static_cast<uint16_t>(terrain->ID + 1);
+}
+
+const std::vector<terrain_type *> *const tile::terrain_types = &terrain_type::get_all();
+
 tile::tile() : Flags(tile_flag::none)
 {
-	this->player_info = std::make_unique<tile_player_info>();
+	//the data used by the per-tile checks must fit in the first 32 bytes; offsetof is conditionally-supported for tile, since it is not standard-layout, but is supported by the compilers used
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+#endif
+	static_assert(offsetof(tile, terrain_feature) <= 32);
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
 }
 
 const terrain_type *tile::get_top_terrain(const bool seen, const bool ignore_destroyed) const
@@ -152,16 +175,16 @@ void tile::SetTerrain(const terrain_type *terrain_type)
 				this->Flags &= ~(tile_flag::space_cliff); // need to do this manually, since tile_flag::space_cliff is added dynamically
 			}
 		}
-		this->overlay_terrain = terrain_type;
+		this->overlay_terrain_index = get_terrain_index(terrain_type);
 		this->OverlayTerrainDestroyed = false;
 		this->OverlayTerrainDamaged = false;
 	} else {
-		this->terrain = terrain_type;
+		this->terrain_index = get_terrain_index(terrain_type);
 		if (this->get_overlay_terrain() != nullptr && !vector::contains(this->get_overlay_terrain()->get_base_terrain_types(), terrain_type)) { //if the overlay terrain is incompatible with the new base terrain, remove the overlay
 			this->Flags &= ~(this->get_overlay_terrain()->Flags);
 			this->Flags &= ~(tile_flag::coast_allowed); // need to do this manually, since MapFieldCoast is added dynamically
 			this->Flags &= ~(tile_flag::space_cliff); // need to do this manually, since tile_flag::space_cliff is added dynamically
-			this->overlay_terrain = nullptr;
+			this->overlay_terrain_index = 0;
 			this->OverlayTransitionTiles.clear();
 		}
 	}
@@ -264,7 +287,7 @@ void tile::RemoveOverlayTerrain()
 
 	this->Flags &= ~(tile_flag::coast_allowed); // need to do this manually, since tile_flag::coast_allowed is added dynamically
 	this->Flags &= ~(tile_flag::space_cliff); // need to do this manually, since tile_flag::space_cliff is added dynamically
-	this->overlay_terrain = nullptr;
+	this->overlay_terrain_index = 0;
 	this->OverlayTerrainDestroyed = false;
 	this->OverlayTerrainDamaged = false;
 	this->OverlayTransitionTiles.clear();
@@ -559,12 +582,12 @@ void tile::parse(lua_State *l)
 	*/
 	const std::string terrain_ident = LuaToString(l, -1, 1);
 	if (!terrain_ident.empty()) {
-		this->terrain = terrain_type::get(terrain_ident);
+		this->terrain_index = get_terrain_index(terrain_type::get(terrain_ident));
 	}
 
 	const std::string overlay_terrain_ident = LuaToString(l, -1, 2);
 	if (!overlay_terrain_ident.empty()) {
-		this->overlay_terrain = terrain_type::get(overlay_terrain_ident);
+		this->overlay_terrain_index = get_terrain_index(terrain_type::get(overlay_terrain_ident));
 	}
 
 	const std::string terrain_feature_ident = LuaToString(l, -1, 3);
@@ -594,7 +617,7 @@ void tile::parse(lua_State *l)
 
 	const int landmass_index = LuaToNumber(l, -1, 14);
 	if (landmass_index != -1) {
-		this->landmass = CMap::get()->get_landmasses()[landmass_index].get();
+		this->set_landmass(CMap::get()->get_landmasses()[landmass_index].get());
 	}
 
 	const std::string settlement_identifier = LuaToString(l, -1, 15);
@@ -809,6 +832,11 @@ const player_color *tile::get_player_color() const
 	return CPlayer::get_neutral_player()->get_player_color();
 }
 
+void tile::set_landmass(const wyrmgus::landmass *landmass)
+{
+	this->landmass_index = landmass != nullptr ? static_cast<uint32_t>(landmass->get_index() + 1) : 0;
+}
+
 const world *tile::get_world() const
 {
 	if (this->get_landmass() != nullptr) {
@@ -254,6 +254,10 @@ class tile final
 public:
 	tile();
 
+	//tiles are only created in place as part of their map layer, and hold a pointer into its player information
+	tile(const tile &other) = delete;
+	tile &operator =(const tile &other) = delete;
+
 	void Save(CFile &file) const;
 	void parse(lua_State *l);
 
@@ -281,12 +285,20 @@ public:
 	
 	const terrain_type *get_terrain() const
 	{
-		return this->terrain;
+		if (this->terrain_index == 0) {
+			return nullptr;
+		}
+
+		return (*tile::terrain_types)[this->terrain_index - 1];
 	}
 
 	const terrain_type *get_overlay_terrain() const
 	{
-		return this->overlay_terrain;
+		if (this->overlay_terrain_index == 0) {
+			return nullptr;
+		}
+
+		return (*tile::terrain_types)[this->overlay_terrain_index - 1];
 	}
 
 	const terrain_type *get_top_terrain(const bool seen = false, const bool ignore_destroyed = false) const;
@@ -395,14 +407,15 @@ public:
 
 	wyrmgus::landmass *get_landmass() const
 	{
-		return this->landmass;
-	}
+		if (this->landmass_index == 0) {
+			return nullptr;
+		}
 
-	void set_landmass(wyrmgus::landmass *landmass)
-	{
-		this->landmass = landmass;
+		return (*tile::landmasses)[this->landmass_index - 1].get();
 	}
 
+	void set_landmass(const wyrmgus::landmass *landmass);
+
 	const world *get_world() const;
 
 	const site *get_settlement() const
@@ -424,33 +437,50 @@ public:
 	void bump_incompatible_units();
 	void remove_incompatible_units();
 
+	static void set_landmasses(const std::vector<std::unique_ptr<wyrmgus::landmass>> *landmasses)
+	{
+		tile::landmasses = landmasses;
+	}
+
+private:
+	//the vectors from which the terrain type and landmass indexes are resolved, kept here so that the accessors can be inline
+	static const std::vector<terrain_type *> *const terrain_types;
+	static inline const std::vector<std::unique_ptr<wyrmgus::landmass>> *landmasses = nullptr;
+
+	//the data used by the per-tile checks of pathfinding, unit placement and drawing comes first, packed into a record of at most 32 bytes, with terrain types and landmasses stored as indexes; the rarely-accessed data comes after it
 public:
 	tile_flag Flags;      /// field flags
-	//Wyrmgus start
-	unsigned char AnimationFrame = 0;		/// current frame of the tile's animation
-	unsigned char OverlayAnimationFrame = 0;		/// current frame of the overlay tile's animation
 private:
-	const terrain_type *terrain = nullptr;
-	const terrain_type *overlay_terrain = nullptr;
-	const wyrmgus::terrain_feature *terrain_feature = nullptr;
+	uint16_t terrain_index = 0; //the terrain type's ID plus one, or 0 if there is none
+	uint16_t overlay_terrain_index = 0;
 public:
+	//Wyrmgus start
 	short SolidTile = 0;
 	short OverlaySolidTile = 0;
-	bool OverlayTerrainDestroyed = false;
-	bool OverlayTerrainDamaged = false;
-	std::vector<tile_transition> TransitionTiles; //transition tiles; the pair contains the terrain type and the tile index
-	std::vector<tile_transition> OverlayTransitionTiles; //overlay transition tiles; the pair contains the terrain type and the tile index
 	//Wyrmgus end
 private:
-	unsigned char movement_cost = 0; //unit cost to move in this tile
 	short value = 0; //HP for walls/resource quantity/forest regeneration/destroyed wall and rock decay
-	wyrmgus::landmass *landmass = nullptr; //to which "landmass" (can also be water) does this map field belong (if any); a "landmass" is a collection of adjacent land tiles, or a collection of adjacent water tiles
 	short ownership_border_tile = -1; //the transition type of the border between this tile's owner, and other players' tiles, if applicable)
+	uint32_t landmass_index = 0; //the index plus one of the "landmass" (can also be water) to which this map field belongs, or 0 if none; a "landmass" is a collection of adjacent land tiles, or a collection of adjacent water tiles
+	unsigned char movement_cost = 0; //unit cost to move in this tile
+public:
+	//Wyrmgus start
+	unsigned char AnimationFrame = 0;		/// current frame of the tile's animation
+	unsigned char OverlayAnimationFrame = 0;		/// current frame of the overlay tile's animation
+	bool OverlayTerrainDestroyed = false;
+	bool OverlayTerrainDamaged = false;
+	//Wyrmgus end
+private:
+	const wyrmgus::terrain_feature *terrain_feature = nullptr;
 	const site *settlement = nullptr;
 public:
+	//Wyrmgus start
+	std::vector<tile_transition> TransitionTiles; //transition tiles; the pair contains the terrain type and the tile index
+	std::vector<tile_transition> OverlayTransitionTiles; //overlay transition tiles; the pair contains the terrain type and the tile index
+	//Wyrmgus end
 	CUnitCache UnitCache;      /// a unit on the map field.
 
-	std::unique_ptr<tile_player_info> player_info;	/// stuff related to player
+	tile_player_info *player_info = nullptr;	/// stuff related to player, stored in a block for the whole map layer
 };
 
 }
@@ -34,18 +34,14 @@
 #include "player/player_color.h"
 #include "time/season.h"
 #include "util/container_util.h"
-#include "util/log_util.h"
 #include "util/string_util.h"
 #include "video/video.h"
 
 namespace wyrmgus {
 
-QImage tile_image_provider::requestImage(const QString &id, QSize *size, const QSize &requested_size)
+QImage tile_image_provider::create_image(const std::string &id) const
 {
-	Q_UNUSED(requested_size)
-
-	const std::string id_str = id.toStdString();
-	const std::vector<std::string> id_list = string::split(id_str, '/');
+	const std::vector<std::string> id_list = string::split(id, '/');
 
 	size_t index = 0;
 	const std::string &terrain_identifier = id_list.at(index);
@@ -92,14 +88,10 @@ QImage tile_image_provider::requestImage(const QString &id, QSize *size, const Q
 
 	const color_set ignored_colors = container::to_set<std::vector<QColor>, color_set>(graphics->get_conversible_player_color()->get_colors());
 
-	const QImage &image = graphics->get_or_create_frame_image(frame_index, color_modification(terrain->get_hue_rotation(), terrain->get_colorization(), ignored_colors, player_color), false);
+	QImage image = graphics->create_modified_frame_image(frame_index, color_modification(terrain->get_hue_rotation(), terrain->get_colorization(), ignored_colors, player_color), false);
 
 	if (image.isNull()) {
-		log::log_error("Tile image for ID \"" + id_str + "\" is null.");
-	}
-
-	if (size != nullptr) {
-		*size = image.size();
+		throw std::runtime_error("Tile image for ID \"" + id + "\" is null.");
 	}
 
 	return image;
@@ -26,20 +26,19 @@
 
 #pragma once
 
-#pragma warning(push, 0)
-#include <QQuickImageProvider>
-#pragma warning(pop)
+#include "ui/async_image_provider.h"
 
 namespace wyrmgus {
 
-class tile_image_provider final : public QQuickImageProvider
+class tile_image_provider final : public async_image_provider
 {
 public:
-	tile_image_provider() : QQuickImageProvider(QQuickImageProvider::Image)
+	tile_image_provider() : async_image_provider("tile")
 	{
 	}
 
-	virtual QImage requestImage(const QString &id, QSize *size, const QSize &requested_size) override;
+protected:
+	virtual QImage create_image(const std::string &id) const override;
 };
 
 }
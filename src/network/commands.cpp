@@ -766,6 +766,16 @@ void SendCommandAutosellResource(int player, int resource)
 	}
 }
 
+/**
+** Send command: Change the network lag.
+**
+** @param lag  New network lag, in game cycles.
+*/
+void SendCommandNetworkLag(const unsigned int lag)
+{
+	NetworkSendExtendedCommand(ExtendedMessageNetworkLag, -1, lag, 0, 0, 0);
+}
+
 //----------------------------------------------------------------------------
 // Parse the message, from the network.
 //----------------------------------------------------------------------------
@@ -1059,6 +1069,35 @@ void ExecCommand(unsigned char msgnr, UnitRef unum,
 	}
 }
 
+/**
+** Execute a command given to a group of units (from network).
+**
+** The command is executed for each unit in turn, in the same cycle, and is
+** logged as a single replay entry.
+**
+** @param msgnr    Network message type of the units' command
+** @param units    Unit numbers (slots) that receive the command.
+** @param x        optional X map position.
+** @param y        optional y map position.
+** @param dstnr    optional destination unit.
+*/
+void ExecGroupCommand(unsigned char msgnr, const std::vector<UnitRef> &units,
+					  unsigned short x, unsigned short y, UnitRef dstnr)
+{
+	std::string value = std::to_string(dstnr);
+	for (const UnitRef unum : units) {
+		value += " " + std::to_string(unum);
+	}
+	CommandLog("group", NoUnitP, (msgnr & 0x80) >> 7, x, y, NoUnitP, value.c_str(), msgnr);
+
+	const bool old_command_log_disabled = CommandLogDisabled;
+	CommandLogDisabled = true;
+	for (const UnitRef unum : units) {
+		ExecCommand(msgnr, unum, x, y, dstnr);
+	}
+	CommandLogDisabled = old_command_log_disabled;
+}
+
 static const char *GetDiplomacyName(const wyrmgus::diplomacy_state e)
 {
 	static constexpr std::array<const char *, 4> diplomacy_names = { "allied", "neutral", "enemy", "crazy" };
@@ -1118,6 +1157,9 @@ void ExecExtendedCommand(unsigned char type, int status,
 			CPlayer::Players[arg2]->AutosellResource(arg3);
 			break;
 		}
+		case ExtendedMessageNetworkLag:
+			SetNetworkLag(arg2);
+			break;
 		default:
 			DebugPrint("Unknown extended message %u/%s %u %u %u %u\n" _C_
 					   type _C_ status ? "flush" : "-" _C_
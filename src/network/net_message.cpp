@@ -442,6 +442,118 @@ size_t CNetworkCommand::Deserialize(const unsigned char *buf)
 	return p - buf;
 }
 
+// CNetworkGroupCommand
+
+/**
+**  Serialize an unsigned integer with a variable length, using 7 bits per byte.
+*/
+static size_t serialize_varint(unsigned char *buf, uint32_t data)
+{
+	size_t size = 0;
+	do {
+		uint8_t byte = data & 0x7F;
+		data >>= 7;
+		if (data != 0) {
+			byte |= 0x80;
+		}
+		size += serialize8(buf ? buf + size : nullptr, byte);
+	} while (data != 0);
+	return size;
+}
+
+/**
+**  Deserialize an unsigned integer with a variable length.
+**
+**  @return the amount of bytes read, or 0 if the integer does not end within the given length.
+*/
+static size_t deserialize_varint(const unsigned char *buf, const size_t len, uint32_t *data)
+{
+	size_t size = 0;
+	*data = 0;
+	for (int shift = 0; shift < 32; shift += 7) {
+		if (size >= len) {
+			return 0;
+		}
+
+		uint8_t byte;
+		size += deserialize8(buf + size, &byte);
+		*data |= static_cast<uint32_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			return size;
+		}
+	}
+	return 0;
+}
+
+size_t CNetworkGroupCommand::Serialize(unsigned char *buf) const
+{
+	unsigned char *p = buf;
+	p += serialize8(p, this->Type);
+	p += serialize16(p, this->X);
+	p += serialize16(p, this->Y);
+	p += serialize16(p, this->Dest);
+	p += serialize16(p, uint16_t(this->Units.size()));
+
+	//units are usually selected in creation order, so the difference to the previous unit number is small; it is zigzag encoded, as it can be negative
+	int32_t previous_unit = 0;
+	for (const uint16_t unit : this->Units) {
+		const int32_t delta = static_cast<int32_t>(unit) - previous_unit;
+		p += serialize_varint(p, static_cast<uint32_t>((delta << 1) ^ (delta >> 31)));
+		previous_unit = unit;
+	}
+	return p - buf;
+}
+
+size_t CNetworkGroupCommand::Deserialize(const unsigned char *buf, const size_t len)
+{
+	if (len < CNetworkGroupCommand::HeaderSize) {
+		return 0;
+	}
+
+	const unsigned char *p = buf;
+	p += deserialize8(p, &this->Type);
+	p += deserialize16(p, &this->X);
+	p += deserialize16(p, &this->Y);
+	p += deserialize16(p, &this->Dest);
+
+	uint16_t size;
+	p += deserialize16(p, &size);
+
+	//each unit takes at least one byte
+	if (size > len - static_cast<size_t>(p - buf)) {
+		return 0;
+	}
+
+	this->Units.resize(size);
+
+	int32_t previous_unit = 0;
+	for (uint16_t &unit : this->Units) {
+		uint32_t encoded_delta;
+		const size_t varint_size = deserialize_varint(p, len - static_cast<size_t>(p - buf), &encoded_delta);
+		if (varint_size == 0) {
+			return 0;
+		}
+		p += varint_size;
+		const int32_t delta = static_cast<int32_t>(encoded_delta >> 1) ^ -static_cast<int32_t>(encoded_delta & 1);
+		unit = static_cast<uint16_t>(previous_unit + delta);
+		previous_unit = unit;
+	}
+	return p - buf;
+}
+
+size_t CNetworkGroupCommand::Size() const
+{
+	size_t size = CNetworkGroupCommand::HeaderSize;
+
+	int32_t previous_unit = 0;
+	for (const uint16_t unit : this->Units) {
+		const int32_t delta = static_cast<int32_t>(unit) - previous_unit;
+		size += serialize_varint(nullptr, static_cast<uint32_t>((delta << 1) ^ (delta >> 31)));
+		previous_unit = unit;
+	}
+	return size;
+}
+
 // CNetworkExtendedCommand
 
 size_t CNetworkExtendedCommand::Serialize(unsigned char *buf) const
@@ -496,6 +608,7 @@ size_t CNetworkCommandSync::Serialize(unsigned char *buf) const
 	unsigned char *p = buf;
 	p += serialize32(p, this->syncSeed);
 	p += serialize32(p, this->syncHash);
+	p += serialize16(p, this->delay);
 	return p - buf;
 }
 
@@ -504,6 +617,7 @@ size_t CNetworkCommandSync::Deserialize(const unsigned char *buf)
 	const unsigned char *p = buf;
 	p += deserialize32(p, &this->syncSeed);
 	p += deserialize32(p, &this->syncHash);
+	p += deserialize16(p, &this->delay);
 	return p - buf;
 }
 
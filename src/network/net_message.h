@@ -32,6 +32,7 @@
 #include "network/multiplayer_setup.h"
 
 constexpr int MaxNetworkCommands = 9;  /// Max Commands In A Packet
+constexpr size_t MaxNetworkPacketSize = 1024;  /// Max size in bytes of a packet, as read by the receiving socket
 
 /**
 **  Network init config message subtypes (menu state machine).
@@ -286,6 +287,7 @@ enum _message_type_ {
 	MessageCommandSellResource,	   /// Unit command sell resource
 	MessageCommandBuyResource,	   /// Unit command buy resource
 	//Wyrmgus end
+	MessageCommandGroup,           /// Unit command shared by a group of units
 
 	MessageExtendedCommand,        /// Command is the next byte
 
@@ -301,7 +303,8 @@ enum _extended_message_type_ {
 	ExtendedMessageSharedVision,  /// Change shared vision
 	ExtendedMessageSetFaction,	  /// Change faction
 	ExtendedMessageSetDynasty,	  /// Change dynasty
-	ExtendedMessageAutosellResource	  /// Autosell resource
+	ExtendedMessageAutosellResource,	  /// Autosell resource
+	ExtendedMessageNetworkLag	  /// Change the network lag
 };
 
 /**
@@ -324,6 +327,37 @@ public:
 	uint16_t Dest;         /// Destination unit
 };
 
+/**
+**  Network group command message.
+**
+**  A unit command given to several units at once, which is sent as a
+**  single message and executed for all of the units in the same cycle.
+**  The unit numbers are delta encoded as variable-length integers.
+*/
+class CNetworkGroupCommand
+{
+public:
+	static constexpr size_t MaxSize = 512;  /// Max serialized size, so that a group fits in a packet with other commands
+	static constexpr size_t HeaderSize = 1 + 2 + 2 + 2 + 2;  /// Serialized size of the fields before the unit numbers
+
+	size_t Serialize(unsigned char *buf) const;
+	/// Deserialize from a buffer of the given length, returning 0 if the message is truncated
+	size_t Deserialize(const unsigned char *buf, const size_t len);
+	size_t Size() const;
+
+	bool HasUnit(const uint16_t unit) const
+	{
+		return std::find(this->Units.begin(), this->Units.end(), unit) != this->Units.end();
+	}
+
+public:
+	uint8_t Type = 0;              /// Command type, including the flush flag
+	uint16_t X = 0;                /// Map position X
+	uint16_t Y = 0;                /// Map position Y
+	uint16_t Dest = 0;             /// Destination unit
+	std::vector<uint16_t> Units;   /// Units receiving the command, in the order they were given it
+};
+
 /**
 **  Extended network command message.
 */
@@ -363,14 +397,15 @@ public:
 class CNetworkCommandSync
 {
 public:
-	CNetworkCommandSync() : syncSeed(0), syncHash(0) {}
+	CNetworkCommandSync() : syncSeed(0), syncHash(0), delay(0) {}
 	size_t Serialize(unsigned char *buf) const;
 	size_t Deserialize(const unsigned char *buf);
-	static size_t Size() { return 4 + 4; };
+	static size_t Size() { return 4 + 4 + 2; };
 
 public:
 	uint32_t syncSeed;
 	uint32_t syncHash;
+	int16_t delay; /// Sender's delay of the server's packets, in milliseconds
 };
 
 /**
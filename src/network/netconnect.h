@@ -39,8 +39,8 @@ class CUDPSocket;
 constexpr int NetworkProtocolMajorVersion = StratagusMajorVersion;
 /// Network protocol minor version (maximum 99)
 constexpr int NetworkProtocolMinorVersion = StratagusMinorVersion;
-/// Network protocol patch level (maximum 99)
-constexpr int NetworkProtocolPatchLevel = StratagusPatchLevel;
+/// Network protocol patch level (maximum 99); this is one ahead of the engine's patch level, as the message types changed after its release (group commands and network lag changes), so that older clients of the same engine version are refused
+constexpr int NetworkProtocolPatchLevel = StratagusPatchLevel + 1;
 /// Network protocol version (1,2,3) -> 10203
 constexpr int NetworkProtocolVersion = (NetworkProtocolMajorVersion * 10000 + NetworkProtocolMinorVersion * 100 + \
 	NetworkProtocolPatchLevel);
@@ -85,7 +85,7 @@ bool CHost::isValid() const
 
 // CUDPSocket_Impl
 
-class CUDPSocket_Impl final
+class CUDPSocket_Impl final : public CUDPTransport
 {
 public:
 	~CUDPSocket_Impl()
@@ -96,20 +96,20 @@ public:
 	}
 
 	[[nodiscard]]
-	bool Open(const CHost &host)
+	virtual bool Open(const CHost &host) override
 	{
 		this->endpoint = boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4(ntohl(host.getIp())), ntohs(host.getPort()));
 		this->socket = std::make_unique<boost::asio::ip::udp::socket>(event_loop::get()->get_io_context(), this->endpoint);
 		return this->socket->is_open();
 	}
 
-	void Close()
+	virtual void Close() override
 	{
 		this->socket->close();
 	}
 
 	[[nodiscard]]
-	boost::asio::awaitable<void> Send(const CHost &host, const void *buf, unsigned int len)
+	virtual boost::asio::awaitable<void> Send(const CHost &host, const void *buf, unsigned int len) override
 	{
 		boost::asio::ip::udp::endpoint receiver_endpoint(boost::asio::ip::address_v4(ntohl(host.getIp())), ntohs(host.getPort()));
 
@@ -121,7 +121,7 @@ public:
 	}
 
 	[[nodiscard]]
-	boost::asio::awaitable<size_t> Recv(std::array<unsigned char, 1024> &buf, int len, CHost *hostFrom)
+	virtual boost::asio::awaitable<size_t> Recv(std::array<unsigned char, 1024> &buf, int len, CHost *hostFrom) override
 	{
 		try {
 			boost::asio::ip::udp::endpoint sender_endpoint;
@@ -136,19 +136,19 @@ public:
 		}
 	}
 
-	void SetNonBlocking()
+	virtual void SetNonBlocking() override
 	{
 		this->socket->non_blocking(true);
 	}
 
 	[[nodiscard]]
-	size_t HasDataToRead()
+	virtual size_t HasDataToRead() override
 	{
 		return this->socket->available();
 	}
 
 	[[nodiscard]]
-	boost::asio::awaitable<size_t> WaitForDataToRead(const int timeout)
+	virtual boost::asio::awaitable<size_t> WaitForDataToRead(const int timeout) override
 	{
 		try {
 			boost::asio::steady_timer timer(event_loop::get()->get_io_context());
@@ -179,7 +179,7 @@ public:
 	}
 
 	[[nodiscard]]
-	bool IsValid() const
+	virtual bool IsValid() const override
 	{
 		return this->socket != nullptr && this->socket->is_open();
 	}
@@ -196,10 +196,22 @@ CUDPSocket::CUDPSocket()
 	m_impl = std::make_unique<CUDPSocket_Impl>();
 }
 
+CUDPSocket::CUDPSocket(std::unique_ptr<CUDPTransport> &&transport) : m_impl(std::move(transport))
+{
+}
+
 CUDPSocket::~CUDPSocket()
 {
 }
 
+void CUDPSocket::SetTransport(std::unique_ptr<CUDPTransport> &&transport)
+{
+	if (m_impl->IsValid()) {
+		m_impl->Close();
+	}
+	m_impl = std::move(transport);
+}
+
 bool CUDPSocket::Open(const CHost &host)
 {
 	return m_impl->Open(host);
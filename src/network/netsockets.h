@@ -82,15 +82,53 @@ private:
 	uint16_t port = 0; //in network byte order
 };
 
-class CUDPSocket_Impl;
 class CTCPSocket_Impl;
 
+/**
+**  Transport through which a UDP socket sends and receives datagrams.
+**
+**  By default this is the operating system's network stack, but it can be
+**  replaced, e.g. by the in-memory transport of the network simulator.
+*/
+class CUDPTransport
+{
+public:
+	virtual ~CUDPTransport()
+	{
+	}
+
+	[[nodiscard]]
+	virtual bool Open(const CHost &host) = 0;
+
+	virtual void Close() = 0;
+
+	[[nodiscard]]
+	virtual boost::asio::awaitable<void> Send(const CHost &host, const void *buf, unsigned int len) = 0;
+
+	[[nodiscard]]
+	virtual boost::asio::awaitable<size_t> Recv(std::array<unsigned char, 1024> &buf, int len, CHost *hostFrom) = 0;
+
+	virtual void SetNonBlocking() = 0;
+
+	[[nodiscard]]
+	virtual size_t HasDataToRead() = 0;
+
+	[[nodiscard]]
+	virtual boost::asio::awaitable<size_t> WaitForDataToRead(const int timeout) = 0;
+
+	virtual bool IsValid() const = 0;
+};
+
 class CUDPSocket final
 {
 public:
 	CUDPSocket();
+	explicit CUDPSocket(std::unique_ptr<CUDPTransport> &&transport);
 	~CUDPSocket();
 
+	/// Replace the transport, closing the previous one
+	void SetTransport(std::unique_ptr<CUDPTransport> &&transport);
+
 	[[nodiscard]]
 	bool Open(const CHost &host);
 
@@ -113,7 +151,7 @@ public:
 	bool IsValid() const;
 
 private:
-	std::unique_ptr<CUDPSocket_Impl> m_impl;
+	std::unique_ptr<CUDPTransport> m_impl;
 };
 
 // Class representing TCP socket used in communication
@@ -148,8 +148,8 @@
 **
 ** @li Add a server/client protocol, which allows more players per game.
 **
-** @li Lag (latency) and bandwidth should be automatic detected during game setup
-** and later during game automatic adapted.
+** @li Lag (latency) and bandwidth should be automatic detected during game setup.
+** During the game, the server adapts the lag to the measured round-trip times.
 **
 ** @li Also it would be nice, if we support viewing clients. This means
 ** other people can view the game in progress.
@@ -215,7 +215,9 @@
 #include "map/map.h"
 #include "network/net_message.h"
 #include "network/netconnect.h"
+#include "network/network_lag_controller.h"
 #include "network/network_manager.h"
+#include "network/network_statistics.h"
 #include "parameters.h"
 #include "player/player.h"
 #include "player/player_type.h"
@@ -290,24 +292,27 @@ static std::array<CNetworkCommandQueue, MaxNetworkCommands> NetworkIn[256][Playe
 static std::deque<CNetworkCommandQueue> CommandsIn;    /// Network command input queue
 static std::deque<CNetworkCommandQueue> MsgCommandsIn; /// Network message input queue
 
+static unsigned long NetworkLastSentCycle = 0; /// Last cycle for which our commands have been sent
+static std::array<std::pair<unsigned long, std::chrono::steady_clock::time_point>, 256> NetworkSendTimes; /// Cycle and time at which our commands for a cycle were sent
+static std::array<std::array<std::pair<unsigned long, std::chrono::steady_clock::time_point>, PlayerMax>, 256> NetworkReceiveTimes; /// Cycle and time at which a peer's commands for a cycle arrived before ours were sent
+static std::optional<wyrmgus::network_lag_controller> NetworkLagController; /// Adapts the network lag, on the server
+static bool NetworkLagChangePending = false; /// Whether a lag change has been sent, but not yet executed
 
-#ifdef DEBUG
-class CNetworkStat
-{
-public:
-	void print() const
-	{
-		DebugPrint("resent: %d packets\n" _C_ resentPacketCount);
-	}
-
-public:
-	unsigned int resentPacketCount = 0;
-};
+static int PlayerQuit[PlayerMax];          /// Player quit
 
-static CNetworkStat NetworkStat;
-#endif
+static void SetNetworkInSync(const bool in_sync)
+{
+	NetworkInSync = in_sync;
+	wyrmgus::network_statistics::get()->set_in_sync(in_sync);
+}
 
-static int PlayerQuit[PlayerMax];          /// Player quit
+/**
+**  Get the duration of a game cycle at the current game speed, in milliseconds.
+*/
+static double GetNetworkCycleDuration()
+{
+	return 1000. * 100. / (CYCLES_PER_SECOND * VideoSyncSpeed);
+}
 
 //----------------------------------------------------------------------------
 //  Mid-Level api functions
@@ -420,13 +425,13 @@ void ExitNetwork1()
 		return;
 	}
 
-#ifdef DEBUG
-	NetworkStat.print();
-#endif
+	if (GameCycle > 0) {
+		wyrmgus::network_statistics::get()->print();
+	}
 
 	network_manager::get()->get_file_descriptor()->Close();
 
-	NetworkInSync = true;
+	SetNetworkInSync(true);
 	NetPlayers = 0;
 	HostsCount = 0;
 
@@ -446,7 +451,7 @@ void NetworkOnStartGame()
 			   CNetworkParameter::Instance.gameCyclesPerUpdate _C_
 			   CNetworkParameter::Instance.NetworkLag _C_ HostsCount);
 
-	NetworkInSync = true;
+	SetNetworkInSync(true);
 	CommandsIn.clear();
 	MsgCommandsIn.clear();
 	// Prepare first time without syncs.
@@ -479,12 +484,86 @@ void NetworkOnStartGame()
 	memset(PlayerQuit, 0, sizeof(PlayerQuit));
 	memset(NetworkLastFrame, 0, sizeof(NetworkLastFrame));
 	memset(NetworkLastCycle, 0, sizeof(NetworkLastCycle));
+
+	NetworkLastSentCycle = CNetworkParameter::Instance.NetworkLag / CNetworkParameter::Instance.gameCyclesPerUpdate * CNetworkParameter::Instance.gameCyclesPerUpdate;
+	NetworkSendTimes.fill({});
+	NetworkReceiveTimes.fill({});
+	wyrmgus::network_statistics::get()->clear();
+
+	NetworkLagChangePending = false;
+	if (NetConnectType == 1 && CNetworkParameter::Instance.AdaptiveLag) {
+		NetworkLagController.emplace(CNetworkParameter::Instance.gameCyclesPerUpdate, 2 * CNetworkParameter::Instance.gameCyclesPerUpdate);
+	} else {
+		NetworkLagController.reset();
+	}
 }
 
 //----------------------------------------------------------------------------
 //  Commands input
 //----------------------------------------------------------------------------
 
+/**
+**  Check whether a command can be given to a group of units at once.
+**
+**  @param type  Command type, including the flush flag.
+*/
+static bool IsGroupableCommand(unsigned char type)
+{
+	type &= 0x7F;
+	return (type >= MessageCommandStop && type < MessageCommandGroup) || type >= MessageCommandSpellCast;
+}
+
+/**
+**  Merge a unit command into the last queued command, if both give the
+**  same order in the same cycle, turning the latter into a group command.
+**
+**  @param ncq   Last queued command.
+**  @param type  Type of the command to merge.
+**  @param nc    Command to merge.
+**
+**  @return true if the command has been merged.
+*/
+static bool MergeGroupCommand(CNetworkCommandQueue &ncq, const unsigned char type, const CNetworkCommand &nc)
+{
+	if (ncq.Time != GameCycle || !IsGroupableCommand(type)) {
+		return false;
+	}
+
+	CNetworkGroupCommand ngc;
+	if (ncq.Type == type) {
+		CNetworkCommand last_nc;
+		last_nc.Deserialize(&ncq.Data[0]);
+		if (last_nc.X != nc.X || last_nc.Y != nc.Y || last_nc.Dest != nc.Dest) {
+			return false;
+		}
+		ngc.Type = type;
+		ngc.X = nc.X;
+		ngc.Y = nc.Y;
+		ngc.Dest = nc.Dest;
+		ngc.Units.push_back(last_nc.Unit);
+	} else if (ncq.Type == MessageCommandGroup) {
+		assert_throw(ngc.Deserialize(ncq.Data.data(), ncq.Data.size()) == ncq.Data.size());
+		if (ngc.Type != type || ngc.X != nc.X || ngc.Y != nc.Y || ngc.Dest != nc.Dest) {
+			return false;
+		}
+		if (ngc.HasUnit(nc.Unit)) {
+			return true;
+		}
+	} else {
+		return false;
+	}
+
+	ngc.Units.push_back(nc.Unit);
+	if (ngc.Size() > CNetworkGroupCommand::MaxSize) {
+		return false;
+	}
+
+	ncq.Type = MessageCommandGroup;
+	ncq.Data.resize(ngc.Size());
+	ngc.Serialize(&ncq.Data[0]);
+	return true;
+}
+
 /**
 **  Prepare send of command message.
 **
@@ -528,6 +607,10 @@ void NetworkSendCommand(int command, const CUnit &unit, int x, int y,
 	if (std::find(CommandsIn.begin(), CommandsIn.end(), ncq) != CommandsIn.end()) {
 		return;
 	}
+	// Orders given to a whole selection are sent as a single group message
+	if (!CommandsIn.empty() && MergeGroupCommand(CommandsIn.back(), ncq.Type, nc)) {
+		return;
+	}
 	CommandsIn.push_back(ncq);
 }
 
@@ -632,6 +715,7 @@ static void NetworkRemovePlayer(int player)
 			break;
 		}
 	}
+	wyrmgus::network_statistics::get()->reset_peer(player);
 	for (int i = 0; i < 256; ++i) {
 		for (int c = 0; c < MaxNetworkCommands; ++c) {
 			NetworkIn[i][player][c].Time = 0;
@@ -663,8 +747,10 @@ static bool IsNetworkCommandReady(unsigned long gameNetCycle)
 }
 
 [[nodiscard]]
-static boost::asio::awaitable<void> ParseResendCommand(const CNetworkPacket &packet)
+static boost::asio::awaitable<void> ParseResendCommand(const CNetworkPacket &packet, const int player)
 {
+	wyrmgus::network_statistics::get()->record_resend_request(player);
+
 	// Destination cycle (time to execute).
 	unsigned long n = ((GameCycle + 128) & ~0xFF) | packet.Header.Cycle;
 	if (n > GameCycle + 128) {
@@ -700,11 +786,8 @@ static boost::asio::awaitable<void> ParseResendCommand(const CNetworkPacket &pac
 	}
 }
 
-static bool IsAValidCommand_Command(const CNetworkPacket &packet, int index, const int player)
+static bool IsAValidCommandUnit(const unsigned int slot, const int player)
 {
-	CNetworkCommand nc;
-	nc.Deserialize(&packet.Command[index][0]);
-	const unsigned int slot = nc.Unit;
 	const CUnit *unit = slot < wyrmgus::unit_manager::get()->GetUsedSlotCount() ? &wyrmgus::unit_manager::get()->GetSlotUnit(slot) : nullptr;
 
 	if (unit && (unit->Player->get_index() == player
@@ -715,23 +798,84 @@ static bool IsAValidCommand_Command(const CNetworkPacket &packet, int index, con
 	}
 }
 
-static bool IsAValidCommand_Dismiss(const CNetworkPacket &packet, int index, const int player)
+static bool IsAValidDismissUnit(const unsigned int slot, const int player)
 {
-	CNetworkCommand nc;
-	nc.Deserialize(&packet.Command[index][0]);
-	const unsigned int slot = nc.Unit;
 	const CUnit *unit = slot < wyrmgus::unit_manager::get()->GetUsedSlotCount() ? &wyrmgus::unit_manager::get()->GetSlotUnit(slot) : nullptr;
 
 	if (unit && unit->Type->ClicksToExplode) {
 		return true;
 	}
-	return IsAValidCommand_Command(packet, index, player);
+	return IsAValidCommandUnit(slot, player);
+}
+
+static bool IsAValidCommand_Command(const CNetworkPacket &packet, int index, const int player)
+{
+	CNetworkCommand nc;
+	nc.Deserialize(&packet.Command[index][0]);
+	return IsAValidCommandUnit(nc.Unit, player);
+}
+
+static bool IsAValidCommand_Dismiss(const CNetworkPacket &packet, int index, const int player)
+{
+	CNetworkCommand nc;
+	nc.Deserialize(&packet.Command[index][0]);
+	return IsAValidDismissUnit(nc.Unit, player);
+}
+
+static bool IsAValidCommand_GroupCommand(const CNetworkPacket &packet, int index, const int player)
+{
+	CNetworkGroupCommand ngc;
+
+	// Truncated messages, or ones with trailing data, are rejected
+	if (ngc.Deserialize(packet.Command[index].data(), packet.Command[index].size()) != packet.Command[index].size()) {
+		return false;
+	}
+
+	if (!IsGroupableCommand(ngc.Type) || ngc.Units.empty()) {
+		return false;
+	}
+
+	// The whole group is rejected if any of its units may not be commanded
+	for (const uint16_t unit : ngc.Units) {
+		const bool valid = (ngc.Type & 0x7F) == MessageCommandDismiss ? IsAValidDismissUnit(unit, player) : IsAValidCommandUnit(unit, player);
+		if (!valid) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+**  Get the player of the server, which decides the network lag.
+*/
+static int GetNetworkServerPlayer()
+{
+	if (NetConnectType == 1) {
+		return CPlayer::GetThisPlayer()->get_index();
+	}
+	return Hosts[HostsCount - 1].PlyNr;
+}
+
+static bool IsAValidCommand_ExtendedCommand(const CNetworkPacket &packet, int index, const int player)
+{
+	if (packet.Command[index].size() < CNetworkExtendedCommand::Size()) {
+		return false;
+	}
+
+	CNetworkExtendedCommand nec;
+	nec.Deserialize(&packet.Command[index][0]);
+
+	// Only the server may change the network lag
+	if (nec.ExtendedType == ExtendedMessageNetworkLag) {
+		return player == GetNetworkServerPlayer();
+	}
+	return true; // FIXME: ensure the sender is part of the command
 }
 
 static bool IsAValidCommand(const CNetworkPacket &packet, int index, const int player)
 {
 	switch (packet.Header.Type[index] & 0x7F) {
-		case MessageExtendedCommand: // FIXME: ensure the sender is part of the command
+		case MessageExtendedCommand: return IsAValidCommand_ExtendedCommand(packet, index, player);
 		case MessageSync: // Sync does not matter
 		case MessageSelection: // FIXME: ensure it's from the right player
 		case MessageQuit:      // FIXME: ensure it's from the right player
@@ -739,11 +883,97 @@ static bool IsAValidCommand(const CNetworkPacket &packet, int index, const int p
 		case MessageChat:      // FIXME: ensure it's from the right player
 			return true;
 		case MessageCommandDismiss: return IsAValidCommand_Dismiss(packet, index, player);
+		case MessageCommandGroup: return IsAValidCommand_GroupCommand(packet, index, player);
 		default: return IsAValidCommand_Command(packet, index, player);
 	}
 	// FIXME: not all values in nc have been validated
 }
 
+/**
+**  Measure the delay from sending our packet for a cycle, to a peer's packet
+**  for the same cycle arriving.
+**
+**  @param player  Player who sent the packet.
+**  @param cycle   Destination cycle of the packet.
+*/
+static void RecordNetworkPacketDelay(const int player, const uint8_t cycle)
+{
+	if (player >= PlayerMax || player == CPlayer::GetThisPlayer()->get_index()) {
+		return;
+	}
+
+	// Only the first packet for a cycle is measured, as packets resent on request arrive late
+	const uint8_t cycle_difference = cycle - static_cast<uint8_t>(NetworkLastCycle[player]);
+	if (NetworkLastFrame[player] != 0 && (cycle_difference == 0 || cycle_difference >= 128)) {
+		return;
+	}
+
+	unsigned long n = ((GameCycle + 128) & ~0xFF) | cycle;
+	if (n > GameCycle + 128) {
+		n -= 0x100;
+	}
+
+	const auto &[send_cycle, send_time] = NetworkSendTimes[n & 0xFF];
+	if (send_cycle != n) {
+		// The packet arrived before we sent ours for the cycle, so the delay is negative and measured when we send it
+		NetworkReceiveTimes[n & 0xFF][player] = std::make_pair(n, std::chrono::steady_clock::now());
+		return;
+	}
+
+	const double delay = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - send_time).count();
+	wyrmgus::network_statistics::get()->record_packet_delay(player, delay);
+}
+
+/**
+**  Measure the delay of the peers' packets for a cycle which arrived before
+**  ours was sent.
+**
+**  @param gameNetCycle  Cycle for which our packet has just been sent.
+*/
+static void RecordEarlyNetworkPacketDelays(const unsigned long gameNetCycle)
+{
+	const std::chrono::steady_clock::time_point send_time = NetworkSendTimes[gameNetCycle & 0xFF].second;
+
+	for (int player = 0; player < PlayerMax; ++player) {
+		auto &[receive_cycle, receive_time] = NetworkReceiveTimes[gameNetCycle & 0xFF][player];
+		if (receive_cycle != gameNetCycle) {
+			continue;
+		}
+
+		const double delay = std::chrono::duration<double, std::milli>(receive_time - send_time).count();
+		wyrmgus::network_statistics::get()->record_packet_delay(player, delay);
+		receive_cycle = 0;
+	}
+}
+
+/**
+**  Get our delay of the server's packets, to be echoed to the server in sync
+**  messages, so that it can combine it with its delay of ours.
+*/
+static int16_t GetEchoedNetworkPacketDelay()
+{
+	if (NetConnectType == 1 || HostsCount == 0) {
+		return 0;
+	}
+
+	const double delay = wyrmgus::network_statistics::get()->get_peer(GetNetworkServerPlayer()).delay;
+	return static_cast<int16_t>(std::clamp(std::lround(delay), static_cast<long>(std::numeric_limits<int16_t>::min()), static_cast<long>(std::numeric_limits<int16_t>::max())));
+}
+
+/**
+**  Record the delay of our packets which a client echoed in a sync message.
+*/
+static void RecordEchoedNetworkPacketDelay(const CNetworkPacket &packet, int index, const int player)
+{
+	if (NetConnectType != 1 || packet.Command[index].size() < CNetworkCommandSync::Size()) {
+		return;
+	}
+
+	CNetworkCommandSync nc;
+	nc.Deserialize(&packet.Command[index][0]);
+	wyrmgus::network_statistics::get()->record_echoed_delay(player, nc.delay);
+}
+
 [[nodiscard]]
 static boost::asio::awaitable<void> NetworkParseInGameEvent(const std::array<unsigned char, 1024> &buf, int len, const CHost &host)
 {
@@ -762,6 +992,13 @@ static boost::asio::awaitable<void> NetworkParseInGameEvent(const std::array<uns
 			co_return;
 		}
 		player = Hosts[index].PlyNr;
+	} else if (NetConnectType == 1) {
+		// Clients only send their own packets, which are then relayed to the other clients
+		const int index = FindHostIndexBy(host);
+		if (index == -1 || Hosts[index].PlyNr != player) {
+			DebugPrint("Packet for player %d not sent by its host\n" _C_ player);
+			co_return;
+		}
 	}
 	if (NetConnectType == 1) {
 		if (player != 255) {
@@ -772,6 +1009,9 @@ static boost::asio::awaitable<void> NetworkParseInGameEvent(const std::array<uns
 		DebugPrint("Bad packet read\n");
 		co_return;
 	}
+	if (commands > 0 && packet.Header.Type[0] != MessageResend) {
+		RecordNetworkPacketDelay(player, packet.Header.Cycle);
+	}
 	NetworkLastCycle[player] = packet.Header.Cycle;
 	// Parse the packet commands.
 	for (int i = 0; i != commands; ++i) {
@@ -786,9 +1026,12 @@ static boost::asio::awaitable<void> NetworkParseInGameEvent(const std::array<uns
 			}
 		}
 		if (packet.Header.Type[i] == MessageResend) {
-			co_await ParseResendCommand(packet);
+			co_await ParseResendCommand(packet, player);
 			co_return;
 		}
+		if ((packet.Header.Type[i] & 0x7F) == MessageSync) {
+			RecordEchoedNetworkPacketDelay(packet, i, player);
+		}
 		// Receive statistic
 		NetworkLastFrame[player] = FrameCounter;
 
@@ -817,7 +1060,7 @@ static boost::asio::awaitable<void> NetworkParseInGameEvent(const std::array<uns
 		const int networkUpdates = CNetworkParameter::Instance.gameCyclesPerUpdate;
 		unsigned long n = ((GameCycle / networkUpdates) + 1) * networkUpdates;
 		if (IsNetworkCommandReady(n) == true) {
-			NetworkInSync = true;
+			SetNetworkInSync(true);
 		}
 	}
 }
@@ -829,7 +1072,7 @@ static boost::asio::awaitable<void> NetworkParseInGameEvent(const std::array<uns
 boost::asio::awaitable<void> NetworkEvent()
 {
 	if (!IsNetworkGame()) {
-		NetworkInSync = true;
+		SetNetworkInSync(true);
 		co_return;
 	}
 
@@ -845,7 +1088,7 @@ boost::asio::awaitable<void> NetworkEvent()
 		exception::report(exception);
 		DebugPrint("Server/Client gone?\n");
 		// just hope for an automatic recover right now..
-		NetworkInSync = false;
+		SetNetworkInSync(false);
 		co_return;
 	}
 
@@ -874,7 +1117,8 @@ boost::asio::awaitable<void> NetworkQuitGame()
 	}
 	const int gameCyclesPerUpdate = CNetworkParameter::Instance.gameCyclesPerUpdate;
 	const int NetworkLag = CNetworkParameter::Instance.NetworkLag;
-	const int n = (GameCycle + gameCyclesPerUpdate) / gameCyclesPerUpdate * gameCyclesPerUpdate + NetworkLag;
+	// After a lag decrease, commands may already have been sent for later cycles
+	const unsigned long n = std::max((GameCycle + gameCyclesPerUpdate) / gameCyclesPerUpdate * gameCyclesPerUpdate + NetworkLag, NetworkLastSentCycle + gameCyclesPerUpdate);
 	std::array<CNetworkCommandQueue, MaxNetworkCommands> &ncqs = NetworkIn[n & 0xFF][CPlayer::GetThisPlayer()->get_index()];
 	CNetworkCommandQuit nc;
 	nc.player = CPlayer::GetThisPlayer()->get_index();
@@ -962,6 +1206,15 @@ static void NetworkExecCommand_ExtendedCommand(const CNetworkCommandQueue &ncq)
 						nec.Arg1, nec.Arg2, nec.Arg3, nec.Arg4);
 }
 
+static void NetworkExecCommand_GroupCommand(const CNetworkCommandQueue &ncq)
+{
+	assert_throw((ncq.Type & 0x7F) == MessageCommandGroup);
+	CNetworkGroupCommand ngc;
+
+	assert_throw(ngc.Deserialize(ncq.Data.data(), ncq.Data.size()) == ncq.Data.size());
+	ExecGroupCommand(ngc.Type, ngc.Units, ngc.X, ngc.Y, ngc.Dest);
+}
+
 static void NetworkExecCommand_Command(const CNetworkCommandQueue &ncq)
 {
 	CNetworkCommand nc;
@@ -983,6 +1236,7 @@ static void NetworkExecCommand(const CNetworkCommandQueue &ncq)
 		case MessageChat: NetworkExecCommand_Chat(ncq); break;
 		case MessageQuit: NetworkExecCommand_Quit(ncq); break;
 		case MessageExtendedCommand: NetworkExecCommand_ExtendedCommand(ncq); break;
+		case MessageCommandGroup: NetworkExecCommand_GroupCommand(ncq); break;
 		case MessageNone:
 			// Nothing to Do, This Message Should Never be Executed
 			assert_throw(false);
@@ -1006,15 +1260,30 @@ static boost::asio::awaitable<void> NetworkSendCommands(unsigned long gameNetCyc
 		ncq[0].Type = MessageSync;
 		nc.syncHash = SyncHash;
 		nc.syncSeed = wyrmgus::random::get()->get_seed();
+		nc.delay = GetEchoedNetworkPacketDelay();
 		ncq[0].Data.resize(nc.Size());
 		nc.Serialize(&ncq[0].Data[0]);
 		ncq[0].Time = gameNetCycle;
 		numcommands = 1;
 	} else {
+		// Commands which don't fit in the packet's size are left for the next update
+		size_t packet_size = CNetworkPacketHeader::Size();
+		const auto fits_in_packet = [&packet_size, &numcommands](const CNetworkCommandQueue &incommand) {
+			const size_t command_size = serialize(nullptr, incommand.Data);
+			if (numcommands > 0 && packet_size + command_size > MaxNetworkPacketSize) {
+				return false;
+			}
+			packet_size += command_size;
+			return true;
+		};
+
 		while (!CommandsIn.empty() && numcommands < MaxNetworkCommands) {
 			const CNetworkCommandQueue &incommand = CommandsIn.front();
+			if (!fits_in_packet(incommand)) {
+				break;
+			}
 #ifdef DEBUG
-			if (incommand.Type != MessageExtendedCommand) {
+			if (incommand.Type != MessageExtendedCommand && incommand.Type != MessageCommandGroup) {
 				CNetworkCommand nc;
 				nc.Deserialize(&incommand.Data[0]);
 
@@ -1032,6 +1301,9 @@ static boost::asio::awaitable<void> NetworkSendCommands(unsigned long gameNetCyc
 		}
 		while (!MsgCommandsIn.empty() && numcommands < MaxNetworkCommands) {
 			const CNetworkCommandQueue &incommand = MsgCommandsIn.front();
+			if (!fits_in_packet(incommand)) {
+				break;
+			}
 			ncq[numcommands] = incommand;
 			ncq[numcommands].Time = gameNetCycle;
 			++numcommands;
@@ -1043,6 +1315,8 @@ static boost::asio::awaitable<void> NetworkSendCommands(unsigned long gameNetCyc
 	}
 	NetworkSyncSeeds[gameNetCycle & 0xFF] = wyrmgus::random::get()->get_seed();
 	NetworkSyncHashs[gameNetCycle & 0xFF] = SyncHash;
+	NetworkSendTimes[gameNetCycle & 0xFF] = std::make_pair(gameNetCycle, std::chrono::steady_clock::now());
+	RecordEarlyNetworkPacketDelays(gameNetCycle);
 	co_await NetworkSendPacket(ncq);
 }
 
@@ -1066,6 +1340,50 @@ static void NetworkExecCommands(unsigned long gameNetCycle)
 	}
 }
 
+/**
+**  Decide whether to change the network lag, and if so send the change to all
+**  players, who then apply it in the same cycle.
+*/
+static void UpdateNetworkLag()
+{
+	if (!NetworkLagController.has_value() || NetworkLagChangePending) {
+		return;
+	}
+
+	const wyrmgus::network_statistics *statistics = wyrmgus::network_statistics::get();
+	if (!statistics->has_rtt_samples()) {
+		return;
+	}
+
+	const auto [rtt, jitter] = statistics->get_max_rtt_and_jitter();
+	const unsigned int lag = CNetworkParameter::Instance.NetworkLag;
+	const std::optional<unsigned int> new_lag = NetworkLagController->update(lag, rtt, jitter, GetNetworkCycleDuration(), wyrmgus::network_statistics::get()->take_stalled(), std::chrono::steady_clock::now());
+
+	if (new_lag.has_value() && new_lag.value() != lag) {
+		SendCommandNetworkLag(new_lag.value());
+		NetworkLagChangePending = true;
+	}
+}
+
+/**
+**  Change the network lag, executed at the same cycle for all players.
+**
+**  @param lag  New network lag, in game cycles.
+*/
+void SetNetworkLag(const unsigned int lag)
+{
+	const unsigned int old_lag = CNetworkParameter::Instance.NetworkLag;
+	const unsigned int new_lag = wyrmgus::network_lag_controller::get_valid_lag(lag, CNetworkParameter::Instance.gameCyclesPerUpdate);
+
+	CNetworkParameter::Instance.NetworkLag = new_lag;
+	wyrmgus::network_statistics::get()->record_lag_change(old_lag, new_lag);
+
+	NetworkLagChangePending = false;
+	if (NetworkLagController.has_value()) {
+		NetworkLagController->on_lag_changed(std::chrono::steady_clock::now());
+	}
+}
+
 /**
 **  Handle network commands.
 */
@@ -1078,10 +1396,16 @@ boost::asio::awaitable<void> NetworkCommands()
 		co_return;
 	}
 	const unsigned long gameNetCycle = GameCycle;
+	const unsigned int gameCyclesPerUpdate = CNetworkParameter::Instance.gameCyclesPerUpdate;
 	// Send messages to all clients (other players)
-	co_await NetworkSendCommands(gameNetCycle + CNetworkParameter::Instance.NetworkLag);
+	// All players change the lag at the same cycle, so they catch up or hold back in lockstep.
+	for (const unsigned long sendGameNetCycle : wyrmgus::network_lag_controller::get_cycles_to_send(NetworkLastSentCycle, gameNetCycle, CNetworkParameter::Instance.NetworkLag, gameCyclesPerUpdate)) {
+		NetworkLastSentCycle = sendGameNetCycle;
+		co_await NetworkSendCommands(sendGameNetCycle);
+	}
 	NetworkExecCommands(gameNetCycle);
-	NetworkInSync = IsNetworkCommandReady(gameNetCycle + CNetworkParameter::Instance.gameCyclesPerUpdate);
+	UpdateNetworkLag();
+	SetNetworkInSync(IsNetworkCommandReady(gameNetCycle + CNetworkParameter::Instance.gameCyclesPerUpdate));
 }
 
 [[nodiscard]]
@@ -1131,9 +1455,7 @@ static boost::asio::awaitable<void> CheckPlayerThatTimeOut(int hostIndex)
 [[nodiscard]]
 static boost::asio::awaitable<void> NetworkResendCommands()
 {
-#ifdef DEBUG
-	++NetworkStat.resentPacketCount;
-#endif
+	wyrmgus::network_statistics::get()->increment_resend_count();
 
 	const int networkUpdates = CNetworkParameter::Instance.gameCyclesPerUpdate;
 	const int nextGameCycle = ((GameCycle / networkUpdates) + 1) * networkUpdates;
@@ -1149,7 +1471,7 @@ static boost::asio::awaitable<void> NetworkResendCommands()
 boost::asio::awaitable<void> NetworkRecover()
 {
 	if (HostsCount == 0) {
-		NetworkInSync = true;
+		SetNetworkInSync(true);
 		co_return;
 	}
 	if (FrameCounter % CNetworkParameter::Instance.gameCyclesPerUpdate != 0) {
@@ -1160,5 +1482,5 @@ boost::asio::awaitable<void> NetworkRecover()
 	}
 	co_await NetworkResendCommands();
 	const unsigned int nextGameNetCycle = GameCycle / CNetworkParameter::Instance.gameCyclesPerUpdate + 1;
-	NetworkInSync = IsNetworkCommandReady(nextGameNetCycle);
+	SetNetworkInSync(IsNetworkCommandReady(nextGameNetCycle));
 }
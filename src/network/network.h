@@ -46,7 +46,8 @@ public:
 	std::string localHost;  /// Local network address to use
 	unsigned int localPort; /// Local network port to use
 	unsigned int gameCyclesPerUpdate;  /// Network update each # game cycles
-	unsigned int NetworkLag;      /// Network lag (# update cycles)
+	unsigned int NetworkLag;      /// Network lag (# game cycles)
+	bool AdaptiveLag = true;      /// Adapt the network lag to the measured round-trip times
 	unsigned int timeoutInS;      /// Number of seconds until player times out
 
 public:
@@ -75,6 +76,7 @@ extern boost::asio::awaitable<void> NetworkRecover();   /// Recover network
 
 [[nodiscard]]
 extern boost::asio::awaitable<void> NetworkCommands();  /// Get all network commands
+extern void SetNetworkLag(const unsigned int lag);  /// Change the network lag
 
 extern void NetworkSendChatMessage(const std::string &msg);  /// Send chat message
 /// Send network command.
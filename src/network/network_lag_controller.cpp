@@ -0,0 +1,100 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#include "stratagus.h"
+
+#include "network/network_lag_controller.h"
+
+namespace wyrmgus {
+
+std::vector<unsigned long> network_lag_controller::get_cycles_to_send(unsigned long last_sent_cycle, const unsigned long game_net_cycle, const unsigned lag, const unsigned cycles_per_update)
+{
+	std::vector<unsigned long> cycles;
+
+	const unsigned long send_cycle = game_net_cycle + lag;
+	while (last_sent_cycle < send_cycle) {
+		last_sent_cycle += std::max(cycles_per_update, 1u);
+		cycles.push_back(last_sent_cycle);
+	}
+
+	return cycles;
+}
+
+unsigned network_lag_controller::get_valid_lag(const unsigned lag, const unsigned cycles_per_update)
+{
+	const unsigned valid_cycles_per_update = std::max(cycles_per_update, 1u);
+
+	return std::clamp(lag / valid_cycles_per_update * valid_cycles_per_update, 2 * valid_cycles_per_update, network_lag_controller::max_lag);
+}
+
+unsigned network_lag_controller::get_desired_lag(const double rtt, const double jitter, const double cycle_duration) const
+{
+	//commands relayed through the server travel from one client to another, which is covered by the round-trip time; four times the jitter covers most delay spikes, and an extra update covers the time the command waits to be sent
+	const double required_time = rtt + 4. * jitter;
+	const unsigned required_cycles = static_cast<unsigned>(std::ceil(required_time / cycle_duration)) + this->cycles_per_update;
+
+	return std::clamp(this->round_to_update(required_cycles), this->round_to_update(this->min_lag), network_lag_controller::max_lag);
+}
+
+std::optional<unsigned> network_lag_controller::update(const unsigned current_lag, const double rtt, const double jitter, const double cycle_duration, const bool stalled, const std::chrono::steady_clock::time_point now)
+{
+	if (this->last_change_time.has_value() && now - this->last_change_time.value() < network_lag_controller::change_interval) {
+		return std::nullopt;
+	}
+
+	unsigned desired_lag = this->get_desired_lag(rtt, jitter, cycle_duration);
+
+	if (stalled) {
+		desired_lag = std::max(desired_lag, std::min(current_lag + this->cycles_per_update, network_lag_controller::max_lag));
+	}
+
+	if (desired_lag > current_lag) {
+		//increase at once, as a too low lag stalls the game
+		this->lower_since.reset();
+		return desired_lag;
+	}
+
+	if (desired_lag == current_lag) {
+		this->lower_since.reset();
+		return std::nullopt;
+	}
+
+	if (!this->lower_since.has_value()) {
+		this->lower_since = now;
+		return std::nullopt;
+	}
+
+	if (now - this->lower_since.value() < network_lag_controller::decrease_delay) {
+		return std::nullopt;
+	}
+
+	//decrease one update at a time, as the commands of the cycles skipped over are held back until the new schedule catches up
+	this->lower_since = now;
+	return std::max(desired_lag, current_lag - this->cycles_per_update);
+}
+
+}
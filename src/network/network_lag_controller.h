@@ -0,0 +1,81 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#pragma once
+
+namespace wyrmgus {
+
+//decides the network lag (the delay in game cycles between a command being given and it being executed) from the measured round-trip times and jitter of the peers
+//the controller only makes the decision: the new lag is applied by all peers at the same cycle through an in-band command, so that their command schedules stay in lockstep
+class network_lag_controller final
+{
+public:
+	//the maximum lag, which must stay well below half of the 256-cycle range in which commands are buffered
+	static constexpr unsigned max_lag = 96;
+
+	//the time the measured lag must stay lower than the current one before it is decreased
+	static constexpr std::chrono::seconds decrease_delay = std::chrono::seconds(5);
+
+	//the minimum time between two lag changes
+	static constexpr std::chrono::seconds change_interval = std::chrono::seconds(1);
+
+	explicit network_lag_controller(const unsigned cycles_per_update, const unsigned min_lag)
+		: cycles_per_update(std::max(cycles_per_update, 1u)), min_lag(min_lag)
+	{
+	}
+
+	//get the cycles for which our commands are to be sent at a network update: if the lag has been increased, the cycles skipped over are sent as well, and if it has been decreased, nothing is sent until the cycles already sent have been passed
+	static std::vector<unsigned long> get_cycles_to_send(const unsigned long last_sent_cycle, const unsigned long game_net_cycle, const unsigned lag, const unsigned cycles_per_update);
+
+	//get the lag to be used for a requested lag: rounded down to a multiple of the cycles per update, and kept between two updates and the maximum lag
+	static unsigned get_valid_lag(const unsigned lag, const unsigned cycles_per_update);
+
+	//get the lag which covers the given round-trip time and jitter, in game cycles
+	unsigned get_desired_lag(const double rtt, const double jitter, const double cycle_duration) const;
+
+	//get the lag to change to, if any; stalls since the last update force an increase
+	std::optional<unsigned> update(const unsigned current_lag, const double rtt, const double jitter, const double cycle_duration, const bool stalled, const std::chrono::steady_clock::time_point now);
+
+	void on_lag_changed(const std::chrono::steady_clock::time_point now)
+	{
+		this->last_change_time = now;
+		this->lower_since.reset();
+	}
+
+private:
+	unsigned round_to_update(const unsigned lag) const
+	{
+		return (lag + this->cycles_per_update - 1) / this->cycles_per_update * this->cycles_per_update;
+	}
+
+	const unsigned cycles_per_update = 1;
+	const unsigned min_lag = 0;
+	std::optional<std::chrono::steady_clock::time_point> last_change_time;
+	std::optional<std::chrono::steady_clock::time_point> lower_since; //since when the desired lag has been lower than the current one
+};
+
+}
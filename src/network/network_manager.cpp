@@ -139,6 +139,7 @@ void network_manager::init_server_connect(const QString &map_filepath_qstr, cons
 {
 	NetConnectRunning = 1;
 	NetConnectType = 1;
+	CNetworkParameter::Instance.AdaptiveLag = preferences::get()->is_adaptive_network_lag_enabled();
 
 	this->reset();
 
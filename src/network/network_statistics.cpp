@@ -0,0 +1,157 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#include "stratagus.h"
+
+#include "network/network_statistics.h"
+
+#include "database/defines.h"
+#include "database/preferences.h"
+#include "network/netconnect.h"
+#include "network/network.h"
+#include "player/player.h"
+#include "ui/ui.h"
+#include "video/font.h"
+#include "video/video.h"
+
+namespace wyrmgus {
+
+void network_statistics::clear()
+{
+	this->peers.fill(peer_network_statistics());
+	this->resend_count = 0;
+	this->stall_count = 0;
+	this->stall_time = {};
+	this->stall_start.reset();
+	this->stalled = false;
+	this->lag_change_count = 0;
+}
+
+std::pair<double, double> network_statistics::get_max_rtt_and_jitter() const
+{
+	double max_rtt = 0;
+	double max_jitter = 0;
+
+	for (const peer_network_statistics &peer : this->peers) {
+		if (peer.sample_count == 0) {
+			continue;
+		}
+
+		max_rtt = std::max(max_rtt, peer.rtt);
+		max_jitter = std::max(max_jitter, peer.jitter);
+	}
+
+	return std::make_pair(max_rtt, max_jitter);
+}
+
+void network_statistics::set_in_sync(const bool in_sync)
+{
+	if (in_sync) {
+		if (this->stall_start.has_value()) {
+			this->stall_time += std::chrono::steady_clock::now() - this->stall_start.value();
+			this->stall_start.reset();
+		}
+	} else if (!this->stall_start.has_value()) {
+		this->stall_start = std::chrono::steady_clock::now();
+		this->stalled = true;
+		++this->stall_count;
+	}
+}
+
+std::chrono::steady_clock::duration network_statistics::get_stall_time() const
+{
+	if (this->stall_start.has_value()) {
+		return this->stall_time + (std::chrono::steady_clock::now() - this->stall_start.value());
+	}
+
+	return this->stall_time;
+}
+
+void network_statistics::record_lag_change(const unsigned old_lag, const unsigned new_lag)
+{
+	++this->lag_change_count;
+
+	const auto [max_rtt, max_jitter] = this->get_max_rtt_and_jitter();
+	fprintf(stdout, "Network lag changed from %u to %u cycles at cycle %lu (RTT %.1f ms, jitter %.1f ms)\n", old_lag, new_lag, GameCycle, max_rtt, max_jitter);
+}
+
+void network_statistics::draw_overlay(std::vector<std::function<void(renderer *)>> &render_commands) const
+{
+	std::vector<std::string> lines;
+
+	std::array<char, 256> buffer{};
+	snprintf(buffer.data(), buffer.size(), "Lag: %u cycles, resends: %u, stalls: %u (%.1f s)", CNetworkParameter::Instance.NetworkLag, this->resend_count, this->stall_count, std::chrono::duration<double>(this->get_stall_time()).count());
+	lines.emplace_back(buffer.data());
+
+	for (int i = 0; i < HostsCount; ++i) {
+		const int player = Hosts[i].PlyNr;
+		const peer_network_statistics &peer = this->peers.at(player);
+
+		snprintf(buffer.data(), buffer.size(), "%s: delay %.1f ms, RTT %.1f ms, jitter %.1f ms, resend requests: %u", CPlayer::Players.at(player)->get_name().c_str(), peer.delay, peer.rtt, peer.jitter, peer.resend_request_count);
+		lines.emplace_back(buffer.data());
+	}
+
+	font *small_font = defines::get()->get_small_font();
+	const CLabel label(small_font);
+
+	const centesimal_int &scale_factor = preferences::get()->get_scale_factor();
+	const int padding = (4 * scale_factor).to_int();
+	const int line_height = small_font->Height() + (2 * scale_factor).to_int();
+
+	int width = 0;
+	for (const std::string &line : lines) {
+		width = std::max(width, small_font->Width(line));
+	}
+	width += padding * 2;
+
+	const int height = line_height * static_cast<int>(lines.size()) + padding * 2;
+	const int x = UI.MapArea.get_rect().right() - width - padding * 2;
+	int y = UI.MapArea.get_rect().y() + padding * 2;
+
+	Video.FillTransRectangle(ColorBlack, x, y, width, height, 160, render_commands);
+
+	y += padding;
+
+	for (const std::string &line : lines) {
+		label.Draw(x + padding, y, line, render_commands);
+		y += line_height;
+	}
+}
+
+void network_statistics::print() const
+{
+	fprintf(stdout, "Network statistics: lag %u cycles (%u changes), %u resends, %u stalls (%.1f s)\n", CNetworkParameter::Instance.NetworkLag, this->lag_change_count, this->resend_count, this->stall_count, std::chrono::duration<double>(this->get_stall_time()).count());
+
+	for (int i = 0; i < HostsCount; ++i) {
+		const int player = Hosts[i].PlyNr;
+		const peer_network_statistics &peer = this->peers.at(player);
+
+		fprintf(stdout, "\t%s: delay %.1f ms, RTT %.1f ms, jitter %.1f ms (%zu samples), %u resend requests\n", CPlayer::Players.at(player)->get_name().c_str(), peer.delay, peer.rtt, peer.jitter, peer.sample_count, peer.resend_request_count);
+	}
+}
+
+}
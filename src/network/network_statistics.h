@@ -0,0 +1,170 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#pragma once
+
+#include "util/singleton.h"
+
+namespace wyrmgus {
+
+class renderer;
+
+//the connection statistics of a peer, with the round-trip time and its jitter smoothed in the way TCP does
+struct peer_network_statistics final
+{
+	//record the delay of a packet from the peer; if the peer has told us its delay of our packets, the two directions give a round-trip time sample
+	void record_delay(const double sample)
+	{
+		if (this->delay_sample_count == 0) {
+			this->delay = sample;
+		} else {
+			this->delay += (sample - this->delay) / 8.;
+		}
+
+		++this->delay_sample_count;
+
+		if (this->echoed_delay.has_value()) {
+			this->record_rtt(std::max(sample + this->echoed_delay.value(), 0.));
+		}
+	}
+
+	void record_rtt(const double sample)
+	{
+		if (this->sample_count == 0) {
+			this->rtt = sample;
+			this->jitter = sample / 2.;
+		} else {
+			this->jitter += (std::abs(sample - this->rtt) - this->jitter) / 4.;
+			this->rtt += (sample - this->rtt) / 8.;
+		}
+
+		++this->sample_count;
+	}
+
+	double delay = 0; //the smoothed delay of the peer's packets, in milliseconds; negative if they arrive before ours are sent
+	size_t delay_sample_count = 0;
+	std::optional<double> echoed_delay; //the peer's delay of our packets, in milliseconds
+	double rtt = 0; //in milliseconds
+	double jitter = 0; //the mean deviation of the round-trip time, in milliseconds
+	size_t sample_count = 0;
+	unsigned resend_request_count = 0; //the amount of times the peer asked for packets to be resent
+};
+
+//keeps the statistics of the in-game network connection, for display in an overlay and in the log
+class network_statistics final : public singleton<network_statistics>
+{
+public:
+	void clear();
+
+	const peer_network_statistics &get_peer(const int player) const
+	{
+		return this->peers.at(player);
+	}
+
+	//record the delay between this client sending its packet for a cycle, and a peer's packet for the same cycle arriving
+	//the delay is negative if the peer's packet arrived first; the phase difference between the peers cancels out when it is added to the peer's delay of our packets, giving the round-trip time
+	void record_packet_delay(const int player, const double delay)
+	{
+		this->peers.at(player).record_delay(delay);
+	}
+
+	//record the delay of our packets as measured by the peer, which it sends in its sync messages
+	void record_echoed_delay(const int player, const double delay)
+	{
+		this->peers.at(player).echoed_delay = delay;
+	}
+
+	void record_resend_request(const int player)
+	{
+		++this->peers.at(player).resend_request_count;
+	}
+
+	void reset_peer(const int player)
+	{
+		this->peers.at(player) = peer_network_statistics();
+	}
+
+	bool has_rtt_samples() const
+	{
+		return std::any_of(this->peers.begin(), this->peers.end(), [](const peer_network_statistics &peer) {
+			return peer.sample_count > 0;
+		});
+	}
+
+	//get the highest round-trip time and jitter among the peers, in milliseconds
+	std::pair<double, double> get_max_rtt_and_jitter() const;
+
+	unsigned get_resend_count() const
+	{
+		return this->resend_count;
+	}
+
+	void increment_resend_count()
+	{
+		++this->resend_count;
+	}
+
+	void set_in_sync(const bool in_sync);
+
+	std::chrono::steady_clock::duration get_stall_time() const;
+
+	//get whether the game stalled waiting for the network since the last call
+	bool take_stalled()
+	{
+		const bool stalled = this->stalled || this->stall_start.has_value();
+		this->stalled = false;
+		return stalled;
+	}
+
+	void record_lag_change(const unsigned old_lag, const unsigned new_lag);
+
+	bool is_overlay_enabled() const
+	{
+		return this->overlay_enabled;
+	}
+
+	void toggle_overlay()
+	{
+		this->overlay_enabled = !this->overlay_enabled;
+	}
+
+	void draw_overlay(std::vector<std::function<void(renderer *)>> &render_commands) const;
+
+	void print() const;
+
+private:
+	std::array<peer_network_statistics, PlayerMax> peers{};
+	unsigned resend_count = 0; //the amount of times this client asked for packets to be resent
+	unsigned stall_count = 0;
+	std::chrono::steady_clock::duration stall_time{};
+	std::optional<std::chrono::steady_clock::time_point> stall_start;
+	bool stalled = false;
+	unsigned lag_change_count = 0;
+	bool overlay_enabled = false;
+};
+
+}
@@ -961,6 +961,8 @@ int AStarFindPath(const Vec2i &startPos, const Vec2i &goalPos, const int gw, con
 		}
 		//Wyrmgus end
 		
+		++PathFinderWorkCount;
+
 		// Find the best node of from the open set
 		const Open shortest = std::move(*OpenSet[z].begin());
 		OpenSet[z].erase(OpenSet[z].begin());
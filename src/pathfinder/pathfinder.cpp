@@ -29,6 +29,7 @@
 #include "pathfinder/pathfinder.h"
 
 #include "actions.h"
+#include "iolib.h"
 #include "map/landmass.h"
 #include "map/map.h"
 #include "map/map_info.h"
@@ -53,6 +54,8 @@ extern void InitAStar();
 /// free the a* data structures
 extern void FreeAStar();
 
+thread_local uint64_t PathFinderWorkCount = 0;
+
 void TerrainTraversal::SetSize(unsigned int width, unsigned int height)
 {
 	m_values.resize((width + 2) * (height + 2));
@@ -225,6 +228,32 @@ void TerrainTraversal::Set(const Vec2i &pos, TerrainTraversal::dataType value)
 	m_values[m_extented_width + 1 + pos.y * m_extented_width + pos.x] = value;
 }
 
+void TerrainTraversal::Save(CFile &file) const
+{
+	file.printf("{\"size\", {%u, %u}, ", m_extented_width - 2, m_height);
+
+	//the values are saved run-length encoded, as most of them are unvisited or border values
+	file.printf("\"values\", {");
+	for (size_t i = 0; i < m_values.size();) {
+		const dataType value = m_values[i];
+		size_t count = 1;
+		while (i + count < m_values.size() && m_values[i + count] == value) {
+			++count;
+		}
+		file.printf("%d, %zu, ", value, count);
+		i += count;
+	}
+	file.printf("}, ");
+
+	file.printf("\"queue\", {");
+	std::queue<PosNode> queue = m_queue;
+	for (; !queue.empty(); queue.pop()) {
+		const PosNode &posNode = queue.front();
+		file.printf("%d, %d, %d, %d, ", posNode.pos.x, posNode.pos.y, posNode.from.x, posNode.from.y);
+	}
+	file.printf("}}");
+}
+
 /**
 **  Init the pathfinder
 */
@@ -161,6 +161,9 @@ public:
 	// Accept pos to be at one inside the real map
 	dataType Get(const Vec2i &pos) const;
 
+	void Save(CFile &file) const;
+	void Load(lua_State *l);
+
 private:
 	void Set(const Vec2i &pos, dataType value);
 
@@ -177,11 +180,15 @@ private:
 	unsigned int m_height = 0;
 };
 
+/// Amount of tiles visited by terrain traversals and of nodes expanded by the A* path finder in the current thread, as a deterministic measure of the path finding work done
+extern thread_local uint64_t PathFinderWorkCount;
+
 template <typename T>
 bool TerrainTraversal::Run(T &context)
 {
 	for (; m_queue.empty() == false; m_queue.pop()) {
 		const PosNode &posNode = m_queue.front();
+		++PathFinderWorkCount;
 
 		switch (context.Visit(*this, posNode.pos, posNode.from)) {
 			case VisitResult::Finished: return true;
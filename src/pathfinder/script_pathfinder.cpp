@@ -36,6 +36,58 @@
 #include "unit/unit.h"
 #include "unit/unit_type.h"
 
+void TerrainTraversal::Load(lua_State *l)
+{
+	if (!lua_istable(l, -1)) {
+		LuaError(l, "incorrect argument in TerrainTraversal::Load");
+	}
+	const int args = 1 + lua_rawlen(l, -1);
+	for (int i = 1; i < args; ++i) {
+		const char *tag = LuaToString(l, -1, i);
+		++i;
+		if (!strcmp(tag, "size")) {
+			lua_rawgeti(l, -1, i);
+			Vec2i size;
+			CclGetPos(l, &size.x, &size.y);
+			lua_pop(l, 1);
+			this->SetSize(size.x, size.y);
+			this->Init();
+		} else if (!strcmp(tag, "values")) {
+			lua_rawgeti(l, -1, i);
+			if (!lua_istable(l, -1)) {
+				LuaError(l, "incorrect argument");
+			}
+			const int subargs = lua_rawlen(l, -1);
+			size_t index = 0;
+			for (int k = 0; k < subargs; ++k) {
+				const dataType value = static_cast<dataType>(LuaToNumber(l, -1, k + 1));
+				++k;
+				const size_t count = LuaToUnsignedNumber(l, -1, k + 1);
+				if (index + count > m_values.size()) {
+					LuaError(l, "TerrainTraversal::Load: Too many values");
+				}
+				std::fill_n(m_values.begin() + index, count, value);
+				index += count;
+			}
+			lua_pop(l, 1);
+		} else if (!strcmp(tag, "queue")) {
+			lua_rawgeti(l, -1, i);
+			if (!lua_istable(l, -1)) {
+				LuaError(l, "incorrect argument");
+			}
+			const int subargs = lua_rawlen(l, -1);
+			for (int k = 0; k < subargs; k += 4) {
+				const Vec2i pos(LuaToNumber(l, -1, k + 1), LuaToNumber(l, -1, k + 2));
+				const Vec2i from(LuaToNumber(l, -1, k + 3), LuaToNumber(l, -1, k + 4));
+				m_queue.push(PosNode(pos, from));
+			}
+			lua_pop(l, 1);
+		} else {
+			LuaError(l, "TerrainTraversal::Load: Unsupported tag: %s" _C_ tag);
+		}
+	}
+}
+
 /**
 **  Enable a*.
 **
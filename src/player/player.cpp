@@ -83,8 +83,10 @@
 #include "player/player_flag.h"
 #include "player/player_type.h"
 #include "player/vassalage_type.h"
+#include "population/population_batch.h"
 #include "population/population_class.h"
 #include "population/population_type.h"
+#include "profiler.h"
 #include "quest/campaign.h"
 #include "quest/objective/quest_objective.h"
 #include "quest/objective/research_upgrade_objective.h"
@@ -554,14 +556,42 @@ void CPlayer::calculate_military_score()
 {
 	this->military_score = 0;
 
+	for (int i = 0; i < this->GetUnitCount(); ++i) {
+		CUnit &unit = this->GetUnit(i);
+
+		const int contribution = unit.counts_for_military_score() ? unit.Variable[POINTS_INDEX].Value : 0;
+		unit.set_military_score_contribution(contribution);
+		this->military_score += contribution;
+	}
+}
+
+void CPlayer::check_aggregates() const
+{
+	//check the incrementally-updated aggregates against a full recalculation
+	int military_score = 0;
+
 	for (int i = 0; i < this->GetUnitCount(); ++i) {
 		const CUnit &unit = this->GetUnit(i);
 
-		if (!unit.counts_for_military_score()) {
-			continue;
+		if (unit.counts_for_military_score()) {
+			military_score += unit.Variable[POINTS_INDEX].Value;
 		}
+	}
+
+	if (military_score != this->get_military_score()) {
+		log::log_error("The military score of player " + std::to_string(this->get_index()) + " is " + std::to_string(this->get_military_score()) + ", but recalculating it gives " + std::to_string(military_score) + ".");
+	}
+
+	std::vector<const site *> settlements;
 
-		this->military_score += unit.Variable[POINTS_INDEX].Value;
+	for (const site *site : site::get_all()) {
+		if (site->is_settlement() && site->get_game_data() != nullptr && site->get_game_data()->get_owner() == this) {
+			settlements.push_back(site);
+		}
+	}
+
+	if (settlements.size() != this->get_settlements().size() || !std::is_permutation(settlements.begin(), settlements.end(), this->get_settlements().begin())) {
+		log::log_error("The settlement list of player " + std::to_string(this->get_index()) + " has " + std::to_string(this->get_settlements().size()) + " settlements, but " + std::to_string(settlements.size()) + " settlements are owned by the player.");
 	}
 }
 
@@ -1120,6 +1150,7 @@ void CPlayer::Init(player_type type)
 	//Wyrmgus end
 	this->score = 0;
 	this->military_score = 0;
+	this->settlements.clear();
 	//Wyrmgus start
 	this->LostTownHallTimer = 0;
 	this->HeroCooldownTimer = 0;
@@ -1286,7 +1317,7 @@ void CPlayer::add_settlement_to_explored_territory(const site *settlement)
 				continue;
 			}
 
-			const std::unique_ptr<tile_player_info> &tile_player_info = tile->player_info;
+			tile_player_info *tile_player_info = tile->player_info;
 
 			if (tile_player_info->get_visibility_state(player_index) == 0) {
 				tile_player_info->get_visibility_state_ref(player_index) = 1;
@@ -2106,16 +2137,16 @@ std::vector<CUnit *> CPlayer::get_town_hall_units() const
 	return town_hall_units;
 }
 
-std::vector<const wyrmgus::site *> CPlayer::get_settlements() const
+void CPlayer::add_settlement(const wyrmgus::site *settlement)
 {
-	std::vector<const wyrmgus::site *> settlements;
+	assert_throw(!vector::contains(this->settlements, settlement));
 
-	const std::vector<CUnit *> town_hall_units = this->get_town_hall_units();
-	for (const CUnit *town_hall_unit : town_hall_units) {
-		settlements.push_back(town_hall_unit->get_settlement());
-	}
+	this->settlements.push_back(settlement);
+}
 
-	return settlements;
+void CPlayer::remove_settlement(const wyrmgus::site *settlement)
+{
+	vector::remove(this->settlements, settlement);
 }
 
 bool CPlayer::has_settlement(const wyrmgus::site *settlement) const
@@ -2144,9 +2175,7 @@ bool CPlayer::has_settlement(const wyrmgus::site *settlement) const
 
 bool CPlayer::has_coastal_settlement() const
 {
-	const std::vector<const wyrmgus::site *> settlements = this->get_settlements();
-
-	for (const wyrmgus::site *settlement : settlements) {
+	for (const wyrmgus::site *settlement : this->get_settlements()) {
 		if (settlement->get_game_data()->is_coastal()) {
 			return true;
 		}
@@ -2181,9 +2210,7 @@ bool CPlayer::HasSettlementNearWaterZone(const landmass *water_zone) const
 
 bool CPlayer::has_settlement_with_resource_source(const wyrmgus::resource *resource) const
 {
-	const std::vector<const wyrmgus::site *> settlements = this->get_settlements();
-
-	for (const wyrmgus::site *settlement : settlements) {
+	for (const wyrmgus::site *settlement : this->get_settlements()) {
 		if (settlement->get_game_data()->has_resource_source(resource)) {
 			return true;
 		}
@@ -2245,11 +2272,9 @@ void CPlayer::update_building_settlement_assignment(const wyrmgus::site *old_set
 site_set CPlayer::get_border_settlements() const
 {
 	//get the settlements bordering this player
-	const std::vector<const site *> settlements = this->get_settlements();
-
 	site_set border_settlements;
 
-	for (const site *settlement : settlements) {
+	for (const site *settlement : this->get_settlements()) {
 		for (const site *border_settlement : settlement->get_game_data()->get_border_settlements()) {
 			const CPlayer *border_settlement_owner = border_settlement->get_game_data()->get_owner();
 			if (border_settlement_owner == this) {
@@ -2875,6 +2900,7 @@ void CPlayer::Clear()
 	//	TotalUnitLimit = 0;
 	this->score = 0;
 	this->military_score = 0;
+	this->settlements.clear();
 	this->TotalUnits = 0;
 	this->TotalBuildings = 0;
 	this->resource_totals.clear();
@@ -3670,6 +3696,10 @@ void CPlayer::set_resource(const resource *resource, const int quantity)
 	}
 
 	emit resource_stored_changed(resource->get_index(), this->get_resource(resource, resource_storage_type::both));
+
+	if (this == CPlayer::GetThisPlayer()) {
+		UI.ButtonPanel.invalidate_allowed_buttons();
+	}
 }
 
 void CPlayer::set_stored_resource(const resource *resource, const int quantity)
@@ -3691,6 +3721,10 @@ void CPlayer::set_stored_resource(const resource *resource, const int quantity)
 	}
 
 	emit resource_stored_changed(resource->get_index(), this->get_resource(resource, resource_storage_type::both));
+
+	if (this == CPlayer::GetThisPlayer()) {
+		UI.ButtonPanel.invalidate_allowed_buttons();
+	}
 }
 
 void CPlayer::set_resource_demand(const resource *resource, const int quantity)
@@ -4569,8 +4603,10 @@ void CPlayer::IncreaseCountsForUnit(CUnit *unit, const bool type_change)
 		this->NumTownHalls++;
 	}
 
-	if (unit->counts_for_military_score()) {
-		this->change_military_score(unit->Variable[POINTS_INDEX].Value);
+	unit->update_military_score_contribution();
+
+	if (!type->Stats[this->get_index()].get_unit_stocks().empty() || !type->Stats[this->get_index()].get_unit_class_stocks().empty()) {
+		unit->register_unit_stocks();
 	}
 	
 	for (const auto &[resource, quantity] : type->Stats[this->get_index()].get_incomes()) {
@@ -4636,9 +4672,8 @@ void CPlayer::DecreaseCountsForUnit(CUnit *unit, const bool type_change)
 		this->NumTownHalls--;
 	}
 
-	if (unit->counts_for_military_score()) {
-		this->change_military_score(-unit->Variable[POINTS_INDEX].Value);
-	}
+	this->change_military_score(-unit->get_military_score_contribution());
+	unit->set_military_score_contribution(0);
 
 	for (const auto &[resource, quantity] : type->Stats[this->get_index()].get_incomes()) {
 		this->change_income(resource, -quantity);
@@ -4668,10 +4703,12 @@ void CPlayer::DecreaseCountsForUnit(CUnit *unit, const bool type_change)
 
 			this->set_capital_settlement(nullptr);
 
-			//the unit has already been removed from the player's unit containers, so its settlement won't appear in the player's settlement list
-			const std::vector<const site *> settlements = this->get_settlements();
-			if (!settlements.empty()) {
-				this->set_capital_settlement(settlements.front());
+			//the settlement's owner is only updated after the unit has been removed from the player's unit containers, so it may still appear in the player's settlement list
+			for (const site *settlement : this->get_settlements()) {
+				if (settlement != unit->get_site()) {
+					this->set_capital_settlement(settlement);
+					break;
+				}
 			}
 		}
 
@@ -4742,6 +4779,7 @@ void PlayersEachCycle()
 			}
 
 			if (p->AiEnabled) {
+				PROFILE_SCOPE(profiler_stage::ai, player);
 				AiEachCycle(*p);
 			}
 		} catch (...) {
@@ -4761,6 +4799,7 @@ void PlayersEachSecond(const int playerIdx)
 		const qunique_ptr<CPlayer> &player = CPlayer::Players[playerIdx];
 
 		if (player->AiEnabled) {
+			PROFILE_SCOPE(profiler_stage::ai, playerIdx);
 			AiEachSecond(*player);
 		}
 
@@ -4785,13 +4824,15 @@ void PlayersEachHalfMinute(const int playerIdx)
 		const qunique_ptr<CPlayer> &player = CPlayer::Players[playerIdx];
 
 		if (player->AiEnabled) {
+			PROFILE_SCOPE(profiler_stage::ai, playerIdx);
 			AiEachHalfMinute(*player);
 		}
 
 		if (!player->is_neutral_player()) {
-			for (const site *settlement : player->get_settlements()) {
-				settlement->get_game_data()->do_per_half_minute_loop();
-			}
+			population_batch population_batch;
+			population_batch.process_settlements(player->get_settlements());
+
+			player->check_aggregates();
 
 			for (const auto &[resource, quantity] : player->get_incomes()) {
 				const wyrmgus::resource *final_resource = resource->get_final_resource();
@@ -4834,6 +4875,7 @@ void PlayersEachMinute(const int playerIdx)
 		const qunique_ptr<CPlayer> &player = CPlayer::Players[playerIdx];
 
 		if (player->AiEnabled) {
+			PROFILE_SCOPE(profiler_stage::ai, playerIdx);
 			AiEachMinute(*player);
 		}
 
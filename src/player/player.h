@@ -317,7 +317,15 @@ public:
 	const unit_class *get_default_population_unit_class(const unit_domain domain) const;
 
 	std::vector<CUnit *> get_town_hall_units() const;
-	std::vector<const wyrmgus::site *> get_settlements() const;
+
+	const std::vector<const wyrmgus::site *> &get_settlements() const
+	{
+		return this->settlements;
+	}
+
+	void add_settlement(const wyrmgus::site *settlement);
+	void remove_settlement(const wyrmgus::site *settlement);
+
 	bool has_settlement(const wyrmgus::site *settlement) const;
 	bool has_coastal_settlement() const;
 	bool HasSettlementNearWaterZone(const landmass *water_zone) const;
@@ -828,6 +836,7 @@ public:
 	}
 
 	void calculate_military_score();
+	void check_aggregates() const;
 	int get_military_score_percent_advantage_over(const CPlayer *other_player) const;
 	bool has_military_advantage_over(const CPlayer *other_player) const;
 
@@ -1440,6 +1449,7 @@ private:
 	std::vector<CUnit *> Units; /// units of this player
 	CUnit *last_created_unit = nullptr;
 	const site *capital_settlement = nullptr;
+	std::vector<const site *> settlements; //the settlements owned by the player, updated when a settlement's owner changes
 	player_index_set enemies; //enemies for this player
 	player_index_set allies; //allies for this player
 	player_index_set shared_vision; //set of player indexes that this player has shared vision with
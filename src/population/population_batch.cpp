@@ -0,0 +1,575 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#include "stratagus.h"
+
+#include "population/population_batch.h"
+
+#include "database/defines.h"
+#include "map/site.h"
+#include "map/site_game_data.h"
+#include "population/employment_type.h"
+#include "population/population_class.h"
+#include "population/population_type.h"
+#include "population/population_unit.h"
+#include "population/population_unit_key.h"
+#include "util/assert_util.h"
+#include "util/vector_util.h"
+
+namespace wyrmgus {
+
+population_batch::settlement_data population_batch::get_settlement_data(const site_game_data *game_data)
+{
+	settlement_data data;
+	data.population = game_data->get_population();
+	data.population_capacity = game_data->get_population_capacity();
+	data.default_population_type = game_data->get_default_population_type();
+	data.get_class_population_type = [game_data](const population_class *population_class) {
+		return game_data->get_class_population_type(population_class);
+	};
+
+	for (const auto &[employment_type, capacity] : game_data->get_employment_capacities()) {
+		data.employment_capacities.emplace_back(employment_type, capacity);
+	}
+
+	for (const qunique_ptr<population_unit> &population_unit : game_data->get_population_units()) {
+		data.population_units.emplace_back(population_unit->get_key(), population_unit->get_population());
+	}
+
+	return data;
+}
+
+void population_batch::process_settlements(const std::vector<const site *> &settlements)
+{
+	if (!defines::get()->is_population_enabled()) {
+		return;
+	}
+
+	this->clear();
+
+	for (const site *settlement_site : settlements) {
+		if (!settlement_site->is_settlement()) {
+			continue;
+		}
+
+		site_game_data *game_data = settlement_site->get_game_data();
+		settlement_state &settlement = this->load_settlement(population_batch::get_settlement_data(game_data), game_data);
+		this->simulate_settlement(settlement);
+	}
+
+	for (const settlement_state &settlement : this->settlements) {
+		this->apply_settlement(settlement);
+
+		settlement.game_data->calculate_employment_incomes();
+		settlement.game_data->sort_population_units();
+	}
+}
+
+void population_batch::process_employment_validity(site_game_data *game_data)
+{
+	this->clear();
+
+	settlement_state &settlement = this->load_settlement(population_batch::get_settlement_data(game_data), game_data);
+	this->check_employment_validity(settlement);
+	this->apply_settlement(settlement);
+}
+
+void population_batch::process_employment_capacities(site_game_data *game_data)
+{
+	this->clear();
+
+	settlement_state &settlement = this->load_settlement(population_batch::get_settlement_data(game_data), game_data);
+	this->check_employment_capacities(settlement);
+	this->apply_settlement(settlement);
+}
+
+std::vector<std::pair<population_unit_key, int64_t>> population_batch::simulate_settlement(const settlement_data &data)
+{
+	this->clear();
+
+	settlement_state &settlement = this->load_settlement(data, nullptr);
+	this->simulate_settlement(settlement);
+	return this->get_population_units(settlement);
+}
+
+void population_batch::clear()
+{
+	this->settlements.clear();
+	this->types.clear();
+	this->employment_types.clear();
+	this->populations.clear();
+	this->alive.clear();
+}
+
+population_batch::settlement_state &population_batch::load_settlement(const settlement_data &data, site_game_data *game_data)
+{
+	settlement_state settlement;
+	settlement.game_data = game_data;
+	settlement.population_capacity = data.population_capacity;
+	settlement.default_population_type = data.default_population_type;
+	settlement.get_class_population_type = data.get_class_population_type;
+	settlement.employment_capacities = data.employment_capacities;
+	settlement.begin = this->types.size();
+	settlement.population = data.population;
+
+	for (const auto &[key, population] : data.population_units) {
+		this->types.push_back(key.type);
+		this->employment_types.push_back(key.employment_type);
+		this->populations.push_back(population);
+		this->alive.push_back(1);
+	}
+
+	settlement.end = this->types.size();
+
+	this->settlements.push_back(std::move(settlement));
+	return this->settlements.back();
+}
+
+void population_batch::simulate_settlement(settlement_state &settlement)
+{
+	this->do_population_growth(settlement);
+	this->do_population_promotion(settlement);
+	this->do_population_demotion(settlement);
+	this->check_employment_validity(settlement);
+	this->check_employment_capacities(settlement);
+	this->check_available_employment(settlement);
+}
+
+std::vector<std::pair<population_unit_key, int64_t>> population_batch::get_population_units(const settlement_state &settlement) const
+{
+	std::vector<std::pair<population_unit_key, int64_t>> population_units;
+
+	for (size_t i = settlement.begin; i < settlement.end; ++i) {
+		if (!this->alive[i]) {
+			continue;
+		}
+
+		population_units.emplace_back(this->get_entry_key(i), this->populations[i]);
+	}
+
+	return population_units;
+}
+
+void population_batch::apply_settlement(const settlement_state &settlement)
+{
+	settlement.game_data->set_population_units(this->get_population_units(settlement), settlement.population);
+}
+
+size_t population_batch::find_entry(const settlement_state &settlement, const population_unit_key &key) const
+{
+	for (size_t i = settlement.begin; i < settlement.end; ++i) {
+		if (this->alive[i] && this->types[i] == key.type && this->employment_types[i] == key.employment_type) {
+			return i;
+		}
+	}
+
+	return population_batch::npos;
+}
+
+size_t population_batch::find_first_entry(const settlement_state &settlement) const
+{
+	for (size_t i = settlement.begin; i < settlement.end; ++i) {
+		if (this->alive[i]) {
+			return i;
+		}
+	}
+
+	return population_batch::npos;
+}
+
+population_unit_key population_batch::get_entry_key(const size_t index) const
+{
+	return population_unit_key(this->types[index], this->employment_types[index]);
+}
+
+void population_batch::create_entry(settlement_state &settlement, const population_unit_key &key, const int64_t population)
+{
+	//the settlement being processed is always the last one, so its entries stay contiguous
+	assert_throw(settlement.end == this->types.size());
+
+	this->types.push_back(key.type);
+	this->employment_types.push_back(key.employment_type);
+	this->populations.push_back(population);
+	this->alive.push_back(1);
+
+	settlement.end = this->types.size();
+	settlement.population += population;
+}
+
+void population_batch::remove_entry(settlement_state &settlement, const size_t index)
+{
+	settlement.population -= this->populations[index];
+	this->alive[index] = 0;
+}
+
+void population_batch::change_entry_population(settlement_state &settlement, const population_unit_key &key, const int64_t change)
+{
+	const size_t index = this->find_entry(settlement, key);
+	if (index != population_batch::npos) {
+		this->change_entry_population(settlement, index, change);
+		return;
+	}
+
+	if (change > 0) {
+		this->create_entry(settlement, key, change);
+	}
+}
+
+void population_batch::change_entry_population(settlement_state &settlement, const size_t index, const int64_t change)
+{
+	this->populations[index] += change;
+	settlement.population += change;
+
+	if (this->populations[index] <= 0) {
+		this->remove_entry(settlement, index);
+	}
+}
+
+void population_batch::change_entry_to_type(settlement_state &settlement, const population_unit_key &key, const population_type *population_type, const int64_t quantity)
+{
+	population_unit_key new_key = key;
+	this->change_entry_population(settlement, key, -quantity);
+
+	new_key.type = population_type;
+	this->change_entry_population(settlement, new_key, quantity);
+}
+
+void population_batch::move_to_employment(settlement_state &settlement, const population_unit_key &key, const employment_type *employment_type, const int64_t quantity)
+{
+	population_unit_key new_key = key;
+	this->change_entry_population(settlement, key, -quantity);
+
+	new_key.employment_type = employment_type;
+	this->change_entry_population(settlement, new_key, quantity);
+}
+
+void population_batch::move_to_unemployment(settlement_state &settlement, const population_unit_key &key, const int64_t quantity)
+{
+	this->move_to_employment(settlement, key, nullptr, quantity);
+}
+
+int population_batch::get_employment_capacity(const settlement_state &settlement, const employment_type *employment_type) const
+{
+	for (const auto &[capacity_employment_type, capacity] : settlement.employment_capacities) {
+		if (capacity_employment_type == employment_type) {
+			return capacity;
+		}
+	}
+
+	return 0;
+}
+
+int64_t population_batch::get_employment_workforce(const settlement_state &settlement, const employment_type *employment_type) const
+{
+	int64_t workforce = 0;
+
+	for (size_t i = settlement.begin; i < settlement.end; ++i) {
+		if (this->alive[i] && this->employment_types[i] == employment_type) {
+			workforce += this->populations[i];
+		}
+	}
+
+	return workforce;
+}
+
+void population_batch::do_population_growth(settlement_state &settlement)
+{
+	const int64_t population_growth_capacity = settlement.population_capacity - settlement.population;
+
+	if (population_growth_capacity == 0) {
+		return;
+	}
+
+	//get the settlement's population proportion for each entry, in permyriad
+	this->entry_permyriads.clear();
+	for (size_t i = settlement.begin; i < settlement.end; ++i) {
+		if (this->alive[i]) {
+			this->entry_permyriads.emplace_back(i, this->populations[i] * 10000 / settlement.population);
+		}
+	}
+
+	int64_t remaining_population_growth_capacity = population_growth_capacity;
+
+	for (const auto &[index, permyriad] : this->entry_permyriads) {
+		const int64_t entry_growth_capacity = population_growth_capacity * permyriad / 10000;
+
+		if (entry_growth_capacity == 0) {
+			continue;
+		}
+
+		population_unit_key key = this->get_entry_key(index);
+
+		if (entry_growth_capacity > 0 && !key.type->is_growable()) {
+			key.type = settlement.default_population_type;
+			key.employment_type = nullptr;
+		}
+
+		const int64_t entry_growth = population_unit::calculate_population_growth_quantity(entry_growth_capacity, this->populations[index]);
+
+		if (key.type != nullptr) {
+			this->change_entry_population(settlement, key, entry_growth);
+		}
+
+		remaining_population_growth_capacity -= entry_growth_capacity;
+	}
+
+	//if there is any remaining population growth capacity, apply it to the default population class if positive, or subtract from existing entries if negative
+	if (remaining_population_growth_capacity > 0) {
+		const int64_t growth = population_unit::calculate_population_growth_quantity(remaining_population_growth_capacity, 0);
+
+		if (settlement.default_population_type != nullptr) {
+			this->change_entry_population(settlement, population_unit_key(settlement.default_population_type, nullptr), growth);
+		}
+	} else if (remaining_population_growth_capacity < 0) {
+		const size_t index = this->find_first_entry(settlement);
+
+		if (index != population_batch::npos) {
+			const int64_t change = population_unit::calculate_population_growth_quantity(remaining_population_growth_capacity, this->populations[index]);
+			this->change_entry_population(settlement, index, change);
+		}
+	}
+}
+
+void population_batch::do_population_promotion(settlement_state &settlement)
+{
+	this->entry_indexes.clear();
+
+	for (size_t i = settlement.begin; i < settlement.end; ++i) {
+		if (!this->alive[i]) {
+			continue;
+		}
+
+		if (this->types[i]->get_population_class()->get_promotion_targets().empty()) {
+			continue;
+		}
+
+		if (this->employment_types[i] == nullptr) {
+			//can only promote here within employment; promoting when becoming employed is handled in the available employment check
+			continue;
+		}
+
+		this->entry_indexes.push_back(i);
+	}
+
+	for (const size_t index : this->entry_indexes) {
+		const employment_type *employment_type = this->employment_types[index];
+
+		if (!this->alive[index]) {
+			continue;
+		}
+
+		for (const population_class *promotion_class : this->types[index]->get_population_class()->get_promotion_targets()) {
+			if (!vector::contains(employment_type->get_employees(), promotion_class)) {
+				continue;
+			}
+
+			const population_type *promotion_type = settlement.get_class_population_type(promotion_class);
+			if (promotion_type == nullptr) {
+				continue;
+			}
+
+			const int64_t available_capacity = this->get_employment_capacity(settlement, employment_type) - this->get_employment_workforce(settlement, employment_type) + this->populations[index];
+
+			if (available_capacity <= 0) {
+				continue;
+			}
+
+			const int64_t promotion_quantity = population_unit::calculate_growth_quantity(available_capacity, this->populations[index], true);
+			const bool removed_entry = promotion_quantity >= this->populations[index];
+
+			this->change_entry_to_type(settlement, this->get_entry_key(index), promotion_type, promotion_quantity);
+
+			if (removed_entry) {
+				break;
+			}
+		}
+	}
+}
+
+void population_batch::do_population_demotion(settlement_state &settlement)
+{
+	this->entry_indexes.clear();
+
+	for (size_t i = settlement.begin; i < settlement.end; ++i) {
+		if (!this->alive[i]) {
+			continue;
+		}
+
+		const population_class *population_class = this->types[i]->get_population_class();
+
+		if (population_class->get_demotion_targets().empty()) {
+			continue;
+		}
+
+		if (this->employment_types[i] != nullptr || population_class->can_have_unemployment()) {
+			continue;
+		}
+
+		this->entry_indexes.push_back(i);
+	}
+
+	for (const size_t index : this->entry_indexes) {
+		if (!this->alive[index]) {
+			continue;
+		}
+
+		for (const population_class *demotion_class : this->types[index]->get_population_class()->get_demotion_targets()) {
+			const population_type *demotion_type = settlement.get_class_population_type(demotion_class);
+			if (demotion_type == nullptr) {
+				continue;
+			}
+
+			const int64_t demotion_quantity = population_unit::calculate_growth_quantity(this->populations[index], this->populations[index], true);
+			const bool removed_entry = demotion_quantity >= this->populations[index];
+
+			this->change_entry_to_type(settlement, this->get_entry_key(index), demotion_type, demotion_quantity);
+
+			if (removed_entry) {
+				break;
+			}
+		}
+	}
+}
+
+void population_batch::check_employment_validity(settlement_state &settlement)
+{
+	this->entry_indexes.clear();
+
+	for (size_t i = settlement.begin; i < settlement.end; ++i) {
+		if (!this->alive[i] || this->employment_types[i] == nullptr) {
+			continue;
+		}
+
+		if (this->get_employment_capacity(settlement, this->employment_types[i]) == 0) {
+			this->entry_indexes.push_back(i);
+		}
+	}
+
+	//move the population of entries with an invalid employment to that of their corresponding unemployed entry
+	for (const size_t index : this->entry_indexes) {
+		this->move_to_unemployment(settlement, this->get_entry_key(index), this->populations[index]);
+	}
+}
+
+void population_batch::check_employment_capacities(settlement_state &settlement)
+{
+	//check if any employment workforce is over capacity and if so, reduce it to capacity
+	for (const auto &[employment_type, capacity] : settlement.employment_capacities) {
+		int64_t surplus_workforce = this->get_employment_workforce(settlement, employment_type) - capacity;
+
+		if (surplus_workforce <= 0) {
+			continue;
+		}
+
+		this->entry_indexes.clear();
+		for (size_t i = settlement.begin; i < settlement.end; ++i) {
+			if (this->alive[i] && this->employment_types[i] == employment_type) {
+				this->entry_indexes.push_back(i);
+			}
+		}
+
+		for (const size_t index : this->entry_indexes) {
+			const int64_t unemployed_change = std::min(surplus_workforce, this->populations[index]);
+			this->move_to_unemployment(settlement, this->get_entry_key(index), unemployed_change);
+			surplus_workforce -= unemployed_change;
+
+			if (surplus_workforce <= 0) {
+				break;
+			}
+		}
+	}
+}
+
+void population_batch::check_available_employment(settlement_state &settlement)
+{
+	for (const auto &[employment_type, capacity] : settlement.employment_capacities) {
+		int64_t available_capacity = capacity - this->get_employment_workforce(settlement, employment_type);
+
+		if (available_capacity <= 0) {
+			continue;
+		}
+
+		this->entry_indexes.clear();
+		for (size_t i = settlement.begin; i < settlement.end; ++i) {
+			if (!this->alive[i] || this->employment_types[i] != nullptr) {
+				continue;
+			}
+
+			if (!employment_type->can_employ(this->types[i]->get_population_class())) {
+				continue;
+			}
+
+			this->entry_indexes.push_back(i);
+		}
+
+		for (const size_t index : this->entry_indexes) {
+			const population_class *population_class = this->types[index]->get_population_class();
+
+			//whether the entry taking up this employment would entail a promotion
+			const bool is_promotion_employment = !vector::contains(employment_type->get_employees(), population_class);
+
+			population_unit_key key = this->get_entry_key(index);
+
+			int64_t employed_change = std::min(available_capacity, this->populations[index]);
+
+			if (is_promotion_employment) {
+				key.type = nullptr;
+
+				for (const wyrmgus::population_class *employee_class : employment_type->get_employees()) {
+					if (!vector::contains(population_class->get_promotion_targets(), employee_class)) {
+						continue;
+					}
+
+					const population_type *employee_type = settlement.get_class_population_type(employee_class);
+					if (employee_type == nullptr) {
+						continue;
+					}
+
+					key.type = employee_type;
+					break;
+				}
+
+				if (key.type == nullptr) {
+					//this is a promotion-based employment, but no actual promotion type is available
+					continue;
+				}
+
+				employed_change = population_unit::calculate_growth_quantity(available_capacity, this->populations[index], true);
+				this->change_entry_to_type(settlement, this->get_entry_key(index), key.type, employed_change);
+			}
+
+			this->move_to_employment(settlement, key, employment_type, employed_change);
+			available_capacity -= employed_change;
+
+			if (available_capacity <= 0) {
+				break;
+			}
+		}
+	}
+}
+
+}
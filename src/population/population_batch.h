@@ -0,0 +1,122 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#pragma once
+
+#include "population/population_unit_key.h"
+
+namespace wyrmgus {
+
+class employment_type;
+class population_class;
+class population_type;
+class site;
+class site_game_data;
+
+//runs the half-minute population simulation for a group of settlements on flat arrays, with an entry per (settlement, population type, employment type), instead of on the population unit objects
+//the settlements are simulated one after another, as in the per-settlement code, so that the synced random numbers are drawn in the same order; the results are written back to the population unit objects once per settlement, at the end
+class population_batch final
+{
+public:
+	static constexpr size_t npos = static_cast<size_t>(-1);
+
+	//the state of a settlement which its population simulation depends on
+	struct settlement_data final
+	{
+		int64_t population = 0;
+		int64_t population_capacity = 0;
+		const population_type *default_population_type = nullptr;
+		std::function<const population_type *(const population_class *)> get_class_population_type;
+		std::vector<std::pair<const employment_type *, int>> employment_capacities;
+		std::vector<std::pair<population_unit_key, int64_t>> population_units;
+	};
+
+	static settlement_data get_settlement_data(const site_game_data *game_data);
+
+	void process_settlements(const std::vector<const site *> &settlements);
+
+	//move the workforce of employments which no longer have any capacity to unemployment
+	void process_employment_validity(site_game_data *game_data);
+
+	//move the workforce of employments which are over capacity to unemployment
+	void process_employment_capacities(site_game_data *game_data);
+
+	//run the half-minute simulation for a settlement, returning its resulting population units
+	std::vector<std::pair<population_unit_key, int64_t>> simulate_settlement(const settlement_data &data);
+
+private:
+	struct settlement_state final
+	{
+		site_game_data *game_data = nullptr;
+		int64_t population_capacity = 0;
+		const population_type *default_population_type = nullptr;
+		std::function<const population_type *(const population_class *)> get_class_population_type;
+		std::vector<std::pair<const employment_type *, int>> employment_capacities;
+		size_t begin = 0;
+		size_t end = 0;
+		int64_t population = 0;
+	};
+
+	void clear();
+	settlement_state &load_settlement(const settlement_data &data, site_game_data *game_data);
+	void simulate_settlement(settlement_state &settlement);
+	std::vector<std::pair<population_unit_key, int64_t>> get_population_units(const settlement_state &settlement) const;
+	void apply_settlement(const settlement_state &settlement);
+
+	size_t find_entry(const settlement_state &settlement, const population_unit_key &key) const;
+	size_t find_first_entry(const settlement_state &settlement) const;
+	population_unit_key get_entry_key(const size_t index) const;
+	void create_entry(settlement_state &settlement, const population_unit_key &key, const int64_t population);
+	void remove_entry(settlement_state &settlement, const size_t index);
+	void change_entry_population(settlement_state &settlement, const population_unit_key &key, const int64_t change);
+	void change_entry_population(settlement_state &settlement, const size_t index, const int64_t change);
+	void change_entry_to_type(settlement_state &settlement, const population_unit_key &key, const population_type *population_type, const int64_t quantity);
+	void move_to_employment(settlement_state &settlement, const population_unit_key &key, const employment_type *employment_type, const int64_t quantity);
+	void move_to_unemployment(settlement_state &settlement, const population_unit_key &key, const int64_t quantity);
+	int get_employment_capacity(const settlement_state &settlement, const employment_type *employment_type) const;
+	int64_t get_employment_workforce(const settlement_state &settlement, const employment_type *employment_type) const;
+
+	void do_population_growth(settlement_state &settlement);
+	void do_population_promotion(settlement_state &settlement);
+	void do_population_demotion(settlement_state &settlement);
+	void check_employment_validity(settlement_state &settlement);
+	void check_employment_capacities(settlement_state &settlement);
+	void check_available_employment(settlement_state &settlement);
+
+	std::vector<settlement_state> settlements;
+
+	//the entries of each settlement are contiguous, in the order of its population units; removed entries are kept until the results are written back, so that indexes stay valid
+	std::vector<const population_type *> types;
+	std::vector<const employment_type *> employment_types;
+	std::vector<int64_t> populations;
+	std::vector<uint8_t> alive;
+
+	std::vector<size_t> entry_indexes; //buffer for the entries selected by a step
+	std::vector<std::pair<size_t, int64_t>> entry_permyriads; //buffer for the population growth step
+};
+
+}
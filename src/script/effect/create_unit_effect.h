@@ -195,7 +195,7 @@ public:
 			}
 
 			if (this->ttl != 0) {
-				unit->TTL = GameCycle + this->ttl;
+				unit->set_ttl(GameCycle + this->ttl);
 			}
 		}
 	}
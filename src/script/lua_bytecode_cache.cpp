@@ -0,0 +1,177 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "script/lua_bytecode_cache.h"
+
+#include "parameters.h"
+#include "script.h"
+#include "util/log_util.h"
+#include "util/path_util.h"
+
+namespace wyrmgus {
+
+static int write_bytecode_chunk(lua_State *l, const void *data, size_t size, void *output)
+{
+	Q_UNUSED(l)
+
+	static_cast<std::string *>(output)->append(static_cast<const char *>(data), size);
+	return 0;
+}
+
+int lua_bytecode_cache::load_buffer(lua_State *l, const std::string &file, const std::string &content, bool &cache_hit) const
+{
+	cache_hit = false;
+
+	if (!this->is_file_cacheable(file)) {
+		return luaL_loadbuffer(l, content.c_str(), content.size(), file.c_str());
+	}
+
+	const uint64_t content_hash = lua_bytecode_cache::get_hash(content);
+	const std::filesystem::path cache_filepath = this->get_cache_filepath(file);
+
+	std::string bytecode;
+	if (this->read_cached_bytecode(cache_filepath, content_hash, bytecode)) {
+		if (luaL_loadbuffer(l, bytecode.c_str(), bytecode.size(), file.c_str()) == 0) {
+			cache_hit = true;
+			return 0;
+		}
+
+		//the cached bytecode could not be loaded, e.g. because it was compiled by another Lua version, so compile the script again
+		lua_pop(l, 1);
+	}
+
+	const int status = luaL_loadbuffer(l, content.c_str(), content.size(), file.c_str());
+
+	if (status == 0) {
+		this->write_cached_bytecode(l, cache_filepath, content_hash);
+	}
+
+	return status;
+}
+
+uint64_t lua_bytecode_cache::get_hash(const std::string_view &data)
+{
+	//64-bit FNV-1a, which is stable across runs and platforms, unlike std::hash
+	uint64_t hash = 14695981039346656037ull;
+
+	for (const char c : data) {
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+std::filesystem::path lua_bytecode_cache::get_cache_filepath(const std::string &file) const
+{
+	std::array<char, 17> filename{};
+	snprintf(filename.data(), filename.size(), "%016llx", static_cast<unsigned long long>(lua_bytecode_cache::get_hash(file)));
+
+	return parameters::get()->GetUserDirectory() / "cache" / "lua" / (std::string(filename.data()) + ".luac");
+}
+
+bool lua_bytecode_cache::is_file_cacheable(const std::string &file) const
+{
+	const std::string user_directory = path::to_string(parameters::get()->GetUserDirectory());
+
+	return user_directory.empty() || !file.starts_with(user_directory);
+}
+
+bool lua_bytecode_cache::read_cached_bytecode(const std::filesystem::path &cache_filepath, const uint64_t content_hash, std::string &bytecode) const
+{
+	std::ifstream ifstream(cache_filepath, std::ios::binary);
+
+	if (!ifstream) {
+		return false;
+	}
+
+	std::array<char, lua_bytecode_cache::magic.size()> file_magic{};
+	uint64_t file_content_hash = 0;
+
+	ifstream.read(file_magic.data(), file_magic.size());
+	ifstream.read(reinterpret_cast<char *>(&file_content_hash), sizeof(file_content_hash));
+
+	if (!ifstream || std::string_view(file_magic.data(), file_magic.size()) != lua_bytecode_cache::magic || file_content_hash != content_hash) {
+		return false;
+	}
+
+	bytecode.assign(std::istreambuf_iterator<char>(ifstream), std::istreambuf_iterator<char>());
+
+	return !bytecode.empty();
+}
+
+void lua_bytecode_cache::write_cached_bytecode(lua_State *l, const std::filesystem::path &cache_filepath, const uint64_t content_hash) const
+{
+	std::string bytecode;
+
+#if LUA_VERSION_NUM >= 503
+	const int status = lua_dump(l, write_bytecode_chunk, &bytecode, 0);
+#else
+	const int status = lua_dump(l, write_bytecode_chunk, &bytecode);
+#endif
+
+	if (status != 0 || bytecode.empty()) {
+		return;
+	}
+
+	std::error_code error_code;
+	std::filesystem::create_directories(cache_filepath.parent_path(), error_code);
+
+	if (error_code) {
+		log::log_error("Failed to create the Lua bytecode cache directory \"" + path::to_string(cache_filepath.parent_path()) + "\": " + error_code.message());
+		return;
+	}
+
+	//write to a temporary file first, so that an interrupted write never leaves a truncated cache file behind
+	std::filesystem::path temp_filepath = cache_filepath;
+	temp_filepath += ".tmp";
+
+	{
+		std::ofstream ofstream(temp_filepath, std::ios::binary | std::ios::trunc);
+
+		if (!ofstream) {
+			return;
+		}
+
+		ofstream.write(lua_bytecode_cache::magic.data(), lua_bytecode_cache::magic.size());
+		ofstream.write(reinterpret_cast<const char *>(&content_hash), sizeof(content_hash));
+		ofstream.write(bytecode.data(), bytecode.size());
+
+		if (!ofstream) {
+			return;
+		}
+	}
+
+	std::filesystem::rename(temp_filepath, cache_filepath, error_code);
+
+	if (error_code) {
+		std::filesystem::remove(temp_filepath, error_code);
+	}
+}
+
+}
@@ -0,0 +1,56 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "util/singleton.h"
+
+struct lua_State;
+
+namespace wyrmgus {
+
+//a cache of compiled Lua chunks, stored in the user directory and keyed by the script's path and the hash of its content, so that unchanged scripts don't need to be compiled again at every launch
+class lua_bytecode_cache final : public singleton<lua_bytecode_cache>
+{
+public:
+	static constexpr std::string_view magic = "WYRMLUAC";
+
+	//load a Lua chunk from the content of a file, using its cached bytecode if it is up to date, and updating the cache otherwise; like luaL_loadbuffer, returns 0 and pushes the chunk on success, or an error code and pushes the error message on failure
+	int load_buffer(lua_State *l, const std::string &file, const std::string &content, bool &cache_hit) const;
+
+private:
+	static uint64_t get_hash(const std::string_view &data);
+
+	std::filesystem::path get_cache_filepath(const std::string &file) const;
+
+	//whether compiled chunks of the file should be cached; files in the user directory, such as saved games, change too often to be worth it
+	bool is_file_cacheable(const std::string &file) const;
+
+	bool read_cached_bytecode(const std::filesystem::path &cache_filepath, const uint64_t content_hash, std::string &bytecode) const;
+	void write_cached_bytecode(lua_State *l, const std::filesystem::path &cache_filepath, const uint64_t content_hash) const;
+};
+
+}
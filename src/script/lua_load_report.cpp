@@ -0,0 +1,70 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "script/lua_load_report.h"
+
+namespace wyrmgus {
+
+void lua_load_report::print(const std::string &filename) const
+{
+	if (this->file_loads.empty()) {
+		return;
+	}
+
+	std::chrono::steady_clock::duration total_duration = std::chrono::steady_clock::duration::zero();
+	size_t cache_hit_count = 0;
+
+	for (const file_load &load : this->file_loads) {
+		total_duration += load.duration;
+
+		if (load.cache_hit) {
+			++cache_hit_count;
+		}
+	}
+
+	fprintf(stdout, "Lua load times for \"%s\": %.1f ms for %zu files (%zu compiled, %zu from the bytecode cache)\n", filename.c_str(), std::chrono::duration<double, std::milli>(total_duration).count(), this->file_loads.size(), this->file_loads.size() - cache_hit_count, cache_hit_count);
+
+	std::vector<const file_load *> sorted_loads;
+	for (const file_load &load : this->file_loads) {
+		sorted_loads.push_back(&load);
+	}
+
+	const size_t printed_count = std::min(sorted_loads.size(), lua_load_report::max_printed_files);
+
+	std::partial_sort(sorted_loads.begin(), sorted_loads.begin() + printed_count, sorted_loads.end(), [](const file_load *lhs, const file_load *rhs) {
+		return lhs->duration > rhs->duration;
+	});
+
+	for (size_t i = 0; i < printed_count; ++i) {
+		const file_load *load = sorted_loads[i];
+		const double milliseconds = std::chrono::duration<double, std::milli>(load->duration).count();
+		fprintf(stdout, "\t%s: %.1f ms%s\n", load->file.c_str(), milliseconds, load->cache_hit ? " (cached)" : "");
+	}
+}
+
+}
@@ -0,0 +1,118 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "util/singleton.h"
+
+namespace wyrmgus {
+
+//accumulates the time spent loading each Lua file, for finding the scripts which slow down startup the most
+class lua_load_report final : public singleton<lua_load_report>
+{
+public:
+	static constexpr size_t max_printed_files = 20;
+
+	struct file_load final
+	{
+		std::string file;
+		std::chrono::steady_clock::duration duration{}; //excludes the time spent loading the files loaded by this one
+		bool cache_hit = false;
+	};
+
+	void clear()
+	{
+		this->file_loads.clear();
+	}
+
+	void record(const std::string &file, const std::chrono::steady_clock::duration duration, const bool cache_hit)
+	{
+		file_load load;
+		load.file = file;
+		load.duration = duration;
+		load.cache_hit = cache_hit;
+		this->file_loads.push_back(std::move(load));
+	}
+
+	void push_nested_load()
+	{
+		this->nested_load_durations.push_back(std::chrono::steady_clock::duration::zero());
+	}
+
+	//pops the nested load, adding its total duration to that of the enclosing one, and returns the time spent in the files loaded by it
+	std::chrono::steady_clock::duration pop_nested_load(const std::chrono::steady_clock::duration total_duration)
+	{
+		const std::chrono::steady_clock::duration children_duration = this->nested_load_durations.back();
+		this->nested_load_durations.pop_back();
+
+		if (!this->nested_load_durations.empty()) {
+			this->nested_load_durations.back() += total_duration;
+		}
+
+		return children_duration;
+	}
+
+	//print the total load time, the bytecode cache statistics and the slowest files
+	void print(const std::string &filename) const;
+
+private:
+	std::vector<file_load> file_loads;
+	std::vector<std::chrono::steady_clock::duration> nested_load_durations;
+};
+
+//times the loading of a Lua file in the scope it is created in
+class lua_file_load_timer final
+{
+public:
+	explicit lua_file_load_timer(const std::string &file)
+		: file(file), start(std::chrono::steady_clock::now())
+	{
+		lua_load_report::get()->push_nested_load();
+	}
+
+	~lua_file_load_timer()
+	{
+		const std::chrono::steady_clock::duration total_duration = std::chrono::steady_clock::now() - this->start;
+		const std::chrono::steady_clock::duration children_duration = lua_load_report::get()->pop_nested_load(total_duration);
+
+		lua_load_report::get()->record(this->file, total_duration - children_duration, this->cache_hit);
+	}
+
+	lua_file_load_timer(const lua_file_load_timer &other) = delete;
+	lua_file_load_timer &operator =(const lua_file_load_timer &other) = delete;
+
+	void set_cache_hit(const bool cache_hit)
+	{
+		this->cache_hit = cache_hit;
+	}
+
+private:
+	const std::string &file;
+	const std::chrono::steady_clock::time_point start;
+	bool cache_hit = false;
+};
+
+}
@@ -28,16 +28,33 @@
 
 #include "sound/sample.h"
 
+#include "sound/sample_cache.h"
 #include "util/path_util.h"
 
 namespace wyrmgus {
 
-void sample::load()
+sample::~sample()
+{
+	if (this->cache != nullptr) {
+		this->cache->remove_sample(this);
+	}
+
+	this->unload();
+}
+
+Mix_Chunk *sample::decode(const std::filesystem::path &filepath)
 {
-	this->chunk = Mix_LoadWAV(path::to_string(this->filepath).c_str());
-	if (this->chunk == nullptr) {
-		throw std::runtime_error("Failed to decode audio file \"" + this->filepath.string() + "\": " + std::string(Mix_GetError()));
+	Mix_Chunk *chunk = Mix_LoadWAV(path::to_string(filepath).c_str());
+	if (chunk == nullptr) {
+		throw std::runtime_error("Failed to decode audio file \"" + filepath.string() + "\": " + std::string(Mix_GetError()));
 	}
+
+	return chunk;
+}
+
+void sample::load()
+{
+	this->set_chunk(sample::decode(this->filepath));
 }
 
 }
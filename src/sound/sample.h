@@ -31,6 +31,8 @@
 
 namespace wyrmgus {
 
+class sample_cache;
+
 /**
 **  RAW samples.
 */
@@ -44,9 +46,11 @@ public:
 		}
 	}
 
-	~sample()
+	~sample();
+
+	const std::filesystem::path &get_filepath() const
 	{
-		this->unload();
+		return this->filepath;
 	}
 
 	bool is_loaded() const
@@ -54,8 +58,17 @@ public:
 		return this->chunk != nullptr;
 	}
 
+	//decode an audio file, without affecting any sample; can be called from any thread
+	static Mix_Chunk *decode(const std::filesystem::path &filepath);
+
 	void load();
 
+	void set_chunk(Mix_Chunk *chunk)
+	{
+		this->unload();
+		this->chunk = chunk;
+	}
+
 	void unload()
 	{
 		if (!this->is_loaded()) {
@@ -66,6 +79,16 @@ public:
 		this->chunk = nullptr;
 	}
 
+	sample_cache *get_cache() const
+	{
+		return this->cache;
+	}
+
+	void set_cache(sample_cache *cache)
+	{
+		this->cache = cache;
+	}
+
 	virtual int Read(void *buf, int len)
 	{
 		Q_UNUSED(buf)
@@ -92,6 +115,7 @@ public:
 private:
 	std::filesystem::path filepath;
 	Mix_Chunk *chunk = nullptr; //sample buffer
+	sample_cache *cache = nullptr; //the sample cache managing the sample, if any
 };
 
 }
@@ -0,0 +1,424 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "sound/sample_cache.h"
+
+#include "database/preferences.h"
+#include "sound/sample.h"
+#include "sound/sound.h"
+#include "sound/sound_server.h"
+#include "sound/unitsound.h"
+#include "unit/unit.h"
+#include "unit/unit_manager.h"
+#include "unit/unit_type.h"
+#include "util/exception_util.h"
+#include "util/log_util.h"
+
+#pragma warning(push, 0)
+#include <SDL_mixer.h>
+#pragma warning(pop)
+
+namespace wyrmgus {
+
+sample_cache::sample_cache()
+{
+}
+
+sample_cache::~sample_cache()
+{
+	this->stop_worker_thread();
+
+	for (const decoded_sample &decoded_sample : this->decoded_samples) {
+		if (decoded_sample.chunk != nullptr) {
+			Mix_FreeChunk(decoded_sample.chunk);
+		}
+	}
+
+	//the samples keep their decoded data, but must no longer refer to the cache
+	for (sample *sample : this->lru_samples) {
+		sample->set_cache(nullptr);
+	}
+
+	for (sample *sample : this->queued_samples) {
+		sample->set_cache(nullptr);
+	}
+
+	for (sample *sample : this->failed_samples) {
+		sample->set_cache(nullptr);
+	}
+}
+
+Mix_Chunk *sample_cache::request_sample(sample *sample, const bool synchronous)
+{
+	this->process_decoded_samples();
+
+	if (sample->is_loaded()) {
+		this->touch_sample(sample);
+		++this->hit_count;
+		return sample->get_chunk();
+	}
+
+	if (this->failed_samples.contains(sample)) {
+		return nullptr;
+	}
+
+	if (!synchronous) {
+		++this->miss_count;
+		this->queue_sample(sample, true);
+		return nullptr;
+	}
+
+	++this->stall_count;
+
+	Mix_Chunk *chunk = nullptr;
+
+	try {
+		chunk = wyrmgus::sample::decode(sample->get_filepath());
+	} catch (const std::exception &exception) {
+		exception::report(exception);
+		this->failed_samples.insert(sample);
+		sample->set_cache(this);
+		return nullptr;
+	}
+
+	//if the sample is also queued for decoding in the worker thread, the result of that will be discarded when it is processed
+	this->add_loaded_sample(sample, chunk);
+
+	return chunk;
+}
+
+void sample_cache::prefetch_sample(sample *sample)
+{
+	this->queue_sample(sample, false);
+}
+
+void sample_cache::prefetch_sound(const sound *sound)
+{
+	if (sound == nullptr) {
+		return;
+	}
+
+	for (const std::unique_ptr<sample> &sample : sound->get_samples()) {
+		this->prefetch_sample(sample.get());
+	}
+
+	this->prefetch_sound(sound->get_first_sound());
+	this->prefetch_sound(sound->get_second_sound());
+}
+
+void sample_cache::prefetch_unit_type_sounds(const unit_type *unit_type)
+{
+	const unit_sound_set *sound_set = unit_type->get_sound_set();
+
+	if (sound_set == nullptr) {
+		return;
+	}
+
+	sound_set->for_each_sound([this](const sound *sound) {
+		this->prefetch_sound(sound);
+	});
+}
+
+void sample_cache::prefetch_map_unit_sounds()
+{
+	if (!SoundEnabled()) {
+		return;
+	}
+
+	std::set<const unit_type *> unit_types;
+
+	for (const CUnit *unit : unit_manager::get()->get_units()) {
+		unit_types.insert(unit->Type);
+	}
+
+	for (const unit_type *unit_type : unit_types) {
+		this->prefetch_unit_type_sounds(unit_type);
+	}
+}
+
+void sample_cache::remove_sample(sample *sample)
+{
+	if (sample->get_cache() != this) {
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+
+		this->condition.wait(lock, [this, sample]() {
+			return this->decoding_sample != sample;
+		});
+
+		std::erase(this->decode_queue, sample);
+
+		std::erase_if(this->decoded_samples, [sample](const decoded_sample &decoded_sample) {
+			if (decoded_sample.target_sample != sample) {
+				return false;
+			}
+
+			if (decoded_sample.chunk != nullptr) {
+				Mix_FreeChunk(decoded_sample.chunk);
+			}
+
+			return true;
+		});
+	}
+
+	this->queued_samples.erase(sample);
+	this->failed_samples.erase(sample);
+
+	const auto find_iterator = this->lru_iterators.find(sample);
+	if (find_iterator != this->lru_iterators.end()) {
+		this->memory_usage -= static_cast<size_t>(sample->get_length());
+		this->lru_samples.erase(find_iterator->second);
+		this->lru_iterators.erase(find_iterator);
+	}
+
+	sample->set_cache(nullptr);
+}
+
+void sample_cache::clear()
+{
+	this->stop_worker_thread();
+
+	for (decoded_sample &decoded_sample : this->decoded_samples) {
+		if (decoded_sample.chunk != nullptr) {
+			Mix_FreeChunk(decoded_sample.chunk);
+		}
+	}
+
+	this->decoded_samples.clear();
+	this->decode_queue.clear();
+
+	for (sample *sample : this->lru_samples) {
+		sample->unload();
+		sample->set_cache(nullptr);
+	}
+
+	for (sample *sample : this->queued_samples) {
+		sample->set_cache(nullptr);
+	}
+
+	for (sample *sample : this->failed_samples) {
+		sample->set_cache(nullptr);
+	}
+
+	this->queued_samples.clear();
+	this->failed_samples.clear();
+	this->lru_samples.clear();
+	this->lru_iterators.clear();
+	this->memory_usage = 0;
+}
+
+void sample_cache::start_worker_thread()
+{
+	if (this->worker_thread.joinable()) {
+		return;
+	}
+
+	this->stopping = false;
+	this->worker_thread = std::thread(&sample_cache::run_worker_thread, this);
+}
+
+void sample_cache::stop_worker_thread()
+{
+	if (!this->worker_thread.joinable()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+
+	this->condition.notify_all();
+	this->worker_thread.join();
+}
+
+void sample_cache::run_worker_thread()
+{
+	while (true) {
+		decoded_sample result;
+		std::filesystem::path filepath;
+
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+
+			this->condition.wait(lock, [this]() {
+				return this->stopping || !this->decode_queue.empty();
+			});
+
+			if (this->stopping) {
+				return;
+			}
+
+			result.target_sample = this->decode_queue.front();
+			this->decode_queue.pop_front();
+			this->decoding_sample = result.target_sample;
+			filepath = result.target_sample->get_filepath();
+		}
+
+		try {
+			result.chunk = sample::decode(filepath);
+		} catch (const std::exception &exception) {
+			result.error_message = exception.what();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->decoded_samples.push_back(std::move(result));
+			this->decoding_sample = nullptr;
+		}
+
+		//wake up the main thread if it is waiting for the decoding of this sample to finish, in order to remove it
+		this->condition.notify_all();
+	}
+}
+
+void sample_cache::queue_sample(sample *sample, const bool priority)
+{
+	if (sample->is_loaded() || this->failed_samples.contains(sample)) {
+		return;
+	}
+
+	sample->set_cache(this);
+
+	if (this->queued_samples.contains(sample)) {
+		if (priority) {
+			std::lock_guard<std::mutex> lock(this->mutex);
+
+			//move the sample to the front of the queue, if it is not being decoded already
+			const auto find_iterator = std::find(this->decode_queue.begin(), this->decode_queue.end(), sample);
+			if (find_iterator != this->decode_queue.end()) {
+				this->decode_queue.erase(find_iterator);
+				this->decode_queue.push_front(sample);
+			}
+		}
+
+		return;
+	}
+
+	this->queued_samples.insert(sample);
+	this->start_worker_thread();
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		if (priority) {
+			this->decode_queue.push_front(sample);
+		} else {
+			this->decode_queue.push_back(sample);
+		}
+	}
+
+	this->condition.notify_all();
+}
+
+void sample_cache::process_decoded_samples()
+{
+	std::vector<decoded_sample> samples;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		if (this->decoded_samples.empty()) {
+			return;
+		}
+
+		samples.swap(this->decoded_samples);
+	}
+
+	for (const decoded_sample &decoded_sample : samples) {
+		sample *sample = decoded_sample.target_sample;
+		this->queued_samples.erase(sample);
+
+		if (!decoded_sample.error_message.empty()) {
+			log::log_error(decoded_sample.error_message);
+			this->failed_samples.insert(sample);
+			continue;
+		}
+
+		if (sample->is_loaded()) {
+			//already loaded synchronously
+			Mix_FreeChunk(decoded_sample.chunk);
+			continue;
+		}
+
+		this->add_loaded_sample(sample, decoded_sample.chunk);
+	}
+}
+
+void sample_cache::add_loaded_sample(sample *sample, Mix_Chunk *chunk)
+{
+	sample->set_chunk(chunk);
+	this->touch_sample(sample);
+	this->enforce_memory_budget();
+}
+
+void sample_cache::touch_sample(sample *sample)
+{
+	const auto find_iterator = this->lru_iterators.find(sample);
+
+	if (find_iterator != this->lru_iterators.end()) {
+		this->lru_samples.splice(this->lru_samples.begin(), this->lru_samples, find_iterator->second);
+		return;
+	}
+
+	sample->set_cache(this);
+	this->lru_samples.push_front(sample);
+	this->lru_iterators[sample] = this->lru_samples.begin();
+	this->memory_usage += static_cast<size_t>(sample->get_length());
+}
+
+void sample_cache::enforce_memory_budget()
+{
+	const size_t memory_budget = this->get_memory_budget();
+
+	for (auto iterator = this->lru_samples.end(); iterator != this->lru_samples.begin() && this->memory_usage > memory_budget;) {
+		--iterator;
+
+		sample *lru_sample = *iterator;
+
+		//never unload the most recently used sample, which may be about to be played, nor samples which are playing
+		if (iterator == this->lru_samples.begin() || SampleIsPlaying(lru_sample)) {
+			continue;
+		}
+
+		this->memory_usage -= static_cast<size_t>(lru_sample->get_length());
+		this->lru_iterators.erase(lru_sample);
+		lru_sample->unload();
+		iterator = this->lru_samples.erase(iterator);
+	}
+}
+
+size_t sample_cache::get_memory_budget() const
+{
+	return static_cast<size_t>(std::max(preferences::get()->get_sound_cache_size(), 1)) * 1024 * 1024;
+}
+
+}
@@ -0,0 +1,129 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "util/singleton.h"
+
+struct Mix_Chunk;
+
+namespace wyrmgus {
+
+class sample;
+class sound;
+class unit_type;
+
+//manages the decoded data of sound effect samples: samples are decoded in a worker thread, and the least recently played ones are unloaded when the decoded data exceeds the memory budget set in the preferences
+//all functions must be called from the main thread, except for those of the worker thread itself
+class sample_cache final : public singleton<sample_cache>
+{
+public:
+	sample_cache();
+	~sample_cache();
+
+	//get the sample's decoded data for playing it; if it has not been decoded yet, it is queued for decoding with priority and null is returned, unless synchronous decoding is requested
+	Mix_Chunk *request_sample(sample *sample, const bool synchronous);
+
+	//queue a sample for decoding, so that it is ready when it is first played
+	void prefetch_sample(sample *sample);
+	void prefetch_sound(const sound *sound);
+	void prefetch_unit_type_sounds(const unit_type *unit_type);
+
+	//prefetch the sounds of the unit types present on the map
+	void prefetch_map_unit_sounds();
+
+	//remove a sample from the cache, e.g. because it is being destroyed
+	void remove_sample(sample *sample);
+
+	//unload all samples managed by the cache, and stop the worker thread
+	void clear();
+
+	//integrate the samples decoded by the worker thread into the cache; this is also done whenever a sample is requested
+	void process_decoded_samples();
+
+	size_t get_memory_usage() const
+	{
+		return this->memory_usage;
+	}
+
+	uint64_t get_hit_count() const
+	{
+		return this->hit_count;
+	}
+
+	//the amount of requests for samples which were not ready yet, and thus could not be played
+	uint64_t get_miss_count() const
+	{
+		return this->miss_count;
+	}
+
+	//the amount of requests for which the sample had to be decoded synchronously
+	uint64_t get_stall_count() const
+	{
+		return this->stall_count;
+	}
+
+private:
+	void start_worker_thread();
+	void stop_worker_thread();
+	void run_worker_thread();
+
+	void queue_sample(sample *sample, const bool priority);
+
+	void add_loaded_sample(sample *sample, Mix_Chunk *chunk);
+	void touch_sample(sample *sample);
+	void enforce_memory_budget();
+	size_t get_memory_budget() const;
+
+private:
+	struct decoded_sample final
+	{
+		wyrmgus::sample *target_sample = nullptr;
+		Mix_Chunk *chunk = nullptr;
+		std::string error_message;
+	};
+
+	//state shared with the worker thread, guarded by the mutex
+	std::thread worker_thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<sample *> decode_queue;
+	sample *decoding_sample = nullptr;
+	std::vector<decoded_sample> decoded_samples;
+	bool stopping = false;
+
+	//state only accessed by the main thread
+	std::set<sample *> queued_samples; //samples in the decode queue, or being decoded
+	std::set<sample *> failed_samples; //samples which failed to decode, and should not be tried again
+	std::list<sample *> lru_samples; //loaded samples, with the most recently played first
+	std::map<sample *, std::list<sample *>::iterator> lru_iterators;
+	size_t memory_usage = 0;
+	uint64_t hit_count = 0;
+	uint64_t miss_count = 0;
+	uint64_t stall_count = 0;
+};
+
+}
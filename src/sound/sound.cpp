@@ -32,9 +32,12 @@
 #include "character.h"
 #include "database/defines.h"
 #include "iolib.h"
+#include "map/map.h"
 #include "missile.h"
 #include "player/civilization.h"
 #include "sound/sample.h"
+#include "sound/sample_cache.h"
+#include "sound/sound_event_manager.h"
 #include "sound/sound_server.h"
 #include "sound/unit_sound_type.h"
 #include "spell/status_effect.h"
@@ -287,13 +290,15 @@ void PlayUnitSound(const CUnit *unit, const wyrmgus::unit_sound_type unit_sound_
 		return;
 	}
 
-	int channel = PlaySample(ChooseSample(sound, selection, source), &source);
-	if (channel == -1) {
-		return;
-	}
-	SetChannelVolume(channel, volume);
-	SetChannelStereo(channel, CalculateStereo(*unit));
-	SetChannelVoiceGroup(channel, unit_sound_type);
+	sound_event event;
+	event.sample = ChooseSample(sound, selection, source);
+	event.origin = source;
+	event.tile_pos = unit->tilePos;
+	event.volume = volume;
+	event.stereo = CalculateStereo(*unit);
+	event.voice = unit_sound_type;
+	event.category = get_unit_sound_type_sound_event_category(unit_sound_type);
+	sound_event_manager::get()->submit(event);
 }
 
 /**
@@ -328,12 +333,13 @@ void PlayUnitSound(const CUnit *unit, wyrmgus::sound *sound)
 		return;
 	}
 
-	int channel = PlaySample(ChooseSample(sound, false, source));
-	if (channel == -1) {
-		return;
-	}
-	SetChannelVolume(channel, volume);
-	SetChannelStereo(channel, CalculateStereo(*unit));
+	sound_event event;
+	event.sample = ChooseSample(sound, false, source);
+	event.tile_pos = unit->tilePos;
+	event.volume = volume;
+	event.stereo = CalculateStereo(*unit);
+	event.category = sound_event_category::effect;
+	sound_event_manager::get()->submit(event);
 }
 
 /**
@@ -359,12 +365,13 @@ void PlayMissileSound(const Missile &missile, wyrmgus::sound *sound)
 		return;
 	}
 
-	int channel = PlaySample(ChooseSample(sound, false, source));
-	if (channel == -1) {
-		return;
-	}
-	SetChannelVolume(channel, volume);
-	SetChannelStereo(channel, stereo);
+	sound_event event;
+	event.sample = ChooseSample(sound, false, source);
+	event.tile_pos = CMap::get()->map_pixel_pos_to_tile_pos(missile.position);
+	event.volume = volume;
+	event.stereo = stereo;
+	event.category = sound_event_category::missile;
+	sound_event_manager::get()->submit(event);
 }
 
 /**
@@ -531,6 +538,8 @@ void sound::initialize()
 void sound::unload()
 {
 	for (const std::unique_ptr<sample> &sample : this->samples) {
+		sample_cache::get()->remove_sample(sample.get());
+
 		if (sample->is_loaded()) {
 			sample->unload();
 		}
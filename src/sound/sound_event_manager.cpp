@@ -0,0 +1,156 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "sound/sound_event_manager.h"
+
+#include "sound/sample.h"
+#include "sound/sound_server.h"
+
+namespace wyrmgus {
+
+sound_event_category get_unit_sound_type_sound_event_category(const unit_sound_type unit_sound_type)
+{
+	switch (unit_sound_type) {
+		case unit_sound_type::dying:
+			return sound_event_category::dying;
+		case unit_sound_type::hit:
+		case unit_sound_type::miss:
+		case unit_sound_type::fire_missile:
+		case unit_sound_type::used:
+			return sound_event_category::effect;
+		case unit_sound_type::step:
+		case unit_sound_type::none:
+			return sound_event_category::ambient;
+		default:
+			return sound_event_category::voice;
+	}
+}
+
+QPoint sound_event::get_coalesce_area() const
+{
+	if (this->tile_pos.x() < 0 || this->tile_pos.y() < 0) {
+		return QPoint(-1, -1);
+	}
+
+	return QPoint(this->tile_pos.x() / sound_event_manager::coalesce_area_size, this->tile_pos.y() / sound_event_manager::coalesce_area_size);
+}
+
+void sound_event_manager::submit(const sound_event &event)
+{
+	if (event.sample == nullptr) {
+		return;
+	}
+
+	++this->submitted_count;
+	this->pending_events.push_back(event);
+}
+
+void sound_event_manager::flush()
+{
+	++this->flush_count;
+
+	std::erase_if(this->sample_starts, [this](const auto &pair) {
+		return (this->flush_count - pair.second.flush) > sound_event_manager::coalesce_flushes;
+	});
+
+	if (this->pending_events.empty()) {
+		return;
+	}
+
+	std::vector<sound_event> events;
+	events.swap(this->pending_events);
+
+	std::stable_sort(events.begin(), events.end(), [](const sound_event &lhs, const sound_event &rhs) {
+		return lhs.get_priority() > rhs.get_priority();
+	});
+
+	for (const sound_event &event : events) {
+		//events for a sample which has been started recently in the same area are coalesced with it, as overlapping identical samples only add to the mixing cost; since the events are sorted by priority, the loudest one of identical events in the same frame is the one which is played
+		const QPoint coalesce_area = event.get_coalesce_area();
+		const auto find_iterator = this->sample_starts.find(std::make_tuple(event.sample, coalesce_area.x(), coalesce_area.y()));
+		if (find_iterator != this->sample_starts.end() && ChannelIsPlayingSample(find_iterator->second.channel, event.sample)) {
+			++this->coalesced_count;
+			continue;
+		}
+
+		if (!this->try_play_event(event)) {
+			++this->culled_count;
+		}
+	}
+}
+
+void sound_event_manager::clear()
+{
+	this->pending_events.clear();
+	this->sample_starts.clear();
+}
+
+bool sound_event_manager::try_play_event(const sound_event &event)
+{
+	Origin origin = event.origin;
+
+	//don't speak if already speaking
+	if (is_voice_unit_sound_type(event.voice) && UnitSoundIsPlaying(&origin)) {
+		return false;
+	}
+
+	const int priority = event.get_priority();
+
+	if (CountPrioritizedChannels() >= sound_event_manager::max_voices) {
+		int lowest_priority = -1;
+		const int lowest_priority_channel = FindLowestPriorityChannel(lowest_priority);
+
+		if (lowest_priority_channel == -1 || lowest_priority >= priority) {
+			return false;
+		}
+
+		StopChannel(lowest_priority_channel);
+		++this->stolen_count;
+	}
+
+	//the sample is played without waiting for it to be decoded, so that it doesn't cause stutters in the middle of the game
+	const int channel = PlaySample(event.sample, origin.Base != nullptr ? &origin : nullptr, false);
+	if (channel == -1) {
+		return false;
+	}
+
+	SetChannelVolume(channel, event.volume);
+	SetChannelStereo(channel, event.stereo);
+	SetChannelPriority(channel, priority);
+
+	if (event.voice != unit_sound_type::none) {
+		SetChannelVoiceGroup(channel, event.voice);
+	}
+
+	const QPoint coalesce_area = event.get_coalesce_area();
+	this->sample_starts[std::make_tuple(event.sample, coalesce_area.x(), coalesce_area.y())] = sample_start{ this->flush_count, channel };
+
+	return true;
+}
+
+}
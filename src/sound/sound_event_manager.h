@@ -0,0 +1,131 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "sound/sound.h"
+#include "sound/unit_sound_type.h"
+#include "util/singleton.h"
+
+namespace wyrmgus {
+
+class sample;
+
+//the categories of sound events, from the least to the most important
+enum class sound_event_category {
+	ambient, //e.g. steps
+	missile,
+	effect, //e.g. hits
+	dying,
+	voice,
+
+	count
+};
+
+extern sound_event_category get_unit_sound_type_sound_event_category(const unit_sound_type unit_sound_type);
+
+//a request to play a unit or missile sound
+struct sound_event final
+{
+	wyrmgus::sample *sample = nullptr;
+	Origin origin = {nullptr, 0};
+	QPoint tile_pos = QPoint(-1, -1); //the position of the event's source on the map
+	int volume = 0;
+	int stereo = 0;
+	unit_sound_type voice = unit_sound_type::none; //the voice group of the event
+	sound_event_category category = sound_event_category::ambient;
+
+	int get_priority() const
+	{
+		return static_cast<int>(this->category) * (MaxSampleVolume + 1) + this->volume;
+	}
+
+	//get the area of the map within which events for the same sample are coalesced
+	QPoint get_coalesce_area() const;
+};
+
+//sits in front of the sound server for unit and missile sounds: the events submitted during a frame are played together, with identical samples being coalesced, and only the most important events being played when the voice budget is exceeded
+class sound_event_manager final : public singleton<sound_event_manager>
+{
+public:
+	//the maximum amount of channels used by sound events, leaving the rest to interface and dialogue sounds
+	static constexpr int max_voices = 32;
+
+	//the amount of flushes after a sample was started during which further events for the same sample in the same area are coalesced with it
+	static constexpr uint64_t coalesce_flushes = 3;
+
+	//the size in tiles of the areas within which events are coalesced, so that identical sounds from different parts of the map are still heard
+	static constexpr int coalesce_area_size = 8;
+
+	void submit(const sound_event &event);
+
+	//play the pending events
+	void flush();
+
+	void clear();
+
+	uint64_t get_submitted_count() const
+	{
+		return this->submitted_count;
+	}
+
+	uint64_t get_coalesced_count() const
+	{
+		return this->coalesced_count;
+	}
+
+	//the amount of events which were not played due to the voice budget, or because the unit was already speaking
+	uint64_t get_culled_count() const
+	{
+		return this->culled_count;
+	}
+
+	//the amount of playing events which were stopped to make room for more important ones
+	uint64_t get_stolen_count() const
+	{
+		return this->stolen_count;
+	}
+
+private:
+	bool try_play_event(const sound_event &event);
+
+private:
+	std::vector<sound_event> pending_events;
+	struct sample_start final
+	{
+		uint64_t flush = 0;
+		int channel = -1;
+	};
+
+	std::map<std::tuple<const wyrmgus::sample *, int, int>, sample_start> sample_starts; //the flush and channel in which each sample was last started, per coalescing area
+	uint64_t flush_count = 0;
+	uint64_t submitted_count = 0;
+	uint64_t coalesced_count = 0;
+	uint64_t culled_count = 0;
+	uint64_t stolen_count = 0;
+};
+
+}
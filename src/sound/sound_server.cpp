@@ -37,9 +37,12 @@
 #include "iolib.h"
 #include "player/civilization.h"
 #include "player/faction.h"
+#include "profiler.h"
 #include "sound/music.h"
 #include "sound/sample.h"
+#include "sound/sample_cache.h"
 #include "sound/sound.h"
+#include "sound/sound_event_manager.h"
 #include "sound/unit_sound_type.h"
 #include "unit/unit.h"
 //Wyrmgus start
@@ -61,9 +64,10 @@ static bool SoundInitialized;    /// is sound initialized
 
 /// Channels for sound effects and unit speech
 struct SoundChannel {
-	std::unique_ptr<Origin> Unit;          /// pointer to unit, who plays the sound, if any
+	std::optional<Origin> Unit;          /// unit who plays the sound, if any
 	wyrmgus::unit_sound_type Voice;  /// Voice group of this channel (for identifying voice types)
 	void (*FinishedCallback)(int channel); /// Callback for when a sample finishes playing
+	int Priority = -1;                     /// Priority of the sound event played in this channel, -1 if the channel is not played by the sound event manager
 };
 
 static constexpr int MaxChannels = 64; //how many channels are supported
@@ -89,6 +93,14 @@ bool SampleIsPlaying(const wyrmgus::sample *sample)
 	return false;
 }
 
+/**
+**  Check if the channel is playing the sample
+*/
+bool ChannelIsPlayingSample(int channel, const wyrmgus::sample *sample)
+{
+	return sample->is_loaded() && Mix_GetChunk(channel) == sample->get_chunk() && Mix_Playing(channel);
+}
+
 bool UnitSoundIsPlaying(Origin *origin)
 {
 	for (int i = 0; i < MaxChannels; ++i) {
@@ -120,6 +132,7 @@ static void ChannelFinished(int channel)
 
 	Channels[channel].Unit.reset();
 	Channels[channel].Voice = unit_sound_type::none;
+	Channels[channel].Priority = -1;
 
 	if (dialogue::has_sound_channel(channel)) {
 		dialogue::remove_sound_channel(channel);
@@ -204,6 +217,62 @@ void SetChannelVoiceGroup(int channel, const wyrmgus::unit_sound_type voice)
 }
 //Wyrmgus end
 
+/**
+**  Set the priority of the sound event played in a channel
+**
+**  @param channel   Channel to set
+**  @param priority  Priority of the sound event
+*/
+void SetChannelPriority(int channel, int priority)
+{
+	if (channel < 0 || channel >= MaxChannels) {
+		return;
+	}
+
+	Channels[channel].Priority = priority;
+}
+
+/**
+**  Count the channels which are playing sound events
+*/
+int CountPrioritizedChannels()
+{
+	int count = 0;
+
+	for (int i = 0; i < MaxChannels; ++i) {
+		if (Channels[i].Priority != -1 && Mix_Playing(i)) {
+			++count;
+		}
+	}
+
+	return count;
+}
+
+/**
+**  Find the channel playing the sound event with the lowest priority
+**
+**  @param priority  Set to the priority of the sound event played in the channel
+**
+**  @return          The channel, or -1 if no channel is playing a sound event
+*/
+int FindLowestPriorityChannel(int &priority)
+{
+	int channel = -1;
+
+	for (int i = 0; i < MaxChannels; ++i) {
+		if (Channels[i].Priority == -1 || !Mix_Playing(i)) {
+			continue;
+		}
+
+		if (channel == -1 || Channels[i].Priority < priority) {
+			channel = i;
+			priority = Channels[i].Priority;
+		}
+	}
+
+	return channel;
+}
+
 /**
 **  Set the channel's callback for when a sound finishes playing
 **
@@ -255,36 +324,36 @@ std::unique_ptr<wyrmgus::sample> LoadSample(const std::filesystem::path &filepat
 /**
 **  Play a sound sample
 **
-**  @param sample  Sample to play
+**  @param sample       Sample to play
+**  @param synchronous  Whether to decode the sample if it has not been decoded yet; otherwise the sample is queued for decoding, and is not played
 **
-**  @return        Channel number, -1 for error
+**  @return             Channel number, -1 for error
 */
-int PlaySample(wyrmgus::sample *sample, Origin *origin)
+int PlaySample(wyrmgus::sample *sample, Origin *origin, const bool synchronous)
 {
 	int channel = -1;
 
 	if (SoundEnabled() && preferences::get()->are_sound_effects_enabled() && sample != nullptr) {
-		try {
-			if (!sample->is_loaded()) {
-				sample->load();
-			}
-		} catch (const std::exception &exception) {
-			exception::report(exception);
+		Mix_Chunk *chunk = sample_cache::get()->request_sample(sample, synchronous);
+		if (chunk == nullptr) {
+			return -1;
+		}
+
+		channel = Mix_PlayChannel(-1, chunk, 0);
+		if (channel == -1) {
+			//no free channel
 			return -1;
 		}
 
-		channel = Mix_PlayChannel(-1, sample->get_chunk(), 0);
 		Mix_Volume(channel, preferences::get()->get_sound_effects_volume() * MIX_MAX_VOLUME / MaxVolume);
 
 		Channels[channel].FinishedCallback = nullptr;
 		Channels[channel].Voice = unit_sound_type::none;
+		Channels[channel].Priority = -1;
 		Channels[channel].Unit.reset();
 
 		if (origin && origin->Base) {
-			auto source = std::make_unique<Origin>();
-			source->Base = origin->Base;
-			source->Id = origin->Id;
-			Channels[channel].Unit = std::move(source);
+			Channels[channel].Unit = *origin;
 		}
 	}
 
@@ -422,11 +491,22 @@ void InitSound()
 	for (int i = 0; i < MaxChannels; ++i) {
 		Channels[i].Unit.reset();
 		Channels[i].Voice = unit_sound_type::none;
+		Channels[i].Priority = -1;
 	}
 
 	//now we're ready for the callback to run
 	Mix_ResumeMusic();
 	Mix_Resume(-1);
+
+	profiler::get()->register_counter_group("Sound events", { "sent", "merged", "culled", "stolen" }, []() -> std::array<int64_t, 4> {
+		const sound_event_manager *event_manager = sound_event_manager::get();
+		return { static_cast<int64_t>(event_manager->get_submitted_count()), static_cast<int64_t>(event_manager->get_coalesced_count()), static_cast<int64_t>(event_manager->get_culled_count()), static_cast<int64_t>(event_manager->get_stolen_count()) };
+	});
+
+	profiler::get()->register_counter_group("Sample cache", { "hits", "misses", "stalls", "KB" }, []() -> std::array<int64_t, 4> {
+		const sample_cache *cache = sample_cache::get();
+		return { static_cast<int64_t>(cache->get_hit_count()), static_cast<int64_t>(cache->get_miss_count()), static_cast<int64_t>(cache->get_stall_count()), static_cast<int64_t>(cache->get_memory_usage() / 1024) };
+	});
 }
 
 /**
@@ -438,6 +518,7 @@ void QuitSound()
 		return;
 	}
 
+	sample_cache::get()->clear();
 	sound::unload_all();
 	music::unload_all();
 
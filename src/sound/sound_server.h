@@ -47,6 +47,12 @@ extern int SetChannelStereo(int channel, int stereo);
 /// Set the channel voice group
 extern void SetChannelVoiceGroup(int channel, const wyrmgus::unit_sound_type unit_sound_type);
 //Wyrmgus end
+/// Set the priority of the sound event played in the channel
+extern void SetChannelPriority(int channel, int priority);
+/// Count the channels which are playing sound events
+extern int CountPrioritizedChannels();
+/// Find the channel playing the sound event with the lowest priority
+extern int FindLowestPriorityChannel(int &priority);
 /// Set the channel's callback for when a sound finishes playing
 extern void SetChannelFinishedCallback(int channel, void (*callback)(int channel));
 /// Stop a channel
@@ -58,10 +64,12 @@ extern void StopAllChannels();
 extern bool UnitSoundIsPlaying(Origin *origin);
 /// Check, if this sample is already playing
 extern bool SampleIsPlaying(const wyrmgus::sample *sample);
+/// Check if the channel is playing the sample
+extern bool ChannelIsPlayingSample(int channel, const wyrmgus::sample *sample);
 /// Load a sample
 extern std::unique_ptr<wyrmgus::sample> LoadSample(const std::filesystem::path &filepath);
 /// Play a sample
-extern int PlaySample(wyrmgus::sample *sample, Origin *origin = nullptr);
+extern int PlaySample(wyrmgus::sample *sample, Origin *origin = nullptr, const bool synchronous = true);
 
 /// Increase tension value for the music
 extern void AddMusicTension(int value);
@@ -164,6 +164,40 @@ void unit_sound_set::map_sounds()
 	}
 }
 
+void unit_sound_set::for_each_sound(const std::function<void(const sound *)> &function) const
+{
+	const auto call_function = [&function](const SoundConfig &sound_config) {
+		if (sound_config.Sound != nullptr) {
+			function(sound_config.Sound);
+		}
+	};
+
+	call_function(this->Selected);
+	call_function(this->Acknowledgement);
+	call_function(this->Attack);
+	call_function(this->Idle);
+	call_function(this->Build);
+	call_function(this->Ready);
+	call_function(this->Repair);
+	call_function(this->Hit);
+	call_function(this->Miss);
+	call_function(this->FireMissile);
+	call_function(this->Step);
+	call_function(this->StepDirt);
+	call_function(this->StepGrass);
+	call_function(this->StepGravel);
+	call_function(this->StepMud);
+	call_function(this->StepStone);
+	call_function(this->Used);
+	for (int i = 0; i < MaxCosts; ++i) {
+		call_function(this->Harvest[i]);
+	}
+	call_function(this->Help);
+	for (int i = 0; i <= ANIMATIONS_DEATHTYPES; ++i) {
+		call_function(this->Dead[i]);
+	}
+}
+
 const sound *unit_sound_set::get_sound_for_unit(const unit_sound_type unit_sound_type, const CUnit *unit) const
 {
 	switch (unit_sound_type) {
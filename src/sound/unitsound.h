@@ -71,6 +71,8 @@ public:
 
 	void map_sounds();
 
+	void for_each_sound(const std::function<void(const sound *)> &function) const;
+
 	const sound *get_sound_for_unit(const unit_sound_type unit_sound_type, const CUnit *unit) const;
 
 	SoundConfig Selected;           /// selected by user
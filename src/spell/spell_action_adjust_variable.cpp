@@ -253,6 +253,7 @@ int spell_action_adjust_variable::Cast(CUnit &caster, const spell &, CUnit *targ
 			unit->Variable[i].Increase = this->Var[i].Increase;
 		}
 		unit->Variable[i].Increase += this->Var[i].AddIncrease;
+		unit->register_variable_increases();
 
 		// Value field
 		if (this->Var[i].ModifValue) {
@@ -159,7 +159,7 @@ int spell_action_summon::Cast(CUnit &caster, const spell &spell, CUnit *target,
 			//  set life span. ttl=0 results in a permanent unit.
 			//
 			if (ttl) {
-				target->TTL = GameCycle + ttl;
+				target->set_ttl(GameCycle + ttl);
 			}
 
 			// Insert summoned unit to AI force so it will help them in battle
@@ -89,7 +89,7 @@ int Spell_SpawnPortal::Cast(CUnit &caster, const wyrmgus::spell &, CUnit *, cons
 								  //Wyrmgus end
 		portal->Summoned = 1;
 	}
-	portal->TTL = GameCycle + ttl;
+	portal->set_ttl(GameCycle + ttl);
 	//  Goal is used to link to destination circle of power
 	caster.Goal = portal;
 	//FIXME: setting destination circle of power should use mana
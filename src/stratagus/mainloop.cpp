@@ -29,6 +29,7 @@
 #include "stratagus.h"
 
 #include "actions.h"
+#include "ai/ai_scheduler.h"
 #include "character.h"
 #include "commands.h"
 #include "database/defines.h"
@@ -47,10 +48,12 @@
 #include "map/terrain_type.h"
 #include "missile.h"
 #include "network/network.h"
+#include "network/network_statistics.h"
 #include "particle.h"
 #include "player/civilization.h"
 #include "player/faction.h"
 #include "player/player.h"
+#include "profiler.h"
 #include "quest/campaign.h"
 //Wyrmgus start
 #include "quest/quest.h"
@@ -66,6 +69,7 @@
 #include "sound/music_player.h"
 #include "sound/music_type.h"
 #include "sound/sound.h"
+#include "sound/sound_event_manager.h"
 #include "sound/sound_server.h"
 #include "time/calendar.h"
 #include "time/time_of_day.h"
@@ -268,6 +272,16 @@ void UpdateDisplay()
 	}
 
 	DrawGuichanWidgets(render_commands);
+
+	if (GameRunning && IsNetworkGame() && network_statistics::get()->is_overlay_enabled()) {
+		network_statistics::get()->draw_overlay(render_commands);
+	}
+
+#ifdef USE_PROFILER
+	if (GameRunning && profiler::get()->is_overlay_enabled()) {
+		profiler::get()->draw_overlay(render_commands);
+	}
+#endif
 	
 	if (CurrentCursorState != CursorState::Rectangle) {
 		DrawCursor(render_commands);
@@ -306,12 +320,32 @@ static boost::asio::awaitable<void> GameLogicLoop()
 			co_await NetworkCommands(); //get network commands
 		}
 
-		TriggersEachCycle(); //handle triggers
-		UnitActions(); //handle units
-		MissileActions(); //handle missiles
-		PlayersEachCycle(); //handle players
+		PROFILE_SCOPE(profiler_stage::game_cycle);
+
+		{
+			PROFILE_SCOPE(profiler_stage::triggers);
+			TriggersEachCycle(); //handle triggers
+		}
+
+		{
+			PROFILE_SCOPE(profiler_stage::unit_actions);
+			UnitActions(); //handle units
+		}
 
-		CMap::get()->do_per_cycle_loop();
+		{
+			PROFILE_SCOPE(profiler_stage::missile_actions);
+			MissileActions(); //handle missiles
+		}
+
+		{
+			PROFILE_SCOPE(profiler_stage::players);
+			PlayersEachCycle(); //handle players
+		}
+
+		{
+			PROFILE_SCOPE(profiler_stage::map);
+			CMap::get()->do_per_cycle_loop();
+		}
 		
 		//
 		// Work todo each second.
@@ -380,6 +414,8 @@ static boost::asio::awaitable<void> GameLogicLoop()
 			PlayersEachMinute(player);
 		}
 		//Wyrmgus end
+
+		ai_scheduler::get()->run_tasks();
 		
 		if (GameCycle > 0) {
 			game::get()->do_cycle();
@@ -403,6 +439,7 @@ static boost::asio::awaitable<void> GameLogicLoop()
 	}
 
 	ParticleManager.update(); // handle particles
+	sound_event_manager::get()->flush(); //play the unit and missile sounds of this cycle
 	CheckMusicFinished(); // Check for next song
 
 	if (FastForwardCycle <= GameCycle || !(GameCycle & 0x3f)) {
@@ -419,6 +456,8 @@ static boost::asio::awaitable<void> GameLogicLoop()
 
 static void DisplayLoop()
 {
+	PROFILE_SCOPE(profiler_stage::display);
+
 	/* update only if screen changed */
 	ValidateOpenGLScreen();
 
@@ -440,6 +479,7 @@ static void DisplayLoop()
 		//FIXME: this might be better placed somewhere at front of the
 		// program, as we now still have a game on the background and
 		// need to go through the game-menu or supply a map file
+		PROFILE_SCOPE(profiler_stage::update_display);
 		UpdateDisplay();
 	}
 }
@@ -64,6 +64,7 @@ void parameters::process()
 		},
 		{ { "d", "data-path" }, "Specify a custom data path.", "data path" },
 		{ { "t", "test-run" }, "Check startup and exit (data files must respect this flag)." },
+		{ { "T", "timing-report" }, "Print the time spent in the stages of script loading, database loading and map generation." },
 		{ { "G", "game-options" }, "Game options passed to game scripts", "game options" },
 		{ { "I", "ip-address" }, "Network address to use", "address" },
 		{ { "l", "no-command-log" }, "Disable command log." },
@@ -149,6 +150,10 @@ void parameters::process()
 		this->test_run = true;
 	}
 
+	if (cmd_parser.isSet("T")) {
+		this->timing_report = true;
+	}
+
 	option = "u";
 	if (cmd_parser.isSet(option)) {
 		this->SetUserDirectory(path::from_string(cmd_parser.value(option).toStdString()));
@@ -45,6 +45,11 @@ public:
 		return this->test_run;
 	}
 
+	bool is_timing_report_enabled() const
+	{
+		return this->timing_report;
+	}
+
 	void SetUserDirectory(const std::filesystem::path &path)
 	{
 		this->user_directory = path;
@@ -64,6 +69,7 @@ public:
 	std::string luaScriptArguments;
 private:
 	bool test_run = false;
+	bool timing_report = false; //whether to print the time spent in loading and map generation stages
 	std::filesystem::path user_directory; //directory containing user settings and data
 };
 
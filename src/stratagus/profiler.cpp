@@ -0,0 +1,291 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "profiler.h"
+
+#include "database/defines.h"
+#include "database/preferences.h"
+#include "parameters.h"
+#include "player/player.h"
+#include "ui/ui.h"
+#include "util/path_util.h"
+#include "video/font.h"
+#include "video/video.h"
+
+namespace wyrmgus {
+
+static thread_local profiler_ring_buffer *thread_ring_buffer = nullptr;
+
+std::string_view get_profiler_stage_name(const profiler_stage stage)
+{
+	switch (stage) {
+		case profiler_stage::game_cycle:
+			return "GameLogicLoop";
+		case profiler_stage::triggers:
+			return "TriggersEachCycle";
+		case profiler_stage::unit_actions:
+			return "UnitActions";
+		case profiler_stage::missile_actions:
+			return "MissileActions";
+		case profiler_stage::players:
+			return "PlayersEachCycle";
+		case profiler_stage::ai:
+			return "AI";
+		case profiler_stage::map:
+			return "CMap::do_per_cycle_loop";
+		case profiler_stage::display:
+			return "DisplayLoop";
+		case profiler_stage::update_display:
+			return "UpdateDisplay";
+		case profiler_stage::render:
+			return "render_context::run";
+		default:
+			break;
+	}
+
+	throw std::runtime_error("Invalid profiler stage: \"" + std::to_string(static_cast<int>(stage)) + "\".");
+}
+
+void profiler_ring_buffer::copy_samples(std::vector<profiler_sample> &output) const
+{
+	const uint64_t end_index = this->write_index.load(std::memory_order_acquire);
+	const uint64_t readable_count = std::min<uint64_t>(end_index, capacity);
+
+	for (uint64_t i = end_index - readable_count; i < end_index; ++i) {
+		const profiler_slot &slot = this->slots[i % capacity];
+
+		const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		if (sequence != i * 2 + 2) {
+			//the slot has already been overwritten, or is being overwritten
+			continue;
+		}
+
+		const int64_t start = slot.start.load(std::memory_order_relaxed);
+		const uint64_t data = slot.data.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+			continue;
+		}
+
+		profiler_sample sample;
+		sample.start = start;
+		sample.duration = static_cast<int64_t>(data >> 16);
+		sample.stage = static_cast<profiler_stage>((data >> 8) & 0xFF);
+		sample.player = static_cast<int8_t>(data & 0xFF);
+		output.push_back(sample);
+	}
+}
+
+profiler::profiler() : epoch(std::chrono::steady_clock::now())
+{
+}
+
+profiler_ring_buffer &profiler::get_thread_ring_buffer()
+{
+	if (thread_ring_buffer == nullptr) {
+		std::lock_guard<std::mutex> lock(this->ring_buffers_mutex);
+
+		auto ring_buffer = std::make_unique<profiler_ring_buffer>(static_cast<int>(this->ring_buffers.size()));
+		thread_ring_buffer = ring_buffer.get();
+		this->ring_buffers.push_back(std::move(ring_buffer));
+	}
+
+	return *thread_ring_buffer;
+}
+
+std::vector<std::pair<int, std::vector<profiler_sample>>> profiler::collect_samples() const
+{
+	std::vector<std::pair<int, std::vector<profiler_sample>>> thread_samples;
+
+	std::lock_guard<std::mutex> lock(this->ring_buffers_mutex);
+
+	for (const std::unique_ptr<profiler_ring_buffer> &ring_buffer : this->ring_buffers) {
+		std::vector<profiler_sample> samples;
+		ring_buffer->copy_samples(samples);
+		thread_samples.emplace_back(ring_buffer->get_thread_index(), std::move(samples));
+	}
+
+	return thread_samples;
+}
+
+std::vector<profiler_stage_statistics> profiler::get_stage_statistics(const std::chrono::nanoseconds window) const
+{
+	const int64_t window_start = this->get_now() - window.count();
+
+	std::map<std::pair<profiler_stage, int>, std::vector<int64_t>> stage_durations;
+
+	for (const auto &[thread_index, samples] : this->collect_samples()) {
+		for (const profiler_sample &sample : samples) {
+			if (sample.start < window_start) {
+				continue;
+			}
+
+			stage_durations[std::make_pair(sample.stage, static_cast<int>(sample.player))].push_back(sample.duration);
+		}
+	}
+
+	std::vector<profiler_stage_statistics> statistics;
+
+	for (auto &[key, durations] : stage_durations) {
+		std::sort(durations.begin(), durations.end());
+
+		const auto get_percentile = [&durations](const double percentile) {
+			const size_t index = std::min(durations.size() - 1, static_cast<size_t>(percentile * durations.size()));
+			return static_cast<double>(durations[index]) / 1000000.;
+		};
+
+		profiler_stage_statistics stage_statistics;
+		stage_statistics.stage = key.first;
+		stage_statistics.player = key.second;
+		stage_statistics.sample_count = durations.size();
+		stage_statistics.p50 = get_percentile(0.5);
+		stage_statistics.p95 = get_percentile(0.95);
+		stage_statistics.p99 = get_percentile(0.99);
+		stage_statistics.max = static_cast<double>(durations.back()) / 1000000.;
+		statistics.push_back(std::move(stage_statistics));
+	}
+
+	return statistics;
+}
+
+void profiler::register_counter_group(const std::string &name, const std::array<std::string, 4> &counter_names, std::function<std::array<int64_t, 4>()> &&get_values)
+{
+	std::erase_if(this->counter_groups, [&name](const profiler_counter_group &counter_group) {
+		return counter_group.name == name;
+	});
+
+	this->counter_groups.push_back(profiler_counter_group{ name, counter_names, std::move(get_values) });
+}
+
+void profiler::draw_overlay(std::vector<std::function<void(renderer *)>> &render_commands) const
+{
+	const std::vector<profiler_stage_statistics> statistics = this->get_stage_statistics(profiler::overlay_window);
+
+	font *small_font = defines::get()->get_small_font();
+	const CLabel label(small_font);
+
+	const centesimal_int &scale_factor = preferences::get()->get_scale_factor();
+	const int padding = (4 * scale_factor).to_int();
+	const int line_height = small_font->Height() + (2 * scale_factor).to_int();
+	const int column_width = (48 * scale_factor).to_int();
+	const int name_width = (160 * scale_factor).to_int();
+
+	const int x = UI.MapArea.get_rect().x() + padding * 2;
+	int y = UI.MapArea.get_rect().y() + padding * 2;
+
+	const int width = name_width + column_width * 4 + padding * 2;
+	//the stage rows, plus the header row, and the header and value rows for each counter group
+	const int height = line_height * (static_cast<int>(statistics.size() + this->counter_groups.size() * 2) + 1) + padding * 2;
+	Video.FillTransRectangle(ColorBlack, x, y, width, height, 160, render_commands);
+
+	y += padding;
+
+	const auto draw_row = [&](const std::string &name, const std::array<std::string, 4> &columns) {
+		label.Draw(x + padding, y, name, render_commands);
+
+		for (size_t i = 0; i < columns.size(); ++i) {
+			label.Draw(x + padding + name_width + column_width * static_cast<int>(i), y, columns[i], render_commands);
+		}
+
+		y += line_height;
+	};
+
+	draw_row("Stage (ms)", { "p50", "p95", "p99", "max" });
+
+	const auto format_time = [](const double time) {
+		std::array<char, 16> buffer{};
+		snprintf(buffer.data(), buffer.size(), "%.2f", time);
+		return std::string(buffer.data());
+	};
+
+	for (const profiler_stage_statistics &stage_statistics : statistics) {
+		std::string name(get_profiler_stage_name(stage_statistics.stage));
+
+		if (stage_statistics.player != -1) {
+			name += " (" + CPlayer::Players.at(stage_statistics.player)->get_name() + ")";
+		}
+
+		draw_row(name, { format_time(stage_statistics.p50), format_time(stage_statistics.p95), format_time(stage_statistics.p99), format_time(stage_statistics.max) });
+	}
+
+	for (const profiler_counter_group &counter_group : this->counter_groups) {
+		draw_row(counter_group.name, counter_group.counter_names);
+
+		const std::array<int64_t, 4> values = counter_group.get_values();
+		draw_row("", { std::to_string(values[0]), std::to_string(values[1]), std::to_string(values[2]), std::to_string(values[3]) });
+	}
+}
+
+void profiler::write_trace(const std::filesystem::path &filepath) const
+{
+	std::ofstream ofstream(filepath);
+
+	if (!ofstream) {
+		throw std::runtime_error("Failed to open file \"" + path::to_string(filepath) + "\" for writing the profiler trace.");
+	}
+
+	ofstream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+
+	for (const auto &[thread_index, samples] : this->collect_samples()) {
+		if (!first) {
+			ofstream << ",";
+		}
+		first = false;
+
+		ofstream << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread_index << ",\"args\":{\"name\":\"thread " << thread_index << "\"}}";
+
+		for (const profiler_sample &sample : samples) {
+			//timestamps are written in microseconds, as expected by the trace event format
+			ofstream << ",\n{\"name\":\"" << get_profiler_stage_name(sample.stage) << "\",\"cat\":\"wyrmgus\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread_index;
+			ofstream << ",\"ts\":" << (sample.start / 1000) << "." << std::setw(3) << std::setfill('0') << (sample.start % 1000);
+			ofstream << ",\"dur\":" << (sample.duration / 1000) << "." << std::setw(3) << std::setfill('0') << (sample.duration % 1000);
+
+			if (sample.player != -1) {
+				ofstream << ",\"args\":{\"player\":" << static_cast<int>(sample.player) << "}";
+			}
+
+			ofstream << "}";
+		}
+	}
+
+	ofstream << "\n]}\n";
+}
+
+std::filesystem::path profiler::dump_trace() const
+{
+	const std::filesystem::path filepath = parameters::get()->GetUserDirectory() / ("profiler_trace_" + std::to_string(GameCycle) + ".json");
+
+	this->write_trace(filepath);
+
+	return filepath;
+}
+
+}
@@ -0,0 +1,224 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "util/singleton.h"
+
+namespace wyrmgus {
+
+class renderer;
+
+enum class profiler_stage : uint8_t {
+	game_cycle, //the whole game logic part of a cycle
+	triggers,
+	unit_actions,
+	missile_actions,
+	players,
+	ai, //all of the AI entry points, recorded per player
+	map,
+	display, //the whole display part of a frame
+	update_display,
+	render, //the execution of the render commands, in the render thread
+
+	count
+};
+
+extern std::string_view get_profiler_stage_name(const profiler_stage stage);
+
+//a timed sample of a profiler stage
+struct profiler_sample final
+{
+	int64_t start = 0; //in nanoseconds since the profiler's epoch
+	int64_t duration = 0; //in nanoseconds
+	profiler_stage stage = profiler_stage::count;
+	int8_t player = -1;
+};
+
+//a fixed-size ring buffer of samples, written only by its owning thread
+//each slot is a sequence lock: readers take a snapshot of the samples without blocking the writer, discarding the slots which are overwritten while they are being read
+class profiler_ring_buffer final
+{
+public:
+	static constexpr size_t capacity = 1 << 16;
+
+	explicit profiler_ring_buffer(const int thread_index) : thread_index(thread_index)
+	{
+	}
+
+	int get_thread_index() const
+	{
+		return this->thread_index;
+	}
+
+	void push(const profiler_sample &sample)
+	{
+		const uint64_t index = this->write_index.load(std::memory_order_relaxed);
+		profiler_slot &slot = this->slots[index % capacity];
+
+		//an odd sequence marks the slot as being written
+		slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		slot.start.store(sample.start, std::memory_order_relaxed);
+		slot.data.store(profiler_ring_buffer::pack_sample_data(sample), std::memory_order_relaxed);
+
+		slot.sequence.store(index * 2 + 2, std::memory_order_release);
+		this->write_index.store(index + 1, std::memory_order_release);
+	}
+
+	void copy_samples(std::vector<profiler_sample> &output) const;
+
+private:
+	//pack the duration, stage and player of a sample into a single word
+	static uint64_t pack_sample_data(const profiler_sample &sample)
+	{
+		return (static_cast<uint64_t>(sample.duration) << 16) | (static_cast<uint64_t>(sample.stage) << 8) | static_cast<uint8_t>(sample.player);
+	}
+
+	struct profiler_slot final
+	{
+		std::atomic<uint64_t> sequence = 0; //twice the index of the sample in the slot plus 2 once written, or odd while being written
+		std::atomic<int64_t> start = 0;
+		std::atomic<uint64_t> data = 0;
+	};
+
+	const int thread_index = 0;
+	std::array<profiler_slot, capacity> slots;
+	std::atomic<uint64_t> write_index = 0;
+};
+
+//percentile statistics for a profiler stage, in milliseconds
+struct profiler_stage_statistics final
+{
+	profiler_stage stage = profiler_stage::count;
+	int player = -1;
+	size_t sample_count = 0;
+	double p50 = 0;
+	double p95 = 0;
+	double p99 = 0;
+	double max = 0;
+};
+
+//a row of counters shown in the profiler overlay, registered by the subsystem which owns them
+struct profiler_counter_group final
+{
+	std::string name;
+	std::array<std::string, 4> counter_names;
+	std::function<std::array<int64_t, 4>()> get_values;
+};
+
+//records scoped timings of the engine's per-cycle and per-frame stages into per-thread ring buffers, for display in an overlay and for export as a Chrome trace
+class profiler final : public singleton<profiler>
+{
+public:
+	static constexpr std::chrono::seconds overlay_window = std::chrono::seconds(5);
+
+	profiler();
+
+	int64_t get_now() const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->epoch).count();
+	}
+
+	void record(const profiler_stage stage, const int player, const int64_t start, const int64_t end)
+	{
+		profiler_sample sample;
+		sample.start = start;
+		sample.duration = end - start;
+		sample.stage = stage;
+		sample.player = static_cast<int8_t>(player);
+
+		this->get_thread_ring_buffer().push(sample);
+	}
+
+	bool is_overlay_enabled() const
+	{
+		return this->overlay_enabled;
+	}
+
+	void toggle_overlay()
+	{
+		this->overlay_enabled = !this->overlay_enabled;
+	}
+
+	std::vector<profiler_stage_statistics> get_stage_statistics(const std::chrono::nanoseconds window) const;
+
+	//register a group of counters to be shown in the overlay, replacing any group with the same name; this and the drawing of the overlay happen in the main thread
+	void register_counter_group(const std::string &name, const std::array<std::string, 4> &counter_names, std::function<std::array<int64_t, 4>()> &&get_values);
+
+	void draw_overlay(std::vector<std::function<void(renderer *)>> &render_commands) const;
+
+	//write the recorded samples as a Chrome trace event file, which can be loaded in chrome://tracing or Perfetto
+	void write_trace(const std::filesystem::path &filepath) const;
+
+	std::filesystem::path dump_trace() const;
+
+private:
+	profiler_ring_buffer &get_thread_ring_buffer();
+
+	std::vector<std::pair<int, std::vector<profiler_sample>>> collect_samples() const;
+
+	const std::chrono::steady_clock::time_point epoch;
+	std::vector<std::unique_ptr<profiler_ring_buffer>> ring_buffers;
+	mutable std::mutex ring_buffers_mutex; //only locked when a thread registers its buffer, or when the buffers are read
+	std::atomic<bool> overlay_enabled = false;
+	std::vector<profiler_counter_group> counter_groups;
+};
+
+//times the scope it is created in, recording it as a sample of a profiler stage
+class profiler_scope final
+{
+public:
+	explicit profiler_scope(const profiler_stage stage, const int player = -1)
+		: stage(stage), player(player), start(profiler::get()->get_now())
+	{
+	}
+
+	~profiler_scope()
+	{
+		profiler::get()->record(this->stage, this->player, this->start, profiler::get()->get_now());
+	}
+
+	profiler_scope(const profiler_scope &other) = delete;
+	profiler_scope &operator =(const profiler_scope &other) = delete;
+
+private:
+	const profiler_stage stage;
+	const int player = -1;
+	const int64_t start = 0;
+};
+
+}
+
+#define WYRMGUS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define WYRMGUS_PROFILE_CONCAT(a, b) WYRMGUS_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef USE_PROFILER
+#define PROFILE_SCOPE(...) const wyrmgus::profiler_scope WYRMGUS_PROFILE_CONCAT(profiler_scope_, __LINE__)(__VA_ARGS__)
+#else
+#define PROFILE_SCOPE(...) ((void) 0)
+#endif
@@ -59,6 +59,8 @@
 #include "player/faction_type.h"
 #include "player/player.h"
 #include "population/employment_type.h"
+#include "script/lua_bytecode_cache.h"
+#include "script/lua_load_report.h"
 #include "script/trigger.h"
 #include "spell/spell.h"
 #include "time/timeline.h"
@@ -234,7 +236,11 @@ int LuaLoadFile(const std::string &file, const std::string &strArg)
 		throw std::runtime_error("Failed to load Lua file: \"" + file + "\"");
 	}
 
-	const int status = luaL_loadbuffer(Lua, content.c_str(), content.size(), file.c_str());
+	lua_file_load_timer load_timer(file);
+
+	bool cache_hit = false;
+	const int status = lua_bytecode_cache::get()->load_buffer(Lua, file, content, cache_hit);
+	load_timer.set_cache_hit(cache_hit);
 
 	if (!status) {
 		if (!strArg.empty()) {
@@ -3619,7 +3625,12 @@ void LoadCcl(const std::string &filename, const std::string &luaArgStr)
 	}
 
 	ShowLoadProgress(_("Loading Script \"%s\"..."), name.c_str());
+	lua_load_report::get()->clear();
 	LuaLoadFile(name, luaArgStr);
+	if (parameters::get()->is_timing_report_enabled()) {
+		lua_load_report::get()->print(name);
+	}
+	lua_load_report::get()->clear();
 	CclInConfigFile = 0;
 	LuaGarbageCollect();
 }
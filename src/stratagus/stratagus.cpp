@@ -529,8 +529,21 @@ boost::asio::awaitable<void> stratagusMain(int argc, char **argv)
 	co_await Exit(exit_code);
 }
 
+//log the time taken by a database loading phase, so that startup regressions can be measured
+static void log_database_phase_duration(const char *phase, const std::chrono::steady_clock::time_point start_time)
+{
+	if (!parameters::get()->is_timing_report_enabled()) {
+		return;
+	}
+
+	const std::chrono::milliseconds duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time);
+	fprintf(stdout, "Database phase \"%s\" took %lld ms.\n", phase, static_cast<long long>(duration.count()));
+}
+
 void load_database(const bool initial_definition)
 {
+	const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
 	thread_pool::get()->co_spawn_sync([initial_definition]() -> boost::asio::awaitable<void> {
 		try {
 			co_await database::get()->load(initial_definition);
@@ -540,6 +553,9 @@ void load_database(const bool initial_definition)
 			std::terminate();
 		}
 	});
+
+	//parsing the data files and processing their data for the entries
+	log_database_phase_duration(initial_definition ? "parse and process (initial definition)" : "parse and process", start_time);
 }
 
 void load_defines()
@@ -551,20 +567,29 @@ void load_defines()
 		std::throw_with_nested(std::runtime_error("Error loading preferences."));
 	}
 
+	const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
 	try {
 		database::get()->load_defines();
 	} catch (...) {
 		std::throw_with_nested(std::runtime_error("Error loading defines."));
 	}
+
+	log_database_phase_duration("defines", start_time);
 }
 
 void initialize_database()
 {
+	const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
 	try {
 		database::get()->initialize();
 	} catch (...) {
 		std::throw_with_nested(std::runtime_error("Error initializing database."));
 	}
+
+	//initializing and checking the entries
+	log_database_phase_duration("initialize and check", start_time);
 }
 
 void save_preferences()
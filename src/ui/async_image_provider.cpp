@@ -0,0 +1,170 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "ui/async_image_provider.h"
+
+#include "database/preferences.h"
+#include "util/exception_util.h"
+
+#pragma warning(push, 0)
+#include <QThreadPool>
+#pragma warning(pop)
+
+namespace wyrmgus {
+
+QImage image_provider_cache::find(const std::string &key)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	const auto find_iterator = this->entry_iterators.find(key);
+	if (find_iterator == this->entry_iterators.end()) {
+		return QImage();
+	}
+
+	this->entries.splice(this->entries.begin(), this->entries, find_iterator->second);
+
+	return find_iterator->second->second;
+}
+
+void image_provider_cache::add(const std::string &key, const QImage &image)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	if (this->entry_iterators.contains(key)) {
+		//already added by another request for the same image
+		return;
+	}
+
+	this->entries.emplace_front(key, image);
+	this->entry_iterators[key] = this->entries.begin();
+	this->memory_usage += image.sizeInBytes();
+
+	while (this->memory_usage > image_provider_cache::memory_budget && this->entries.size() > 1) {
+		const std::pair<std::string, QImage> &entry = this->entries.back();
+		this->memory_usage -= entry.second.sizeInBytes();
+		this->entry_iterators.erase(entry.first);
+		this->entries.pop_back();
+	}
+}
+
+void image_provider_cache::clear()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->entries.clear();
+	this->entry_iterators.clear();
+	this->memory_usage = 0;
+}
+
+void image_response_runnable::run()
+{
+	if (*this->canceled) {
+		return;
+	}
+
+	QImage image;
+	QString error_string;
+
+	try {
+		image = image_provider_cache::get()->find(this->cache_key);
+
+		if (image.isNull()) {
+			image = this->create_image();
+
+			if (image.isNull()) {
+				throw std::runtime_error("Image for cache key \"" + this->cache_key + "\" is null.");
+			}
+
+			image_provider_cache::get()->add(this->cache_key, image);
+		}
+	} catch (const std::exception &exception) {
+		exception::report(exception);
+		error_string = QString::fromStdString(exception.what());
+	}
+
+	emit done(image, error_string);
+}
+
+image_response::image_response(const std::string &cache_key, std::function<QImage()> &&create_image)
+{
+	//the runnable is deleted by the thread pool after running; if the response is deleted first, the queued connection is removed with it
+	image_response_runnable *runnable = new image_response_runnable(cache_key, std::move(create_image), this->canceled);
+	connect(runnable, &image_response_runnable::done, this, &image_response::on_done, Qt::QueuedConnection);
+
+	async_image_provider::get_thread_pool()->start(runnable);
+}
+
+void image_response::cancel()
+{
+	*this->canceled = true;
+
+	if (this->is_finished) {
+		return;
+	}
+
+	//the engine still needs the finished signal to clean up a canceled response
+	this->is_finished = true;
+	emit finished();
+}
+
+void image_response::on_done(const QImage &image, const QString &error_string)
+{
+	if (this->is_finished) {
+		//canceled in the meantime
+		return;
+	}
+
+	this->image = image;
+	this->error_string = error_string;
+
+	this->is_finished = true;
+	emit finished();
+}
+
+QThreadPool *async_image_provider::get_thread_pool()
+{
+	static QThreadPool thread_pool;
+	return &thread_pool;
+}
+
+QQuickImageResponse *async_image_provider::requestImageResponse(const QString &id, const QSize &requested_size)
+{
+	Q_UNUSED(requested_size)
+
+	const std::string id_str = id.toStdString();
+
+	//the images depend on the scale factor, so it is part of the cache key
+	const std::string cache_key = this->name + "/" + preferences::get()->get_scale_factor().to_string() + "/" + id_str;
+
+	//capture the creation function rather than the provider, as the provider may be deleted while the image is being created
+	return new image_response(cache_key, [create_image = this->create_image, id_str]() {
+		return create_image(id_str);
+	});
+}
+
+}
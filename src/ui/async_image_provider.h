@@ -0,0 +1,127 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "util/singleton.h"
+
+#pragma warning(push, 0)
+#include <QQuickImageProvider>
+#include <QRunnable>
+#pragma warning(pop)
+
+class QThreadPool;
+
+namespace wyrmgus {
+
+//a least recently used cache of the images created by the asynchronous image providers, keyed by the provider and the request ID
+class image_provider_cache final : public singleton<image_provider_cache>
+{
+public:
+	static constexpr qsizetype memory_budget = 64 * 1024 * 1024;
+
+	QImage find(const std::string &key);
+	void add(const std::string &key, const QImage &image);
+	void clear();
+
+private:
+	std::mutex mutex;
+	std::list<std::pair<std::string, QImage>> entries; //with the most recently used first
+	std::map<std::string, std::list<std::pair<std::string, QImage>>::iterator> entry_iterators;
+	qsizetype memory_usage = 0;
+};
+
+//the task which creates the image for a request in the image provider worker pool; it only holds what it needs to create the image, so that it does not depend on the response or on the provider, either of which may be deleted while it runs
+class image_response_runnable final : public QObject, public QRunnable
+{
+	Q_OBJECT
+
+public:
+	explicit image_response_runnable(const std::string &cache_key, std::function<QImage()> &&create_image, const std::shared_ptr<std::atomic<bool>> &canceled)
+		: cache_key(cache_key), create_image(std::move(create_image)), canceled(canceled)
+	{
+	}
+
+	virtual void run() override;
+
+signals:
+	void done(const QImage &image, const QString &error_string);
+
+private:
+	const std::string cache_key;
+	std::function<QImage()> create_image;
+	const std::shared_ptr<std::atomic<bool>> canceled;
+};
+
+//the response for a request to an asynchronous image provider; the image is created by a runnable in the image provider worker pool, which sends the result to the response through a queued connection
+class image_response final : public QQuickImageResponse
+{
+	Q_OBJECT
+
+public:
+	explicit image_response(const std::string &cache_key, std::function<QImage()> &&create_image);
+
+	virtual QQuickTextureFactory *textureFactory() const override
+	{
+		return QQuickTextureFactory::textureFactoryForImage(this->image);
+	}
+
+	virtual QString errorString() const override
+	{
+		return this->error_string;
+	}
+
+	virtual void cancel() override;
+
+private:
+	void on_done(const QImage &image, const QString &error_string);
+
+	QImage image;
+	QString error_string;
+	const std::shared_ptr<std::atomic<bool>> canceled = std::make_shared<std::atomic<bool>>(false); //shared with the runnable, so that it can skip creating the image
+	bool is_finished = false;
+};
+
+//an image provider which creates its images in a worker pool shared by all such providers, so that loading graphics does not block the thread from which QML requests the images
+class async_image_provider : public QQuickAsyncImageProvider
+{
+public:
+	static QThreadPool *get_thread_pool();
+
+	//the image creation function is called from the worker pool, and should throw an exception on failure; it must not depend on the provider, as requests can still be running when the QML engine deletes it
+	explicit async_image_provider(const std::string &name, QImage(*create_image)(const std::string &id))
+		: name(name), create_image(create_image)
+	{
+	}
+
+	virtual QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requested_size) override final;
+
+private:
+	const std::string name;
+	QImage(*const create_image)(const std::string &id) = nullptr;
+};
+
+}
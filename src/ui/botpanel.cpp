@@ -73,6 +73,7 @@
 #include "translator.h"
 #include "ui/button.h"
 #include "ui/button_cmd.h"
+#include "ui/button_index.h"
 #include "ui/button_level.h"
 #include "ui/cursor.h"
 #include "ui/cursor_type.h"
@@ -116,7 +117,9 @@ void InitButtons()
 			button->Icon.Load();
 		}
 	}
+	button_index::get()->build();
 	CurrentButtons.clear();
+	UI.ButtonPanel.invalidate_allowed_buttons();
 }
 
 /*----------------------------------------------------------------------------
@@ -131,6 +134,8 @@ void CleanButtons()
 	CurrentButtonLevel = nullptr;
 	LastDrawnButtonPopup = nullptr;
 	CurrentButtons.clear();
+	button_index::get()->clear();
+	UI.ButtonPanel.invalidate_allowed_buttons();
 }
 
 /**
@@ -1080,6 +1085,10 @@ void CButtonPanel::Draw(std::vector<std::function<void(renderer *)>> &render_com
 	assert_throw(!Selected.empty());
 	std::string str;
 
+	if (this->allowed_buttons_dirty || this->allowed_buttons_game_cycle != GameCycle || this->allowed_unit_counts.size() != buttons.size()) {
+		this->update_allowed_buttons();
+	}
+
 	//  Draw all buttons.
 	for (size_t i = 0; i < buttons.size(); ++i) {
 		const std::unique_ptr<wyrmgus::button> &button = buttons[i];
@@ -1103,14 +1112,12 @@ void CButtonPanel::Draw(std::vector<std::function<void(renderer *)>> &render_com
 		}
 		//Wyrmgus end
 
-		bool gray = false;
+		const size_t allowed_unit_count = std::min(this->allowed_unit_counts[i], Selected.size());
+		const bool gray = allowed_unit_count < Selected.size();
 		bool cooldownSpell = false;
 		int maxCooldown = 0;
-		for (size_t j = 0; j != Selected.size(); ++j) {
-			if (!IsButtonAllowed(*Selected[j], *button)) {
-				gray = true;
-				break;
-			} else if (button->Action == ButtonCmd::SpellCast
+		for (size_t j = 0; j != allowed_unit_count; ++j) {
+			if (button->Action == ButtonCmd::SpellCast
 				&& (*Selected[j]).get_spell_cooldown_timer(wyrmgus::spell::get_all()[button->Value]) > 0) {
 				assert_throw(spell::get_all()[button->Value]->get_cooldown() > 0);
 				cooldownSpell = true;
@@ -1645,30 +1652,28 @@ int GetButtonCooldownPercent(const CUnit &unit, const wyrmgus::button &buttonact
 */
 static void UpdateButtonPanelMultipleUnits(const std::vector<std::unique_ptr<button>> &buttonActions)
 {
-	std::array<char, 128> unit_ident{};
-	//Wyrmgus start
-	std::vector<std::array<char, 128>> individual_unit_ident;
-	//Wyrmgus end
+	const button_index *index = button_index::get();
+
+	const std::string group_identifier = CPlayer::GetThisPlayer()->get_civilization()->get_identifier() + "-group";
+	const std::vector<const button *> &group_buttons = index->get_identifier_buttons(CurrentButtonLevel, group_identifier);
 
-	sprintf(unit_ident.data(), ",%s-group,", CPlayer::GetThisPlayer()->get_civilization()->get_identifier().c_str());
-	
 	//Wyrmgus start
+	std::vector<const unit_type *> selected_unit_types;
 	for (size_t i = 0; i != Selected.size(); ++i) {
-		std::array<char, 128> ident_array{};
-		sprintf(ident_array.data(), ",%s,", Selected[i]->Type->get_identifier().c_str());
-		individual_unit_ident.push_back(std::move(ident_array));
+		if (!vector::contains(selected_unit_types, Selected[i]->Type)) {
+			selected_unit_types.push_back(Selected[i]->Type);
+		}
 	}
 	//Wyrmgus end
 
-	for (const button *button : button::get_all()) {
-		if (button->get_level() != CurrentButtonLevel) {
-			continue;
-		}
+	//the candidates are the buttons for the civilization's group and those available for the first selected unit type, since a button used by all selected units must be available for that type too
+	const std::vector<const button *> candidate_buttons = index->merge_buttons(group_buttons, index->get_unit_type_buttons(CurrentButtonLevel, selected_unit_types.front()));
 
+	for (const button *button : candidate_buttons) {
 		//Wyrmgus start
 		bool used_by_all = true;
-		for (size_t i = 0; i != Selected.size(); ++i) {
-			if (!strstr(button->UnitMask.c_str(), individual_unit_ident[i].data()) && !vector::contains(button->get_unit_classes(), Selected[i]->Type->get_unit_class())) {
+		for (const unit_type *unit_type : selected_unit_types) {
+			if (!index->is_button_available_for_unit_type(button, unit_type)) {
 				used_by_all = false;
 				break;
 			}
@@ -1676,8 +1681,7 @@ static void UpdateButtonPanelMultipleUnits(const std::vector<std::unique_ptr<but
 		//Wyrmgus end
 		
 		// any unit or unit in list
-		if (button->UnitMask[0] != '*'
-			&& !strstr(button->UnitMask.c_str(), unit_ident.data()) && !used_by_all) {
+		if (!used_by_all && !vector::contains(group_buttons, button)) {
 			continue;
 		}
 
@@ -1714,41 +1718,31 @@ static void UpdateButtonPanelMultipleUnits(const std::vector<std::unique_ptr<but
 */
 static void UpdateButtonPanelSingleUnit(const CUnit &unit, const std::vector<std::unique_ptr<button>> &buttonActions)
 {
-	std::array<char, 128> unit_ident{};
+	const button_index *index = button_index::get();
 
 	//
 	//  FIXME: johns: some hacks for cancel buttons
 	//
-	bool only_cancel_allowed = true;
+	const std::vector<const button *> *candidate_buttons = nullptr;
 	if (unit.CurrentAction() == UnitAction::Built) {
 		// Trick 17 to get the cancel-build button
-		strcpy_s(unit_ident.data(), sizeof(unit_ident), ",cancel-build,");
+		candidate_buttons = &index->get_identifier_buttons(CurrentButtonLevel, "cancel-build");
 	} else if (unit.CurrentAction() == UnitAction::UpgradeTo) {
 		// Trick 17 to get the cancel-upgrade button
-		strcpy_s(unit_ident.data(), sizeof(unit_ident), ",cancel-upgrade,");
+		candidate_buttons = &index->get_identifier_buttons(CurrentButtonLevel, "cancel-upgrade");
 	} else if (unit.CurrentAction() == UnitAction::Research) {
 		if (CurrentButtonLevel != nullptr) {
 			CurrentButtonLevel = nullptr;
 		}
 		// Trick 17 to get the cancel-upgrade button
-		strcpy_s(unit_ident.data(), sizeof(unit_ident), ",cancel-upgrade,");
+		candidate_buttons = &index->get_identifier_buttons(CurrentButtonLevel, "cancel-upgrade");
 	} else {
-		sprintf(unit_ident.data(), ",%s,", unit.Type->get_identifier().c_str());
-		only_cancel_allowed = false;
+		// any unit or unit in list
+		candidate_buttons = &index->get_unit_type_buttons(CurrentButtonLevel, unit.Type);
 	}
-	for (const button *button : button::get_all()) {
-		assert_throw(0 < button->get_pos() && button->get_pos() <= (int)UI.ButtonPanel.Buttons.size());
-
-		// Same level
-		if (button->get_level() != CurrentButtonLevel) {
-			continue;
-		}
 
-		// any unit or unit in list
-		if (button->UnitMask[0] != '*'
-			&& !strstr(button->UnitMask.c_str(), unit_ident.data()) && (only_cancel_allowed || !vector::contains(button->get_unit_classes(), unit.Type->get_unit_class()))) {
-			continue;
-		}
+	for (const button *button : *candidate_buttons) {
+		assert_throw(0 < button->get_pos() && button->get_pos() <= (int)UI.ButtonPanel.Buttons.size());
 		//Wyrmgus start
 //		int allow = IsButtonAllowed(unit, buttonaction);
 		bool allow = true; // check all selected units, as different units of the same type may have different allowed buttons
@@ -1796,6 +1790,8 @@ void CButtonPanel::Update()
 		return;
 	}
 
+	button_index::get()->rebuild_if_outdated();
+
 	CUnit &unit = *Selected[0];
 	// foreign unit
 	//Wyrmgus start
@@ -1814,14 +1810,8 @@ void CButtonPanel::Update()
 		unsigned int potential_neutral_faction_count = 0;
 		unsigned int potential_dynasty_count = 0;
 
-		for (button *button : button::get_all()) {
-			if (button->Action != ButtonCmd::Faction && button->Action != ButtonCmd::PotentialNeutralFaction && button->Action != ButtonCmd::Dynasty && button->Action != ButtonCmd::Buy) {
-				continue;
-			}
-
-			std::array<char, 128> unit_ident{};
-			sprintf(unit_ident.data(), ",%s,", unit.Type->get_identifier().c_str());
-			if (button->UnitMask[0] != '*' && !strstr(button->UnitMask.c_str(), unit_ident.data()) && !vector::contains(button->get_unit_classes(), unit.Type->get_unit_class())) {
+		for (button *button : button_index::get()->get_dynamic_buttons()) {
+			if (!button_index::get()->is_button_available_for_unit_type(button, unit.Type)) {
 				continue;
 			}
 
@@ -1943,6 +1933,33 @@ void CButtonPanel::Update()
 		// -- continue with setting buttons as for the first unit
 		UpdateButtonPanelSingleUnit(unit, CurrentButtons);
 	}
+
+	this->invalidate_allowed_buttons();
+}
+
+/**
+**  Cache for each current button how many of the selected units, in selection order, it is allowed for before reaching one for which it isn't.
+**
+**  @internal Checking whether buttons are allowed is expensive, and the result can only change together with the game state, so it is kept until the game cycle changes or the cache is invalidated.
+*/
+void CButtonPanel::update_allowed_buttons()
+{
+	this->allowed_unit_counts.clear();
+
+	for (const std::unique_ptr<button> &button : CurrentButtons) {
+		size_t allowed_unit_count = 0;
+
+		if (button->get_pos() != -1) {
+			while (allowed_unit_count < Selected.size() && IsButtonAllowed(*Selected[allowed_unit_count], *button)) {
+				++allowed_unit_count;
+			}
+		}
+
+		this->allowed_unit_counts.push_back(allowed_unit_count);
+	}
+
+	this->allowed_buttons_game_cycle = GameCycle;
+	this->allowed_buttons_dirty = false;
 }
 
 void CButtonPanel::DoClicked_SelectTarget(int button)
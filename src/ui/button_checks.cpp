@@ -41,11 +41,12 @@
 #include "script/condition/and_condition.h"
 #include "ui/button.h"
 #include "ui/button_cmd.h"
+#include "ui/button_index.h"
+#include "ui/button_level.h"
 #include "ui/interface.h"
 #include "unit/unit.h"
 #include "unit/unit_type.h"
 #include "upgrade/upgrade.h"
-#include "util/vector_util.h"
 
 /**
 **  ButtonCheck for button enabled, always true.
@@ -487,26 +488,27 @@ bool ButtonCheckHasInventory(const CUnit &unit, const wyrmgus::button &button)
 */
 bool ButtonCheckHasSubButtons(const CUnit &unit, const wyrmgus::button &button)
 {
-	for (const wyrmgus::button *other_button : wyrmgus::button::get_all()) {
-		if (other_button->GetLevelID() != button.Value) {
-			continue;
-		}
-		
-		if (other_button->Action == ButtonCmd::Button && (other_button->Value == button.GetLevelID() || other_button->Value == 0)) { //don't count buttons to return to the level where this button is, or buttons to return to the default level
-			continue;
-		}
+	//the default level and the level with index 0 share the same level ID
+	std::vector<const wyrmgus::button_level *> sub_levels;
+	if (button.Value == 0) {
+		sub_levels.push_back(nullptr);
+	}
+	if (button.Value >= 0 && button.Value < static_cast<int>(wyrmgus::button_level::get_all().size())) {
+		sub_levels.push_back(wyrmgus::button_level::get_all()[button.Value]);
+	}
 
-		std::array<char, 128> unit_ident{};
-		sprintf(unit_ident.data(), ",%s,", unit.Type->get_identifier().c_str());
-		if (other_button->UnitMask[0] != '*' && !strstr(other_button->UnitMask.c_str(), unit_ident.data()) && !wyrmgus::vector::contains(other_button->get_unit_classes(), unit.Type->get_unit_class())) {
-			continue;
-		}
-		
-		if (!other_button->is_always_shown() && !IsButtonAllowed(unit, *other_button)) {
-			continue;
+	for (const wyrmgus::button_level *sub_level : sub_levels) {
+		for (const wyrmgus::button *other_button : wyrmgus::button_index::get()->get_unit_type_buttons(sub_level, unit.Type)) {
+			if (other_button->Action == ButtonCmd::Button && (other_button->Value == button.GetLevelID() || other_button->Value == 0)) { //don't count buttons to return to the level where this button is, or buttons to return to the default level
+				continue;
+			}
+
+			if (!other_button->is_always_shown() && !IsButtonAllowed(unit, *other_button)) {
+				continue;
+			}
+
+			return true;
 		}
-		
-		return true;
 	}
 	
 	return false;
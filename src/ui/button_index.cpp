@@ -0,0 +1,186 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "ui/button_index.h"
+
+#include "ui/button.h"
+#include "ui/button_cmd.h"
+#include "unit/unit_class.h"
+#include "unit/unit_type.h"
+#include "util/string_util.h"
+
+namespace wyrmgus {
+
+void button_index::build()
+{
+	this->clear();
+
+	std::map<const button_level *, std::map<const unit_class *, std::vector<const button *>>> level_class_buttons;
+
+	size_t order = 0;
+	for (button *button : button::get_all()) {
+		this->button_orders[button] = order++;
+
+		switch (button->Action) {
+			case ButtonCmd::Faction:
+			case ButtonCmd::PotentialNeutralFaction:
+			case ButtonCmd::Dynasty:
+			case ButtonCmd::Buy:
+				this->dynamic_buttons.push_back(button);
+				break;
+			default:
+				break;
+		}
+
+		level_buttons &level_buttons = this->level_buttons_map[button->get_level()];
+
+		if (button->UnitMask[0] == '*') {
+			level_buttons.wildcard_buttons.push_back(button);
+			continue;
+		}
+
+		for (const std::string &identifier : string::split(button->UnitMask, ',')) {
+			if (identifier.empty()) {
+				continue;
+			}
+
+			std::vector<const wyrmgus::button *> &identifier_buttons = level_buttons.identifier_buttons[identifier];
+			if (!identifier_buttons.empty() && identifier_buttons.back() == button) {
+				//the identifier is repeated in the unit mask
+				continue;
+			}
+
+			identifier_buttons.push_back(button);
+		}
+
+		for (const unit_class *unit_class : button->get_unit_classes()) {
+			level_class_buttons[button->get_level()][unit_class].push_back(button);
+		}
+	}
+
+	for (auto &[level, level_buttons] : this->level_buttons_map) {
+		const std::map<const unit_class *, std::vector<const button *>> &class_buttons = level_class_buttons[level];
+
+		for (const unit_type *unit_type : unit_type::get_all()) {
+			std::vector<const button *> unit_type_buttons;
+
+			const auto identifier_find_iterator = level_buttons.identifier_buttons.find(unit_type->get_identifier());
+			if (identifier_find_iterator != level_buttons.identifier_buttons.end()) {
+				unit_type_buttons = identifier_find_iterator->second;
+			}
+
+			if (unit_type->get_unit_class() != nullptr) {
+				const auto class_find_iterator = class_buttons.find(unit_type->get_unit_class());
+				if (class_find_iterator != class_buttons.end()) {
+					unit_type_buttons = this->merge_buttons(unit_type_buttons, class_find_iterator->second);
+				}
+			}
+
+			if (unit_type_buttons.empty()) {
+				//the unit type only has the wildcard buttons available for it
+				continue;
+			}
+
+			level_buttons.unit_type_buttons[unit_type] = this->merge_buttons(unit_type_buttons, level_buttons.wildcard_buttons);
+		}
+
+		for (auto &[identifier, identifier_buttons] : level_buttons.identifier_buttons) {
+			identifier_buttons = this->merge_buttons(identifier_buttons, level_buttons.wildcard_buttons);
+		}
+	}
+
+	this->built = true;
+}
+
+void button_index::clear()
+{
+	this->level_buttons_map.clear();
+	this->button_orders.clear();
+	this->dynamic_buttons.clear();
+	this->built = false;
+	this->outdated = false;
+}
+
+const std::vector<const button *> &button_index::get_unit_type_buttons(const button_level *level, const unit_type *unit_type) const
+{
+	const level_buttons *level_buttons = this->get_level_buttons(level);
+	if (level_buttons == nullptr) {
+		return button_index::empty_buttons;
+	}
+
+	const auto find_iterator = level_buttons->unit_type_buttons.find(unit_type);
+	if (find_iterator != level_buttons->unit_type_buttons.end()) {
+		return find_iterator->second;
+	}
+
+	return level_buttons->wildcard_buttons;
+}
+
+const std::vector<const button *> &button_index::get_identifier_buttons(const button_level *level, const std::string_view &identifier) const
+{
+	const level_buttons *level_buttons = this->get_level_buttons(level);
+	if (level_buttons == nullptr) {
+		return button_index::empty_buttons;
+	}
+
+	const auto find_iterator = level_buttons->identifier_buttons.find(identifier);
+	if (find_iterator != level_buttons->identifier_buttons.end()) {
+		return find_iterator->second;
+	}
+
+	return level_buttons->wildcard_buttons;
+}
+
+bool button_index::is_button_available_for_unit_type(const button *button, const unit_type *unit_type) const
+{
+	if (button->UnitMask[0] == '*') {
+		return true;
+	}
+
+	const std::vector<const wyrmgus::button *> &unit_type_buttons = this->get_unit_type_buttons(button->get_level(), unit_type);
+
+	return std::binary_search(unit_type_buttons.begin(), unit_type_buttons.end(), button, [this](const wyrmgus::button *lhs, const wyrmgus::button *rhs) {
+		return this->is_button_before(lhs, rhs);
+	});
+}
+
+std::vector<const button *> button_index::merge_buttons(const std::vector<const button *> &buttons, const std::vector<const button *> &other_buttons) const
+{
+	std::vector<const button *> merged_buttons;
+	merged_buttons.reserve(buttons.size() + other_buttons.size());
+
+	const auto compare = [this](const button *lhs, const button *rhs) {
+		return this->is_button_before(lhs, rhs);
+	};
+
+	std::set_union(buttons.begin(), buttons.end(), other_buttons.begin(), other_buttons.end(), std::back_inserter(merged_buttons), compare);
+
+	return merged_buttons;
+}
+
+}
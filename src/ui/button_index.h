@@ -0,0 +1,125 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "util/singleton.h"
+
+namespace wyrmgus {
+
+class button;
+class button_level;
+class unit_type;
+
+//an index of the buttons by button level and by the unit types and unit mask identifiers they are available for, so that the button panel doesn't need to go through all buttons and match their unit masks whenever it is updated
+//the buttons in each of the index' lists are kept in definition order, as later buttons overwrite earlier ones for the same position
+class button_index final : public singleton<button_index>
+{
+private:
+	struct level_buttons final
+	{
+		std::vector<const button *> wildcard_buttons; //buttons available for any unit
+		std::map<std::string, std::vector<const button *>, std::less<>> identifier_buttons; //the buttons with each identifier in their unit mask, together with the wildcard buttons
+		std::map<const unit_type *, std::vector<const button *>> unit_type_buttons; //the buttons available for each unit type, either by its identifier or by its class, together with the wildcard buttons
+	};
+
+public:
+	void build();
+	void clear();
+
+	bool is_built() const
+	{
+		return this->built;
+	}
+
+	//mark a built index as needing to be rebuilt, e.g. because a button was defined after it was built; it is then rebuilt once when the button panel is next updated, instead of once for every defined button
+	void set_outdated()
+	{
+		if (this->is_built()) {
+			this->outdated = true;
+		}
+	}
+
+	void rebuild_if_outdated()
+	{
+		if (this->outdated) {
+			this->build();
+		}
+	}
+
+	//get the buttons of a level which are available for a unit type
+	const std::vector<const button *> &get_unit_type_buttons(const button_level *level, const unit_type *unit_type) const;
+
+	//get the buttons of a level which have an identifier in their unit mask (e.g. "cancel-build"), or which are available for any unit
+	const std::vector<const button *> &get_identifier_buttons(const button_level *level, const std::string_view &identifier) const;
+
+	bool is_button_available_for_unit_type(const button *button, const unit_type *unit_type) const;
+
+	//get the buttons whose properties are set depending on the selected unit, such as the buy and faction buttons
+	const std::vector<button *> &get_dynamic_buttons() const
+	{
+		return this->dynamic_buttons;
+	}
+
+	//merge two lists of buttons ordered by definition, removing duplicates
+	std::vector<const button *> merge_buttons(const std::vector<const button *> &buttons, const std::vector<const button *> &other_buttons) const;
+
+private:
+	const level_buttons *get_level_buttons(const button_level *level) const
+	{
+		const auto find_iterator = this->level_buttons_map.find(level);
+		if (find_iterator != this->level_buttons_map.end()) {
+			return &find_iterator->second;
+		}
+
+		return nullptr;
+	}
+
+	//get the position of the button in the definition order; buttons defined after the index was built are placed after all indexed ones
+	size_t get_button_order(const button *button) const
+	{
+		const auto find_iterator = this->button_orders.find(button);
+		if (find_iterator != this->button_orders.end()) {
+			return find_iterator->second;
+		}
+
+		return std::numeric_limits<size_t>::max();
+	}
+
+	bool is_button_before(const button *first_button, const button *second_button) const
+	{
+		return this->get_button_order(first_button) < this->get_button_order(second_button);
+	}
+
+	bool built = false;
+	bool outdated = false;
+	std::map<const button_level *, level_buttons> level_buttons_map;
+	std::unordered_map<const button *, size_t> button_orders; //the position of each button in the definition order
+	std::vector<button *> dynamic_buttons;
+	static inline const std::vector<const button *> empty_buttons;
+};
+
+}
@@ -31,60 +31,47 @@
 #include "database/preferences.h"
 #include "player/player_color.h"
 #include "ui/icon.h"
-#include "util/exception_util.h"
 #include "util/string_util.h"
 #include "video/color_modification.h"
 #include "video/video.h"
 
 namespace wyrmgus {
 
-QImage icon_image_provider::requestImage(const QString &id, QSize *size, const QSize &requested_size)
+QImage icon_image_provider::create_image(const std::string &id)
 {
-	Q_UNUSED(requested_size)
+	const std::vector<std::string> id_list = string::split(id, '/');
 
-	try {
-		const std::string id_str = id.toStdString();
-		const std::vector<std::string> id_list = string::split(id_str, '/');
+	size_t index = 0;
+	const std::string &icon_identifier = id_list.at(index);
+	const icon *icon = icon::get(icon_identifier);
 
-		size_t index = 0;
-		const std::string &icon_identifier = id_list.at(index);
-		const icon *icon = icon::get(icon_identifier);
+	++index;
 
+	const player_color *player_color = nullptr;
+	if (index < id_list.size()) {
+		const std::string &player_color_identifier = id_list.at(index);
+		player_color = player_color::get(player_color_identifier);
 		++index;
+	}
 
-		const player_color *player_color = nullptr;
-		if (index < id_list.size()) {
-			const std::string &player_color_identifier = id_list.at(index);
-			player_color = player_color::get(player_color_identifier);
+	bool grayscale = false;
+	if (index < id_list.size()) {
+		if (id_list.at(index) == "grayscale") {
+			grayscale = true;
 			++index;
 		}
+	}
 
-		bool grayscale = false;
-		if (index < id_list.size()) {
-			if (id_list.at(index) == "grayscale") {
-				grayscale = true;
-				++index;
-			}
-		}
-
-		std::shared_ptr<CGraphic> graphics = icon->get_graphics();
-		graphics->Load(preferences::get()->get_scale_factor());
-
-		const QImage &image = graphics->get_or_create_frame_image(icon->get_frame(), color_modification(icon->get_hue_rotation(), icon->get_colorization(), icon->get_hue_ignored_colors(), player_color), grayscale);
-
-		if (image.isNull()) {
-			throw std::runtime_error("Icon image for ID \"" + id_str + "\" is null.");
-		}
+	std::shared_ptr<CGraphic> graphics = icon->get_graphics();
+	graphics->Load(preferences::get()->get_scale_factor());
 
-		if (size != nullptr) {
-			*size = image.size();
-		}
+	QImage image = graphics->create_modified_frame_image(icon->get_frame(), color_modification(icon->get_hue_rotation(), icon->get_colorization(), icon->get_hue_ignored_colors(), player_color), grayscale);
 
-		return image;
-	} catch (const std::exception &exception) {
-		exception::report(exception);
-		return QImage();
+	if (image.isNull()) {
+		throw std::runtime_error("Icon image for ID \"" + id + "\" is null.");
 	}
+
+	return image;
 }
 
 }
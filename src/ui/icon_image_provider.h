@@ -26,20 +26,19 @@
 
 #pragma once
 
-#pragma warning(push, 0)
-#include <QQuickImageProvider>
-#pragma warning(pop)
+#include "ui/async_image_provider.h"
 
 namespace wyrmgus {
 
-class icon_image_provider final : public QQuickImageProvider
+class icon_image_provider final : public async_image_provider
 {
 public:
-	icon_image_provider() : QQuickImageProvider(QQuickImageProvider::Image)
+	icon_image_provider() : async_image_provider("icon", &icon_image_provider::create_image)
 	{
 	}
 
-	virtual QImage requestImage(const QString &id, QSize *size, const QSize &requested_size) override;
+private:
+	static QImage create_image(const std::string &id);
 };
 
 }
@@ -44,9 +44,11 @@
 #include "map/minimap.h"
 #include "map/minimap_mode.h"
 #include "network/network.h"
+#include "network/network_statistics.h"
 #include "player/player.h"
 #include "player/player_color.h"
 #include "player/player_type.h"
+#include "profiler.h"
 #include "replay.h"
 #include "script.h"
 #include "script/cheat.h"
@@ -61,6 +63,7 @@
 #include "unit/unit.h"
 #include "unit/unit_find.h"
 #include "unit/unit_type.h"
+#include "util/path_util.h"
 #include "util/util.h"
 #include "video/font.h"
 #include "video/video.h"
@@ -826,6 +829,27 @@ static bool CommandKey(int key, const Qt::KeyboardModifiers key_modifiers)
 				return false;
 			}
 		//Wyrmgus end
+
+		case SDLK_F12: // CTRL+F12 toggles the network statistics overlay
+			if (key_modifiers & Qt::ControlModifier) {
+				network_statistics::get()->toggle_overlay();
+				break;
+			}
+#ifdef USE_PROFILER
+			// F12 toggles the profiler overlay, SHIFT+F12 dumps a profiler trace
+			if (key_modifiers & Qt::ShiftModifier) {
+				try {
+					const std::filesystem::path filepath = profiler::get()->dump_trace();
+					SetMessage(_("Profiler trace saved to %s."), path::to_string(filepath).c_str());
+				} catch (const std::exception &exception) {
+					exception::report(exception);
+					SetMessage("%s", _("Failed to save the profiler trace."));
+				}
+			} else {
+				profiler::get()->toggle_overlay();
+			}
+#endif
+			break;
 		
 		case SDLK_TAB: // TAB toggles minimap.
 			if (key_modifiers & Qt::AltModifier) {
@@ -32,7 +32,6 @@
 #include "engine_interface.h"
 #include "ui/interface_element_type.h"
 #include "ui/interface_style.h"
-#include "util/exception_util.h"
 #include "util/log_util.h"
 #include "util/string_util.h"
 #include "util/vector_util.h"
@@ -40,48 +39,36 @@
 
 namespace wyrmgus {
 
-QImage interface_image_provider::requestImage(const QString &id, QSize *size, const QSize &requested_size)
+QImage interface_image_provider::create_image(const std::string &id)
 {
-	Q_UNUSED(requested_size)
+	const std::vector<std::string> id_list = string::split(id, '/');
 
-	try {
-		const std::string id_str = id.toStdString();
-		const std::vector<std::string> id_list = string::split(id_str, '/');
+	const std::string &interface_identifier = id_list.at(0);
+	const interface_style *interface = interface_style::get(interface_identifier);
 
-		const std::string &interface_identifier = id_list.at(0);
-		const interface_style *interface = interface_style::get(interface_identifier);
+	const std::string &interface_element_str = id_list.at(1);
+	const interface_element_type interface_element_type = string_to_interface_element_type(interface_element_str);
 
-		const std::string &interface_element_str = id_list.at(1);
-		const interface_element_type interface_element_type = string_to_interface_element_type(interface_element_str);
-
-		std::vector<std::string> qualifiers;
-		if (id_list.size() > 2) {
-			qualifiers = vector::subvector(id_list, 2);
-		}
-
-		const std::shared_ptr<CGraphic> graphics = interface->get_interface_element_graphics(interface_element_type, qualifiers);
-
-		if (graphics == nullptr) {
-			throw std::runtime_error("No graphics found for interface image ID \"" + id.toStdString() + "\".");
-		}
+	std::vector<std::string> qualifiers;
+	if (id_list.size() > 2) {
+		qualifiers = vector::subvector(id_list, 2);
+	}
 
-		graphics->Load(preferences::get()->get_scale_factor());
+	const std::shared_ptr<CGraphic> graphics = interface->get_interface_element_graphics(interface_element_type, qualifiers);
 
-		const QImage &image = graphics->get_or_create_frame_image(0, color_modification(), false);
+	if (graphics == nullptr) {
+		throw std::runtime_error("No graphics found for interface image ID \"" + id + "\".");
+	}
 
-		if (image.isNull()) {
-			throw std::runtime_error("Interface image for ID \"" + id_str + "\" is null.");
-		}
+	graphics->Load(preferences::get()->get_scale_factor());
 
-		if (size != nullptr) {
-			*size = image.size();
-		}
+	QImage image = graphics->create_modified_frame_image(0, color_modification(), false);
 
-		return image;
-	} catch (const std::exception &exception) {
-		exception::report(exception);
-		return QImage();
+	if (image.isNull()) {
+		throw std::runtime_error("Interface image for ID \"" + id + "\" is null.");
 	}
+
+	return image;
 }
 
 }
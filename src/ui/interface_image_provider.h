@@ -26,20 +26,19 @@
 
 #pragma once
 
-#pragma warning(push, 0)
-#include <QQuickImageProvider>
-#pragma warning(pop)
+#include "ui/async_image_provider.h"
 
 namespace wyrmgus {
 
-class interface_image_provider final : public QQuickImageProvider
+class interface_image_provider final : public async_image_provider
 {
 public:
-	interface_image_provider() : QQuickImageProvider(QQuickImageProvider::Image)
+	interface_image_provider() : async_image_provider("interface", &interface_image_provider::create_image)
 	{
 	}
 
-	virtual QImage requestImage(const QString &id, QSize *size, const QSize &requested_size) override;
+private:
+	static QImage create_image(const std::string &id);
 };
 
 }
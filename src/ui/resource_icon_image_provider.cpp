@@ -30,39 +30,25 @@
 
 #include "database/preferences.h"
 #include "ui/resource_icon.h"
-#include "util/exception_util.h"
-#include "util/string_util.h"
 #include "video/color_modification.h"
 #include "video/video.h"
 
 namespace wyrmgus {
 
-QImage resource_icon_image_provider::requestImage(const QString &id, QSize *size, const QSize &requested_size)
+QImage resource_icon_image_provider::create_image(const std::string &id)
 {
-	Q_UNUSED(requested_size)
+	const resource_icon *resource_icon = resource_icon::get(id);
 
-	try {
-		const std::string id_str = id.toStdString();
-		const resource_icon *resource_icon = resource_icon::get(id_str);
+	std::shared_ptr<CGraphic> graphics = resource_icon->get_graphics();
+	graphics->Load(preferences::get()->get_scale_factor());
 
-		std::shared_ptr<CGraphic> graphics = resource_icon->get_graphics();
-		graphics->Load(preferences::get()->get_scale_factor());
+	QImage image = graphics->create_modified_frame_image(resource_icon->get_frame(), color_modification(), false);
 
-		const QImage &image = graphics->get_or_create_frame_image(resource_icon->get_frame(), color_modification(), false);
-
-		if (image.isNull()) {
-			throw std::runtime_error("Resource icon image for ID \"" + id_str + "\" is null.");
-		}
-
-		if (size != nullptr) {
-			*size = image.size();
-		}
-
-		return image;
-	} catch (const std::exception &exception) {
-		exception::report(exception);
-		return QImage();
+	if (image.isNull()) {
+		throw std::runtime_error("Resource icon image for ID \"" + id + "\" is null.");
 	}
+
+	return image;
 }
 
 }
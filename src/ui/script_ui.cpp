@@ -42,6 +42,7 @@
 #include "util/util.h"
 #include "ui/button.h"
 #include "ui/button_cmd.h"
+#include "ui/button_index.h"
 #include "ui/button_level.h"
 #include "ui/contenttype.h"
 #include "ui/cursor.h"
@@ -922,6 +923,9 @@ int CclDefineButton(lua_State *l)
 		lua_pop(l, 1);
 	}
 
+	//a button defined after the button index was built needs to be indexed as well
+	button_index::get()->set_outdated();
+
 	return 0;
 }
 
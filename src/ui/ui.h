@@ -225,7 +225,15 @@ public:
 	void DoClicked(int button, const Qt::KeyboardModifiers key_modifiers);
 	int DoKey(int key, const Qt::KeyboardModifiers key_modifiers);
 
+	//invalidate the cached allowed state of the current buttons, e.g. because the resources or upgrades of a player changed outside of the game cycle
+	void invalidate_allowed_buttons()
+	{
+		this->allowed_buttons_dirty = true;
+	}
+
 private:
+	void update_allowed_buttons();
+
 	void DoClicked_SelectTarget(int button);
 
 	void DoClicked_Unload(int button, const Qt::KeyboardModifiers key_modifiers);
@@ -259,6 +267,11 @@ public:
 	int X = 0;
 	int Y = 0;
 	std::vector<CUIButton> Buttons;
+
+private:
+	std::vector<size_t> allowed_unit_counts; //for each current button, the amount of selected units it is allowed for before one for which it isn't
+	unsigned long allowed_buttons_game_cycle = 0;
+	bool allowed_buttons_dirty = true;
 };
 
 class CInfoPanel final
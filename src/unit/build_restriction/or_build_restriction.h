@@ -73,6 +73,11 @@ public:
 		return false;
 	}
 
+	const std::vector<std::unique_ptr<build_restriction>> &get_restrictions() const
+	{
+		return this->restrictions;
+	}
+
 private:
 	std::vector<std::unique_ptr<build_restriction>> restrictions;
 };
@@ -36,6 +36,7 @@
 //Wyrmgus end
 #include "animation/animation_set.h"
 #include "commands.h"
+#include "economy/resource_unit_index.h"
 #include "epithet.h"
 //Wyrmgus start
 #include "grand_strategy.h"
@@ -524,10 +525,10 @@ int CclUnit(lua_State *l)
 			--j;
 		} else if (!strcmp(value, "ttl")) {
 			// FIXME : unsigned long should be better handled
-			unit->TTL = LuaToNumber(l, 2, j + 1);
+			unit->set_ttl(LuaToNumber(l, 2, j + 1));
 		} else if (!strcmp(value, "threshold")) {
 			// FIXME : unsigned long should be better handled
-			unit->Threshold = LuaToNumber(l, 2, j + 1);
+			unit->set_threshold(LuaToNumber(l, 2, j + 1));
 		} else if (!strcmp(value, "step-count")) {
 			unit->step_count = LuaToNumber(l, 2, j + 1);
 		} else if (!strcmp(value, "group-id")) {
@@ -545,7 +546,9 @@ int CclUnit(lua_State *l)
 		} else if (!strcmp(value, "gives-resource")) {
 			lua_rawgeti(l, 2, j + 1);
 			lua_pushvalue(l, -1);
+			const int old_resource = unit->GivesResource;
 			unit->GivesResource = CclGetResourceByName(l);
+			resource_unit_index::get()->on_unit_given_resource_changed(unit, old_resource);
 			lua_pop(l, 1);
 		//Wyrmgus end
 		} else if (!strcmp(value, "pathfinder-input")) {
@@ -594,7 +597,7 @@ int CclUnit(lua_State *l)
 
 				assert_throw(u != nullptr);
 
-				unit->Resource.Workers.push_back(u->acquire_ref());
+				unit->Resource.Workers.push_back(u->get_handle());
 			}
 			lua_pop(l, 1);
 		} else if (!strcmp(value, "resource-active")) {
@@ -739,6 +742,7 @@ int CclUnit(lua_State *l)
 			if (index != -1) { // Valid index
 				lua_rawgeti(l, 2, j + 1);
 				DefineVariableField(l, unit->Variable[index], -1);
+				unit->register_variable_increases();
 				lua_pop(l, 1);
 				continue;
 			}
@@ -1916,6 +1920,7 @@ static int CclSetUnitVariable(lua_State *l)
 	} else if (!strcmp(name, "RegenerationRate")) {
 		value = LuaToNumber(l, 3);
 		unit->Variable[HP_INDEX].Increase = std::min(unit->Variable[HP_INDEX].Max, value);
+		unit->register_variable_increases();
 	} else if (!strcmp(name, "IndividualUpgrade")) {
 		LuaCheckArgs(l, 4);
 		std::string upgrade_ident = LuaToString(l, 3);
@@ -2023,7 +2028,7 @@ static int CclSetUnitVariable(lua_State *l)
 		}
 		unit->generate_special_properties(nullptr, dropper_player, true, false, always_magic);
 	} else if (!strcmp(name, "TTL")) {
-		unit->TTL = GameCycle + LuaToNumber(l, 3);
+		unit->set_ttl(GameCycle + LuaToNumber(l, 3));
 	} else if (!strcmp(name, "Identified")) {
 		unit->Identified = LuaToBoolean(l, 3);
 	//Wyrmgus end
@@ -2054,6 +2059,7 @@ static int CclSetUnitVariable(lua_State *l)
 				unit->Variable[index].Max = value;
 			} else if (!strcmp(type, "Increase")) {
 				unit->Variable[index].Increase = value;
+				unit->register_variable_increases();
 			} else if (!strcmp(type, "Enable")) {
 				unit->Variable[index].Enable = value;
 			} else {
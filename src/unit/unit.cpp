@@ -36,6 +36,7 @@
 #include "actions.h"
 #include "ai.h"
 //Wyrmgus start
+#include "ai/ai_building_place_cache.h"
 #include "ai/ai_local.h" //for using AiHelpers
 //Wyrmgus end
 #include "animation/animation_set.h"
@@ -44,6 +45,7 @@
 #include "database/defines.h"
 #include "database/preferences.h"
 #include "economy/resource_storage_type.h"
+#include "economy/resource_unit_index.h"
 #include "epithet.h"
 #include "game/game.h"
 #include "editor.h"
@@ -456,8 +458,6 @@ void CUnit::Init()
 	this->VisCount.fill(0);
 	this->Seen = _seen_stuff_();
 	this->Variable.clear();
-	TTL = 0;
-	Threshold = 0;
 	GroupId = 0;
 	LastGroup = 0;
 	ResourcesHeld = 0;
@@ -478,6 +478,7 @@ void CUnit::Init()
 	this->clear_special_orders();
 	this->autocast_spells.clear();
 	this->spell_cooldown_timers.clear();
+	this->status_effect_timers.clear();
 	this->AutoRepair = 0;
 	this->Goal = nullptr;
 	this->IndividualUpgrades.clear();
@@ -564,6 +565,62 @@ void CUnit::Release(const bool final)
 	unit_manager::get()->ReleaseUnit(this);
 }
 
+wyrmgus::unit_handle CUnit::get_handle() const
+{
+	const int slot = this->UnitManagerData.GetUnitId();
+	return wyrmgus::unit_handle(slot, wyrmgus::unit_manager::get()->get_slot_generation(slot));
+}
+
+unsigned long CUnit::get_ttl() const
+{
+	return wyrmgus::unit_manager::get()->get_unit_ttl(this->UnitManagerData.GetUnitId());
+}
+
+void CUnit::set_ttl(const unsigned long ttl)
+{
+	wyrmgus::unit_manager::get()->set_unit_ttl(this->UnitManagerData.GetUnitId(), ttl);
+}
+
+int CUnit::get_threshold() const
+{
+	return wyrmgus::unit_manager::get()->get_unit_threshold(this->UnitManagerData.GetUnitId());
+}
+
+void CUnit::set_threshold(const int threshold)
+{
+	wyrmgus::unit_manager::get()->set_unit_threshold(this->UnitManagerData.GetUnitId(), threshold);
+}
+
+void CUnit::set_spell_cooldown_timer(const wyrmgus::spell *spell, const int cooldown)
+{
+	this->spell_cooldown_timers[spell] = cooldown;
+	wyrmgus::unit_manager::get()->set_has_timers(this->UnitManagerData.GetUnitId(), true);
+}
+
+void CUnit::set_status_effect_timer(const status_effect status_effect, const int cycles)
+{
+	if (cycles <= 0) {
+		if (this->status_effect_timers.contains(status_effect)) {
+			this->status_effect_timers.erase(status_effect);
+		}
+	} else {
+		this->status_effect_timers[status_effect] = cycles;
+		wyrmgus::unit_manager::get()->set_has_timers(this->UnitManagerData.GetUnitId(), true);
+	}
+}
+
+//called whenever the per-second increase of the unit's variables may have become non-zero, so that the unit is visited by the variable regeneration
+void CUnit::register_variable_increases()
+{
+	wyrmgus::unit_manager::get()->set_has_variable_increases(this->UnitManagerData.GetUnitId(), true);
+}
+
+//called whenever the unit's type may have gained unit stocks for its owner, so that the unit is visited by the stock replenishment
+void CUnit::register_unit_stocks()
+{
+	wyrmgus::unit_manager::get()->set_has_unit_stocks(this->UnitManagerData.GetUnitId(), true);
+}
+
 std::shared_ptr<wyrmgus::unit_ref> CUnit::acquire_ref() const
 {
 	if (this->base_ref == nullptr) {
@@ -764,6 +821,7 @@ void CUnit::IncreaseLevel(int level_quantity, bool automatic_learning)
 	}
 	
 	UpdateXPRequired();
+	this->update_military_score_contribution();
 	
 	bool upgrade_found = true;
 	while (this->Variable[LEVELUP_INDEX].Value > 0 && upgrade_found && automatic_learning) {
@@ -1057,6 +1115,7 @@ void CUnit::apply_character_properties()
 		}
 
 		this->Variable = this->get_character()->get_unit_type()->Stats[this->Player->get_index()].Variables;
+		this->register_variable_increases();
 	} else {
 		fprintf(stderr, "Character \"%s\" has no unit type.\n", character->get_identifier().c_str());
 		return;
@@ -1718,6 +1777,7 @@ void CUnit::EquipItem(CUnit &item, bool affect_character)
 			Variable[HP_INDEX].Value += item.Variable[i].Value;
 			Variable[HP_INDEX].Max += item.Variable[i].Max;
 			Variable[HP_INDEX].Increase += item.Variable[i].Increase;
+			this->register_variable_increases();
 		} else if (i == SIGHTRANGE_INDEX || i == DAYSIGHTRANGEBONUS_INDEX || i == NIGHTSIGHTRANGEBONUS_INDEX) {
 			if (!SaveGameLoading) {
 				MapUnmarkUnitSight(*this);
@@ -1733,6 +1793,10 @@ void CUnit::EquipItem(CUnit &item, bool affect_character)
 			}
 		}
 	}
+
+	if (!SaveGameLoading) {
+		this->update_military_score_contribution_with_container();
+	}
 }
 
 void CUnit::DeequipItem(CUnit &item, bool affect_character)
@@ -1755,6 +1819,7 @@ void CUnit::DeequipItem(CUnit &item, bool affect_character)
 			Variable[HP_INDEX].Value -= item.Variable[i].Value;
 			Variable[HP_INDEX].Max -= item.Variable[i].Max;
 			Variable[HP_INDEX].Increase -= item.Variable[i].Increase;
+			this->register_variable_increases();
 		} else if (i == SIGHTRANGE_INDEX || i == DAYSIGHTRANGEBONUS_INDEX || i == NIGHTSIGHTRANGEBONUS_INDEX) {
 			MapUnmarkUnitSight(*this);
 			Variable[i].Value -= item.Variable[i].Value;
@@ -1882,6 +1947,10 @@ void CUnit::DeequipItem(CUnit &item, bool affect_character)
 		this->ChooseButtonIcon(ButtonCmd::Move);
 	}
 	this->ChooseButtonIcon(ButtonCmd::Patrol);
+
+	if (!SaveGameLoading) {
+		this->update_military_score_contribution_with_container();
+	}
 }
 
 void CUnit::ReadWork(const CUpgrade *work, bool affect_character)
@@ -2418,7 +2487,7 @@ void CUnit::GenerateDrop()
 				if (droppedUnit->Prefix != nullptr || droppedUnit->Suffix != nullptr || droppedUnit->Spell != nullptr || droppedUnit->Work != nullptr || droppedUnit->Elixir != nullptr) {
 					ttl_cycles *= 4;
 				}
-				droppedUnit->TTL = GameCycle + ttl_cycles;
+				droppedUnit->set_ttl(GameCycle + ttl_cycles);
 			}
 		}
 	}
@@ -3093,11 +3162,13 @@ void CUnit::ProduceResource(const wyrmgus::resource *resource)
 		this->GivesResource = 0;
 		this->ResourcesHeld = 0;
 	}
+
+	resource_unit_index::get()->on_unit_given_resource_changed(this, old_resource);
 	
 	if (old_resource != 0) {
-		for (const std::shared_ptr<unit_ref> &uins_ref : this->Resource.Workers) {
-			CUnit *uins = uins_ref->get();
-			if (uins->Container == this) {
+		for (const unit_handle &uins_handle : this->Resource.Workers) {
+			CUnit *uins = uins_handle.get();
+			if (uins != nullptr && uins->Container == this) {
 				uins->CurrentOrder()->Finished = true;
 				uins->drop_out_on_side(LookingW, this);
 			}
@@ -3257,6 +3328,7 @@ void CUnit::Init(const wyrmgus::unit_type &type, const bool loading_saved_unit)
 	if (UnitTypeVar.GetNumberVariable()) {
 		assert_throw(Variable.empty());
 		this->Variable = type.DefaultStat.Variables;
+		this->register_variable_increases();
 	} else {
 		this->Variable.clear();
 	}
@@ -3385,6 +3457,7 @@ void CUnit::AssignToPlayer(CPlayer &player)
 		if (UnitTypeVar.GetNumberVariable()) {
 			assert_throw(!this->Stats->Variables.empty());
 			this->Variable = this->Stats->Variables;
+			this->register_variable_increases();
 		}
 	}
 
@@ -3800,6 +3873,8 @@ void MarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += unit.MapLayer->get_width();
 	} while (--h);
+
+	ai_building_place_cache::get()->on_unit_field_flags_changed(unit.get_tile_rect(), flags, unit.MapLayer->ID);
 }
 
 class _UnmarkUnitFieldFlags final
@@ -3858,6 +3933,8 @@ void UnmarkUnitFieldFlags(const CUnit &unit)
 		} while (--w);
 		index += unit.MapLayer->get_width();
 	} while (--h);
+
+	ai_building_place_cache::get()->on_unit_field_flags_changed(unit.get_tile_rect(), unit.Type->FieldFlags, unit.MapLayer->ID);
 }
 
 /**
@@ -3875,6 +3952,9 @@ void CUnit::AddInContainer(CUnit &host)
 	if (!SaveGameLoading) {
 		//if host has no range by itself, but the unit has range, and the unit can attack from a transporter, change the host's range to the unit's; but don't do this while loading, as it causes a crash (since one unit needs to be loaded before the other, and when this function is processed both won't already have their variables set)
 		host.update_for_transported_units();
+
+		//whether the unit can move or attack depends on its container
+		this->update_military_score_contribution();
 	}
 	//Wyrmgus end
 }
@@ -3896,6 +3976,8 @@ static void RemoveUnitFromContainer(CUnit &unit)
 	//reset host attack range
 	host->update_for_transported_units();
 	//Wyrmgus end
+
+	unit.update_military_score_contribution();
 }
 
 void CUnit::set_garrisoned_gathering_income(const int income)
@@ -4177,6 +4259,7 @@ void CUnit::on_variable_changed(const int var_index, const int change)
 		case ATTACKRANGE_INDEX:
 			if (this->Container != nullptr && !SaveGameLoading) {
 				this->Container->UpdateContainerAttackRange();
+				this->Container->update_military_score_contribution();
 			}
 			break;
 		case LEVEL_INDEX:
@@ -4184,7 +4267,7 @@ void CUnit::on_variable_changed(const int var_index, const int change)
 			break;
 		case POINTS_INDEX:
 			this->UpdateXPRequired();
-			this->Player->change_military_score(change);
+			this->update_military_score_contribution();
 			break;
 		case XP_INDEX:
 			this->XPChanged();
@@ -5590,9 +5673,10 @@ void CUnit::ChangeOwner(CPlayer &newplayer, bool show_change)
 
 static bool IsMineAssignedBy(const CUnit *mine, const CUnit *worker)
 {
-	for (const std::shared_ptr<wyrmgus::unit_ref> &unit_ref : mine->Resource.Workers) {
-		const CUnit *unit = unit_ref->get();
-		if (unit == worker) {
+	const unit_handle worker_handle = worker->get_handle();
+
+	for (const unit_handle &handle : mine->Resource.Workers) {
+		if (handle == worker_handle) {
 			return true;
 		}
 	}
@@ -5614,7 +5698,7 @@ void CUnit::AssignWorkerToMine(CUnit &mine)
 			   _C_ mine.Data.Resource.Assigned);
 #endif
 
-	mine.Resource.Workers.push_back(this->acquire_ref());
+	mine.Resource.Workers.push_back(this->get_handle());
 }
 
 void CUnit::DeAssignWorkerFromMine(CUnit &mine)
@@ -5631,10 +5715,10 @@ void CUnit::DeAssignWorkerFromMine(CUnit &mine)
 			   _C_ mine.CurrentOrder()->Data.Resource.Assigned);
 #endif
 
-	for (size_t i = 0; i < mine.Resource.Workers.size(); ++i) {
-		const CUnit *worker = *mine.Resource.Workers[i];
+	const unit_handle handle = this->get_handle();
 
-		if (worker == this) {
+	for (size_t i = 0; i < mine.Resource.Workers.size(); ++i) {
+		if (mine.Resource.Workers[i] == handle) {
 			mine.Resource.Workers.erase(mine.Resource.Workers.begin() + i);
 			break;
 		}
@@ -5883,7 +5967,7 @@ void DropOutAll(const CUnit &source)
 			if (unit->Prefix != nullptr || unit->Suffix != nullptr || unit->Spell != nullptr || unit->Work != nullptr || unit->Elixir != nullptr) {
 				ttl_cycles *= 4;
 			}
-			unit->TTL = GameCycle + ttl_cycles;
+			unit->set_ttl(GameCycle + ttl_cycles);
 		}
 		//Wyrmgus end
 	}
@@ -7580,6 +7664,18 @@ bool CUnit::is_near_site(const wyrmgus::site *site) const
 	}
 }
 
+void CUnit::update_military_score_contribution()
+{
+	const int contribution = this->counts_for_military_score() ? this->Variable[POINTS_INDEX].Value : 0;
+
+	if (contribution == this->get_military_score_contribution()) {
+		return;
+	}
+
+	this->Player->change_military_score(contribution - this->get_military_score_contribution());
+	this->set_military_score_contribution(contribution);
+}
+
 bool CUnit::counts_for_military_score() const
 {
 	if (!this->IsAlive()) {
@@ -7610,7 +7706,7 @@ void LetUnitDie(CUnit &unit, bool suicide)
 {
 	unit.Variable[HP_INDEX].Value = std::min<int>(0, unit.Variable[HP_INDEX].Value);
 	unit.Moving = 0;
-	unit.TTL = 0;
+	unit.set_ttl(0);
 	unit.Anim.Unbreakable = false;
 
 	const wyrmgus::unit_type *type = unit.Type;
@@ -8175,7 +8271,7 @@ static void HitUnit_AttackBack(CUnit &attacker, CUnit &target)
 		CommandAttack(target, best->tilePos, best, FlushCommands, best->MapLayer->ID);
 		// Set threshold value only for aggressive units
 		if (best->IsAgressive()) {
-			target.Threshold = threshold;
+			target.set_threshold(threshold);
 		}
 		if (saved_order != nullptr) {
 			target.SavedOrder = std::move(saved_order);
@@ -8275,7 +8371,7 @@ void HitUnit(CUnit *attacker, CUnit &target, int damage, const Missile *missile,
 	if (HitUnit_IsUnitWillDie(attacker, target, damage)) { // unit is killed or destroyed
 		if (attacker) {
 			//  Setting ai threshold counter to 0 so it can target other units
-			attacker->Threshold = 0;
+			attacker->set_threshold(0);
 		}
 		
 		CUnit *destroyer = attacker;
@@ -8345,15 +8441,15 @@ void HitUnit(CUnit *attacker, CUnit &target, int damage, const Missile *missile,
 
 	const int threshold = 30;
 
-	if (target.Threshold && target.CurrentOrder()->has_goal() && target.CurrentOrder()->get_goal() == attacker) {
-		target.Threshold = threshold;
+	if (target.get_threshold() && target.CurrentOrder()->has_goal() && target.CurrentOrder()->get_goal() == attacker) {
+		target.set_threshold(threshold);
 		return;
 	}
 
 	//Wyrmgus start
-//	if (target.Threshold == 0 && target.IsAgressive() && target.CanMove() && !target.ReCast) {
+//	if (target.get_threshold() == 0 && target.IsAgressive() && target.CanMove() && !target.ReCast) {
 	if (
-		target.Threshold == 0
+		target.get_threshold() == 0
 		&& (target.IsAgressive() || (target.CanAttack() && target.Type->BoolFlag[COWARD_INDEX].value && (attacker->Type->BoolFlag[COWARD_INDEX].value || attacker->Variable[HP_INDEX].Value <= 3))) // attacks back if isn't coward, or if attacker is also coward, or if attacker has 3 HP or less 
 		&& target.CanMove()
 		&& !target.ReCast
@@ -30,6 +30,7 @@
 #include "player/player_container.h"
 #include "spell/spell_container.h"
 #include "unit/unit_class_container.h"
+#include "unit/unit_handle.h"
 #include "unit/unit_type.h"
 #include "unit/unit_type_container.h"
 #include "unit/unit_variable.h"
@@ -142,6 +143,7 @@ public:
 
 	void Init();
 
+	//acquire a reference-counted reference, which keeps the unit from being released while held; kept for code which hasn't been migrated to unit handles yet
 	std::shared_ptr<wyrmgus::unit_ref> acquire_ref() const;
 
 	int get_ref_count() const
@@ -149,6 +151,8 @@ public:
 		return this->ref.use_count();
 	}
 
+	wyrmgus::unit_handle get_handle() const;
+
 	int get_tile_x() const
 	{
 		return this->tilePos.x;
@@ -215,6 +219,9 @@ public:
 	{
 		this->update_garrisoned_gathering_income();
 		this->UpdateContainerAttackRange();
+
+		//whether the container can attack depends on the units inside it
+		this->update_military_score_contribution();
 	}
 
 	void set_garrisoned_gathering_income(const int income);
@@ -623,6 +630,14 @@ public:
 		return this->Variable[var_index].Increase;
 	}
 
+	void register_variable_increases();
+	void register_unit_stocks();
+
+	unsigned long get_ttl() const;
+	void set_ttl(const unsigned long ttl);
+	int get_threshold() const;
+	void set_threshold(const int threshold);
+
 	int GetModifiedVariable(const int index, const VariableAttribute variable_type) const;
 	int GetModifiedVariable(const int index) const;
 
@@ -830,10 +845,7 @@ public:
 		return 0;
 	}
 
-	void set_spell_cooldown_timer(const wyrmgus::spell *spell, const int cooldown)
-	{
-		this->spell_cooldown_timers[spell] = cooldown;
-	}
+	void set_spell_cooldown_timer(const wyrmgus::spell *spell, const int cooldown);
 
 	void decrement_spell_cooldown_timers()
 	{
@@ -887,16 +899,7 @@ public:
 		return 0;
 	}
 
-	void set_status_effect_timer(const status_effect status_effect, const int cycles)
-	{
-		if (cycles <= 0) {
-			if (this->status_effect_timers.contains(status_effect)) {
-				this->status_effect_timers.erase(status_effect);
-			}
-		} else {
-			this->status_effect_timers[status_effect] = cycles;
-		}
-	}
+	void set_status_effect_timer(const status_effect status_effect, const int cycles);
 
 	void decrement_status_effect_timers()
 	{
@@ -1010,6 +1013,28 @@ public:
 	bool is_near_site(const wyrmgus::site *site) const;
 	bool counts_for_military_score() const;
 
+	int get_military_score_contribution() const
+	{
+		return this->military_score_contribution;
+	}
+
+	void set_military_score_contribution(const int contribution)
+	{
+		this->military_score_contribution = contribution;
+	}
+
+	void update_military_score_contribution();
+
+	//update the military score contribution of the unit and of its container, as whether a container can attack depends on the units inside it
+	void update_military_score_contribution_with_container()
+	{
+		this->update_military_score_contribution();
+
+		if (this->Container != nullptr) {
+			this->Container->update_military_score_contribution();
+		}
+	}
+
 public:
 	class CUnitManagerData final
 	{
@@ -1042,7 +1067,7 @@ public:
 	CUnit *Container;     /// Pointer to the unit containing it (or 0)
 
 	struct {
-		std::vector<std::shared_ptr<wyrmgus::unit_ref>> Workers; ///references to the workers assigned to this resource.
+		std::vector<wyrmgus::unit_handle> Workers; ///handles to the workers assigned to this resource.
 		int Active = 0; /// how many units are harvesting from the resource.
 	} Resource; /// Resource still
 
@@ -1087,6 +1112,7 @@ private:
 	const wyrmgus::site *settlement = nullptr;	//settlement (for if the unit is a town hall or a building associated to a settlement)
 	const wyrmgus::site *site = nullptr; //the site to which the unit belongs, if it is a site unit (not necessarily the same as the settlement, e.g. if the site is a non-major one)
 	std::vector<const CUpgrade *> traits;
+	int military_score_contribution = 0; //the amount which the unit currently adds to its player's military score
 public:
 	int Variation;      /// Which of the variations of its unit type this unit has
 	int LayerVariation[MaxImageLayers];	/// Which layer variations this unit has
@@ -1163,13 +1189,12 @@ public:
 
 	std::vector<wyrmgus::unit_variable> Variable; /// array of User Defined variables.
 
-	unsigned long TTL;  /// time to live
+	//the time to live and the AI target change threshold are stored in the unit manager, see get_ttl() and get_threshold()
 
 	unsigned int GroupId;       /// unit belongs to this group id
 	unsigned int LastGroup;     /// unit belongs to this last group
 
 	unsigned int Wait;          /// action counter
-	int Threshold;              /// The counter while ai unit couldn't change target.
 	
 private:
 	unsigned char step_count = 0;	/// How many steps the unit has taken without stopping (maximum 10)
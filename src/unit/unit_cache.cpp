@@ -34,6 +34,7 @@
 
 #include "unit/unit_cache.h"
 
+#include "economy/resource_unit_index.h"
 #include "map/map.h"
 #include "map/map_info.h"
 #include "map/map_layer.h"
@@ -76,6 +77,8 @@ void CMap::Insert(CUnit &unit)
 		} while (--j && unit.tilePos.x + (j - w) < unit.MapLayer->get_width());
 		index += unit.MapLayer->get_width();
 	} while (--i && unit.tilePos.y + (i - h) < unit.MapLayer->get_height());
+
+	resource_unit_index::get()->add_unit(&unit);
 }
 
 /**
@@ -100,4 +103,6 @@ void CMap::Remove(CUnit &unit)
 		} while (--j && unit.tilePos.x + (j - w) < unit.MapLayer->get_width());
 		index += unit.MapLayer->get_width();
 	} while (--i && unit.tilePos.y + (i - h) < unit.MapLayer->get_height());
+
+	resource_unit_index::get()->remove_unit(&unit);
 }
@@ -32,6 +32,7 @@
 
 #include "actions.h"
 #include "economy/resource.h"
+#include "economy/resource_unit_index.h"
 #include "map/map.h"
 #include "map/map_layer.h"
 #include "map/tile.h"
@@ -524,7 +525,7 @@ public:
 		const wyrmgus::unit_type &type = *unit->Type;
 		//Wyrmgus start
 //		return (type.GivesResource == resource
-		return ((unit->get_given_resource() == resource || (!only_same && unit->GivesResource != TradeCost && wyrmgus::resource::get_all()[unit->GivesResource]->get_final_resource() == resource) || (include_luxury && wyrmgus::resource::get_all()[unit->GivesResource]->is_luxury()))
+		return (this->is_valid_resource(unit->GivesResource)
 		//Wyrmgus end
 				&& unit->ResourcesHeld != 0
 				//Wyrmgus start
@@ -534,6 +535,21 @@ public:
 				&& !unit->IsUnusable(true) //allow mines under construction
 			   );
 	}
+
+	//whether units giving a resource can fulfill the search at all, used to visit only the relevant buckets of the resource unit index
+	bool is_valid_resource(const int resource_index) const
+	{
+		if (resource_index == 0) {
+			return false;
+		}
+
+		const wyrmgus::resource *given_resource = wyrmgus::resource::get_all()[resource_index];
+
+		return given_resource == resource
+			|| (!only_same && resource_index != TradeCost && given_resource->get_final_resource() == resource)
+			|| (include_luxury && given_resource->is_luxury());
+	}
+
 private:
 	const wyrmgus::resource *resource = nullptr;
 	//Wyrmgus start
@@ -549,7 +565,7 @@ class ResourceUnitFinder final
 public:
 	//Wyrmgus start
 //	explicit ResourceUnitFinder(const CUnit &worker, const CUnit *deposit, const resource *resource, int maxRange, bool check_usage, CUnit **resultMine) :
-	explicit ResourceUnitFinder(const CUnit &worker, const CUnit *deposit, const resource *resource, int maxRange, bool check_usage, CUnit **resultMine, bool only_harvestable, bool ignore_exploration, bool only_unsettled_area, bool include_luxury, bool only_same) :
+	explicit ResourceUnitFinder(const CUnit &worker, const CUnit *deposit, const resource *resource, int maxRange, bool check_usage, CUnit **resultMine, bool only_harvestable, bool ignore_exploration, bool only_unsettled_area, bool include_luxury, bool only_same, const int candidate_count) :
 	//Wyrmgus end
 		worker(worker),
 		res_info(worker.Type->get_resource_info(resource)),
@@ -566,7 +582,8 @@ public:
 //		res_finder(resource, 1),
 		res_finder(resource, only_harvestable, include_luxury, only_same),
 		//Wyrmgus end
-		resultMine(resultMine)
+		resultMine(resultMine),
+		remaining_candidate_count(candidate_count)
 	{
 		bestCost.SetToMax();
 		*resultMine = nullptr;
@@ -618,6 +635,8 @@ private:
 	CResourceFinder res_finder;
 	ResourceUnitFinder_Cost bestCost;
 	CUnit **resultMine;
+	int remaining_candidate_count = 0; //the amount of resource units on the map layer which can match the search and have not been visited yet
+	std::vector<const CUnit *> visited_candidates;
 };
 
 bool ResourceUnitFinder::MineIsUsable(const CUnit &mine) const
@@ -700,6 +719,11 @@ VisitResult ResourceUnitFinder::Visit(TerrainTraversal &terrainTraversal, const
 	}
 	//Wyrmgus end
 
+	if (mine != nullptr && !vector::contains(this->visited_candidates, mine)) {
+		this->visited_candidates.push_back(mine);
+		--this->remaining_candidate_count;
+	}
+
 	//Wyrmgus start
 //	if (mine && mine != *resultMine && MineIsUsable(*mine)) {
 	if (
@@ -723,6 +747,11 @@ VisitResult ResourceUnitFinder::Visit(TerrainTraversal &terrainTraversal, const
 		}
 	}
 
+	if (this->remaining_candidate_count == 0) {
+		//all resource units which could be found have been visited already, so the result can't change anymore
+		return VisitResult::Finished;
+	}
+
 	if (CanMoveToMask(pos, movemask, worker.MapLayer->ID)) { // reachable
 		if (terrainTraversal.Get(pos) < maxRange) {
 			return VisitResult::Ok;
@@ -753,6 +782,16 @@ CUnit *UnitFindResource(const CUnit &unit, const CUnit &start_unit, const int ra
 						const bool check_usage, const CUnit *depot, const bool only_harvestable, const bool ignore_exploration, const bool only_unsettled_area, const bool include_luxury, const bool only_same)
 						//Wyrmgus end
 {
+	const CResourceFinder res_finder(resource, only_harvestable, include_luxury, only_same);
+	const int candidate_count = resource_unit_index::get()->count_units(start_unit.MapLayer->ID, [&res_finder](const int given_resource) {
+		return res_finder.is_valid_resource(given_resource);
+	}, res_finder);
+
+	if (candidate_count == 0) {
+		//there are no resource units on the map layer which could fulfill the search
+		return nullptr;
+	}
+
 	if (!depot) { // Find the nearest depot
 		depot = FindDepositNearLoc(*unit.Player, start_unit.tilePos, range, resource, start_unit.MapLayer->ID);
 	}
@@ -775,7 +814,7 @@ CUnit *UnitFindResource(const CUnit &unit, const CUnit &start_unit, const int ra
 
 	//Wyrmgus start
 //	ResourceUnitFinder resourceUnitFinder(unit, depot, resource, range, check_usage, &resultMine);
-	ResourceUnitFinder resourceUnitFinder(unit, depot, resource, range, check_usage, &resultMine, only_harvestable, ignore_exploration, only_unsettled_area, include_luxury, only_same);
+	ResourceUnitFinder resourceUnitFinder(unit, depot, resource, range, check_usage, &resultMine, only_harvestable, ignore_exploration, only_unsettled_area, include_luxury, only_same, candidate_count);
 	//Wyrmgus end
 
 	terrainTraversal.Run(resourceUnitFinder);
@@ -0,0 +1,106 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+class CUnit;
+
+namespace wyrmgus {
+
+//a lightweight reference to a unit, consisting of its unit manager slot and the generation of that slot
+//unlike unit_ref, a handle doesn't keep the unit from being released: once the slot has been released, the handle is stale and resolves to null, which is checked in constant time
+//handles are only used for the workers of resource units and for the AI's harvester plans; saved games, replays, orders, missiles and the other unit references still use slot numbers and unit_ref
+class unit_handle final
+{
+public:
+	unit_handle()
+	{
+	}
+
+	explicit unit_handle(const int slot, const uint32_t generation) : slot(slot), generation(generation)
+	{
+	}
+
+	int get_slot() const
+	{
+		return this->slot;
+	}
+
+	uint32_t get_generation() const
+	{
+		return this->generation;
+	}
+
+	bool is_null() const
+	{
+		return this->slot == -1;
+	}
+
+	bool is_valid() const
+	{
+		return this->get() != nullptr;
+	}
+
+	explicit operator bool() const
+	{
+		return this->is_valid();
+	}
+
+	CUnit *get() const;
+
+	CUnit *operator->() const
+	{
+		return this->get();
+	}
+
+	CUnit &operator*() const
+	{
+		return *this->get();
+	}
+
+	bool operator==(const unit_handle &other) const = default;
+
+	//packs the handle into a single integer, for hashing
+	uint64_t to_uint64() const
+	{
+		return (static_cast<uint64_t>(this->generation) << 32) | static_cast<uint32_t>(this->slot);
+	}
+
+private:
+	int slot = -1;
+	uint32_t generation = 0;
+};
+
+}
+
+template <>
+struct std::hash<wyrmgus::unit_handle>
+{
+	size_t operator()(const wyrmgus::unit_handle &handle) const
+	{
+		return std::hash<uint64_t>()(handle.to_uint64());
+	}
+};
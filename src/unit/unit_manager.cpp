@@ -56,6 +56,16 @@ void unit_manager::init()
 	this->units.clear();
 	this->released_units.clear();
 	this->unit_slots.clear();
+	this->unit_slot_generations.clear();
+	this->unit_ttls.clear();
+	this->unit_thresholds.clear();
+	this->ttl_queue = {};
+	this->queued_unit_ttls.clear();
+	this->expired_ttl_slots.clear();
+	this->timer_slots.clear();
+	this->variable_increase_slots.clear();
+	this->unit_stock_slots.clear();
+	this->timed_effect_slots.clear();
 }
 
 void unit_manager::clean_units()
@@ -123,17 +133,44 @@ CUnit *unit_manager::AllocUnit()
 		unit->Init();
 		unit->UnitManagerData.slot = slot;
 		unit->UnitManagerData.unitSlot = -1;
+		this->reset_unit_hot_data(slot);
 		return unit;
 	} else {
 		auto unit = std::make_unique<CUnit>();
-		unit->UnitManagerData.slot = this->unit_slots.size();
 		CUnit *unit_ptr = unit.get();
-		this->unit_slots.push_back(std::move(unit));
+		this->add_unit_slot(std::move(unit));
 
 		return unit_ptr;
 	}
 }
 
+void unit_manager::add_unit_slot(std::unique_ptr<CUnit> &&unit)
+{
+	unit->UnitManagerData.slot = static_cast<int>(this->unit_slots.size());
+	this->unit_slots.push_back(std::move(unit));
+	this->unit_slot_generations.push_back(0);
+	this->unit_ttls.push_back(0);
+	this->unit_thresholds.push_back(0);
+	this->queued_unit_ttls.push_back(0);
+	this->expired_ttl_slots.push_back(false);
+	this->timer_slots.push_back(false);
+	this->variable_increase_slots.push_back(false);
+	this->unit_stock_slots.push_back(false);
+}
+
+void unit_manager::reset_unit_hot_data(const int slot)
+{
+	this->unit_ttls[slot] = 0;
+	this->unit_thresholds[slot] = 0;
+	this->expired_ttl_slots[slot] = false;
+	this->timer_slots[slot] = false;
+	this->variable_increase_slots[slot] = false;
+	this->unit_stock_slots[slot] = false;
+	this->timed_effect_slots.erase(slot);
+
+	//a queue entry for the slot is discarded when popped, as the slot's TTL is now 0
+}
+
 /**
 **  Release a unit
 **
@@ -167,6 +204,7 @@ void unit_manager::ReleaseUnit(CUnit *unit)
 
 	this->released_units.push_back(unit);
 	unit->ReleaseCycle = GameCycle + 500; // can be reused after this time
+	++this->unit_slot_generations[unit->UnitManagerData.slot];
 	//Refs = GameCycle + (NetworkMaxLag << 1); // could be reuse after this time
 }
 
@@ -242,9 +280,7 @@ void unit_manager::Load(lua_State *l)
 		LuaError(l, "incorrect argument");
 	}
 	for (unsigned int i = 0; i < unitCount; i++) {
-		auto unit = std::make_unique<CUnit>();
-		unit->UnitManagerData.slot = i;
-		this->unit_slots.push_back(std::move(unit));
+		this->add_unit_slot(std::make_unique<CUnit>());
 	}
 
 	const unsigned int args = lua_rawlen(l, 2);
@@ -281,6 +317,65 @@ void unit_manager::Load(lua_State *l)
 	}
 }
 
+/**
+**  Set the time to live of a unit slot
+**
+**  The slot is queued by the cycle at which its time to live expires. If
+**  it is already queued for an earlier cycle, it is requeued when that
+**  entry is popped instead, so that repeated calls don't grow the queue.
+**
+**  @param slot  The unit slot
+**  @param ttl   The game cycle at which the unit dies, or 0 for none
+*/
+void unit_manager::set_unit_ttl(const int slot, const unsigned long ttl)
+{
+	this->unit_ttls[slot] = ttl;
+	this->expired_ttl_slots[slot] = ttl != 0 && ttl < GameCycle;
+	this->update_timed_effect_slot(slot);
+
+	if (ttl == 0 || this->expired_ttl_slots[slot]) {
+		return;
+	}
+
+	const unsigned long queued_ttl = this->queued_unit_ttls[slot];
+	if (queued_ttl == 0 || ttl < queued_ttl) {
+		this->ttl_queue.emplace(ttl, slot);
+		this->queued_unit_ttls[slot] = ttl;
+	}
+}
+
+/**
+**  Mark the unit slots whose time to live has expired by the current cycle
+*/
+void unit_manager::update_expired_ttls()
+{
+	while (!this->ttl_queue.empty() && this->ttl_queue.top().first < GameCycle) {
+		const auto [queued_ttl, slot] = this->ttl_queue.top();
+		this->ttl_queue.pop();
+
+		if (this->queued_unit_ttls[slot] != queued_ttl) {
+			//superseded by an entry for an earlier cycle
+			continue;
+		}
+
+		this->queued_unit_ttls[slot] = 0;
+
+		const unsigned long ttl = this->unit_ttls[slot];
+		if (ttl == 0) {
+			continue;
+		}
+
+		if (ttl < GameCycle) {
+			this->expired_ttl_slots[slot] = true;
+			this->timed_effect_slots.insert(slot);
+		} else {
+			//the time to live was extended, so queue the slot again
+			this->ttl_queue.emplace(ttl, slot);
+			this->queued_unit_ttls[slot] = ttl;
+		}
+	}
+}
+
 void unit_manager::add_unit_seen_under_fog(CUnit *unit)
 {
 	this->units_seen_under_fog[unit] = unit->acquire_ref();
@@ -66,9 +66,106 @@ public:
 	CUnit &GetSlotUnit(int index) const;
 	unsigned int GetUsedSlotCount() const;
 
+	uint32_t get_slot_generation(const int slot) const
+	{
+		return this->unit_slot_generations[slot];
+	}
+
+	//get the unit in a slot, provided the slot hasn't been released since the given generation
+	CUnit *get_slot_unit_if_current(const int slot, const uint32_t generation) const
+	{
+		if (slot < 0 || slot >= static_cast<int>(this->unit_slots.size()) || this->unit_slot_generations[slot] != generation) {
+			return nullptr;
+		}
+
+		return this->unit_slots[slot].get();
+	}
+
 	void add_unit_seen_under_fog(CUnit *unit);
 	void remove_unit_seen_under_fog(CUnit *unit);
 
+	unsigned long get_unit_ttl(const int slot) const
+	{
+		return this->unit_ttls[slot];
+	}
+
+	void set_unit_ttl(const int slot, const unsigned long ttl);
+	void update_expired_ttls();
+
+	bool has_expired_ttl(const int slot) const
+	{
+		return this->expired_ttl_slots[slot];
+	}
+
+	int get_unit_threshold(const int slot) const
+	{
+		return this->unit_thresholds[slot];
+	}
+
+	void set_unit_threshold(const int slot, const int threshold)
+	{
+		this->unit_thresholds[slot] = threshold;
+	}
+
+	void decrement_unit_thresholds()
+	{
+		//count down the threshold of every slot, stopping at 0; released slots are reset to 0, so they stay unchanged and need no check of whether the slot is in use
+		for (int &threshold : this->unit_thresholds) {
+			threshold = std::max(threshold - 1, 0);
+		}
+	}
+
+	bool has_timers(const int slot) const
+	{
+		return this->timer_slots[slot];
+	}
+
+	void set_has_timers(const int slot, const bool has_timers)
+	{
+		this->timer_slots[slot] = has_timers;
+		this->update_timed_effect_slot(slot);
+	}
+
+	bool has_unit_stocks(const int slot) const
+	{
+		return this->unit_stock_slots[slot];
+	}
+
+	void set_has_unit_stocks(const int slot, const bool has_unit_stocks)
+	{
+		this->unit_stock_slots[slot] = has_unit_stocks;
+		this->update_timed_effect_slot(slot);
+	}
+
+	//the slots which have an expired time to live, timers or unit stocks, in slot order
+	const std::set<int> &get_timed_effect_slots() const
+	{
+		return this->timed_effect_slots;
+	}
+
+	bool has_variable_increases(const int slot) const
+	{
+		return this->variable_increase_slots[slot];
+	}
+
+	void set_has_variable_increases(const int slot, const bool has_variable_increases)
+	{
+		this->variable_increase_slots[slot] = has_variable_increases;
+	}
+
+private:
+	void add_unit_slot(std::unique_ptr<CUnit> &&unit);
+	void reset_unit_hot_data(const int slot);
+
+	void update_timed_effect_slot(const int slot)
+	{
+		if (this->expired_ttl_slots[slot] || this->timer_slots[slot] || this->unit_stock_slots[slot]) {
+			this->timed_effect_slots.insert(slot);
+		} else {
+			this->timed_effect_slots.erase(slot);
+		}
+	}
+
 private:
 	//units currently in use
 	std::vector<CUnit *> units;
@@ -81,6 +178,24 @@ private:
 
 	//units seen under fog, which we need to keep references to in order to prevent them from being released
 	std::map<const CUnit *, std::shared_ptr<unit_ref>> units_seen_under_fog;
+
+	//the generation of each unit slot, incremented whenever the slot's unit is released, so that unit handles to it become stale
+	std::vector<uint32_t> unit_slot_generations;
+
+	//data accessed by the unit loops every cycle, stored contiguously and indexed by unit slot
+	std::vector<unsigned long> unit_ttls; //the game cycle at which each unit dies, or 0 if it doesn't have a time to live
+	std::vector<int> unit_thresholds; //the counter for while an AI unit cannot change target
+
+	//the slots of units with a time to live, ordered by the cycle at which it expires; each slot has at most one live entry, the one matching its queued TTL, and superseded entries are discarded when popped
+	std::priority_queue<std::pair<unsigned long, int>, std::vector<std::pair<unsigned long, int>>, std::greater<>> ttl_queue;
+	std::vector<unsigned long> queued_unit_ttls; //the TTL with which each slot has a live entry in the queue, or 0 if it has none
+
+	//whether each slot has a timed effect to handle, so that the unit loops only do that work for the units which need it
+	std::vector<bool> expired_ttl_slots; //whether the slot's time to live has expired, with the unit not having died yet
+	std::vector<bool> timer_slots; //whether the slot's unit may have spell cooldown or status effect timers
+	std::vector<bool> variable_increase_slots; //whether the slot's unit may have variables with a per-second increase
+	std::vector<bool> unit_stock_slots; //whether the slot's unit type has unit stocks to replenish for its owner
+	std::set<int> timed_effect_slots; //the slots with any of the flags handled each cycle, so that the each cycle loop only visits them
 };
 
 }
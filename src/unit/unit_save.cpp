@@ -269,8 +269,8 @@ void SaveUnit(const CUnit &unit, CFile &file)
 	if (unit.Active) {
 		file.printf(" \"active\",");
 	}
-	file.printf("\"ttl\", %lu,\n  ", unit.TTL);
-	file.printf("\"threshold\", %d,\n  ", unit.Threshold);
+	file.printf("\"ttl\", %lu,\n  ", unit.get_ttl());
+	file.printf("\"threshold\", %d,\n  ", unit.get_threshold());
 	file.printf("\"step-count\", %d,\n  ", unit.get_step_count());
 
 	//Wyrmgus start
@@ -321,9 +321,14 @@ void SaveUnit(const CUnit &unit, CFile &file)
 	if (!unit.Resource.Workers.empty()) {
 		file.printf(" \"resource-active\", %d,", unit.Resource.Active);
 		file.printf("\n  \"resource-workers\", {");
-		for (size_t i = 0; i < unit.Resource.Workers.size(); ++i) {
-			const std::shared_ptr<wyrmgus::unit_ref> &worker_ref = unit.Resource.Workers[i];
-			const CUnit *worker = worker_ref->get();
+		bool first = true;
+		for (const wyrmgus::unit_handle &worker_handle : unit.Resource.Workers) {
+			const CUnit *worker = worker_handle.get();
+
+			if (worker == nullptr) {
+				//the worker's slot has already been released
+				continue;
+			}
 
 			if (worker->Destroyed) {
 				/* this unit is destroyed so it's not in the global unit
@@ -331,9 +336,10 @@ void SaveUnit(const CUnit &unit, CFile &file)
 				printf("FIXME: storing destroyed Worker - loading will fail.\n");
 			}
 
-			if (i > 0) {
+			if (!first) {
 				file.printf(", ");
 			}
+			first = false;
 			file.printf("\"%s\"", UnitReference(worker).c_str());
 		}
 		file.printf("},\n  ");
@@ -1584,6 +1584,7 @@ void IndividualUpgradeAcquire(CUnit &unit, const CUpgrade *upgrade)
 	}
 	//Wyrmgus end
 	unit.SetIndividualUpgrade(upgrade, unit.GetIndividualUpgrade(upgrade) + 1);
+	UI.ButtonPanel.invalidate_allowed_buttons();
 	
 	const deity *upgrade_deity = upgrade->get_deity();
 	if (upgrade_deity != nullptr) {
@@ -1638,6 +1639,7 @@ void IndividualUpgradeLost(CUnit &unit, const CUpgrade *upgrade, bool lose_all)
 	}
 	//Wyrmgus end
 	unit.SetIndividualUpgrade(upgrade, unit.GetIndividualUpgrade(upgrade) - 1);
+	UI.ButtonPanel.invalidate_allowed_buttons();
 
 	const deity *upgrade_deity = upgrade->get_deity();
 	if (upgrade_deity != nullptr) {
@@ -1709,6 +1711,7 @@ void AllowUnitId(CPlayer &player, int id, int units)
 //Wyrmgus end
 {
 	player.Allow.Units[id] = units;
+	UI.ButtonPanel.invalidate_allowed_buttons();
 }
 
 /**
@@ -1722,6 +1725,7 @@ void AllowUpgradeId(CPlayer &player, int id, char af)
 {
 	assert_throw(af == 'A' || af == 'F' || af == 'R');
 	player.Allow.Upgrades[id] = af;
+	UI.ButtonPanel.invalidate_allowed_buttons();
 }
 
 /**
@@ -386,6 +386,12 @@ void upgrade_modifier::apply_to_player(CPlayer *player, const int multiplier) co
 			stat.change_unit_class_stock(stock_unit_class, unit_stock *multiplier);
 		}
 
+		if (!this->Modifier.get_unit_stocks().empty() || !this->Modifier.get_unit_class_stocks().empty()) {
+			for (CUnit *unit : unitupgrade) {
+				unit->register_unit_stocks();
+			}
+		}
+
 		int varModified = 0;
 		for (unsigned int j = 0; j < UnitTypeVar.GetNumberVariable(); j++) {
 			const unit_variable &modifier_variable = this->Modifier.Variables[j];
@@ -595,6 +601,7 @@ void upgrade_modifier::apply_to_unit(CUnit *unit, const int multiplier) const
 				unit_variable.Value += effective_modifier_value;
 			}
 			unit_variable.Increase += modifier_variable.Increase * multiplier;
+			unit->register_variable_increases();
 		}
 
 		unit_variable.Max += modifier_variable.Max * multiplier;
@@ -640,6 +647,9 @@ void upgrade_modifier::apply_to_unit(CUnit *unit, const int multiplier) const
 			unit->change_unit_class_stock(stock_unit_class, effective_unit_stock);
 		}
 	}
+
+	//the modifier may have changed whether the unit, or its container, counts for the military score
+	unit->update_military_score_contribution_with_container();
 }
 
 std::string upgrade_modifier::get_string() const
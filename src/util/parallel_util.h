@@ -0,0 +1,135 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+#include "util/thread_pool.h"
+
+namespace wyrmgus::parallel {
+
+//get the amount of contiguous chunks into which to split a job over the given amount of items, so that each chunk has at least the given minimum amount of items
+inline size_t get_chunk_count(const size_t item_count, const size_t min_chunk_size)
+{
+	const size_t thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	return std::clamp<size_t>(item_count / std::max<size_t>(min_chunk_size, 1), 1, thread_count);
+}
+
+//get the executor of the engine's thread pool, so that work can be posted to it without blocking on a coroutine
+inline const boost::asio::any_io_executor &get_thread_pool_executor()
+{
+	static const boost::asio::any_io_executor executor = []() {
+		boost::asio::any_io_executor pool_executor;
+
+		thread_pool::get()->co_spawn_sync([&pool_executor]() -> boost::asio::awaitable<void> {
+			pool_executor = co_await boost::asio::this_coro::executor;
+		});
+
+		return pool_executor;
+	}();
+
+	return executor;
+}
+
+//call the function for contiguous, non-overlapping chunks of the index range [0, item_count), with the chunks being processed concurrently on the thread pool; the function is called with the begin and end indices of a chunk
+//the function must only write to data belonging to its chunk, so that the result does not depend on how the chunks are scheduled
+//the calling thread processes chunks as well, and only waits for chunks which have already been started by the pool, so that this does not deadlock if all pool threads are busy (or if it is called from a pool thread)
+template <typename function_type>
+void for_each_chunk(const size_t item_count, const size_t min_chunk_size, const function_type &function)
+{
+	const size_t chunk_count = parallel::get_chunk_count(item_count, min_chunk_size);
+
+	if (chunk_count <= 1) {
+		function(static_cast<size_t>(0), item_count);
+		return;
+	}
+
+	const size_t chunk_size = (item_count + chunk_count - 1) / chunk_count;
+
+	struct chunk_state final
+	{
+		std::atomic<size_t> next_chunk_index = 0;
+		size_t finished_chunk_count = 0;
+		std::exception_ptr exception;
+		std::mutex mutex;
+		std::condition_variable finished_condition;
+	};
+
+	//the state is shared with the posted tasks, since these may only start after this function has returned, in which case they find no chunk left to process
+	const std::shared_ptr<chunk_state> state = std::make_shared<chunk_state>();
+
+	const auto process_chunks = [state, chunk_count, chunk_size, item_count, &function]() {
+		while (true) {
+			const size_t chunk_index = state->next_chunk_index.fetch_add(1);
+			if (chunk_index >= chunk_count) {
+				return;
+			}
+
+			const size_t begin = chunk_index * chunk_size;
+			const size_t end = std::min(begin + chunk_size, item_count);
+
+			std::exception_ptr exception;
+
+			try {
+				if (begin < end) {
+					function(begin, end);
+				}
+			} catch (...) {
+				exception = std::current_exception();
+			}
+
+			std::lock_guard<std::mutex> lock(state->mutex);
+
+			if (exception != nullptr && state->exception == nullptr) {
+				state->exception = exception;
+			}
+
+			++state->finished_chunk_count;
+
+			if (state->finished_chunk_count == chunk_count) {
+				state->finished_condition.notify_all();
+			}
+		}
+	};
+
+	const boost::asio::any_io_executor &executor = parallel::get_thread_pool_executor();
+
+	for (size_t i = 1; i < chunk_count; ++i) {
+		boost::asio::post(executor, process_chunks);
+	}
+
+	process_chunks();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->finished_condition.wait(lock, [&state, chunk_count]() {
+		return state->finished_chunk_count == chunk_count;
+	});
+
+	if (state->exception != nullptr) {
+		std::rethrow_exception(state->exception);
+	}
+}
+
+}
@@ -721,7 +721,31 @@ QPoint CGraphic::get_frame_pos(const int frame_index) const
 QImage CGraphic::create_modified_image(const color_modification &color_modification, const bool grayscale) const
 {
 	QImage image = this->get_image();
+	this->apply_modifications(image, color_modification, grayscale);
+	return image;
+}
+
+QImage CGraphic::create_modified_frame_image(const size_t frame_index, const color_modification &color_modification, const bool grayscale) const
+{
+	//this is called from the image provider worker pool, which must have loaded the graphic before reading its image
+	assert_throw(this->IsLoaded());
+
+	if (frame_index >= static_cast<size_t>(this->NumFrames)) {
+		throw std::runtime_error("Invalid frame index " + std::to_string(frame_index) + " for graphic \"" + this->get_filepath().string() + "\".");
+	}
 
+	//the image is stored at its loaded size, with the scaling only being applied to modified images
+	const QSize &frame_size = this->get_loaded_frame_size();
+	const QPoint frame_pos = this->get_frame_pos(static_cast<int>(frame_index));
+	const QRect frame_rect(QPoint(frame_pos.x() * frame_size.width(), frame_pos.y() * frame_size.height()), frame_size);
+
+	QImage image = this->get_image().copy(frame_rect);
+	this->apply_modifications(image, color_modification, grayscale);
+	return image;
+}
+
+void CGraphic::apply_modifications(QImage &image, const color_modification &color_modification, const bool grayscale) const
+{
 	if (image.format() != QImage::Format_RGBA8888) {
 		image = image.convertToFormat(QImage::Format_RGBA8888);
 	}
@@ -779,7 +803,6 @@ QImage CGraphic::create_modified_image(const color_modification &color_modificat
 		}
 	}
 
-	return image;
 }
 
 void CGraphic::create_frame_images(const color_modification &color_modification, const bool grayscale)
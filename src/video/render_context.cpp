@@ -28,6 +28,7 @@
 
 #include "video/render_context.h"
 
+#include "profiler.h"
 #include "util/exception_util.h"
 #include "video/frame_buffer_object.h"
 
@@ -49,6 +50,8 @@ void render_context::set_commands(std::vector<std::function<void(renderer *)>> &
 
 void render_context::run(renderer *renderer)
 {
+	PROFILE_SCOPE(profiler_stage::render);
+
 	std::vector<std::function<void(wyrmgus::renderer *)>> commands;
 
 	{
@@ -242,6 +242,7 @@ public:
 	int get_frame_index(const QPoint &frame_pos) const;
 	QPoint get_frame_pos(const int frame_index) const;
 
+	//the image may be read from several threads at once after Load has returned, as Load only modifies it while holding the load mutex, and a thread which called Load acquired that mutex after any such modification; it must not be read concurrently with unload or resizing
 	const QImage &get_image() const
 	{
 		return this->image;
@@ -249,6 +250,9 @@ public:
 
 	QImage create_modified_image(const color_modification &color_modification, const bool grayscale) const;
 
+	//create a modified image of a single frame, without creating those of the other frames
+	QImage create_modified_frame_image(const size_t frame_index, const color_modification &color_modification, const bool grayscale) const;
+
 	const QImage *get_frame_image(const size_t frame_index, const color_modification &color_modification = {}, const bool grayscale = false) const
 	{
 		if (grayscale) {
@@ -382,6 +386,9 @@ public:
 
 	void free_textures();
 
+private:
+	void apply_modifications(QImage &image, const color_modification &color_modification, const bool grayscale) const;
+
 private:
 	std::filesystem::path filepath;
 public:
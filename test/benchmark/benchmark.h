@@ -0,0 +1,147 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+namespace wyrmgus::benchmark {
+
+//the state passed to each benchmark function; its iteration loop mirrors Google Benchmark's, so that results can be compared with tooling written for it
+class state final
+{
+public:
+	explicit state(const std::vector<int64_t> &args, const int64_t max_iterations)
+		: args(args), max_iterations(max_iterations)
+	{
+	}
+
+	int64_t range(const size_t index) const
+	{
+		return this->args.at(index);
+	}
+
+	bool keep_running()
+	{
+		if (this->iterations == 0) {
+			this->resume_timing();
+		}
+
+		if (this->iterations >= this->max_iterations) {
+			this->pause_timing();
+			return false;
+		}
+
+		++this->iterations;
+		return true;
+	}
+
+	void pause_timing()
+	{
+		if (this->running) {
+			this->elapsed += std::chrono::steady_clock::now() - this->start_time;
+			this->running = false;
+		}
+	}
+
+	void resume_timing()
+	{
+		if (!this->running) {
+			this->start_time = std::chrono::steady_clock::now();
+			this->running = true;
+		}
+	}
+
+	int64_t get_iterations() const
+	{
+		return this->iterations;
+	}
+
+	std::chrono::nanoseconds get_elapsed() const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(this->elapsed);
+	}
+
+	int64_t get_items_processed() const
+	{
+		return this->items_processed;
+	}
+
+	void set_items_processed(const int64_t items)
+	{
+		this->items_processed = items;
+	}
+
+	const std::string &get_label() const
+	{
+		return this->label;
+	}
+
+	void set_label(const std::string &label)
+	{
+		this->label = label;
+	}
+
+private:
+	const std::vector<int64_t> &args;
+	int64_t max_iterations = 0;
+	int64_t iterations = 0;
+	int64_t items_processed = 0;
+	bool running = false;
+	std::chrono::steady_clock::time_point start_time;
+	std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::duration::zero();
+	std::string label;
+};
+
+using function = void(*)(state &);
+
+struct definition final
+{
+	std::string name;
+	function func = nullptr;
+	std::vector<std::vector<int64_t>> arg_sets;
+};
+
+extern bool register_benchmark(const std::string &name, const function func, std::vector<std::vector<int64_t>> &&arg_sets = {});
+
+//prevents the compiler from optimizing away a computed value
+template <typename T>
+inline void do_not_optimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void *sink = nullptr;
+	sink = &value;
+#endif
+}
+
+}
+
+#define WYRMGUS_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define WYRMGUS_BENCHMARK_CONCAT(a, b) WYRMGUS_BENCHMARK_CONCAT_IMPL(a, b)
+
+//register a benchmark function, optionally with a list of argument sets, each of which is run as a separate benchmark
+#define WYRMGUS_BENCHMARK(func, ...) \
+	static const bool WYRMGUS_BENCHMARK_CONCAT(func##_registered_, __LINE__) = wyrmgus::benchmark::register_benchmark(#func, func, { __VA_ARGS__ })
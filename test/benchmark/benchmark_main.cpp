@@ -0,0 +1,283 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "benchmark.h"
+
+#include "version.h"
+
+#include <QCoreApplication>
+
+namespace wyrmgus::benchmark {
+
+struct result final
+{
+	std::string name;
+	int64_t iterations = 0;
+	double real_time = 0; //in nanoseconds per iteration
+	double cpu_time = 0; //in nanoseconds per iteration
+	double items_per_second = 0;
+	std::string label;
+};
+
+static std::vector<definition> &get_definitions()
+{
+	static std::vector<definition> definitions;
+	return definitions;
+}
+
+bool register_benchmark(const std::string &name, const function func, std::vector<std::vector<int64_t>> &&arg_sets)
+{
+	definition def;
+	def.name = name;
+	def.func = func;
+	def.arg_sets = std::move(arg_sets);
+
+	if (def.arg_sets.empty()) {
+		def.arg_sets.emplace_back();
+	}
+
+	get_definitions().push_back(std::move(def));
+	return true;
+}
+
+static std::string get_run_name(const definition &def, const std::vector<int64_t> &args)
+{
+	std::string name = def.name;
+
+	for (const int64_t arg : args) {
+		name += "/" + std::to_string(arg);
+	}
+
+	return name;
+}
+
+static result run_benchmark(const definition &def, const std::vector<int64_t> &args, const std::chrono::duration<double> min_time)
+{
+	static constexpr int64_t max_iterations = 1000000000;
+
+	int64_t iterations = 1;
+
+	while (true) {
+		state state(args, iterations);
+
+		const std::clock_t cpu_start = std::clock();
+		def.func(state);
+		const std::clock_t cpu_end = std::clock();
+
+		const std::chrono::duration<double> elapsed = state.get_elapsed();
+
+		if (elapsed >= min_time || iterations >= max_iterations) {
+			result result;
+			result.name = get_run_name(def, args);
+			result.iterations = state.get_iterations();
+			result.real_time = static_cast<double>(state.get_elapsed().count()) / std::max<int64_t>(1, result.iterations);
+			result.cpu_time = (static_cast<double>(cpu_end - cpu_start) / CLOCKS_PER_SEC) * 1e9 / std::max<int64_t>(1, result.iterations);
+			if (state.get_items_processed() > 0 && elapsed.count() > 0) {
+				result.items_per_second = static_cast<double>(state.get_items_processed()) / elapsed.count();
+			}
+			result.label = state.get_label();
+			return result;
+		}
+
+		//estimate how many iterations are needed to reach the minimum time, in the same way as Google Benchmark
+		double multiplier = min_time.count() * 1.4 / std::max(elapsed.count(), 1e-9);
+		if (elapsed.count() / min_time.count() <= 0.1) {
+			multiplier = std::min(multiplier, 10.);
+		}
+		iterations = std::clamp<int64_t>(static_cast<int64_t>(iterations * multiplier), iterations + 1, max_iterations);
+	}
+}
+
+static std::string escape_json(const std::string &str)
+{
+	std::string escaped;
+
+	for (const char c : str) {
+		switch (c) {
+			case '"':
+				escaped += "\\\"";
+				break;
+			case '\\':
+				escaped += "\\\\";
+				break;
+			case '\n':
+				escaped += "\\n";
+				break;
+			default:
+				escaped += c;
+				break;
+		}
+	}
+
+	return escaped;
+}
+
+//write the results in the same format as Google Benchmark's JSON reporter, so that its comparison tools can be used on them
+static void write_json(std::ostream &stream, const std::vector<result> &results)
+{
+	const std::time_t now = std::time(nullptr);
+	char date[64];
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+	stream << "{\n";
+	stream << "  \"context\": {\n";
+	stream << "    \"date\": \"" << date << "\",\n";
+	stream << "    \"executable\": \"wyrmgus_benchmark\",\n";
+	stream << "    \"version\": \"" << escape_json(VERSION) << "\",\n";
+	stream << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+	stream << "    \"library_build_type\": \"release\"\n";
+#else
+	stream << "    \"library_build_type\": \"debug\"\n";
+#endif
+	stream << "  },\n";
+	stream << "  \"benchmarks\": [\n";
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		const result &result = results[i];
+
+		stream << "    {\n";
+		stream << "      \"name\": \"" << escape_json(result.name) << "\",\n";
+		stream << "      \"run_name\": \"" << escape_json(result.name) << "\",\n";
+		stream << "      \"run_type\": \"iteration\",\n";
+		stream << "      \"iterations\": " << result.iterations << ",\n";
+		stream << "      \"real_time\": " << result.real_time << ",\n";
+		stream << "      \"cpu_time\": " << result.cpu_time << ",\n";
+		stream << "      \"time_unit\": \"ns\"";
+		if (result.items_per_second > 0) {
+			stream << ",\n      \"items_per_second\": " << result.items_per_second;
+		}
+		if (!result.label.empty()) {
+			stream << ",\n      \"label\": \"" << escape_json(result.label) << "\"";
+		}
+		stream << "\n    }";
+		if (i + 1 < results.size()) {
+			stream << ",";
+		}
+		stream << "\n";
+	}
+
+	stream << "  ]\n";
+	stream << "}\n";
+}
+
+static void print_result(const result &result)
+{
+	std::cout << std::left << std::setw(48) << result.name << std::right
+		<< std::setw(16) << std::fixed << std::setprecision(0) << result.real_time << " ns"
+		<< std::setw(16) << result.cpu_time << " ns"
+		<< std::setw(12) << result.iterations;
+
+	if (result.items_per_second > 0) {
+		std::cout << "  items_per_second=" << std::setprecision(3) << std::scientific << result.items_per_second << std::fixed;
+	}
+
+	if (!result.label.empty()) {
+		std::cout << "  " << result.label;
+	}
+
+	std::cout << std::endl;
+}
+
+}
+
+static void print_usage()
+{
+	std::cout << "Usage: wyrmgus_benchmark [options]\n"
+		"\t--benchmark_filter=<regex>      Only run benchmarks whose name matches the regex\n"
+		"\t--benchmark_min_time=<seconds>  Minimum time to run each benchmark for (default 0.5)\n"
+		"\t--benchmark_out=<file>          Write the results as JSON to the file\n"
+		"\t--benchmark_list_tests          List the benchmarks instead of running them\n";
+}
+
+int main(int argc, char **argv)
+{
+	using namespace wyrmgus::benchmark;
+
+	//the game state expects a Qt application object to exist, but no GUI is needed for the benchmarks
+	QCoreApplication app(argc, argv);
+
+	std::regex filter(".*");
+	std::chrono::duration<double> min_time(0.5);
+	std::string out_filepath;
+	bool list_only = false;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+
+		if (arg.starts_with("--benchmark_filter=")) {
+			filter = std::regex(arg.substr(arg.find('=') + 1));
+		} else if (arg.starts_with("--benchmark_min_time=")) {
+			min_time = std::chrono::duration<double>(std::stod(arg.substr(arg.find('=') + 1)));
+		} else if (arg.starts_with("--benchmark_out=")) {
+			out_filepath = arg.substr(arg.find('=') + 1);
+		} else if (arg == "--benchmark_list_tests") {
+			list_only = true;
+		} else {
+			print_usage();
+			return arg == "-h" || arg == "--help" ? 0 : 1;
+		}
+	}
+
+	std::vector<result> results;
+
+	try {
+		for (const definition &def : get_definitions()) {
+			for (const std::vector<int64_t> &args : def.arg_sets) {
+				const std::string run_name = get_run_name(def, args);
+
+				if (!std::regex_search(run_name, filter)) {
+					continue;
+				}
+
+				if (list_only) {
+					std::cout << run_name << std::endl;
+					continue;
+				}
+
+				results.push_back(run_benchmark(def, args, min_time));
+				print_result(results.back());
+			}
+		}
+	} catch (const std::exception &exception) {
+		exception::report(exception);
+		return 1;
+	}
+
+	if (!out_filepath.empty()) {
+		std::ofstream ofstream(out_filepath);
+		if (!ofstream) {
+			std::cerr << "Failed to open \"" << out_filepath << "\" for writing." << std::endl;
+			return 1;
+		}
+
+		write_json(ofstream, results);
+	}
+
+	return 0;
+}
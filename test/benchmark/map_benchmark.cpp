@@ -0,0 +1,222 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "benchmark.h"
+#include "map_fixture.h"
+
+#include "iolib.h"
+#include "map/landmass.h"
+#include "map/map.h"
+#include "map/map_layer.h"
+#include "map/terrain_type.h"
+#include "map/tile.h"
+#include "map/tile_flag.h"
+#include "pathfinder/pathfinder.h"
+
+namespace wyrmgus::benchmark {
+
+class flood_fill_context final
+{
+public:
+	VisitResult Visit(TerrainTraversal &terrain_traversal, const Vec2i &pos, const Vec2i &from)
+	{
+		Q_UNUSED(terrain_traversal)
+		Q_UNUSED(from)
+
+		++this->visited_count;
+
+		if (CMap::get()->Field(pos, 0)->CheckMask(tile_flag::impassable)) {
+			return VisitResult::DeadEnd;
+		}
+
+		return VisitResult::Ok;
+	}
+
+	int64_t get_visited_count() const
+	{
+		return this->visited_count;
+	}
+
+private:
+	int64_t visited_count = 0;
+};
+
+//flood fill the whole map from its center
+static void TerrainTraversal_FloodFill(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	map_fixture fixture(map_size, map_size);
+
+	int64_t visited_count = 0;
+
+	while (state.keep_running()) {
+		TerrainTraversal terrain_traversal;
+		terrain_traversal.SetSize(map_size, map_size);
+		terrain_traversal.Init();
+		terrain_traversal.PushPos(fixture.get_random_passable_pos());
+
+		flood_fill_context context;
+		terrain_traversal.Run(context);
+
+		visited_count += context.get_visited_count();
+	}
+
+	state.set_items_processed(visited_count);
+}
+
+WYRMGUS_BENCHMARK(TerrainTraversal_FloodFill, { 64 }, { 128 }, { 256 }, { 512 });
+
+//mark and unmark the sight of a unit-sized area at random positions
+static void MapSight_MarkUnmark(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	const int sight_range = static_cast<int>(state.range(1));
+	map_fixture fixture(map_size, map_size);
+
+	const CPlayer &player = *map_fixture::get_player(0);
+
+	std::vector<QPoint> positions;
+	for (int i = 0; i < 256; ++i) {
+		positions.push_back(fixture.get_random_passable_pos());
+	}
+
+	size_t position_index = 0;
+
+	while (state.keep_running()) {
+		const QPoint &pos = positions[position_index];
+		position_index = (position_index + 1) % positions.size();
+
+		MapSight<MapMarkTileSight>(player, pos, 1, 1, sight_range, 0);
+		MapSight<MapUnmarkTileSight>(player, pos, 1, 1, sight_range, 0);
+	}
+
+	state.set_items_processed(state.get_iterations() * 2);
+}
+
+WYRMGUS_BENCHMARK(MapSight_MarkUnmark, { 128, 4 }, { 128, 8 }, { 128, 16 }, { 512, 8 });
+
+//save every tile of the map layer, as done when saving a game
+static void tile_Save(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	map_fixture fixture(map_size, map_size);
+
+	const CMapLayer *map_layer = fixture.get_map_layer();
+	const int tile_count = map_size * map_size;
+
+	const std::filesystem::path filepath = std::filesystem::temp_directory_path() / "wyrmgus_benchmark_tiles.sav";
+
+	while (state.keep_running()) {
+		state.pause_timing();
+		CFile file;
+		if (file.open(path::to_string(filepath).c_str(), CL_OPEN_WRITE) == -1) {
+			throw std::runtime_error("Failed to open \"" + path::to_string(filepath) + "\" for writing.");
+		}
+		state.resume_timing();
+
+		for (int i = 0; i < tile_count; ++i) {
+			map_layer->Field(i)->Save(file);
+		}
+
+		state.pause_timing();
+		file.close();
+		state.resume_timing();
+	}
+
+	std::filesystem::remove(filepath);
+
+	state.set_items_processed(state.get_iterations() * tile_count);
+}
+
+WYRMGUS_BENCHMARK(tile_Save, { 64 }, { 256 });
+
+//read the terrain type and landmass of every tile, as done by the per-tile checks of pathfinding and AI searches
+static void tile_GetTerrainAndLandmass(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	map_fixture fixture(map_size, map_size);
+
+	static terrain_type *benchmark_terrain_type = terrain_type::add("terrain_benchmark", nullptr);
+
+	if (CMap::get()->get_landmasses().empty()) {
+		CMap::get()->add_landmass(std::make_unique<landmass>(0));
+	}
+	const landmass *benchmark_landmass = CMap::get()->get_landmasses().front().get();
+
+	CMapLayer *map_layer = fixture.get_map_layer();
+	const int tile_count = map_size * map_size;
+
+	for (int i = 0; i < tile_count; ++i) {
+		tile *tile = map_layer->Field(i);
+		tile->SetTerrain(benchmark_terrain_type);
+		tile->set_landmass(benchmark_landmass);
+	}
+
+	int64_t matching_count = 0;
+
+	while (state.keep_running()) {
+		for (int i = 0; i < tile_count; ++i) {
+			const tile *tile = map_layer->Field(i);
+
+			if (tile->get_terrain() == benchmark_terrain_type && tile->get_landmass() == benchmark_landmass) {
+				++matching_count;
+			}
+		}
+	}
+
+	do_not_optimize(matching_count);
+
+	state.set_items_processed(state.get_iterations() * tile_count);
+}
+
+WYRMGUS_BENCHMARK(tile_GetTerrainAndLandmass, { 64 }, { 256 });
+
+//allocate and initialize the tiles of a map layer, as done when loading a map
+static void CMapLayer_Create(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	const int64_t tile_count = static_cast<int64_t>(map_size) * map_size;
+
+	while (state.keep_running()) {
+		auto map_layer = std::make_unique<CMapLayer>(map_size, map_size);
+		do_not_optimize(map_layer);
+
+		state.pause_timing();
+		map_layer.reset();
+		state.resume_timing();
+	}
+
+	//the size of the map layer's tile arrays as allocated, from the sizes of the tile types; this is not a measurement of resident memory, and it excludes the per-tile containers, which are only allocated when used
+	const size_t tile_size = sizeof(tile) + sizeof(tile_player_info);
+	state.set_label(std::to_string(tile_size) + " bytes allocated per tile, " + std::to_string(tile_count * static_cast<int64_t>(tile_size) / (1024 * 1024)) + " MiB allocated in total");
+	state.set_items_processed(state.get_iterations() * tile_count);
+}
+
+WYRMGUS_BENCHMARK(CMapLayer_Create, { 256 }, { 1024 });
+
+}
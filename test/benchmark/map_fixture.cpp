@@ -0,0 +1,216 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "map_fixture.h"
+
+#include "map/map.h"
+#include "map/map_info.h"
+#include "map/map_layer.h"
+#include "map/tile.h"
+#include "map/tile_flag.h"
+#include "missile.h"
+#include "missile/missile_class.h"
+#include "pathfinder/pathfinder.h"
+#include "player/player.h"
+#include "player/player_type.h"
+#include "unit/unit.h"
+#include "unit/unit_manager.h"
+#include "unit/unit_type.h"
+
+namespace wyrmgus::benchmark {
+
+static unit_type *benchmark_unit_type = nullptr;
+static missile_type *benchmark_missile_type = nullptr;
+
+void map_fixture::initialize_game_state()
+{
+	static bool initialized = false;
+
+	if (initialized) {
+		return;
+	}
+
+	UnitTypeVar.Init();
+
+	for (size_t p = CPlayer::Players.size(); p < PlayerMax; ++p) {
+		CPlayer::Players.push_back(make_qunique<CPlayer>(static_cast<int>(p)));
+	}
+
+	for (int p = 0; p < PlayerMax; ++p) {
+		CPlayer::Players[p]->set_type(player_type::nobody);
+	}
+	CPlayer::Players[PlayerNumNeutral]->set_type(player_type::neutral);
+
+	//the players of the fixture are all enemies of one another, so that target searches have something to find
+	for (int p = 0; p < map_fixture::player_count; ++p) {
+		CPlayer *player = CPlayer::Players[p].get();
+		player->set_type(p == 0 ? player_type::person : player_type::computer);
+
+		for (int other_p = 0; other_p < map_fixture::player_count; ++other_p) {
+			if (other_p != p) {
+				player->set_enemy_diplomatic_stance_with(CPlayer::Players[other_p].get());
+			}
+		}
+	}
+	NumPlayers = map_fixture::player_count;
+	CPlayer::SetThisPlayer(CPlayer::Players[0].get());
+
+	benchmark_unit_type = unit_type::add("unit_benchmark", nullptr);
+	benchmark_unit_type->setProperty("tile_size", QSize(1, 1));
+	benchmark_unit_type->DefaultStat.Variables[HP_INDEX].Max = 100;
+	benchmark_unit_type->DefaultStat.Variables[HP_INDEX].Value = 100;
+	benchmark_unit_type->DefaultStat.Variables[HP_INDEX].Enable = 1;
+	benchmark_unit_type->DefaultStat.Variables[SIGHTRANGE_INDEX].Max = 6;
+	benchmark_unit_type->DefaultStat.Variables[SIGHTRANGE_INDEX].Value = 6;
+	benchmark_unit_type->DefaultStat.Variables[SIGHTRANGE_INDEX].Enable = 1;
+	benchmark_unit_type->DefaultStat.Variables[ATTACKRANGE_INDEX].Max = 1;
+	benchmark_unit_type->DefaultStat.Variables[ATTACKRANGE_INDEX].Value = 1;
+	benchmark_unit_type->DefaultStat.Variables[ATTACKRANGE_INDEX].Enable = 1;
+	UpdateUnitStats(*benchmark_unit_type, 1);
+
+	benchmark_missile_type = missile_type::add("missile_benchmark", nullptr);
+	benchmark_missile_type->setProperty("missile_class", QVariant::fromValue(missile_class::point_to_point));
+	benchmark_missile_type->setProperty("frame_size", QSize(32, 32));
+	benchmark_missile_type->setProperty("speed", 1);
+	benchmark_missile_type->setProperty("sleep", 1);
+
+	initialized = true;
+}
+
+const unit_type *map_fixture::get_unit_type()
+{
+	map_fixture::initialize_game_state();
+	return benchmark_unit_type;
+}
+
+const missile_type *map_fixture::get_missile_type()
+{
+	map_fixture::initialize_game_state();
+	return benchmark_missile_type;
+}
+
+CPlayer *map_fixture::get_player(const int index)
+{
+	map_fixture::initialize_game_state();
+	return CPlayer::Players.at(index).get();
+}
+
+map_fixture::map_fixture(const int width, const int height, const int unit_count)
+	: width(width), height(height), random_engine(static_cast<unsigned>(width * 31 + height * 17 + unit_count))
+{
+	map_fixture::initialize_game_state();
+
+	unit_manager::get()->init();
+
+	this->create_map_layer();
+
+	InitPathfinder();
+
+	this->create_units(unit_count);
+}
+
+map_fixture::~map_fixture()
+{
+	CleanMissiles();
+	unit_manager::get()->clean_units();
+	unit_manager::get()->init();
+
+	FreePathfinder();
+
+	CMap::get()->ClearMapLayers();
+	CMap::get()->Info->MapWidths.clear();
+	CMap::get()->Info->MapHeights.clear();
+	CMap::get()->Info->set_map_size(QSize(0, 0));
+}
+
+CMapLayer *map_fixture::get_map_layer() const
+{
+	return CMap::get()->MapLayers.front().get();
+}
+
+void map_fixture::create_map_layer()
+{
+	if (!CMap::get()->MapLayers.empty()) {
+		throw std::runtime_error("Tried to create a benchmark map while another map already exists.");
+	}
+
+	CMap::get()->Info->set_map_size(QSize(this->width, this->height));
+	CMap::get()->Info->MapWidths.push_back(this->width);
+	CMap::get()->Info->MapHeights.push_back(this->height);
+
+	auto map_layer = std::make_unique<CMapLayer>(this->width, this->height);
+	map_layer->ID = 0;
+
+	//lay walls across the map at regular intervals, with periodic gaps, so that searches have to route around obstacles
+	for (int x = 0; x < this->width; ++x) {
+		for (int y = 0; y < this->height; ++y) {
+			tile *tile = map_layer->Field(x, y);
+			tile->Flags = tile_flag::land_allowed;
+
+			if (x > 0 && (x % map_fixture::wall_spacing) == 0 && (y % map_fixture::wall_gap_spacing) != 0) {
+				tile->Flags |= tile_flag::rock | tile_flag::impassable | tile_flag::air_impassable;
+			}
+		}
+	}
+
+	CMap::get()->MapLayers.push_back(std::move(map_layer));
+}
+
+void map_fixture::create_units(const int unit_count)
+{
+	const unit_type *unit_type = map_fixture::get_unit_type();
+
+	this->units.reserve(unit_count);
+
+	for (int i = 0; i < unit_count; ++i) {
+		CPlayer *player = map_fixture::get_player(i % map_fixture::player_count);
+
+		CUnit *unit = MakeUnitAndPlace(this->get_random_passable_pos(), *unit_type, player, 0);
+		if (unit == nullptr) {
+			throw std::runtime_error("Failed to create benchmark unit.");
+		}
+
+		this->units.push_back(unit);
+	}
+}
+
+QPoint map_fixture::get_random_passable_pos()
+{
+	std::uniform_int_distribution<int> x_distribution(0, this->width - 1);
+	std::uniform_int_distribution<int> y_distribution(0, this->height - 1);
+
+	while (true) {
+		const QPoint pos(x_distribution(this->random_engine), y_distribution(this->random_engine));
+
+		if (!CMap::get()->Field(pos, 0)->CheckMask(tile_flag::impassable)) {
+			return pos;
+		}
+	}
+}
+
+}
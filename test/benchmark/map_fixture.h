@@ -0,0 +1,90 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#pragma once
+
+class CMapLayer;
+class CPlayer;
+class CUnit;
+
+namespace wyrmgus {
+	class missile_type;
+	class unit_type;
+}
+
+namespace wyrmgus::benchmark {
+
+//a synthetic single-layer map with a configurable unit population, set up without any game data
+class map_fixture final
+{
+public:
+	static constexpr int player_count = 2;
+	static constexpr int wall_spacing = 16; //the spacing between the impassable walls laid across the map
+	static constexpr int wall_gap_spacing = 8; //the spacing between the gaps in each wall
+
+	static const unit_type *get_unit_type();
+	static const missile_type *get_missile_type();
+	static CPlayer *get_player(const int index);
+
+	explicit map_fixture(const int width, const int height, const int unit_count = 0);
+	~map_fixture();
+
+	map_fixture(const map_fixture &other) = delete;
+	map_fixture &operator =(const map_fixture &other) = delete;
+
+	int get_width() const
+	{
+		return this->width;
+	}
+
+	int get_height() const
+	{
+		return this->height;
+	}
+
+	CMapLayer *get_map_layer() const;
+
+	const std::vector<CUnit *> &get_units() const
+	{
+		return this->units;
+	}
+
+	//get a random passable position, drawn from the fixture's own deterministic generator
+	QPoint get_random_passable_pos();
+
+private:
+	static void initialize_game_state();
+
+	void create_map_layer();
+	void create_units(const int unit_count);
+
+	int width = 0;
+	int height = 0;
+	std::vector<CUnit *> units;
+	std::mt19937 random_engine;
+};
+
+}
@@ -0,0 +1,79 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "benchmark.h"
+
+#include "script.h"
+
+namespace wyrmgus::benchmark {
+
+static std::unique_ptr<NumberDesc> create_direct_number(const int value)
+{
+	auto number = std::make_unique<NumberDesc>();
+	number->e = ENumber_Dir;
+	number->D.Val = value;
+	return number;
+}
+
+//build a balanced expression tree of the given depth, cycling through the arithmetic and comparison operators, as used by UI and trigger expressions
+static std::unique_ptr<NumberDesc> create_number_tree(const int depth, int &leaf_value)
+{
+	static constexpr std::array<ENumber, 8> operators = {
+		ENumber_Add, ENumber_Sub, ENumber_Mul, ENumber_Max, ENumber_Min, ENumber_Gt, ENumber_LtEq, ENumber_Div
+	};
+
+	if (depth == 0) {
+		return create_direct_number(++leaf_value);
+	}
+
+	auto number = std::make_unique<NumberDesc>();
+	number->e = operators[depth % operators.size()];
+	number->D.binOp.Left = create_number_tree(depth - 1, leaf_value);
+	number->D.binOp.Right = create_number_tree(depth - 1, leaf_value);
+	return number;
+}
+
+static void EvalNumber_Tree(state &state)
+{
+	const int depth = static_cast<int>(state.range(0));
+
+	int leaf_value = 0;
+	const std::unique_ptr<NumberDesc> number = create_number_tree(depth, leaf_value);
+
+	while (state.keep_running()) {
+		const int result = EvalNumber(number.get());
+		do_not_optimize(result);
+	}
+
+	//each evaluation visits every node of the tree
+	state.set_items_processed(state.get_iterations() * ((int64_t(1) << (depth + 1)) - 1));
+}
+
+WYRMGUS_BENCHMARK(EvalNumber_Tree, { 1 }, { 4 }, { 8 }, { 12 });
+
+}
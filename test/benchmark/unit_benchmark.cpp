@@ -0,0 +1,260 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "benchmark.h"
+#include "map_fixture.h"
+
+#include "actions.h"
+#include "map/map.h"
+#include "missile.h"
+#include "pathfinder/pathfinder.h"
+#include "unit/unit.h"
+#include "unit/unit_find.h"
+#include "unit/unit_manager.h"
+#include "unit/unit_type.h"
+
+namespace wyrmgus::benchmark {
+
+//find paths between a unit and random goals across a map with walls
+static void AStarFindPath_RandomGoals(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	map_fixture fixture(map_size, map_size, 1);
+
+	const CUnit &unit = *fixture.get_units().front();
+
+	std::vector<QPoint> goals;
+	for (int i = 0; i < 64; ++i) {
+		goals.push_back(fixture.get_random_passable_pos());
+	}
+
+	size_t goal_index = 0;
+	int64_t reached_count = 0;
+
+	while (state.keep_running()) {
+		const QPoint &goal_pos = goals[goal_index];
+		goal_index = (goal_index + 1) % goals.size();
+
+		std::array<char, PathFinderOutput::MAX_PATH_LENGTH> path{};
+		const int result = AStarFindPath(unit.tilePos, goal_pos, 1, 1, unit.Type->get_tile_width(), unit.Type->get_tile_height(), 0, 0, &path, unit, 0, 0);
+		if (result >= 0) {
+			++reached_count;
+		}
+		do_not_optimize(path);
+	}
+
+	state.set_label(std::to_string(reached_count) + " paths found");
+}
+
+WYRMGUS_BENCHMARK(AStarFindPath_RandomGoals, { 64 }, { 128 }, { 256 });
+
+//select the units in a square area around random positions
+static void SelectFixed_Area(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	const int unit_count = static_cast<int>(state.range(1));
+	const int area_size = static_cast<int>(state.range(2));
+	map_fixture fixture(map_size, map_size, unit_count);
+
+	std::vector<QPoint> positions;
+	for (int i = 0; i < 256; ++i) {
+		positions.push_back(fixture.get_random_passable_pos());
+	}
+
+	size_t position_index = 0;
+	std::vector<CUnit *> table;
+	int64_t found_count = 0;
+
+	while (state.keep_running()) {
+		const QPoint &pos = positions[position_index];
+		position_index = (position_index + 1) % positions.size();
+
+		const Vec2i top_left(std::max(0, pos.x() - area_size / 2), std::max(0, pos.y() - area_size / 2));
+		const Vec2i bottom_right(std::min(map_size - 1, pos.x() + area_size / 2), std::min(map_size - 1, pos.y() + area_size / 2));
+
+		table.clear();
+		SelectFixed(top_left, bottom_right, table, 0);
+		found_count += static_cast<int64_t>(table.size());
+	}
+
+	state.set_items_processed(found_count);
+}
+
+WYRMGUS_BENCHMARK(SelectFixed_Area, { 128, 1000, 16 }, { 128, 1000, 64 }, { 256, 5000, 16 }, { 256, 5000, 64 });
+
+//look for the best target in range for each unit in turn
+static void AttackUnitsInDistance_AllUnits(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	const int unit_count = static_cast<int>(state.range(1));
+	const int range = static_cast<int>(state.range(2));
+	map_fixture fixture(map_size, map_size, unit_count);
+
+	const std::vector<CUnit *> &units = fixture.get_units();
+	size_t unit_index = 0;
+
+	while (state.keep_running()) {
+		const CUnit &unit = *units[unit_index];
+		unit_index = (unit_index + 1) % units.size();
+
+		CUnit *target = AttackUnitsInDistance<false>(unit, range);
+		do_not_optimize(target);
+	}
+
+	state.set_items_processed(state.get_iterations());
+}
+
+WYRMGUS_BENCHMARK(AttackUnitsInDistance_AllUnits, { 128, 1000, 6 }, { 256, 5000, 6 }, { 256, 5000, 12 });
+
+//run the per-cycle unit actions for a whole population of idle units
+static void UnitActions_Population(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	const int unit_count = static_cast<int>(state.range(1));
+	map_fixture fixture(map_size, map_size, unit_count);
+
+	const unsigned long start_game_cycle = GameCycle;
+
+	while (state.keep_running()) {
+		UnitActions();
+		++GameCycle;
+	}
+
+	GameCycle = start_game_cycle;
+
+	state.set_items_processed(state.get_iterations() * unit_count);
+}
+
+WYRMGUS_BENCHMARK(UnitActions_Population, { 128, 1000 }, { 256, 5000 }, { 512, 20000 });
+
+//count down the AI target change thresholds of a whole population, stored contiguously by unit slot
+static void UnitThresholds_SlotArray(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	const int unit_count = static_cast<int>(state.range(1));
+	map_fixture fixture(map_size, map_size, unit_count);
+
+	while (state.keep_running()) {
+		state.pause_timing();
+		for (CUnit *unit : fixture.get_units()) {
+			unit->set_threshold(30);
+		}
+		state.resume_timing();
+
+		unit_manager::get()->decrement_unit_thresholds();
+	}
+
+	state.set_items_processed(state.get_iterations() * unit_count);
+}
+
+WYRMGUS_BENCHMARK(UnitThresholds_SlotArray, { 128, 1000 }, { 256, 5000 }, { 512, 20000 });
+
+//the layout the thresholds had before being moved to the unit manager: a field inside each separately-allocated unit object, surrounded by the rest of the unit's data
+class per_object_unit final
+{
+public:
+	int threshold = 0;
+	std::array<char, sizeof(CUnit) - sizeof(int)> other_data{};
+};
+
+//count down the same number of thresholds stored in separate unit-sized objects, as the per-unit loop did before the thresholds were stored by unit slot
+static void UnitThresholds_PerUnit(state &state)
+{
+	const int map_size = static_cast<int>(state.range(0));
+	const int unit_count = static_cast<int>(state.range(1));
+	map_fixture fixture(map_size, map_size, unit_count);
+
+	//allocate each object separately, as unit objects are
+	std::vector<std::unique_ptr<per_object_unit>> units;
+	units.reserve(fixture.get_units().size());
+	for (size_t i = 0; i < fixture.get_units().size(); ++i) {
+		units.push_back(std::make_unique<per_object_unit>());
+	}
+
+	while (state.keep_running()) {
+		state.pause_timing();
+		for (const std::unique_ptr<per_object_unit> &unit : units) {
+			unit->threshold = 30;
+		}
+		state.resume_timing();
+
+		for (const std::unique_ptr<per_object_unit> &unit : units) {
+			if (unit->threshold > 0) {
+				--unit->threshold;
+			}
+		}
+
+		do_not_optimize(units);
+	}
+
+	state.set_items_processed(state.get_iterations() * unit_count);
+}
+
+WYRMGUS_BENCHMARK(UnitThresholds_PerUnit, { 128, 1000 }, { 256, 5000 }, { 512, 20000 });
+
+//move a population of missiles across the map
+static void MissileActions_Population(state &state)
+{
+	static constexpr int cycles_per_volley = 1024;
+
+	const int map_size = static_cast<int>(state.range(0));
+	const int missile_count = static_cast<int>(state.range(1));
+	map_fixture fixture(map_size, map_size);
+
+	const missile_type &missile_type = *map_fixture::get_missile_type();
+
+	const auto fire_volley = [&]() {
+		CleanMissiles();
+
+		for (int i = 0; i < missile_count; ++i) {
+			const PixelPos start_pos = CMap::get()->tile_pos_to_map_pixel_pos_center(fixture.get_random_passable_pos());
+			const PixelPos dest_pos = CMap::get()->tile_pos_to_map_pixel_pos_center(fixture.get_random_passable_pos());
+			MakeMissile(missile_type, start_pos, dest_pos, 0);
+		}
+	};
+
+	fire_volley();
+
+	while (state.keep_running()) {
+		if ((state.get_iterations() % cycles_per_volley) == 0) {
+			state.pause_timing();
+			fire_volley();
+			state.resume_timing();
+		}
+
+		MissileActions();
+	}
+
+	CleanMissiles();
+
+	state.set_items_processed(state.get_iterations() * missile_count);
+}
+
+WYRMGUS_BENCHMARK(MissileActions_Population, { 128, 100 }, { 256, 1000 });
+
+}
@@ -0,0 +1,463 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#include "stratagus.h"
+
+#include "lockstep_simulation.h"
+
+#include "network/net_message.h"
+#include "network/network.h"
+#include "network/network_lag_controller.h"
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/use_future.hpp>
+
+namespace wyrmgus::test {
+
+class lockstep_peer final
+{
+public:
+	explicit lockstep_peer(lockstep_simulation *simulation, const int player, const int peer_count, const uint32_t seed)
+		: simulation(simulation), player(player), peer_count(peer_count), random_engine(seed), lag(simulation->get_lag())
+	{
+		std::unique_ptr<memory_udp_transport> transport = simulation->get_network().create_transport();
+		this->transport = transport.get();
+		this->socket = std::make_unique<CUDPSocket>(std::move(transport));
+
+		if (!this->socket->Open(simulation->get_host(player))) {
+			throw std::runtime_error("Failed to open the socket of simulated peer " + std::to_string(player) + ".");
+		}
+
+		//as in NetworkOnStartGame, the cycles up to the lag start with sync messages
+		const unsigned cycles_per_update = simulation->get_cycles_per_update();
+		for (unsigned cycle = 0; cycle <= simulation->get_lag(); cycle += cycles_per_update) {
+			for (int i = 0; i < peer_count; ++i) {
+				CNetworkCommandSync nc;
+				received_commands &commands = this->received[cycle & 0xFF][i];
+				commands.time = cycle;
+				commands.commands.clear();
+				commands.commands.emplace_back(MessageSync, std::vector<unsigned char>(nc.Size()));
+				nc.Serialize(commands.commands.back().second.data());
+			}
+		}
+
+		this->last_sent_cycle = this->lag / cycles_per_update * cycles_per_update;
+	}
+
+	bool is_server() const
+	{
+		return this->player == 0;
+	}
+
+	unsigned long get_game_cycle() const
+	{
+		return this->game_cycle;
+	}
+
+	void corrupt_state()
+	{
+		this->state_hash ^= 0xDEADBEEF;
+	}
+
+	void request_lag_change(const unsigned lag)
+	{
+		this->pending_lag = lag;
+	}
+
+	void do_frame();
+
+	lockstep_peer_report get_report() const
+	{
+		lockstep_peer_report report;
+		report.player = this->player;
+		report.game_cycle = this->game_cycle;
+		report.lag = this->lag;
+		report.stall_frames = this->stall_frames;
+		report.executed_command_count = this->executed_command_count;
+		report.desync_count = this->desync_count;
+		report.resend_request_count = this->resend_request_count;
+		report.traffic = this->simulation->get_network().get_statistics(this->simulation->get_host(this->player));
+		return report;
+	}
+
+private:
+	struct received_commands final
+	{
+		unsigned long time = 0;
+		std::vector<std::pair<uint8_t, std::vector<unsigned char>>> commands;
+	};
+
+	struct sent_packet final
+	{
+		unsigned long cycle = 0;
+		CNetworkPacket packet;
+		int command_count = 0;
+	};
+
+	unsigned long get_full_cycle(const uint8_t cycle) const
+	{
+		unsigned long n = ((this->game_cycle + 128) & ~0xFF) | cycle;
+		if (n > this->game_cycle + 128) {
+			n -= 0x100;
+		}
+		return n;
+	}
+
+	bool is_command_ready(const unsigned long cycle) const
+	{
+		for (int i = 0; i < this->peer_count; ++i) {
+			if (this->received[cycle & 0xFF][i].time != cycle) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void receive_packets();
+	void parse_packet(const std::array<unsigned char, 1024> &buf, const size_t len);
+	void send_commands(const unsigned long cycle);
+	void execute_commands(const unsigned long cycle);
+	void send_resend_request();
+	void broadcast(const CNetworkPacket &packet, const int command_count, const int excluded_player = -1);
+
+	lockstep_simulation *simulation = nullptr;
+	const int player = 0;
+	const int peer_count = 0;
+	std::mt19937 random_engine;
+	unsigned lag = 0;
+	unsigned long last_sent_cycle = 0;
+	std::optional<unsigned> pending_lag; //the lag change to be sent by the server
+	memory_udp_transport *transport = nullptr;
+	std::unique_ptr<CUDPSocket> socket;
+	unsigned long game_cycle = 0;
+	unsigned long frame_counter = 0;
+	bool in_sync = true;
+	uint32_t state_hash = 0;
+	std::array<std::array<received_commands, PlayerMax>, 256> received{};
+	std::array<sent_packet, 256> sent_packets{};
+	std::array<uint32_t, 256> sync_hashes{};
+	unsigned long stall_frames = 0;
+	size_t executed_command_count = 0;
+	size_t desync_count = 0;
+	size_t resend_request_count = 0;
+};
+
+void lockstep_peer::do_frame()
+{
+	this->receive_packets();
+
+	const unsigned cycles_per_update = this->simulation->get_cycles_per_update();
+
+	if (this->in_sync) {
+		++this->game_cycle;
+
+		//as in NetworkCommands
+		if (this->game_cycle % cycles_per_update == 0) {
+			for (const unsigned long cycle : network_lag_controller::get_cycles_to_send(this->last_sent_cycle, this->game_cycle, this->lag, cycles_per_update)) {
+				this->last_sent_cycle = cycle;
+				this->send_commands(cycle);
+			}
+			this->execute_commands(this->game_cycle);
+			this->in_sync = this->is_command_ready(this->game_cycle + cycles_per_update);
+		}
+	} else {
+		//as in NetworkRecover
+		++this->stall_frames;
+
+		if (this->frame_counter % cycles_per_update == 0) {
+			this->send_resend_request();
+		}
+
+		const unsigned long next_cycle = (this->game_cycle / cycles_per_update + 1) * cycles_per_update;
+		this->in_sync = this->is_command_ready(next_cycle);
+	}
+
+	++this->frame_counter;
+}
+
+void lockstep_peer::receive_packets()
+{
+	std::array<unsigned char, 1024> buf{};
+
+	while (this->socket->HasDataToRead() > 0) {
+		CHost host;
+		const size_t len = this->simulation->run_awaitable(this->socket->Recv(buf, static_cast<int>(buf.size()), &host));
+		if (len > 0) {
+			this->parse_packet(buf, len);
+		}
+	}
+}
+
+void lockstep_peer::parse_packet(const std::array<unsigned char, 1024> &buf, const size_t len)
+{
+	CNetworkPacket packet;
+	int command_count = 0;
+	packet.Deserialize(buf.data(), static_cast<unsigned int>(len), &command_count);
+
+	const int origin_player = packet.Header.OrigPlayer;
+	if (origin_player < 0 || origin_player >= this->peer_count || origin_player == this->player) {
+		return;
+	}
+
+	//as in NetworkParseInGameEvent, the server relays the packets of each client to the other ones
+	if (this->is_server()) {
+		this->broadcast(packet, command_count, origin_player);
+	}
+
+	if (packet.Header.Type[0] == MessageResend) {
+		//as in ParseResendCommand
+		const unsigned long cycle = this->get_full_cycle(packet.Header.Cycle);
+		const sent_packet &sent_packet = this->sent_packets[cycle & 0xFF];
+		if (sent_packet.cycle == cycle) {
+			this->broadcast(sent_packet.packet, sent_packet.command_count);
+		}
+		return;
+	}
+
+	const unsigned long cycle = this->get_full_cycle(packet.Header.Cycle);
+	received_commands &commands = this->received[cycle & 0xFF][origin_player];
+	commands.time = cycle;
+	commands.commands.clear();
+	for (int i = 0; i < command_count; ++i) {
+		commands.commands.emplace_back(packet.Header.Type[i], packet.Command[i]);
+	}
+}
+
+void lockstep_peer::send_commands(const unsigned long cycle)
+{
+	CNetworkPacket packet;
+	packet.Header.Cycle = cycle & 0xFF;
+	packet.Header.OrigPlayer = this->player;
+
+	if (this->pending_lag.has_value()) {
+		//as in SendCommandNetworkLag
+		CNetworkExtendedCommand nec;
+		nec.ExtendedType = ExtendedMessageNetworkLag;
+		nec.Arg1 = 0xFF;
+		nec.Arg2 = static_cast<uint16_t>(this->pending_lag.value());
+		packet.Header.Type[0] = MessageExtendedCommand;
+		packet.Command[0].resize(nec.Size());
+		nec.Serialize(packet.Command[0].data());
+		this->pending_lag.reset();
+	} else if (std::uniform_real_distribution<double>(0., 1.)(this->random_engine) < this->simulation->get_command_chance()) {
+		CNetworkCommand nc;
+		nc.Unit = static_cast<uint16_t>(std::uniform_int_distribution<int>(0, 1023)(this->random_engine));
+		nc.X = static_cast<uint16_t>(std::uniform_int_distribution<int>(0, 255)(this->random_engine));
+		nc.Y = static_cast<uint16_t>(std::uniform_int_distribution<int>(0, 255)(this->random_engine));
+		nc.Dest = 0xFFFF;
+		packet.Header.Type[0] = MessageCommandMove;
+		packet.Command[0].resize(nc.Size());
+		nc.Serialize(packet.Command[0].data());
+	} else {
+		CNetworkCommandSync nc;
+		nc.syncSeed = 0;
+		nc.syncHash = this->state_hash;
+		packet.Header.Type[0] = MessageSync;
+		packet.Command[0].resize(nc.Size());
+		nc.Serialize(packet.Command[0].data());
+	}
+
+	for (int i = 1; i < MaxNetworkCommands; ++i) {
+		packet.Header.Type[i] = MessageNone;
+	}
+
+	this->sync_hashes[cycle & 0xFF] = this->state_hash;
+
+	received_commands &commands = this->received[cycle & 0xFF][this->player];
+	commands.time = cycle;
+	commands.commands.clear();
+	commands.commands.emplace_back(packet.Header.Type[0], packet.Command[0]);
+
+	sent_packet &sent_packet = this->sent_packets[cycle & 0xFF];
+	sent_packet.cycle = cycle;
+	sent_packet.packet = packet;
+	sent_packet.command_count = 1;
+
+	this->broadcast(packet, 1);
+}
+
+void lockstep_peer::execute_commands(const unsigned long cycle)
+{
+	//as in NetworkExecCommands, the commands are executed in the same order on all peers
+	for (int i = 0; i < this->peer_count; ++i) {
+		const received_commands &commands = this->received[cycle & 0xFF][i];
+		if (commands.time != cycle) {
+			continue;
+		}
+
+		for (const auto &[type, data] : commands.commands) {
+			if (type == MessageSync) {
+				CNetworkCommandSync nc;
+				nc.Deserialize(data.data());
+				if (nc.syncHash != this->sync_hashes[cycle & 0xFF]) {
+					++this->desync_count;
+				}
+				continue;
+			}
+
+			if (type == MessageExtendedCommand) {
+				//as in SetNetworkLag, all peers change the lag at the same cycle
+				CNetworkExtendedCommand nec;
+				nec.Deserialize(data.data());
+				if (nec.ExtendedType == ExtendedMessageNetworkLag) {
+					this->lag = network_lag_controller::get_valid_lag(nec.Arg2, this->simulation->get_cycles_per_update());
+				}
+			}
+
+			//FNV-1a over the executing player and the command
+			this->state_hash = (this->state_hash ^ static_cast<uint32_t>(i)) * 16777619u;
+			for (const unsigned char byte : data) {
+				this->state_hash = (this->state_hash ^ byte) * 16777619u;
+			}
+			++this->executed_command_count;
+		}
+	}
+}
+
+void lockstep_peer::send_resend_request()
+{
+	//as in NetworkResendCommands
+	const unsigned cycles_per_update = this->simulation->get_cycles_per_update();
+	const unsigned long next_cycle = (this->game_cycle / cycles_per_update + 1) * cycles_per_update;
+
+	CNetworkPacket packet;
+	packet.Header.Type[0] = MessageResend;
+	for (int i = 1; i < MaxNetworkCommands; ++i) {
+		packet.Header.Type[i] = MessageNone;
+	}
+	packet.Header.Cycle = static_cast<uint8_t>(next_cycle & 0xFF);
+	packet.Header.OrigPlayer = this->player;
+
+	++this->resend_request_count;
+	this->broadcast(packet, 1);
+}
+
+void lockstep_peer::broadcast(const CNetworkPacket &packet, const int command_count, const int excluded_player)
+{
+	const size_t size = packet.Size(command_count);
+	std::vector<unsigned char> buf(size);
+	packet.Serialize(buf.data(), command_count);
+
+	if (this->is_server()) {
+		for (int i = 1; i < this->peer_count; ++i) {
+			if (i == excluded_player) {
+				continue;
+			}
+			this->simulation->run_awaitable(this->socket->Send(this->simulation->get_host(i), buf.data(), static_cast<unsigned int>(size)));
+		}
+	} else {
+		this->simulation->run_awaitable(this->socket->Send(this->simulation->get_host(0), buf.data(), static_cast<unsigned int>(size)));
+	}
+}
+
+lockstep_simulation::lockstep_simulation(const int peer_count, const unsigned cycles_per_update, const unsigned lag, const uint32_t seed)
+	: cycles_per_update(std::max(cycles_per_update, 1u)), lag(std::max(lag, 2 * std::max(cycles_per_update, 1u))), network(seed)
+{
+	for (int i = 0; i < peer_count; ++i) {
+		//each peer gets its own loopback address
+		this->hosts.emplace_back(htonl(0x7F000001 + i), htons(CNetworkParameter::default_port));
+	}
+
+	for (int i = 0; i < peer_count; ++i) {
+		this->peers.push_back(std::make_unique<lockstep_peer>(this, i, peer_count, seed + i + 1));
+	}
+}
+
+lockstep_simulation::~lockstep_simulation()
+{
+}
+
+const CHost &lockstep_simulation::get_host(const int player) const
+{
+	return this->hosts.at(player);
+}
+
+void lockstep_simulation::corrupt_peer_state(const int player)
+{
+	this->peers.at(player)->corrupt_state();
+}
+
+void lockstep_simulation::change_lag(const unsigned lag)
+{
+	this->peers.front()->request_lag_change(lag);
+}
+
+bool lockstep_simulation::run(const unsigned long cycle, const unsigned long max_frames)
+{
+	const auto all_peers_reached_cycle = [this, cycle]() {
+		return std::all_of(this->peers.begin(), this->peers.end(), [cycle](const std::unique_ptr<lockstep_peer> &peer) {
+			return peer->get_game_cycle() >= cycle;
+		});
+	};
+
+	for (unsigned long frame = 0; frame < max_frames; ++frame) {
+		if (all_peers_reached_cycle()) {
+			return true;
+		}
+
+		for (const std::unique_ptr<lockstep_peer> &peer : this->peers) {
+			//peers which reached the cycle stop, as the others catch up
+			if (peer->get_game_cycle() < cycle) {
+				peer->do_frame();
+			}
+		}
+
+		this->network.advance_time(lockstep_simulation::frame_duration);
+	}
+
+	return all_peers_reached_cycle();
+}
+
+std::vector<lockstep_peer_report> lockstep_simulation::get_reports() const
+{
+	std::vector<lockstep_peer_report> reports;
+
+	for (const std::unique_ptr<lockstep_peer> &peer : this->peers) {
+		reports.push_back(peer->get_report());
+	}
+
+	return reports;
+}
+
+void lockstep_simulation::print_reports() const
+{
+	for (const lockstep_peer_report &report : this->get_reports()) {
+		fprintf(stdout, "Peer %d: cycle %lu, lag %u, %lu stall frames, %zu commands, %zu desyncs, %zu resend requests, sent %zu bytes (%zu datagrams, %zu dropped, %zu duplicated), received %zu bytes (%zu datagrams)\n", report.player, report.game_cycle, report.lag, report.stall_frames, report.executed_command_count, report.desync_count, report.resend_request_count, report.traffic.sent_bytes, report.traffic.sent_datagrams, report.traffic.dropped_datagrams, report.traffic.duplicated_datagrams, report.traffic.received_bytes, report.traffic.received_datagrams);
+	}
+}
+
+template <typename T>
+T lockstep_simulation::run_awaitable(boost::asio::awaitable<T> &&awaitable)
+{
+	//the memory transport never suspends, so running the I/O context completes the awaitable
+	std::future<T> future = boost::asio::co_spawn(this->io_context, std::move(awaitable), boost::asio::use_future);
+	this->io_context.restart();
+	this->io_context.run();
+	return future.get();
+}
+
+}
@@ -0,0 +1,115 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#pragma once
+
+#include "network_simulator.h"
+
+#include <boost/asio/io_context.hpp>
+
+namespace wyrmgus::test {
+
+class lockstep_peer;
+
+//the outcome of a lockstep simulation for a peer
+struct lockstep_peer_report final
+{
+	int player = 0;
+	unsigned long game_cycle = 0;
+	unsigned lag = 0;
+	unsigned long stall_frames = 0; //frames in which the peer could not advance, as it was waiting for commands
+	size_t executed_command_count = 0;
+	size_t desync_count = 0;
+	size_t resend_request_count = 0; //resend requests sent by the peer
+	network_traffic_statistics traffic;
+};
+
+//runs a lockstep game between several peers in one process, over a simulated network, following the protocol of network.cpp
+//the first peer is the server, which relays the packets of the clients to each other; each update every peer sends its commands for the cycle lag cycles ahead, and then stalls, asking for resends, until the commands of all peers for the next update have arrived
+//a peer's game state is a hash of the commands it executed, which it sends in its sync messages, so that the other peers can detect desyncs
+class lockstep_simulation final
+{
+public:
+	static constexpr std::chrono::milliseconds frame_duration = std::chrono::milliseconds(1000 / CYCLES_PER_SECOND);
+
+	explicit lockstep_simulation(const int peer_count, const unsigned cycles_per_update, const unsigned lag, const uint32_t seed);
+	~lockstep_simulation();
+
+	network_simulator &get_network()
+	{
+		return this->network;
+	}
+
+	const CHost &get_host(const int player) const;
+
+	unsigned get_cycles_per_update() const
+	{
+		return this->cycles_per_update;
+	}
+
+	unsigned get_lag() const
+	{
+		return this->lag;
+	}
+
+	double get_command_chance() const
+	{
+		return this->command_chance;
+	}
+
+	//set the chance of each peer giving a command in an update
+	void set_command_chance(const double chance)
+	{
+		this->command_chance = chance;
+	}
+
+	//corrupt the game state of a peer, which the other peers should detect as a desync
+	void corrupt_peer_state(const int player);
+
+	//make the server change the lag, which it sends in its next update, as it does for a change decided by the network lag controller
+	void change_lag(const unsigned lag);
+
+	//run frames until all peers have reached the given cycle, or the frame limit is reached; returns whether all peers reached the cycle
+	bool run(const unsigned long cycle, const unsigned long max_frames);
+
+	std::vector<lockstep_peer_report> get_reports() const;
+	void print_reports() const;
+
+	template <typename T>
+	T run_awaitable(boost::asio::awaitable<T> &&awaitable);
+
+private:
+	const unsigned cycles_per_update = 1;
+	const unsigned lag = 0;
+	double command_chance = 0.1;
+	network_simulator network;
+	boost::asio::io_context io_context;
+	std::vector<CHost> hosts;
+	std::vector<std::unique_ptr<lockstep_peer>> peers;
+};
+
+}
@@ -0,0 +1,82 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "network/net_message.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(group_command_round_trip_test)
+{
+	CNetworkGroupCommand ngc;
+	ngc.Type = MessageCommandMove | 0x80;
+	ngc.X = 300;
+	ngc.Y = 12;
+	ngc.Dest = 65535;
+	//include units out of order and far apart, so that negative and multi-byte deltas are covered
+	ngc.Units = { 5, 6, 7, 2, 1000, 65535, 0 };
+
+	std::vector<unsigned char> buf(ngc.Size());
+	BOOST_REQUIRE(ngc.Serialize(buf.data()) == buf.size());
+
+	CNetworkGroupCommand deserialized_ngc;
+	BOOST_CHECK(deserialized_ngc.Deserialize(buf.data(), buf.size()) == buf.size());
+	BOOST_CHECK(deserialized_ngc.Type == ngc.Type);
+	BOOST_CHECK(deserialized_ngc.X == ngc.X);
+	BOOST_CHECK(deserialized_ngc.Y == ngc.Y);
+	BOOST_CHECK(deserialized_ngc.Dest == ngc.Dest);
+	BOOST_CHECK(deserialized_ngc.Units == ngc.Units);
+}
+
+BOOST_AUTO_TEST_CASE(group_command_truncated_test)
+{
+	CNetworkGroupCommand ngc;
+	ngc.Type = MessageCommandAttack;
+	ngc.Units = { 1, 200, 40000 };
+
+	std::vector<unsigned char> buf(ngc.Size());
+	ngc.Serialize(buf.data());
+
+	//every truncation of the message is rejected
+	for (size_t len = 0; len < buf.size(); ++len) {
+		CNetworkGroupCommand truncated_ngc;
+		BOOST_CHECK(truncated_ngc.Deserialize(buf.data(), len) == 0);
+	}
+
+	//a unit count larger than the remaining data is rejected without reading past the buffer
+	std::vector<unsigned char> oversized_count_buf(buf.begin(), buf.begin() + CNetworkGroupCommand::HeaderSize);
+	serialize16(&oversized_count_buf[CNetworkGroupCommand::HeaderSize - 2], uint16_t(65535));
+	CNetworkGroupCommand oversized_count_ngc;
+	BOOST_CHECK(oversized_count_ngc.Deserialize(oversized_count_buf.data(), oversized_count_buf.size()) == 0);
+
+	//a unit number whose variable-length encoding doesn't end is rejected
+	std::vector<unsigned char> unterminated_buf(buf.begin(), buf.begin() + CNetworkGroupCommand::HeaderSize);
+	serialize16(&unterminated_buf[CNetworkGroupCommand::HeaderSize - 2], uint16_t(1));
+	unterminated_buf.insert(unterminated_buf.end(), 6, 0xFF);
+	CNetworkGroupCommand unterminated_ngc;
+	BOOST_CHECK(unterminated_ngc.Deserialize(unterminated_buf.data(), unterminated_buf.size()) == 0);
+}
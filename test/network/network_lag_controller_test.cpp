@@ -0,0 +1,146 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#include "stratagus.h"
+
+#include "network/network_lag_controller.h"
+#include "network/network_statistics.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+constexpr unsigned cycles_per_update = 2;
+constexpr unsigned min_lag = 4;
+constexpr double cycle_duration = 30.;
+
+}
+
+BOOST_AUTO_TEST_CASE(network_lag_controller_desired_lag_test)
+{
+	const wyrmgus::network_lag_controller controller(cycles_per_update, min_lag);
+
+	//140 ms take 5 cycles, plus an update to wait for sending
+	BOOST_CHECK(controller.get_desired_lag(100., 10., cycle_duration) == 8);
+	BOOST_CHECK(controller.get_desired_lag(0., 0., cycle_duration) == min_lag);
+	BOOST_CHECK(controller.get_desired_lag(10000., 100., cycle_duration) == wyrmgus::network_lag_controller::max_lag);
+}
+
+BOOST_AUTO_TEST_CASE(network_lag_controller_increase_test)
+{
+	wyrmgus::network_lag_controller controller(cycles_per_update, min_lag);
+	const std::chrono::steady_clock::time_point start_time;
+
+	//an increase is applied at once
+	BOOST_CHECK(controller.update(4, 100., 10., cycle_duration, false, start_time) == 8u);
+	controller.on_lag_changed(start_time);
+
+	//but not before the change interval has passed
+	BOOST_CHECK(!controller.update(8, 260., 10., cycle_duration, false, start_time + std::chrono::milliseconds(500)).has_value());
+	BOOST_CHECK(controller.update(8, 260., 10., cycle_duration, false, start_time + wyrmgus::network_lag_controller::change_interval) == 12u);
+}
+
+BOOST_AUTO_TEST_CASE(network_lag_controller_decrease_test)
+{
+	wyrmgus::network_lag_controller controller(cycles_per_update, min_lag);
+	const std::chrono::steady_clock::time_point start_time;
+
+	//a decrease is only applied once the desired lag has stayed lower for the decrease delay
+	BOOST_CHECK(!controller.update(20, 100., 10., cycle_duration, false, start_time).has_value());
+	BOOST_CHECK(!controller.update(20, 100., 10., cycle_duration, false, start_time + std::chrono::seconds(4)).has_value());
+
+	//and then one update at a time
+	const std::chrono::steady_clock::time_point decrease_time = start_time + wyrmgus::network_lag_controller::decrease_delay;
+	BOOST_CHECK(controller.update(20, 100., 10., cycle_duration, false, decrease_time) == 18u);
+	controller.on_lag_changed(decrease_time);
+
+	BOOST_CHECK(!controller.update(18, 100., 10., cycle_duration, false, decrease_time + std::chrono::seconds(1)).has_value());
+	BOOST_CHECK(!controller.update(18, 100., 10., cycle_duration, false, decrease_time + std::chrono::seconds(5)).has_value());
+	BOOST_CHECK(controller.update(18, 100., 10., cycle_duration, false, decrease_time + std::chrono::seconds(6)) == 16u);
+
+	//a desired lag equal to the current one restarts the decrease delay
+	wyrmgus::network_lag_controller other_controller(cycles_per_update, min_lag);
+	BOOST_CHECK(!other_controller.update(20, 100., 10., cycle_duration, false, start_time).has_value());
+	BOOST_CHECK(!other_controller.update(8, 100., 10., cycle_duration, false, start_time + std::chrono::seconds(3)).has_value());
+	BOOST_CHECK(!other_controller.update(20, 100., 10., cycle_duration, false, start_time + std::chrono::seconds(4)).has_value());
+	BOOST_CHECK(!other_controller.update(20, 100., 10., cycle_duration, false, decrease_time).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(network_lag_controller_stall_test)
+{
+	wyrmgus::network_lag_controller controller(cycles_per_update, min_lag);
+	const std::chrono::steady_clock::time_point start_time;
+
+	//a stall increases the lag by an update, even if the measured round-trip time is covered
+	BOOST_CHECK(controller.update(8, 100., 10., cycle_duration, true, start_time) == 10u);
+
+	//but not beyond the maximum
+	const unsigned max_lag = wyrmgus::network_lag_controller::max_lag;
+	BOOST_CHECK(!controller.update(max_lag, 100., 10., cycle_duration, true, start_time).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(network_lag_cycles_to_send_test)
+{
+	using cycle_vector = std::vector<unsigned long>;
+
+	//at a constant lag, one cycle is sent per update
+	BOOST_CHECK(wyrmgus::network_lag_controller::get_cycles_to_send(20, 12, 10, cycles_per_update) == cycle_vector({ 22 }));
+
+	//after an increase, the cycles skipped over are sent as well
+	BOOST_CHECK(wyrmgus::network_lag_controller::get_cycles_to_send(20, 12, 14, cycles_per_update) == cycle_vector({ 22, 24, 26 }));
+
+	//after a decrease, nothing is sent until the cycles already sent have been passed
+	BOOST_CHECK(wyrmgus::network_lag_controller::get_cycles_to_send(20, 12, 6, cycles_per_update).empty());
+	BOOST_CHECK(wyrmgus::network_lag_controller::get_cycles_to_send(20, 14, 6, cycles_per_update).empty());
+	BOOST_CHECK(wyrmgus::network_lag_controller::get_cycles_to_send(20, 16, 6, cycles_per_update) == cycle_vector({ 22 }));
+}
+
+BOOST_AUTO_TEST_CASE(network_lag_valid_lag_test)
+{
+	//lags are rounded down to a multiple of the cycles per update
+	BOOST_CHECK_EQUAL(wyrmgus::network_lag_controller::get_valid_lag(11, cycles_per_update), 10u);
+
+	//and kept between two updates and the maximum lag
+	BOOST_CHECK_EQUAL(wyrmgus::network_lag_controller::get_valid_lag(1, cycles_per_update), 2 * cycles_per_update);
+	BOOST_CHECK_EQUAL(wyrmgus::network_lag_controller::get_valid_lag(1000, cycles_per_update), wyrmgus::network_lag_controller::max_lag);
+}
+
+BOOST_AUTO_TEST_CASE(network_peer_round_trip_time_test)
+{
+	wyrmgus::peer_network_statistics peer;
+
+	//without the peer's delay of our packets, there is no round-trip time
+	peer.record_delay(-20.);
+	BOOST_CHECK(peer.sample_count == 0);
+
+	//the phase difference between the peers cancels out over both directions
+	peer.echoed_delay = 80.;
+	peer.record_delay(-20.);
+	BOOST_CHECK(peer.sample_count == 1);
+	BOOST_CHECK_CLOSE(peer.rtt, 60., 0.001);
+	BOOST_CHECK(peer.delay < 0.);
+}
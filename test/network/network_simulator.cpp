@@ -0,0 +1,224 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#include "stratagus.h"
+
+#include "network_simulator.h"
+
+namespace wyrmgus {
+
+void network_simulator::advance_time(const std::chrono::milliseconds duration)
+{
+	const std::chrono::milliseconds end_time = this->time + duration;
+
+	while (true) {
+		//process the scripted events and datagrams in time order, so that condition changes apply to the datagrams sent after them
+		std::optional<std::chrono::milliseconds> next_time;
+
+		if (!this->scripted_events.empty() && this->scripted_events.front().time <= end_time) {
+			next_time = this->scripted_events.front().time;
+		}
+
+		if (!this->in_flight_datagrams.empty() && this->in_flight_datagrams.top().delivery_time <= end_time) {
+			const std::chrono::milliseconds delivery_time = this->in_flight_datagrams.top().delivery_time;
+			if (!next_time.has_value() || delivery_time < next_time.value()) {
+				next_time = delivery_time;
+			}
+		}
+
+		if (!next_time.has_value()) {
+			break;
+		}
+
+		this->time = std::max(this->time, next_time.value());
+
+		if (!this->scripted_events.empty() && this->scripted_events.front().time == next_time.value()) {
+			const std::function<void(network_simulator &)> function = std::move(this->scripted_events.front().function);
+			this->scripted_events.erase(this->scripted_events.begin());
+			function(*this);
+			continue;
+		}
+
+		datagram delivered_datagram = this->in_flight_datagrams.top();
+		this->in_flight_datagrams.pop();
+
+		const auto find_iterator = this->transports.find(network_simulator::get_host_key(delivered_datagram.to));
+		if (find_iterator == this->transports.end()) {
+			//nothing is listening on the destination host
+			continue;
+		}
+
+		network_traffic_statistics &receiver_statistics = this->statistics[network_simulator::get_host_key(delivered_datagram.to)];
+		++receiver_statistics.received_datagrams;
+		receiver_statistics.received_bytes += delivered_datagram.data.size();
+
+		find_iterator->second->deliver(delivered_datagram.from, std::move(delivered_datagram.data));
+	}
+
+	this->time = end_time;
+}
+
+const network_conditions &network_simulator::get_link_conditions(const CHost &from, const CHost &to) const
+{
+	const auto find_iterator = this->link_conditions.find(std::make_pair(network_simulator::get_host_key(from), network_simulator::get_host_key(to)));
+	if (find_iterator != this->link_conditions.end()) {
+		return find_iterator->second;
+	}
+
+	return this->default_conditions;
+}
+
+void network_simulator::add_scripted_event(const std::chrono::milliseconds time, std::function<void(network_simulator &)> &&function)
+{
+	scripted_event event;
+	event.time = std::max(time, this->time);
+	event.function = std::move(function);
+
+	const auto insert_iterator = std::upper_bound(this->scripted_events.begin(), this->scripted_events.end(), event.time, [](const std::chrono::milliseconds time, const scripted_event &other_event) {
+		return time < other_event.time;
+	});
+	this->scripted_events.insert(insert_iterator, std::move(event));
+}
+
+std::unique_ptr<memory_udp_transport> network_simulator::create_transport()
+{
+	return std::make_unique<memory_udp_transport>(this);
+}
+
+bool network_simulator::bind(const CHost &host, memory_udp_transport *transport)
+{
+	return this->transports.try_emplace(network_simulator::get_host_key(host), transport).second;
+}
+
+void network_simulator::unbind(const CHost &host)
+{
+	this->transports.erase(network_simulator::get_host_key(host));
+}
+
+void network_simulator::send(const CHost &from, const CHost &to, const void *buf, const unsigned int len)
+{
+	network_traffic_statistics &sender_statistics = this->statistics[network_simulator::get_host_key(from)];
+	++sender_statistics.sent_datagrams;
+	sender_statistics.sent_bytes += len;
+
+	const network_conditions &conditions = this->get_link_conditions(from, to);
+
+	if (this->roll(conditions.loss_rate)) {
+		++sender_statistics.dropped_datagrams;
+		return;
+	}
+
+	const std::vector<unsigned char> data(static_cast<const unsigned char *>(buf), static_cast<const unsigned char *>(buf) + len);
+
+	this->queue_datagram(from, to, data, conditions);
+
+	if (this->roll(conditions.duplication_rate)) {
+		++sender_statistics.duplicated_datagrams;
+		this->queue_datagram(from, to, data, conditions);
+	}
+}
+
+void network_simulator::queue_datagram(const CHost &from, const CHost &to, const std::vector<unsigned char> &data, const network_conditions &conditions)
+{
+	datagram queued_datagram;
+	queued_datagram.from = from;
+	queued_datagram.to = to;
+	queued_datagram.data = data;
+	queued_datagram.delivery_time = this->time + conditions.latency;
+	queued_datagram.sequence = this->next_sequence++;
+
+	if (conditions.jitter.count() > 0) {
+		queued_datagram.delivery_time += std::chrono::milliseconds(std::uniform_int_distribution<int64_t>(0, conditions.jitter.count())(this->random_engine));
+	}
+
+	if (this->roll(conditions.reorder_rate)) {
+		queued_datagram.delivery_time += network_simulator::reorder_delay;
+	}
+
+	this->in_flight_datagrams.push(std::move(queued_datagram));
+}
+
+const network_traffic_statistics &network_simulator::get_statistics(const CHost &host) const
+{
+	static const network_traffic_statistics empty_statistics;
+
+	const auto find_iterator = this->statistics.find(network_simulator::get_host_key(host));
+	if (find_iterator != this->statistics.end()) {
+		return find_iterator->second;
+	}
+
+	return empty_statistics;
+}
+
+bool memory_udp_transport::Open(const CHost &host)
+{
+	if (!this->simulator->bind(host, this)) {
+		return false;
+	}
+
+	this->host = host;
+	this->open = true;
+	return true;
+}
+
+void memory_udp_transport::Close()
+{
+	this->simulator->unbind(this->host);
+	this->open = false;
+	this->received_datagrams.clear();
+}
+
+void memory_udp_transport::send(const CHost &host, const void *buf, const unsigned int len)
+{
+	if (!this->IsValid()) {
+		throw std::runtime_error("Failed to send data through a closed memory UDP transport.");
+	}
+
+	this->simulator->send(this->host, host, buf, len);
+}
+
+size_t memory_udp_transport::receive(std::array<unsigned char, 1024> &buf, CHost *hostFrom)
+{
+	if (this->received_datagrams.empty()) {
+		return 0;
+	}
+
+	auto [from, data] = std::move(this->received_datagrams.front());
+	this->received_datagrams.pop_front();
+
+	//datagrams which don't fit in the buffer are truncated, as with a real socket
+	const size_t size = std::min(data.size(), buf.size());
+	std::copy_n(data.begin(), size, buf.begin());
+
+	if (hostFrom != nullptr) {
+		*hostFrom = from;
+	}
+
+	return size;
+}
+
+}
@@ -0,0 +1,234 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#pragma once
+
+#include "network/netsockets.h"
+
+namespace wyrmgus {
+
+class memory_udp_transport;
+
+//the conditions of a simulated network link
+struct network_conditions final
+{
+	std::chrono::milliseconds latency = std::chrono::milliseconds(0); //one-way latency
+	std::chrono::milliseconds jitter = std::chrono::milliseconds(0); //maximum random delay added to the latency
+	double loss_rate = 0; //chance of a datagram being dropped
+	double duplication_rate = 0; //chance of a datagram being delivered twice
+	double reorder_rate = 0; //chance of a datagram being held back, so that datagrams sent after it overtake it
+};
+
+//the datagrams sent and received by a simulated host
+struct network_traffic_statistics final
+{
+	size_t sent_datagrams = 0;
+	size_t sent_bytes = 0;
+	size_t received_datagrams = 0;
+	size_t received_bytes = 0;
+	size_t dropped_datagrams = 0; //datagrams sent by the host which were lost
+	size_t duplicated_datagrams = 0; //datagrams sent by the host which were duplicated
+};
+
+//an in-memory network driven by a virtual clock, with scripted conditions, to which memory UDP transports attach
+//it is deterministic for a given seed, so that lockstep runs between several peers in one process can be reproduced
+class network_simulator final
+{
+public:
+	static constexpr std::chrono::milliseconds reorder_delay = std::chrono::milliseconds(50);
+
+	explicit network_simulator(const uint32_t seed) : random_engine(seed)
+	{
+	}
+
+	std::chrono::milliseconds get_time() const
+	{
+		return this->time;
+	}
+
+	//advance the virtual clock, running the scripted events and delivering the datagrams which are due
+	void advance_time(const std::chrono::milliseconds duration);
+
+	void set_default_conditions(const network_conditions &conditions)
+	{
+		this->default_conditions = conditions;
+	}
+
+	//set the conditions for the datagrams sent from a host to another
+	void set_link_conditions(const CHost &from, const CHost &to, const network_conditions &conditions)
+	{
+		this->link_conditions[std::make_pair(network_simulator::get_host_key(from), network_simulator::get_host_key(to))] = conditions;
+	}
+
+	const network_conditions &get_link_conditions(const CHost &from, const CHost &to) const;
+
+	//add an event to be run when the virtual clock reaches the given time, e.g. to change the network conditions
+	void add_scripted_event(const std::chrono::milliseconds time, std::function<void(network_simulator &)> &&function);
+
+	std::unique_ptr<memory_udp_transport> create_transport();
+
+	bool bind(const CHost &host, memory_udp_transport *transport);
+	void unbind(const CHost &host);
+	void send(const CHost &from, const CHost &to, const void *buf, const unsigned int len);
+
+	const network_traffic_statistics &get_statistics(const CHost &host) const;
+
+private:
+	static uint64_t get_host_key(const CHost &host)
+	{
+		return (static_cast<uint64_t>(host.getIp()) << 16) | host.getPort();
+	}
+
+	struct datagram final
+	{
+		CHost from;
+		CHost to;
+		std::vector<unsigned char> data;
+		std::chrono::milliseconds delivery_time{};
+		uint64_t sequence = 0; //keeps the order of datagrams due at the same time stable
+	};
+
+	struct datagram_later final
+	{
+		bool operator()(const datagram &lhs, const datagram &rhs) const
+		{
+			if (lhs.delivery_time != rhs.delivery_time) {
+				return lhs.delivery_time > rhs.delivery_time;
+			}
+
+			return lhs.sequence > rhs.sequence;
+		}
+	};
+
+	struct scripted_event final
+	{
+		std::chrono::milliseconds time{};
+		std::function<void(network_simulator &)> function;
+	};
+
+	void queue_datagram(const CHost &from, const CHost &to, const std::vector<unsigned char> &data, const network_conditions &conditions);
+
+	bool roll(const double chance)
+	{
+		return chance > 0 && std::uniform_real_distribution<double>(0., 1.)(this->random_engine) < chance;
+	}
+
+	std::chrono::milliseconds time{};
+	std::mt19937 random_engine;
+	network_conditions default_conditions;
+	std::map<std::pair<uint64_t, uint64_t>, network_conditions> link_conditions;
+	std::vector<scripted_event> scripted_events; //sorted by time
+	std::priority_queue<datagram, std::vector<datagram>, datagram_later> in_flight_datagrams;
+	uint64_t next_sequence = 0;
+	std::map<uint64_t, memory_udp_transport *> transports;
+	std::map<uint64_t, network_traffic_statistics> statistics;
+};
+
+//a UDP transport which sends and receives datagrams through a network simulator, without blocking
+class memory_udp_transport final : public CUDPTransport
+{
+public:
+	explicit memory_udp_transport(network_simulator *simulator) : simulator(simulator)
+	{
+	}
+
+	virtual ~memory_udp_transport() override
+	{
+		if (this->IsValid()) {
+			this->Close();
+		}
+	}
+
+	const CHost &get_host() const
+	{
+		return this->host;
+	}
+
+	virtual bool Open(const CHost &host) override;
+	virtual void Close() override;
+
+	[[nodiscard]]
+	virtual boost::asio::awaitable<void> Send(const CHost &host, const void *buf, unsigned int len) override
+	{
+		this->send(host, buf, len);
+		co_return;
+	}
+
+	void send(const CHost &host, const void *buf, const unsigned int len);
+
+	[[nodiscard]]
+	virtual boost::asio::awaitable<size_t> Recv(std::array<unsigned char, 1024> &buf, int len, CHost *hostFrom) override
+	{
+		Q_UNUSED(len);
+
+		co_return this->receive(buf, hostFrom);
+	}
+
+	//receive the next datagram, returning 0 if there is none
+	size_t receive(std::array<unsigned char, 1024> &buf, CHost *hostFrom);
+
+	void deliver(const CHost &from, std::vector<unsigned char> &&data)
+	{
+		this->received_datagrams.emplace_back(from, std::move(data));
+	}
+
+	virtual void SetNonBlocking() override
+	{
+	}
+
+	[[nodiscard]]
+	virtual size_t HasDataToRead() override
+	{
+		if (this->received_datagrams.empty()) {
+			return 0;
+		}
+
+		return this->received_datagrams.front().second.size();
+	}
+
+	//the simulator's time only advances between frames, so waiting would never see new data
+	[[nodiscard]]
+	virtual boost::asio::awaitable<size_t> WaitForDataToRead(const int timeout) override
+	{
+		Q_UNUSED(timeout);
+
+		co_return this->HasDataToRead();
+	}
+
+	virtual bool IsValid() const override
+	{
+		return this->open;
+	}
+
+private:
+	network_simulator *simulator = nullptr;
+	CHost host;
+	bool open = false;
+	std::deque<std::pair<CHost, std::vector<unsigned char>>> received_datagrams;
+};
+
+}
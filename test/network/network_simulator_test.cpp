@@ -0,0 +1,204 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#include "stratagus.h"
+
+#include "lockstep_simulation.h"
+#include "network_simulator.h"
+
+#include "network/netsockets.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(memory_transport_test)
+{
+	network_simulator network(1);
+
+	network_conditions conditions;
+	conditions.latency = std::chrono::milliseconds(50);
+	network.set_default_conditions(conditions);
+
+	const CHost host_a(htonl(0x7F000001), htons(6660));
+	const CHost host_b(htonl(0x7F000002), htons(6660));
+
+	std::unique_ptr<memory_udp_transport> transport_a = network.create_transport();
+	std::unique_ptr<memory_udp_transport> transport_b = network.create_transport();
+	BOOST_REQUIRE(transport_a->Open(host_a));
+	BOOST_REQUIRE(transport_b->Open(host_b));
+
+	const std::array<unsigned char, 4> data = { 1, 2, 3, 4 };
+	transport_a->send(host_b, data.data(), static_cast<unsigned int>(data.size()));
+
+	network.advance_time(std::chrono::milliseconds(49));
+	BOOST_CHECK(transport_b->HasDataToRead() == 0);
+
+	network.advance_time(std::chrono::milliseconds(1));
+	BOOST_CHECK(transport_b->HasDataToRead() > 0);
+
+	std::array<unsigned char, 1024> buf{};
+	CHost host_from;
+	BOOST_CHECK(transport_b->receive(buf, &host_from) == data.size());
+	BOOST_CHECK(host_from == host_a);
+	BOOST_CHECK(std::equal(data.begin(), data.end(), buf.begin()));
+	BOOST_CHECK(transport_b->HasDataToRead() == 0);
+
+	BOOST_CHECK(network.get_statistics(host_a).sent_datagrams == 1);
+	BOOST_CHECK(network.get_statistics(host_b).received_bytes == data.size());
+}
+
+BOOST_AUTO_TEST_CASE(lockstep_perfect_network_test)
+{
+	wyrmgus::test::lockstep_simulation simulation(4, 1, 10, 1);
+
+	network_conditions conditions;
+	conditions.latency = std::chrono::milliseconds(20);
+	simulation.get_network().set_default_conditions(conditions);
+
+	BOOST_REQUIRE(simulation.run(300, 400));
+
+	for (const wyrmgus::test::lockstep_peer_report &report : simulation.get_reports()) {
+		BOOST_CHECK(report.desync_count == 0);
+		BOOST_CHECK(report.stall_frames == 0);
+		BOOST_CHECK(report.resend_request_count == 0);
+		BOOST_CHECK(report.traffic.dropped_datagrams == 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(lockstep_lossy_network_test)
+{
+	wyrmgus::test::lockstep_simulation simulation(4, 2, 10, 2);
+	simulation.set_command_chance(0.5);
+
+	network_conditions conditions;
+	conditions.latency = std::chrono::milliseconds(40);
+	conditions.jitter = std::chrono::milliseconds(40);
+	conditions.loss_rate = 0.1;
+	conditions.duplication_rate = 0.05;
+	conditions.reorder_rate = 0.1;
+	simulation.get_network().set_default_conditions(conditions);
+
+	const bool completed = simulation.run(600, 20000);
+	simulation.print_reports();
+	BOOST_REQUIRE(completed);
+
+	size_t resend_request_count = 0;
+	size_t executed_command_count = 0;
+
+	for (const wyrmgus::test::lockstep_peer_report &report : simulation.get_reports()) {
+		BOOST_CHECK(report.desync_count == 0);
+		resend_request_count += report.resend_request_count;
+
+		//all peers execute the same commands
+		if (report.player == 0) {
+			executed_command_count = report.executed_command_count;
+		} else {
+			BOOST_CHECK(report.executed_command_count == executed_command_count);
+		}
+	}
+
+	BOOST_CHECK(resend_request_count > 0);
+}
+
+BOOST_AUTO_TEST_CASE(lockstep_lag_change_test)
+{
+	wyrmgus::test::lockstep_simulation simulation(3, 2, 10, 5);
+	simulation.set_command_chance(0.5);
+
+	network_conditions conditions;
+	conditions.latency = std::chrono::milliseconds(20);
+	simulation.get_network().set_default_conditions(conditions);
+
+	//after an increase the cycles skipped over are sent at once, and after a decrease the commands are held back, so the peers stay in lockstep without stalling
+	BOOST_REQUIRE(simulation.run(100, 200));
+	simulation.change_lag(20);
+	BOOST_REQUIRE(simulation.run(200, 200));
+	simulation.change_lag(12);
+	const bool completed = simulation.run(400, 400);
+	simulation.print_reports();
+	BOOST_REQUIRE(completed);
+
+	size_t executed_command_count = 0;
+
+	for (const wyrmgus::test::lockstep_peer_report &report : simulation.get_reports()) {
+		BOOST_CHECK(report.lag == 12);
+		BOOST_CHECK(report.desync_count == 0);
+		BOOST_CHECK(report.stall_frames == 0);
+
+		if (report.player == 0) {
+			executed_command_count = report.executed_command_count;
+		} else {
+			BOOST_CHECK(report.executed_command_count == executed_command_count);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(lockstep_desync_test)
+{
+	wyrmgus::test::lockstep_simulation simulation(3, 1, 10, 3);
+
+	BOOST_REQUIRE(simulation.run(50, 100));
+	simulation.corrupt_peer_state(2);
+	BOOST_REQUIRE(simulation.run(100, 200));
+
+	size_t desync_count = 0;
+	for (const wyrmgus::test::lockstep_peer_report &report : simulation.get_reports()) {
+		desync_count += report.desync_count;
+	}
+
+	BOOST_CHECK(desync_count > 0);
+}
+
+BOOST_AUTO_TEST_CASE(scripted_outage_test)
+{
+	wyrmgus::test::lockstep_simulation simulation(2, 1, 10, 4);
+
+	network_conditions conditions;
+	conditions.latency = std::chrono::milliseconds(10);
+	simulation.get_network().set_default_conditions(conditions);
+
+	//drop all datagrams for a second, after which the peers have to recover through resend requests
+	simulation.get_network().add_scripted_event(std::chrono::milliseconds(2000), [](network_simulator &network) {
+		network_conditions outage_conditions;
+		outage_conditions.latency = std::chrono::milliseconds(10);
+		outage_conditions.loss_rate = 1;
+		network.set_default_conditions(outage_conditions);
+	});
+
+	simulation.get_network().add_scripted_event(std::chrono::milliseconds(3000), [conditions](network_simulator &network) {
+		network.set_default_conditions(conditions);
+	});
+
+	const bool completed = simulation.run(300, 2000);
+	simulation.print_reports();
+	BOOST_REQUIRE(completed);
+
+	for (const wyrmgus::test::lockstep_peer_report &report : simulation.get_reports()) {
+		BOOST_CHECK(report.desync_count == 0);
+		BOOST_CHECK(report.stall_frames > 0);
+		BOOST_CHECK(report.resend_request_count > 0);
+	}
+}
@@ -58,6 +58,7 @@ void FillCustomValue(CNetworkCommandSync *obj)
 {
 	obj->syncSeed = 0x01234567;
 	obj->syncHash = 0x89ABCDEF;
+	obj->delay = -0x0123;
 }
 void FillCustomValue(CNetworkCommandQuit *obj)
 {
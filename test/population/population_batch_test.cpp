@@ -0,0 +1,495 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+
+#include "stratagus.h"
+
+#include "population/population_batch.h"
+
+#include "database/gsml_data.h"
+#include "population/employment_type.h"
+#include "population/population_class.h"
+#include "population/population_type.h"
+#include "population/population_unit.h"
+#include "population/population_unit_key.h"
+#include "util/random.h"
+#include "util/vector_util.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+using population_unit_vector = std::vector<std::pair<population_unit_key, int64_t>>;
+
+//the per-settlement population simulation as it worked on the population unit objects, before it was batched, kept to check that the batch gives the same results
+class reference_settlement final
+{
+public:
+	explicit reference_settlement(const population_batch::settlement_data &data) : data(data), population(data.population)
+	{
+		for (const auto &[key, unit_population] : data.population_units) {
+			this->population_units.push_back(std::make_unique<reference_population_unit>(key, unit_population));
+		}
+	}
+
+	void do_per_half_minute_loop()
+	{
+		this->do_population_growth();
+		this->do_population_promotion();
+		this->do_population_demotion();
+		this->check_employment_validity();
+		this->check_employment_capacities();
+		this->check_available_employment();
+	}
+
+	population_unit_vector get_population_units() const
+	{
+		population_unit_vector population_units;
+		for (const std::unique_ptr<reference_population_unit> &population_unit : this->population_units) {
+			population_units.emplace_back(population_unit->key, population_unit->population);
+		}
+		return population_units;
+	}
+
+	int64_t get_population() const
+	{
+		return this->population;
+	}
+
+private:
+	struct reference_population_unit final
+	{
+		explicit reference_population_unit(const population_unit_key &key, const int64_t population) : key(key), population(population)
+		{
+		}
+
+		population_unit_key key;
+		int64_t population = 0;
+	};
+
+	reference_population_unit *get_population_unit(const population_unit_key &key) const
+	{
+		for (const std::unique_ptr<reference_population_unit> &population_unit : this->population_units) {
+			if (population_unit->key == key) {
+				return population_unit.get();
+			}
+		}
+		return nullptr;
+	}
+
+	void change_population_unit_population(const population_unit_key &key, const int64_t change)
+	{
+		reference_population_unit *population_unit = this->get_population_unit(key);
+		if (population_unit != nullptr) {
+			population_unit->population += change;
+			this->population += change;
+
+			if (population_unit->population <= 0) {
+				this->population -= population_unit->population;
+				std::erase_if(this->population_units, [population_unit](const std::unique_ptr<reference_population_unit> &other) {
+					return other.get() == population_unit;
+				});
+			}
+			return;
+		}
+
+		if (change > 0) {
+			this->population_units.push_back(std::make_unique<reference_population_unit>(key, change));
+			this->population += change;
+		}
+	}
+
+	void change_population_unit_to_type(const population_unit_key &key, const population_type *population_type, const int64_t quantity)
+	{
+		population_unit_key new_key = key;
+		this->change_population_unit_population(key, -quantity);
+		new_key.type = population_type;
+		this->change_population_unit_population(new_key, quantity);
+	}
+
+	void move_to_employment(const population_unit_key &key, const employment_type *employment_type, const int64_t quantity)
+	{
+		population_unit_key new_key = key;
+		this->change_population_unit_population(key, -quantity);
+		new_key.employment_type = employment_type;
+		this->change_population_unit_population(new_key, quantity);
+	}
+
+	int get_employment_capacity(const employment_type *employment_type) const
+	{
+		for (const auto &[capacity_employment_type, capacity] : this->data.employment_capacities) {
+			if (capacity_employment_type == employment_type) {
+				return capacity;
+			}
+		}
+		return 0;
+	}
+
+	int64_t get_employment_workforce(const employment_type *employment_type) const
+	{
+		int64_t workforce = 0;
+		for (const std::unique_ptr<reference_population_unit> &population_unit : this->population_units) {
+			if (population_unit->key.employment_type == employment_type) {
+				workforce += population_unit->population;
+			}
+		}
+		return workforce;
+	}
+
+	void do_population_growth()
+	{
+		const int64_t population_growth_capacity = this->data.population_capacity - this->population;
+		if (population_growth_capacity == 0) {
+			return;
+		}
+
+		std::vector<std::pair<reference_population_unit *, int64_t>> population_units_permyriad;
+		for (const std::unique_ptr<reference_population_unit> &population_unit : this->population_units) {
+			population_units_permyriad.emplace_back(population_unit.get(), population_unit->population * 10000 / this->population);
+		}
+
+		int64_t remaining_population_growth_capacity = population_growth_capacity;
+
+		for (const auto &[population_unit, permyriad] : population_units_permyriad) {
+			const int64_t population_unit_growth_capacity = population_growth_capacity * permyriad / 10000;
+			if (population_unit_growth_capacity == 0) {
+				continue;
+			}
+
+			population_unit_key key = population_unit->key;
+			if (population_unit_growth_capacity > 0 && !key.type->is_growable()) {
+				key.type = this->data.default_population_type;
+				key.employment_type = nullptr;
+			}
+
+			const int64_t population_unit_growth = population_unit::calculate_population_growth_quantity(population_unit_growth_capacity, population_unit->population);
+			this->change_population_unit_population(key, population_unit_growth);
+
+			remaining_population_growth_capacity -= population_unit_growth_capacity;
+		}
+
+		if (remaining_population_growth_capacity > 0) {
+			const int64_t population_unit_growth = population_unit::calculate_population_growth_quantity(remaining_population_growth_capacity, 0);
+			this->change_population_unit_population(population_unit_key(this->data.default_population_type, nullptr), population_unit_growth);
+		} else if (remaining_population_growth_capacity < 0 && !this->population_units.empty()) {
+			const reference_population_unit *population_unit = this->population_units.front().get();
+			const int64_t change = population_unit::calculate_population_growth_quantity(remaining_population_growth_capacity, population_unit->population);
+			this->change_population_unit_population(population_unit->key, change);
+		}
+	}
+
+	void do_population_promotion()
+	{
+		std::vector<reference_population_unit *> promotable_population_units;
+		for (const std::unique_ptr<reference_population_unit> &population_unit : this->population_units) {
+			if (!population_unit->key.type->get_population_class()->get_promotion_targets().empty() && population_unit->key.employment_type != nullptr) {
+				promotable_population_units.push_back(population_unit.get());
+			}
+		}
+
+		for (reference_population_unit *population_unit : promotable_population_units) {
+			for (const population_class *promotion_class : population_unit->key.type->get_population_class()->get_promotion_targets()) {
+				if (!vector::contains(population_unit->key.employment_type->get_employees(), promotion_class)) {
+					continue;
+				}
+
+				const population_type *promotion_type = this->data.get_class_population_type(promotion_class);
+				if (promotion_type == nullptr) {
+					continue;
+				}
+
+				const int64_t available_capacity = this->get_employment_capacity(population_unit->key.employment_type) - this->get_employment_workforce(population_unit->key.employment_type) + population_unit->population;
+				if (available_capacity <= 0) {
+					continue;
+				}
+
+				const int64_t promotion_quantity = population_unit::calculate_growth_quantity(available_capacity, population_unit->population, true);
+				const bool removed_pop = promotion_quantity >= population_unit->population;
+
+				this->change_population_unit_to_type(population_unit->key, promotion_type, promotion_quantity);
+
+				if (removed_pop) {
+					break;
+				}
+			}
+		}
+	}
+
+	void do_population_demotion()
+	{
+		std::vector<reference_population_unit *> demotable_population_units;
+		for (const std::unique_ptr<reference_population_unit> &population_unit : this->population_units) {
+			const population_class *population_class = population_unit->key.type->get_population_class();
+			if (!population_class->get_demotion_targets().empty() && population_unit->key.employment_type == nullptr && !population_class->can_have_unemployment()) {
+				demotable_population_units.push_back(population_unit.get());
+			}
+		}
+
+		for (reference_population_unit *population_unit : demotable_population_units) {
+			for (const population_class *demotion_class : population_unit->key.type->get_population_class()->get_demotion_targets()) {
+				const population_type *demotion_type = this->data.get_class_population_type(demotion_class);
+				if (demotion_type == nullptr) {
+					continue;
+				}
+
+				const int64_t demotion_quantity = population_unit::calculate_growth_quantity(population_unit->population, population_unit->population, true);
+				const bool removed_pop = demotion_quantity >= population_unit->population;
+
+				this->change_population_unit_to_type(population_unit->key, demotion_type, demotion_quantity);
+
+				if (removed_pop) {
+					break;
+				}
+			}
+		}
+	}
+
+	void check_employment_validity()
+	{
+		std::vector<reference_population_unit *> invalid_employment_population_units;
+		for (const std::unique_ptr<reference_population_unit> &population_unit : this->population_units) {
+			if (population_unit->key.employment_type != nullptr && this->get_employment_capacity(population_unit->key.employment_type) == 0) {
+				invalid_employment_population_units.push_back(population_unit.get());
+			}
+		}
+
+		for (reference_population_unit *population_unit : invalid_employment_population_units) {
+			this->move_to_employment(population_unit->key, nullptr, population_unit->population);
+		}
+	}
+
+	void check_employment_capacities()
+	{
+		for (const auto &[employment_type, capacity] : this->data.employment_capacities) {
+			int64_t surplus_workforce = this->get_employment_workforce(employment_type) - capacity;
+			if (surplus_workforce <= 0) {
+				continue;
+			}
+
+			std::vector<reference_population_unit *> employment_population_units;
+			for (const std::unique_ptr<reference_population_unit> &population_unit : this->population_units) {
+				if (population_unit->key.employment_type == employment_type) {
+					employment_population_units.push_back(population_unit.get());
+				}
+			}
+
+			for (reference_population_unit *population_unit : employment_population_units) {
+				const int64_t unemployed_change = std::min(surplus_workforce, population_unit->population);
+				this->move_to_employment(population_unit->key, nullptr, unemployed_change);
+				surplus_workforce -= unemployed_change;
+
+				if (surplus_workforce <= 0) {
+					break;
+				}
+			}
+		}
+	}
+
+	void check_available_employment()
+	{
+		for (const auto &[employment_type, capacity] : this->data.employment_capacities) {
+			int64_t available_capacity = capacity - this->get_employment_workforce(employment_type);
+			if (available_capacity <= 0) {
+				continue;
+			}
+
+			std::vector<reference_population_unit *> employable_population_units;
+			for (const std::unique_ptr<reference_population_unit> &population_unit : this->population_units) {
+				if (population_unit->key.employment_type == nullptr && employment_type->can_employ(population_unit->key.type->get_population_class())) {
+					employable_population_units.push_back(population_unit.get());
+				}
+			}
+
+			for (reference_population_unit *population_unit : employable_population_units) {
+				const population_class *population_class = population_unit->key.type->get_population_class();
+				const bool is_promotion_employment = !vector::contains(employment_type->get_employees(), population_class);
+
+				population_unit_key key = population_unit->key;
+				int64_t employed_change = std::min(available_capacity, population_unit->population);
+
+				if (is_promotion_employment) {
+					key.type = nullptr;
+
+					for (const wyrmgus::population_class *employee_class : employment_type->get_employees()) {
+						if (!vector::contains(population_class->get_promotion_targets(), employee_class)) {
+							continue;
+						}
+
+						const population_type *employee_type = this->data.get_class_population_type(employee_class);
+						if (employee_type != nullptr) {
+							key.type = employee_type;
+							break;
+						}
+					}
+
+					if (key.type == nullptr) {
+						continue;
+					}
+
+					employed_change = population_unit::calculate_growth_quantity(available_capacity, population_unit->population, true);
+					this->change_population_unit_to_type(population_unit->key, key.type, employed_change);
+				}
+
+				this->move_to_employment(key, employment_type, employed_change);
+				available_capacity -= employed_change;
+
+				if (available_capacity <= 0) {
+					break;
+				}
+			}
+		}
+	}
+
+	const population_batch::settlement_data &data;
+	int64_t population = 0;
+	std::vector<std::unique_ptr<reference_population_unit>> population_units;
+};
+
+//a peasant class which can be promoted to artisans, who cannot be unemployed and so are demoted back when unemployed
+struct population_batch_fixture
+{
+	population_batch_fixture()
+	{
+		this->peasant_class = population_class::add("population_batch_test_peasant", nullptr);
+		this->peasant_class->setProperty("growable", true);
+		this->peasant_class->setProperty("unemployment", true);
+
+		this->artisan_class = population_class::add("population_batch_test_artisan", nullptr);
+
+		gsml_data promotion_targets("promotion_targets");
+		promotion_targets.add_value(this->artisan_class->get_identifier());
+		this->peasant_class->process_gsml_scope(promotion_targets);
+
+		this->peasant_type = population_type::add("population_batch_test_peasant", nullptr);
+		this->peasant_type->setProperty("population_class", QVariant::fromValue(this->peasant_class));
+		this->artisan_type = population_type::add("population_batch_test_artisan", nullptr);
+		this->artisan_type->setProperty("population_class", QVariant::fromValue(this->artisan_class));
+
+		this->farming = employment_type::add("population_batch_test_farming", nullptr);
+		gsml_data farming_employees("employees");
+		farming_employees.add_value(this->peasant_class->get_identifier());
+		this->farming->process_gsml_scope(farming_employees);
+
+		this->crafting = employment_type::add("population_batch_test_crafting", nullptr);
+		gsml_data crafting_employees("employees");
+		crafting_employees.add_value(this->artisan_class->get_identifier());
+		this->crafting->process_gsml_scope(crafting_employees);
+	}
+
+	population_batch::settlement_data generate_settlement_data(std::mt19937 &random_engine) const
+	{
+		const auto generate = [&random_engine](const int64_t min, const int64_t max) {
+			return std::uniform_int_distribution<int64_t>(min, max)(random_engine);
+		};
+
+		population_batch::settlement_data data;
+		data.population_capacity = generate(0, 40) * 1000;
+		data.default_population_type = this->peasant_type;
+		data.get_class_population_type = [this](const population_class *population_class) -> const population_type * {
+			if (population_class == this->peasant_class) {
+				return this->peasant_type;
+			} else if (population_class == this->artisan_class) {
+				return this->artisan_type;
+			}
+			return nullptr;
+		};
+
+		//in the order of the employment type map
+		for (const employment_type *employment_type : { this->crafting, this->farming }) {
+			const int capacity = static_cast<int>(generate(-5, 10)) * 500;
+			if (capacity > 0) {
+				data.employment_capacities.emplace_back(employment_type, capacity);
+			}
+		}
+
+		const std::array<population_unit_key, 4> keys = {
+			population_unit_key(this->peasant_type, nullptr),
+			population_unit_key(this->peasant_type, this->farming),
+			population_unit_key(this->artisan_type, this->crafting),
+			population_unit_key(this->artisan_type, nullptr)
+		};
+
+		for (const population_unit_key &key : keys) {
+			const int64_t population = generate(-2, 10) * 750;
+			if (population > 0) {
+				data.population_units.emplace_back(key, population);
+				data.population += population;
+			}
+		}
+
+		std::shuffle(data.population_units.begin(), data.population_units.end(), random_engine);
+
+		return data;
+	}
+
+	population_class *peasant_class = nullptr;
+	population_class *artisan_class = nullptr;
+	population_type *peasant_type = nullptr;
+	population_type *artisan_type = nullptr;
+	employment_type *farming = nullptr;
+	employment_type *crafting = nullptr;
+};
+
+}
+
+BOOST_FIXTURE_TEST_CASE(population_batch_equivalence_test, population_batch_fixture)
+{
+	static constexpr int half_minute_count = 20;
+
+	population_batch population_batch;
+
+	for (uint32_t seed = 1; seed <= 200; ++seed) {
+		std::mt19937 random_engine(seed);
+		const population_batch::settlement_data initial_data = this->generate_settlement_data(random_engine);
+
+		//the batch must draw the same synced random numbers as the per-settlement code, in the same order, to give the same results
+		random::get()->set_seed(seed);
+		population_batch::settlement_data reference_data = initial_data;
+		for (int i = 0; i < half_minute_count; ++i) {
+			reference_settlement settlement(reference_data);
+			settlement.do_per_half_minute_loop();
+			reference_data.population_units = settlement.get_population_units();
+			reference_data.population = settlement.get_population();
+		}
+		const auto reference_seed = random::get()->get_seed();
+
+		random::get()->set_seed(seed);
+		population_batch::settlement_data batch_data = initial_data;
+		for (int i = 0; i < half_minute_count; ++i) {
+			batch_data.population_units = population_batch.simulate_settlement(batch_data);
+			batch_data.population = 0;
+			for (const auto &[key, population] : batch_data.population_units) {
+				batch_data.population += population;
+			}
+		}
+
+		BOOST_TEST_CONTEXT("seed " << seed) {
+			BOOST_CHECK(random::get()->get_seed() == reference_seed);
+			BOOST_CHECK(batch_data.population == reference_data.population);
+			BOOST_CHECK(batch_data.population_units == reference_data.population_units);
+		}
+	}
+}
@@ -0,0 +1,252 @@
+//       _________ __                 __
+//      /   _____//  |_____________ _/  |______     ____  __ __  ______
+//      \_____  \\   __\_  __ \__  \\   __\__  \   / ___\|  |  \/  ___/
+//      /        \|  |  |  | \// __ \|  |  / __ \_/ /_/  >  |  /\___ |
+//     /_______  /|__|  |__|  (____  /__| (____  /\___  /|____//____  >
+//             \/                  \/          \//_____/            \/
+//  ______________________                           ______________________
+//                        T H E   W A R   B E G I N S
+//         Stratagus - A free fantasy real time strategy game engine
+//
+//      (c) Copyright 2022 by Andrettin
+//
+//      This program is free software; you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation; only version 2 of the License.
+//
+//      This program is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with this program; if not, write to the Free Software
+//      Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+//      02111-1307, USA.
+
+#include "stratagus.h"
+
+#include "sound/sample_cache.h"
+
+#include "database/preferences.h"
+#include "sound/sample.h"
+
+#include <boost/test/unit_test.hpp>
+
+#pragma warning(push, 0)
+#include <SDL.h>
+#include <SDL_mixer.h>
+#pragma warning(pop)
+
+namespace {
+
+constexpr int test_sample_frequency = 44100;
+constexpr int test_sample_channel_count = 2;
+constexpr int test_sample_frame_count = 100000;
+
+//opens the audio device with the dummy driver, and provides WAV files for samples
+class sample_cache_fixture
+{
+public:
+	sample_cache_fixture()
+	{
+		qputenv("SDL_AUDIODRIVER", "dummy");
+
+		BOOST_REQUIRE(SDL_InitSubSystem(SDL_INIT_AUDIO) == 0);
+		BOOST_REQUIRE(Mix_OpenAudio(test_sample_frequency, AUDIO_S16SYS, test_sample_channel_count, 1024) == 0);
+
+		this->directory = std::filesystem::temp_directory_path() / "wyrmgus_sample_cache_test";
+		std::filesystem::create_directories(this->directory);
+
+		this->sound_cache_size = preferences::get()->get_sound_cache_size();
+	}
+
+	~sample_cache_fixture()
+	{
+		preferences::get()->set_sound_cache_size(this->sound_cache_size);
+
+		std::filesystem::remove_all(this->directory);
+
+		Mix_CloseAudio();
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+	}
+
+	//create a sample for a silent 16-bit WAV file in the device's format, so that its decoded data has a known length
+	std::unique_ptr<sample> create_sample(const std::string &name) const
+	{
+		const std::filesystem::path filepath = this->directory / (name + ".wav");
+
+		const uint32_t data_size = test_sample_frame_count * test_sample_channel_count * sizeof(int16_t);
+		const uint16_t block_align = test_sample_channel_count * sizeof(int16_t);
+		const uint32_t byte_rate = test_sample_frequency * block_align;
+
+		std::ofstream ofstream(filepath, std::ios::binary);
+
+		const auto write_uint32 = [&ofstream](const uint32_t value) {
+			const std::array<char, 4> bytes = { static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF), static_cast<char>((value >> 16) & 0xFF), static_cast<char>((value >> 24) & 0xFF) };
+			ofstream.write(bytes.data(), bytes.size());
+		};
+
+		const auto write_uint16 = [&ofstream](const uint16_t value) {
+			const std::array<char, 2> bytes = { static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF) };
+			ofstream.write(bytes.data(), bytes.size());
+		};
+
+		ofstream.write("RIFF", 4);
+		write_uint32(36 + data_size);
+		ofstream.write("WAVE", 4);
+
+		ofstream.write("fmt ", 4);
+		write_uint32(16);
+		write_uint16(1); //PCM
+		write_uint16(test_sample_channel_count);
+		write_uint32(test_sample_frequency);
+		write_uint32(byte_rate);
+		write_uint16(block_align);
+		write_uint16(16); //bits per sample
+
+		ofstream.write("data", 4);
+		write_uint32(data_size);
+
+		const std::vector<char> data(data_size, 0);
+		ofstream.write(data.data(), data.size());
+		ofstream.close();
+
+		return std::make_unique<sample>(filepath);
+	}
+
+private:
+	std::filesystem::path directory;
+	int sound_cache_size = 0;
+};
+
+void wait_for_decoding(sample_cache &cache, const sample *sample)
+{
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while (!sample->is_loaded() && std::chrono::steady_clock::now() < deadline) {
+		cache.process_decoded_samples();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+}
+
+BOOST_FIXTURE_TEST_CASE(sample_cache_prefetch_test, sample_cache_fixture)
+{
+	sample_cache cache;
+	const std::unique_ptr<sample> sample = this->create_sample("prefetch");
+
+	cache.prefetch_sample(sample.get());
+	BOOST_CHECK(sample->get_cache() == &cache);
+
+	wait_for_decoding(cache, sample.get());
+	BOOST_REQUIRE(sample->is_loaded());
+	BOOST_CHECK(cache.get_memory_usage() == static_cast<size_t>(sample->get_length()));
+
+	//a prefetched sample is played without stalling
+	BOOST_CHECK(cache.request_sample(sample.get(), false) == sample->get_chunk());
+	BOOST_CHECK(cache.get_hit_count() == 1);
+	BOOST_CHECK(cache.get_miss_count() == 0);
+	BOOST_CHECK(cache.get_stall_count() == 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(sample_cache_miss_test, sample_cache_fixture)
+{
+	sample_cache cache;
+	const std::unique_ptr<sample> sample = this->create_sample("miss");
+
+	//a sample which is not ready is not played, but queued for decoding
+	BOOST_CHECK(cache.request_sample(sample.get(), false) == nullptr);
+	BOOST_CHECK(cache.get_miss_count() == 1);
+	BOOST_CHECK(cache.get_hit_count() == 0);
+
+	wait_for_decoding(cache, sample.get());
+	BOOST_REQUIRE(sample->is_loaded());
+
+	BOOST_CHECK(cache.request_sample(sample.get(), false) != nullptr);
+	BOOST_CHECK(cache.get_hit_count() == 1);
+	BOOST_CHECK(cache.get_miss_count() == 1);
+	BOOST_CHECK(cache.get_stall_count() == 0);
+}
+
+BOOST_FIXTURE_TEST_CASE(sample_cache_stall_test, sample_cache_fixture)
+{
+	sample_cache cache;
+	const std::unique_ptr<sample> sample = this->create_sample("stall");
+
+	BOOST_CHECK(cache.request_sample(sample.get(), true) != nullptr);
+	BOOST_CHECK(sample->is_loaded());
+	BOOST_CHECK(cache.get_stall_count() == 1);
+	BOOST_CHECK(cache.get_miss_count() == 0);
+
+	BOOST_CHECK(cache.request_sample(sample.get(), true) != nullptr);
+	BOOST_CHECK(cache.get_stall_count() == 1);
+	BOOST_CHECK(cache.get_hit_count() == 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(sample_cache_eviction_test, sample_cache_fixture)
+{
+	//a budget of 1 MB holds two of the test samples, but not three
+	preferences::get()->set_sound_cache_size(1);
+
+	sample_cache cache;
+	const std::unique_ptr<sample> sample_1 = this->create_sample("eviction_1");
+	const std::unique_ptr<sample> sample_2 = this->create_sample("eviction_2");
+	const std::unique_ptr<sample> sample_3 = this->create_sample("eviction_3");
+
+	BOOST_REQUIRE(cache.request_sample(sample_1.get(), true) != nullptr);
+	BOOST_REQUIRE(cache.request_sample(sample_2.get(), true) != nullptr);
+
+	const size_t sample_size = static_cast<size_t>(sample_1->get_length());
+	BOOST_REQUIRE(sample_size * 2 <= 1024 * 1024);
+	BOOST_REQUIRE(sample_size * 3 > 1024 * 1024);
+
+	//play the first sample again, so that the second one becomes the least recently used
+	BOOST_CHECK(cache.request_sample(sample_1.get(), false) != nullptr);
+
+	BOOST_REQUIRE(cache.request_sample(sample_3.get(), true) != nullptr);
+	BOOST_CHECK(sample_1->is_loaded());
+	BOOST_CHECK(!sample_2->is_loaded());
+	BOOST_CHECK(sample_3->is_loaded());
+	BOOST_CHECK(cache.get_memory_usage() == sample_size * 2);
+
+	//the evicted sample is decoded again when requested, evicting the least recently used of the others
+	BOOST_CHECK(cache.request_sample(sample_2.get(), false) == nullptr);
+	wait_for_decoding(cache, sample_2.get());
+	BOOST_CHECK(sample_2->is_loaded());
+	BOOST_CHECK(!sample_1->is_loaded());
+	BOOST_CHECK(sample_3->is_loaded());
+	BOOST_CHECK(cache.get_memory_usage() == sample_size * 2);
+
+	BOOST_CHECK(cache.get_hit_count() == 1);
+	BOOST_CHECK(cache.get_miss_count() == 1);
+	BOOST_CHECK(cache.get_stall_count() == 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(sample_cache_remove_test, sample_cache_fixture)
+{
+	sample_cache cache;
+
+	{
+		std::unique_ptr<sample> sample = this->create_sample("remove");
+		cache.prefetch_sample(sample.get());
+
+		//destroying a sample while it is queued or being decoded removes it from the cache
+	}
+
+	cache.process_decoded_samples();
+	BOOST_CHECK(cache.get_memory_usage() == 0);
+
+	//samples which outlive the cache no longer refer to it
+	const std::unique_ptr<sample> sample = this->create_sample("outlive");
+
+	{
+		sample_cache temporary_cache;
+		BOOST_REQUIRE(temporary_cache.request_sample(sample.get(), true) != nullptr);
+		BOOST_CHECK(sample->get_cache() == &temporary_cache);
+	}
+
+	BOOST_CHECK(sample->get_cache() == nullptr);
+	BOOST_CHECK(sample->is_loaded());
+}